@@ -0,0 +1,178 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#include <esp_cpu.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * Minimal benchmark harness, usable on the host and on the device.
+ * Each benchmark is calibrated to run for at least the configured time,
+ * results are reported per operation and, when the work units of one
+ * operation are known, as ns/pixel, frames/s and bytes/s.
+ */
+namespace Bench
+{
+
+// Monotonic tick source: CPU cycles on the device, nanoseconds on the host
+struct Clock
+{
+#ifdef ESP_PLATFORM
+    static constexpr const char* platform = CONFIG_IDF_TARGET;
+    static constexpr double ticksPerNs
+        = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 1000.0;
+
+    // The cycle counter is 32 bit, differences are taken modulo 2^32
+    using Tick = uint32_t;
+    static Tick now() { return esp_cpu_get_cycle_count(); }
+#else
+    static constexpr const char* platform = "host";
+    static constexpr double ticksPerNs = 1.0;
+
+    using Tick = uint64_t;
+    static Tick now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+#endif
+};
+
+// Keeps the compiler from optimizing away the benchmarked computation
+template<typename T> inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Work done by one operation of a benchmark
+struct Units
+{
+    size_t pixels = 0;
+    size_t frames = 0;
+    size_t bytes = 0;
+};
+
+struct Result
+{
+    const char* name;
+    uint32_t iterations;
+    double nsPerOp;
+    Units units;
+
+    double nsPerPixel() const { return nsPerOp / units.pixels; }
+    double framesPerSecond() const { return units.frames * 1e9 / nsPerOp; }
+    double bytesPerSecond() const { return units.bytes * 1e9 / nsPerOp; }
+};
+
+class Runner
+{
+public:
+    explicit Runner(uint32_t minTimeMs = 200)
+        : minTimeNs_{ minTimeMs * 1'000'000.0 }
+    {
+    }
+
+    template<typename Fn> void run(const char* name, Units units, Fn&& fn)
+    {
+        fn();  // warm-up
+
+        // Grow the batch until it is long enough to be timed reliably
+        uint32_t iterations = 1;
+        double elapsedNs = measure(iterations, fn);
+        while (elapsedNs < minTimeNs_ / 10 && iterations < (1u << 24))
+        {
+            iterations *= 2;
+            elapsedNs = measure(iterations, fn);
+        }
+        if (elapsedNs < minTimeNs_)
+        {
+            const double scale = minTimeNs_ / (elapsedNs > 0 ? elapsedNs : 1);
+            iterations = static_cast<uint32_t>(iterations * scale) + 1;
+            elapsedNs = measure(iterations, fn);
+        }
+
+        results_.push_back({ name, iterations, elapsedNs / iterations, units });
+        printSummary(results_.back());
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+    // Machine readable report, one object with all results
+    void printJson(FILE* out) const
+    {
+        std::fprintf(
+            out, "{\"platform\":\"%s\",\"benchmarks\":[", Clock::platform);
+        for (size_t i = 0; i < results_.size(); ++i)
+        {
+            const Result& r = results_[i];
+            std::fprintf(
+                out,
+                "%s{\"name\":\"%s\",\"iterations\":%lu,\"ns_per_op\":%.1f",
+                i ? "," : "",
+                r.name,
+                static_cast<unsigned long>(r.iterations),
+                r.nsPerOp);
+            if (r.units.pixels)
+            {
+                std::fprintf(out, ",\"ns_per_pixel\":%.2f", r.nsPerPixel());
+            }
+            if (r.units.frames)
+            {
+                std::fprintf(
+                    out, ",\"frames_per_s\":%.1f", r.framesPerSecond());
+            }
+            if (r.units.bytes)
+            {
+                std::fprintf(out, ",\"bytes_per_s\":%.0f", r.bytesPerSecond());
+            }
+            std::fprintf(out, "}");
+        }
+        std::fprintf(out, "]}\n");
+    }
+
+private:
+    template<typename Fn> static double measure(uint32_t iterations, Fn& fn)
+    {
+        const Clock::Tick start = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            fn();
+        }
+        const Clock::Tick ticks = Clock::now() - start;
+        return ticks / Clock::ticksPerNs;
+    }
+
+    static void printSummary(const Result& r)
+    {
+        std::fprintf(stderr, "%-40s %12.1f ns/op", r.name, r.nsPerOp);
+        if (r.units.pixels)
+        {
+            std::fprintf(stderr, " %9.2f ns/px", r.nsPerPixel());
+        }
+        if (r.units.frames)
+        {
+            std::fprintf(stderr, " %10.1f frames/s", r.framesPerSecond());
+        }
+        if (r.units.bytes)
+        {
+            std::fprintf(stderr, " %8.2f MB/s", r.bytesPerSecond() / 1e6);
+        }
+        std::fprintf(stderr, "\n");
+    }
+
+    double minTimeNs_;
+    std::vector<Result> results_;
+};
+
+}  // namespace Bench
+
+#endif  // BENCH_HARNESS_HPP
@@ -0,0 +1,17 @@
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include "BenchHarness.hpp"
+#include "LedMatrix.hpp"
+
+// Color correction, pixel mapping and frame conversion of the LED matrix
+void runPipelineBenchmarks(Bench::Runner& runner, LedMatrix& matrix);
+
+// User shaders: the interpreter per frame, at its step budget, and the
+// colour correction it uses
+void runShaderBenchmarks(Bench::Runner& runner, LedMatrix& matrix);
+
+// Binary (de)serialization of stored content and JSON frame parsing
+void runStorageBenchmarks(Bench::Runner& runner);
+
+#endif  // BENCHMARKS_HPP
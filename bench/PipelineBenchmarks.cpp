@@ -0,0 +1,97 @@
+#include "Benchmarks.hpp"
+
+#include <array>
+
+namespace
+{
+using Frame = std::array<LedMatrix::RGB, LedMatrix::numPixels>;
+
+Frame makeTestFrame()
+{
+    Frame frame;
+    for (size_t i = 0; i < frame.size(); ++i)
+    {
+        frame[i] = { static_cast<uint8_t>(i),
+                     static_cast<uint8_t>(255 - i),
+                     static_cast<uint8_t>(i * 7) };
+    }
+    return frame;
+}
+}  // namespace
+
+void runPipelineBenchmarks(Bench::Runner& runner, LedMatrix& matrix)
+{
+    constexpr size_t N = LedMatrix::numPixels;
+    static const Frame frame = makeTestFrame();
+
+    runner.run(
+        "RGB::scaleAndGammaCorrect",
+        { .pixels = N },
+        [&]
+        {
+            for (const auto& pixel: frame)
+            {
+                auto corrected = pixel.scaleAndGammaCorrect();
+                Bench::doNotOptimize(corrected);
+            }
+        });
+
+    runner.run(
+        "WS2812Matrix::index",
+        { .pixels = N },
+        [&]
+        {
+            size_t sum = 0;
+            for (uint16_t y = 0; y < 16; ++y)
+            {
+                for (uint16_t x = 0; x < 16; ++x)
+                {
+                    sum += matrix.index(x, y);
+                }
+            }
+            Bench::doNotOptimize(sum);
+        });
+
+    runner.run(
+        "WS2812Matrix::setAllPixels",
+        { .pixels = N, .frames = 1, .bytes = N * 3 },
+        [&] { matrix.setAllPixels(frame); });
+
+    // 16 colour palette, 4-bit indices
+    static const auto palette = []
+    {
+        std::array<LedMatrix::WireColor, 16> colors;
+        for (size_t i = 0; i < colors.size(); ++i)
+        {
+            colors[i] = LedMatrix::toWire(frame[i]);
+        }
+        return colors;
+    }();
+    static const auto indices = []
+    {
+        std::array<uint8_t, N / 2> packed;
+        for (size_t i = 0; i < packed.size(); ++i)
+        {
+            packed[i] = static_cast<uint8_t>(i * 0x35);
+        }
+        return packed;
+    }();
+
+    runner.run(
+        "WS2812Matrix::setIndexedPixels (4-bit)",
+        { .pixels = N, .frames = 1, .bytes = N / 2 },
+        [&] { matrix.setIndexedPixels(indices.data(), 4, palette.data()); });
+
+    runner.run(
+        "WS2812Matrix::fill",
+        { .pixels = N, .frames = 1, .bytes = N * 3 },
+        [&] { matrix.fill({ 10, 20, 30 }); });
+
+#ifdef ESP_PLATFORM
+    // Includes the wire time of the frame on the device
+    runner.run(
+        "WS2812Matrix::update",
+        { .pixels = N, .frames = 1, .bytes = N * 3 },
+        [&] { matrix.update(); });
+#endif
+}
@@ -0,0 +1,83 @@
+#include "Benchmarks.hpp"
+#include "PixelShader.hpp"
+
+#include <array>
+
+namespace
+{
+// Three sine waves through a rainbow, about the size of a real shader
+constexpr const char* plasmaSource = R"(
+    mul r6, x, 0.08
+    add r6, r6, t
+    sin r6, r6
+    mul r7, y, 0.06
+    sub r7, r7, t
+    cos r7, r7
+    add r8, x, y
+    mul r8, r8, 0.05
+    sin r8, r8
+    add r6, r6, r7
+    add r6, r6, r8
+    mul r6, r6, 0.33
+    sin r, r6
+    add r9, r6, 0.33
+    sin g, r9
+    add r9, r6, 0.67
+    sin b, r9
+    noise r10, x, y
+    mul b, b, r10
+)";
+
+// Never ends: every pixel uses its whole budget
+constexpr const char* spinSource = R"(
+loop:
+    add r6, r6, 0.01
+    jmp loop
+)";
+}  // namespace
+
+void runShaderBenchmarks(Bench::Runner& runner, LedMatrix& matrix)
+{
+    constexpr size_t N = LedMatrix::numPixels;
+
+    ShaderRenderer<LedMatrix> plasma{ *PixelShader::assemble(plasmaSource) };
+    int64_t nowUs = 0;
+    runner.run(
+        "ShaderRenderer::render (plasma)",
+        { .pixels = N, .frames = 1 },
+        [&]
+        {
+            plasma.render(matrix, nowUs);
+            nowUs += PixelShader::frameMs * 1000;
+        });
+
+    // The longest a frame can take, whatever the program
+    ShaderRenderer<LedMatrix> spin{ *PixelShader::assemble(spinSource) };
+    runner.run(
+        "ShaderRenderer::render (step budget)",
+        { .pixels = N, .frames = 1 },
+        [&] { spin.render(matrix, 0); });
+
+    static const auto colors = []
+    {
+        std::array<LedMatrix::RGB, N> frame;
+        for (size_t i = 0; i < frame.size(); ++i)
+        {
+            frame[i] = { static_cast<uint8_t>(i),
+                         static_cast<uint8_t>(255 - i),
+                         static_cast<uint8_t>(i * 7) };
+        }
+        return frame;
+    }();
+    runner.run(
+        "LedMatrix::toWireFast",
+        { .pixels = N },
+        [&]
+        {
+            for (const auto& color: colors)
+            {
+                auto wire = LedMatrix::toWireFast(color);
+                Bench::doNotOptimize(wire);
+            }
+        });
+}
@@ -0,0 +1,144 @@
+#include "Arena.hpp"
+#include "Benchmarks.hpp"
+#include "CJsonHooks.hpp"
+#include "FrameJson.hpp"
+#include "StorageManager.hpp"
+
+#include <cJSON.h>
+
+#include <string>
+
+namespace
+{
+constexpr size_t numFrames = 100;
+constexpr size_t numJsonFrames = 10;
+
+StorageManager::Animation makeTestAnimation()
+{
+    StorageManager::Animation animation;
+    animation.name = "bench";
+    animation.intervalMs = 100;
+    for (size_t f = 0; f < numFrames; ++f)
+    {
+        std::array<LedMatrix::RGB, LedMatrix::numPixels> frame;
+        for (size_t i = 0; i < frame.size(); ++i)
+        {
+            frame[i] = { static_cast<uint8_t>(i + f),
+                         static_cast<uint8_t>(i * 3),
+                         static_cast<uint8_t>(f) };
+        }
+        animation.frames.push_back(frame);
+    }
+    return animation;
+}
+
+// Request body of /animation, as sent by the web interface
+std::string makeAnimationJson()
+{
+    std::string json = "{\"interval_ms\":100,\"frames\":[";
+    char hex[8];
+    for (size_t f = 0; f < numJsonFrames; ++f)
+    {
+        json += f ? ",[" : "[";
+        for (size_t i = 0; i < LedMatrix::numPixels; ++i)
+        {
+            snprintf(
+                hex,
+                sizeof(hex),
+                "#%02x%02x%02x",
+                static_cast<unsigned>(i & 0xff),
+                static_cast<unsigned>(f & 0xff),
+                static_cast<unsigned>((i * 5) & 0xff));
+            json += i ? ",\"" : "\"";
+            json += hex;
+            json += "\"";
+        }
+        json += "]";
+    }
+    json += "]}";
+    return json;
+}
+}  // namespace
+
+void runStorageBenchmarks(Bench::Runner& runner)
+{
+    constexpr size_t N = LedMatrix::numPixels;
+    const auto animation = makeTestAnimation();
+    const auto serialized = StorageManager::serializeAnimation(animation);
+
+    runner.run(
+        "StorageManager::serializeAnimation",
+        { .pixels = numFrames * N,
+          .frames = numFrames,
+          .bytes = serialized.size() },
+        [&]
+        {
+            auto data = StorageManager::serializeAnimation(animation);
+            Bench::doNotOptimize(data);
+        });
+
+    runner.run(
+        "StorageManager::deserializeAnimation",
+        { .pixels = numFrames * N,
+          .frames = numFrames,
+          .bytes = serialized.size() },
+        [&]
+        {
+            auto loaded = StorageManager::deserializeAnimation(serialized);
+            Bench::doNotOptimize(loaded);
+        });
+
+    const std::string json = makeAnimationJson();
+    runner.run(
+        "/animation JSON parse",
+        { .pixels = numJsonFrames * N,
+          .frames = numJsonFrames,
+          .bytes = json.size() },
+        [&]
+        {
+            cJSON* root = cJSON_Parse(json.c_str());
+            cJSON* frames = cJSON_GetObjectItem(root, "frames");
+            cJSON* frame = nullptr;
+            cJSON_ArrayForEach(frame, frames)
+            {
+                auto pixels = FrameJson::parseFrame(frame, true);
+                Bench::doNotOptimize(pixels);
+            }
+            cJSON_Delete(root);
+        });
+
+    cJSON* root = cJSON_Parse(json.c_str());
+    cJSON* firstFrame
+        = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "frames"), 0);
+    runner.run(
+        "FrameJson::parseFrame",
+        { .pixels = N, .frames = 1 },
+        [&]
+        {
+            auto pixels = FrameJson::parseFrame(firstFrame);
+            Bench::doNotOptimize(pixels);
+        });
+    cJSON_Delete(root);
+
+    // Same parse as a handler sees it: cJSON nodes come from the request arena
+    HeapStats::installCJsonHooks();
+    HeapStats::Arena arena;
+    runner.run(
+        "/animation JSON parse (request arena)",
+        { .pixels = numJsonFrames * N,
+          .frames = numJsonFrames,
+          .bytes = json.size() },
+        [&]
+        {
+            HeapStats::Arena::Scope scope{ &arena };
+            cJSON* root = cJSON_Parse(json.c_str());
+            cJSON* frames = cJSON_GetObjectItem(root, "frames");
+            cJSON* frame = nullptr;
+            cJSON_ArrayForEach(frame, frames)
+            {
+                auto pixels = FrameJson::parseFrame(frame, true);
+                Bench::doNotOptimize(pixels);
+            }
+            cJSON_Delete(root);
+        });
+}
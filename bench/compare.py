@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+"""Compares two benchmark reports produced by the FramePix bench harness.
+
+Usage: compare.py BASELINE.json CANDIDATE.json
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        report = json.load(f)
+    return {b["name"]: b for b in report["benchmarks"]}
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    base = load(sys.argv[1])
+    cand = load(sys.argv[2])
+    print(f"{'benchmark':40} {'base ns/op':>12} {'new ns/op':>12} {'change':>8}")
+    for name, b in base.items():
+        c = cand.get(name)
+        if c is None:
+            print(f"{name:40} {b['ns_per_op']:12.1f} {'-':>12} {'-':>8}")
+            continue
+        change = (c["ns_per_op"] - b["ns_per_op"]) / b["ns_per_op"] * 100
+        print(
+            f"{name:40} {b['ns_per_op']:12.1f} {c['ns_per_op']:12.1f}"
+            f" {change:+7.1f}%"
+        )
+    for name, c in cand.items():
+        if name not in base:
+            print(f"{name:40} {'-':>12} {c['ns_per_op']:12.1f} {'new':>8}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,59 @@
+#include "Benchmarks.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Usage: framepix_bench [--min-time-ms N] [--json FILE]
+int main(int argc, char** argv)
+{
+    uint32_t minTimeMs = 200;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc)
+        {
+            minTimeMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            std::fprintf(
+                stderr, "Usage: %s [--min-time-ms N] [--json FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    HostSim::Ws2812Sink::instance().setRealtime(false);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    if (!matrix.init())
+    {
+        return 1;
+    }
+
+    Bench::Runner runner{ minTimeMs };
+    runPipelineBenchmarks(runner, matrix);
+    runShaderBenchmarks(runner, matrix);
+#if FRAMEPIX_BENCH_STORAGE
+    runStorageBenchmarks(runner);
+#endif
+
+    FILE* out = jsonPath ? std::fopen(jsonPath, "w") : stdout;
+    if (!out)
+    {
+        std::perror(jsonPath);
+        return 1;
+    }
+    runner.printJson(out);
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+    return 0;
+}
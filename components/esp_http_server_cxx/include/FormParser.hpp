@@ -88,21 +88,17 @@ private:
         while (*ptr && fieldCount_ < MaxFields)
         {
             char* keyStart = ptr;
-            char* keyEnd = nullptr;
             char* valStart = nullptr;
-            char* valEnd = nullptr;
 
             // Find '='
             while (*ptr && *ptr != '=' && *ptr != '&')
                 ++ptr;
             if (*ptr == '=')
             {
-                keyEnd = ptr;
                 *ptr++ = '\0';
                 valStart = ptr;
                 while (*ptr && *ptr != '&')
                     ++ptr;
-                valEnd = ptr;
             }
             else
             {
@@ -118,10 +114,9 @@ private:
             urlDecodeInPlace(keyStart);
             urlDecodeInPlace(valStart);
 
-            fields_[fieldCount_++] = {
-                std::string_view{ keyStart, keyEnd },
-                std::string_view{ valStart, valEnd }
-            };
+            // Decoding shrinks the fields in place, take the new lengths
+            fields_[fieldCount_++] = { std::string_view{ keyStart },
+                                       std::string_view{ valStart } };
         }
     }
 };
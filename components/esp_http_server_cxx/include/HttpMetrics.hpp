@@ -0,0 +1,266 @@
+#ifndef _ESP_HTTP_SERVER_CXX_HTTP_METRICS_HPP
+#define _ESP_HTTP_SERVER_CXX_HTTP_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace EspHttpServer
+{
+// URI handlers one HttpServer takes, each of them gets a metrics slot.
+// What the web UI and the provisioning page register plus a few spare,
+// registering fails once it is full.
+inline constexpr size_t maxUriHandlers = 56;
+
+/**
+ * Per-route request counters in fixed-size storage.
+ * Routes are added when URIs are registered, counters are updated from the
+ * server task and can be read from anywhere. Nothing allocates.
+ */
+class HttpMetrics
+{
+public:
+    static constexpr size_t maxRoutes = maxUriHandlers;
+    // Upper bounds of the latency buckets, the last bucket is +Inf
+    static constexpr std::array<uint32_t, 9> latencyBoundsUs{
+        1'000,   5'000,   10'000,  25'000,   50'000,
+        100'000, 250'000, 500'000, 1'000'000
+    };
+    static constexpr size_t numLatencyBuckets = latencyBoundsUs.size() + 1;
+    // 1xx to 5xx
+    static constexpr size_t numStatusClasses = 5;
+
+    class Route
+    {
+    public:
+        void record(int status, size_t bytesIn, size_t bytesOut, uint32_t latencyUs)
+        {
+            const int statusClass = status / 100 - 1;
+            if (statusClass >= 0 && statusClass < static_cast<int>(numStatusClasses))
+            {
+                statusClasses_[statusClass].fetch_add(1, std::memory_order_relaxed);
+            }
+            size_t bucket = 0;
+            while (bucket < latencyBoundsUs.size() && latencyUs > latencyBoundsUs[bucket])
+            {
+                ++bucket;
+            }
+            latency_[bucket].fetch_add(1, std::memory_order_relaxed);
+            latencySumMs_.fetch_add((latencyUs + 500) / 1'000, std::memory_order_relaxed);
+            bytesIn_.fetch_add(static_cast<uint32_t>(bytesIn), std::memory_order_relaxed);
+            bytesOut_.fetch_add(static_cast<uint32_t>(bytesOut), std::memory_order_relaxed);
+        }
+
+        const char* uri() const { return uri_; }
+        const char* method() const { return method_; }
+
+    private:
+        friend class HttpMetrics;
+
+        const char* uri_{ nullptr };
+        const char* method_{ nullptr };
+        std::array<std::atomic<uint32_t>, numStatusClasses> statusClasses_{};
+        std::array<std::atomic<uint32_t>, numLatencyBuckets> latency_{};
+        // 32-bit like the rest, 64-bit atomics are not lock-free on the
+        // ESP32. They wrap, which Prometheus takes as a counter reset.
+        // The latency sum is in ms, so it only wraps after 49 days of
+        // handler time, not long after the counts do.
+        std::atomic<uint32_t> latencySumMs_{ 0 };
+        std::atomic<uint32_t> bytesIn_{ 0 };
+        std::atomic<uint32_t> bytesOut_{ 0 };
+    };
+
+    // Returns the slot for uri + method (reusing an existing one), or
+    // nullptr when all slots are taken. The strings must outlive the metrics.
+    Route* add(const char* uri, const char* method)
+    {
+        const size_t count = count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (std::strcmp(routes_[i].uri_, uri) == 0
+                && std::strcmp(routes_[i].method_, method) == 0)
+            {
+                return &routes_[i];
+            }
+        }
+        if (count == maxRoutes)
+        {
+            return nullptr;
+        }
+        routes_[count].uri_ = uri;
+        routes_[count].method_ = method;
+        count_.store(count + 1, std::memory_order_release);
+        return &routes_[count];
+    }
+
+    size_t size() const { return count_.load(std::memory_order_acquire); }
+
+    /**
+     * Serializes all counters in the Prometheus text format.
+     * write(const char* data, size_t size) is called once per line and
+     * returns false to abort.
+     */
+    template<typename Writer> bool writePrometheus(Writer&& write) const
+    {
+        static constexpr const char* statusLabels[numStatusClasses]
+            = { "1xx", "2xx", "3xx", "4xx", "5xx" };
+
+        char line[192];
+        auto emit = [&](int length) -> bool
+        {
+            if (length < 0)
+            {
+                return false;
+            }
+            const size_t size = static_cast<size_t>(length) < sizeof(line)
+                                    ? static_cast<size_t>(length)
+                                    : sizeof(line) - 1;
+            return write(line, size);
+        };
+        auto header = [&](const char* name, const char* help, const char* type)
+        {
+            return emit(snprintf(
+                line,
+                sizeof(line),
+                "# HELP %s %s\n# TYPE %s %s\n",
+                name,
+                help,
+                name,
+                type));
+        };
+        auto counter = [&](const char* name, const Route& route, uint32_t value)
+        {
+            return emit(snprintf(
+                line,
+                sizeof(line),
+                "%s{route=\"%s\",method=\"%s\"} %lu\n",
+                name,
+                route.uri_,
+                route.method_,
+                static_cast<unsigned long>(value)));
+        };
+
+        const size_t count = size();
+
+        if (!header("http_requests_total", "Handled requests", "counter"))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Route& route = routes_[i];
+            for (size_t s = 0; s < numStatusClasses; ++s)
+            {
+                if (!emit(snprintf(
+                        line,
+                        sizeof(line),
+                        "http_requests_total{route=\"%s\",method=\"%s\",status=\"%s\"} %lu\n",
+                        route.uri_,
+                        route.method_,
+                        statusLabels[s],
+                        static_cast<unsigned long>(
+                            route.statusClasses_[s].load(std::memory_order_relaxed)))))
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (!header("http_request_bytes_total", "Received body bytes", "counter"))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!counter(
+                    "http_request_bytes_total",
+                    routes_[i],
+                    routes_[i].bytesIn_.load(std::memory_order_relaxed)))
+            {
+                return false;
+            }
+        }
+
+        if (!header("http_response_bytes_total", "Sent body bytes", "counter"))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!counter(
+                    "http_response_bytes_total",
+                    routes_[i],
+                    routes_[i].bytesOut_.load(std::memory_order_relaxed)))
+            {
+                return false;
+            }
+        }
+
+        if (!header(
+                "http_request_duration_seconds",
+                "Time spent in the handler, including sending",
+                "histogram"))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Route& route = routes_[i];
+            uint32_t cumulative = 0;
+            for (size_t b = 0; b < numLatencyBuckets; ++b)
+            {
+                cumulative += route.latency_[b].load(std::memory_order_relaxed);
+                char le[16];
+                if (b < latencyBoundsUs.size())
+                {
+                    snprintf(le, sizeof(le), "%g", latencyBoundsUs[b] / 1e6);
+                }
+                else
+                {
+                    snprintf(le, sizeof(le), "+Inf");
+                }
+                if (!emit(snprintf(
+                        line,
+                        sizeof(line),
+                        "http_request_duration_seconds_bucket{route=\"%s\",method=\"%s\",le=\"%s\"} %lu\n",
+                        route.uri_,
+                        route.method_,
+                        le,
+                        static_cast<unsigned long>(cumulative))))
+                {
+                    return false;
+                }
+            }
+            const uint32_t sumMs = route.latencySumMs_.load(std::memory_order_relaxed);
+            if (!emit(snprintf(
+                    line,
+                    sizeof(line),
+                    "http_request_duration_seconds_sum{route=\"%s\",method=\"%s\"} %lu.%03lu\n",
+                    route.uri_,
+                    route.method_,
+                    static_cast<unsigned long>(sumMs / 1'000),
+                    static_cast<unsigned long>(sumMs % 1'000)))
+                || !emit(snprintf(
+                    line,
+                    sizeof(line),
+                    "http_request_duration_seconds_count{route=\"%s\",method=\"%s\"} %lu\n",
+                    route.uri_,
+                    route.method_,
+                    static_cast<unsigned long>(cumulative))))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    std::array<Route, maxRoutes> routes_{};
+    std::atomic<size_t> count_{ 0 };
+};
+}  // namespace EspHttpServer
+
+#endif  //_ESP_HTTP_SERVER_CXX_HTTP_METRICS_HPP
@@ -1,6 +1,8 @@
 #ifndef _ESP_HTTP_SERVER_CXX_HTTP_REQUEST_HPP
 #define _ESP_HTTP_SERVER_CXX_HTTP_REQUEST_HPP
 
+#include "Arena.hpp"
+
 #include <esp_http_server.h>
 
 #include <optional>
@@ -12,6 +14,12 @@ namespace EspHttpServer
 class HttpRequest
 {
 public:
+    // Request bodies can be large, they go to the request arena (PSRAM)
+    using Content = std::basic_string<
+        char,
+        std::char_traits<char>,
+        HeapStats::ArenaAllocator<char>>;
+
     HttpRequest(httpd_req_t* req)
         : req_{ req }
     {
@@ -68,12 +76,14 @@ public:
         return std::string(query.substr(valueStart, valueEnd - valueStart));
     }
 
-    std::string getContent()
+    Content getContent()
     {
+        Content content{ HeapStats::ArenaAllocator<char>{
+            HeapStats::AllocTag::Http } };
         if (req_->content_len > 0)
         {
-            std::string content(req_->content_len, ' ');
-            int received = 0;
+            content.resize(req_->content_len);
+            size_t received = 0;
             while (received < req_->content_len)
             {
 
@@ -83,16 +93,29 @@ public:
                     req_->content_len - received);
                 if (ret < 0)
                 {
-                    return std::string{ "" };
+                    content.clear();
+                    return content;
                 }
                 else
                 {
                     received += ret;
                 }
             }
-            return content;
         }
-        return std::string{ "" };
+        return content;
+    }
+
+    // Reads the next part of the body, for bodies too large to hold at
+    // once. Returns the bytes read, 0 once all of it was read, negative
+    // when the connection failed.
+    int receive(char* buffer, size_t size)
+    {
+        int ret;
+        do
+        {
+            ret = httpd_req_recv(req_, buffer, size);
+        } while (ret == HTTPD_SOCK_ERR_TIMEOUT);
+        return ret;
     }
 
     httpd_req_t* getNativeHandle() { return req_; }
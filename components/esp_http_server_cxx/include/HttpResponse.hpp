@@ -1,6 +1,7 @@
 #ifndef _ESP_HTTP_SERVER_CXX_HTTP_RESPONSE_HPP
 #define _ESP_HTTP_SERVER_CXX_HTTP_RESPONSE_HPP
 
+#include "Arena.hpp"
 #include "HttpRequest.hpp"
 
 #include <esp_http_server.h>
@@ -17,7 +18,17 @@ public:
     {
     }
 
-    void setStatus(const char* status) { httpd_resp_set_status(req_, status); }
+    void setStatus(const char* status)
+    {
+        httpd_resp_set_status(req_, status);
+        // "404 Not Found" -> 404, kept for the metrics
+        int code = 0;
+        for (size_t i = 0; i < 3 && status[i] >= '0' && status[i] <= '9'; ++i)
+        {
+            code = code * 10 + (status[i] - '0');
+        }
+        status_ = code;
+    }
 
     void setHeader(const char* key, const char* value)
     {
@@ -49,7 +60,9 @@ private:
 
 private:
     httpd_req_t* req_;
-    std::string content_{};
+    int status_{ 200 };
+    std::basic_string<char, std::char_traits<char>, HeapStats::ArenaAllocator<char>>
+        content_{ HeapStats::ArenaAllocator<char>{ HeapStats::AllocTag::Http } };
     std::string contentType_{};
 };
 
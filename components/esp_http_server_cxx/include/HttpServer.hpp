@@ -1,13 +1,19 @@
 #ifndef _ESP_HTTP_SERVER_CXX_HTTP_SERVER_HPP
 #define _ESP_HTTP_SERVER_CXX_HTTP_SERVER_HPP
 
+#include "Arena.hpp"
+#include "HttpMetrics.hpp"
 #include "HttpUri.hpp"
+#include "WebSocketUri.hpp"
 
 #include <esp_err.h>
 #include <esp_http_server.h>
 
 namespace EspHttpServer
 {
+// Every registered handler must have a slot, or it is missing on /metrics
+static_assert(HttpMetrics::maxRoutes >= maxUriHandlers);
+
 class HttpServer
 {
 public:
@@ -34,11 +40,28 @@ public:
 
     Error registerUri(HttpUri& uri);
     Error unregisterUri(HttpUri& uri);
+    Error registerUri(WebSocketUri& uri);
+    Error unregisterUri(WebSocketUri& uri);
+
+    // Serves the per-route metrics in the Prometheus text format on GET uri
+    Error registerMetricsUri(const char* uri = "/metrics");
+    const HttpMetrics& metrics() const { return metrics_; }
+    // Scratch memory of the handlers, reset after every request
+    const HeapStats::Arena& arena() const { return arena_; }
 
 private:
+    // Registers handle, its metrics slot when one is left
+    Error registerNative(httpd_uri_t& handle, HttpMetrics::Route*& metrics);
+    Error unregisterNative(httpd_uri_t& handle);
+    static esp_err_t metricsHandler(httpd_req_t* req);
+
     httpd_handle_t server_;
     httpd_config_t config_;
     bool running_{ false };
+    HttpMetrics metrics_;
+    // All handlers run on the single server task
+    HeapStats::Arena arena_;
+    httpd_uri_t metricsUri_{};
 };
 }
 
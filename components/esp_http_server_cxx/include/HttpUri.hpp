@@ -1,10 +1,13 @@
 #ifndef _ESP_HTTP_SERVER_CXX_HTTP_URI_HPP
 #define _ESP_HTTP_SERVER_CXX_HTTP_URI_HPP
 
+#include "Arena.hpp"
+#include "HttpMetrics.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
 
 #include <esp_http_server.h>
+#include <esp_timer.h>
 
 #include <functional>
 
@@ -23,8 +26,20 @@ public:
                     [](httpd_req_t* req)
                 {
                     HttpUri* uriObj = (HttpUri*)req->user_ctx;
+                    const int64_t startUs = esp_timer_get_time();
+                    // Everything the handler allocates is dropped at once
+                    HeapStats::Arena::Scope arenaScope{ uriObj->arena_ };
                     auto response = uriObj->handler_(HttpRequest(req));
-                    return response.send();
+                    esp_err_t err = response.send();
+                    if (uriObj->metrics_)
+                    {
+                        uriObj->metrics_->record(
+                            err == ESP_OK ? response.status_ : 500,
+                            req->content_len,
+                            response.content_.size(),
+                            static_cast<uint32_t>(esp_timer_get_time() - startUs));
+                    }
+                    return err;
                 },
                 .user_ctx = this }
     {
@@ -33,6 +48,8 @@ public:
     HttpUri(HttpUri&& other) noexcept
         : handler_{ std::move(other.handler_) }
         , uri_{ other.uri_ }
+        , metrics_{ other.metrics_ }
+        , arena_{ other.arena_ }
     {
         uri_.user_ctx = this;
     }
@@ -44,6 +61,8 @@ public:
             handler_ = std::move(other.handler_);
             uri_ = other.uri_;
             uri_.user_ctx = this;
+            metrics_ = other.metrics_;
+            arena_ = other.arena_;
         }
         return *this;
     }
@@ -54,8 +73,13 @@ public:
     httpd_uri_t& getNativeHandle() { return uri_; }
 
 private:
+    friend class HttpServer;
+
     HttpUriHandlerType handler_;
     httpd_uri_t uri_;
+    // Assigned by HttpServer::registerUri
+    HttpMetrics::Route* metrics_{ nullptr };
+    HeapStats::Arena* arena_{ nullptr };
 };
 }
 
@@ -0,0 +1,115 @@
+#ifndef _ESP_HTTP_SERVER_CXX_WEB_SOCKET_URI_HPP
+#define _ESP_HTTP_SERVER_CXX_WEB_SOCKET_URI_HPP
+
+#include "HttpMetrics.hpp"
+
+#include <esp_http_server.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace EspHttpServer
+{
+/**
+ * WebSocketUri: a WebSocket endpoint. The server answers the handshake and
+ * control frames (ping, close); every text or binary message is read into
+ * a buffer of maxMessageSize bytes, allocated once, and passed to the
+ * handler. A larger message, or the handler returning false, closes the
+ * connection. Needs CONFIG_HTTPD_WS_SUPPORT.
+ */
+class WebSocketUri
+{
+    inline static constexpr const char* TAG = "WebSocketUri";
+
+public:
+    using WebSocketHandlerType
+        = std::function<bool(httpd_ws_type_t type, std::span<const uint8_t> message)>;
+
+    WebSocketUri(const char* uri, size_t maxMessageSize, WebSocketHandlerType handler)
+        : handler_{ handler }
+        , maxMessageSize_{ maxMessageSize }
+        , uri_{ .uri = uri,
+                .method = HTTP_GET,
+                .handler = [](httpd_req_t* req)
+                { return static_cast<WebSocketUri*>(req->user_ctx)->receive(req); },
+                .user_ctx = this,
+                .is_websocket = true }
+    {
+    }
+
+    WebSocketUri(const WebSocketUri&) = delete;
+    WebSocketUri& operator=(const WebSocketUri&) = delete;
+
+    httpd_uri_t& getNativeHandle() { return uri_; }
+
+private:
+    friend class HttpServer;
+
+    esp_err_t receive(httpd_req_t* req)
+    {
+        if (req->method == HTTP_GET)
+        {
+            // The handshake, the connection is open
+            ESP_LOGI(TAG, "[%s] connected", uri_.uri);
+            return ESP_OK;
+        }
+
+        const int64_t startUs = esp_timer_get_time();
+        httpd_ws_frame_t frame{};
+        // The length first, then the payload
+        esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "[%s] failed to read a frame: %s", uri_.uri, esp_err_to_name(err));
+            return err;
+        }
+        if (frame.len > maxMessageSize_)
+        {
+            ESP_LOGW(
+                TAG,
+                "[%s] message of %u bytes is too large",
+                uri_.uri,
+                static_cast<unsigned>(frame.len));
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (buffer_.empty())
+        {
+            buffer_.resize(maxMessageSize_);
+        }
+        if (frame.len > 0)
+        {
+            frame.payload = buffer_.data();
+            err = httpd_ws_recv_frame(req, &frame, frame.len);
+            if (err != ESP_OK)
+            {
+                ESP_LOGW(
+                    TAG, "[%s] failed to read a message: %s", uri_.uri, esp_err_to_name(err));
+                return err;
+            }
+        }
+        const bool ok = handler_(frame.type, { buffer_.data(), frame.len });
+        if (metrics_)
+        {
+            metrics_->record(
+                ok ? 200 : 400,
+                frame.len,
+                0,
+                static_cast<uint32_t>(esp_timer_get_time() - startUs));
+        }
+        return ok ? ESP_OK : ESP_FAIL;
+    }
+
+    WebSocketHandlerType handler_;
+    const size_t maxMessageSize_;
+    std::vector<uint8_t> buffer_;
+    httpd_uri_t uri_;
+    // Assigned by HttpServer::registerUri, one record per message
+    HttpMetrics::Route* metrics_{ nullptr };
+};
+}
+
+#endif  //_ESP_HTTP_SERVER_CXX_WEB_SOCKET_URI_HPP
@@ -2,6 +2,8 @@
 
 #include <esp_log.h>
 
+#include <cstring>
+
 namespace EspHttpServer
 {
 
@@ -109,7 +111,8 @@ HttpServer::Error HttpServer::start(uint16_t port)
     config_ = HTTPD_DEFAULT_CONFIG();
     config_.server_port = port;
     config_.stack_size = 10240;
-    config_.max_uri_handlers = 20;
+    // Shared with HttpMetrics, see HttpMetrics.hpp
+    config_.max_uri_handlers = maxUriHandlers;
 
     esp_err_t err = httpd_start(&server_, &config_);
     running_ = (err == ESP_OK);
@@ -137,19 +140,101 @@ HttpServer::Error HttpServer::stop()
 
 HttpServer::Error HttpServer::registerUri(HttpUri& uri)
 {
-    esp_err_t err
-        = httpd_register_uri_handler(getNativeHandle(), &uri.getNativeHandle());
+    Error result = registerNative(uri.getNativeHandle(), uri.metrics_);
+    if (result == Error::None)
+    {
+        uri.arena_ = &arena_;
+    }
+    return result;
+}
+
+HttpServer::Error HttpServer::registerUri(WebSocketUri& uri)
+{
+    return registerNative(uri.getNativeHandle(), uri.metrics_);
+}
+
+HttpServer::Error
+HttpServer::registerNative(httpd_uri_t& handle, HttpMetrics::Route*& metrics)
+{
+    esp_err_t err = httpd_register_uri_handler(getNativeHandle(), &handle);
+    Error result = (err == ESP_OK) ? Error::None : Error::RegisterUriFailed;
+    logResult("Register URI", err, result, handle.uri);
+    if (result == Error::None)
+    {
+        metrics = metrics_.add(
+            handle.uri, http_method_str(static_cast<http_method>(handle.method)));
+        if (!metrics)
+        {
+            ESP_LOGW(TAG, "No metrics slot left for [%s]", handle.uri);
+        }
+    }
+    return result;
+}
+
+HttpServer::Error HttpServer::registerMetricsUri(const char* uri)
+{
+    metricsUri_ = { .uri = uri,
+                    .method = HTTP_GET,
+                    .handler = metricsHandler,
+                    .user_ctx = this };
+    esp_err_t err = httpd_register_uri_handler(getNativeHandle(), &metricsUri_);
     Error result = (err == ESP_OK) ? Error::None : Error::RegisterUriFailed;
-    logResult("Register URI", err, result, uri.getNativeHandle().uri);
+    logResult("Register URI", err, result, uri);
     return result;
 }
 
+esp_err_t HttpServer::metricsHandler(httpd_req_t* req)
+{
+    auto* server = static_cast<HttpServer*>(req->user_ctx);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    // Lines are batched on the stack and sent as HTTP chunks
+    char buffer[512];
+    size_t used = 0;
+    auto flush = [&]()
+    {
+        esp_err_t err = httpd_resp_send_chunk(req, buffer, used);
+        used = 0;
+        return err == ESP_OK;
+    };
+    bool ok = server->metrics_.writePrometheus(
+        [&](const char* data, size_t size)
+        {
+            if (used + size > sizeof(buffer) && !flush())
+            {
+                return false;
+            }
+            memcpy(buffer + used, data, size);
+            used += size;
+            return true;
+        });
+    if (ok && used > 0)
+    {
+        ok = flush();
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to send metrics");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
 HttpServer::Error HttpServer::unregisterUri(HttpUri& uri)
 {
-    esp_err_t err
-        = httpd_unregister_uri(getNativeHandle(), uri.getNativeHandle().uri);
+    return unregisterNative(uri.getNativeHandle());
+}
+
+HttpServer::Error HttpServer::unregisterUri(WebSocketUri& uri)
+{
+    return unregisterNative(uri.getNativeHandle());
+}
+
+HttpServer::Error HttpServer::unregisterNative(httpd_uri_t& handle)
+{
+    esp_err_t err = httpd_unregister_uri(getNativeHandle(), handle.uri);
     Error result = (err == ESP_OK) ? Error::None : Error::UnregisterUriFailed;
-    logResult("Unregister URI", err, result, uri.getNativeHandle().uri);
+    logResult("Unregister URI", err, result, handle.uri);
     return result;
 }
 
@@ -0,0 +1,137 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "HeapStats.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace HeapStats
+{
+/**
+ * Bump allocator for short-lived allocations, e.g. everything an HTTP
+ * handler builds. Memory comes in PSRAM chunks, freeing single blocks is a
+ * no-op and reset() releases everything at once (the first chunk is kept
+ * for the next round).
+ * An arena is used by one task at a time: Scope makes it the current arena
+ * of the calling task, so allocateScratch() and the cJSON hooks use it.
+ */
+class Arena
+{
+public:
+    // Chunks grow with the arena up to this size (or chunkSize, if bigger),
+    // only blocks larger than that get a bigger chunk of their own
+    static constexpr size_t maxChunkSize = 128 * 1024;
+
+    explicit Arena(size_t chunkSize = 32 * 1024, AllocTag tag = AllocTag::Http);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size);
+    bool owns(const void* ptr) const;
+    void reset();
+
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+    // Most bytes handed out between two resets
+    size_t peakUsed() const { return peakUsed_; }
+
+    // Arena of the calling task, nullptr outside of a Scope
+    static Arena* current();
+
+    // From the current arena, or the accounted heap without one
+    static void* allocateScratch(size_t size, AllocTag tag, bool preferPsram);
+    static void deallocateScratch(void* ptr, AllocTag tag);
+
+    // Makes arena current for the calling task, resets it when done
+    class Scope
+    {
+    public:
+        explicit Scope(Arena* arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* arena_;
+        Arena* previous_;
+    };
+
+private:
+    struct Chunk
+    {
+        Chunk* next;
+        size_t size;
+        size_t used;
+        alignas(std::max_align_t) unsigned char data[];
+    };
+
+    Chunk* addChunk(size_t minSize);
+
+    size_t chunkSize_;
+    AllocTag tag_;
+    Chunk* head_{ nullptr };
+    size_t used_{ 0 };
+    size_t capacity_{ 0 };
+    size_t peakUsed_{ 0 };
+};
+
+/**
+ * Standard allocator on top of Arena::allocateScratch(), for buffers that
+ * only live as long as the current request.
+ */
+template<class T> class ArenaAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::true_type;
+
+    ArenaAllocator(AllocTag tag = AllocTag::Other) noexcept
+        : tag_{ tag }
+    {
+    }
+
+    template<class U>
+    constexpr ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : tag_{ other.tag() }
+    {
+    }
+
+    [[nodiscard]] value_type* allocate(std::size_t n)
+    {
+        return static_cast<value_type*>(
+            Arena::allocateScratch(n * sizeof(value_type), tag_, true));
+    }
+
+    void deallocate(value_type* p, std::size_t) noexcept
+    {
+        Arena::deallocateScratch(p, tag_);
+    }
+
+    AllocTag tag() const { return tag_; }
+
+private:
+    AllocTag tag_;
+};
+
+template<class T, class U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&)
+{
+    return true;
+}
+
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T>& x, const ArenaAllocator<U>& y)
+{
+    return !(x == y);
+}
+}  // namespace HeapStats
+
+#endif  // ARENA_HPP
@@ -0,0 +1,12 @@
+#ifndef CJSON_HOOKS_HPP
+#define CJSON_HOOKS_HPP
+
+namespace HeapStats
+{
+// Routes cJSON allocations to the task's current Arena, or through the
+// accounting tagged as Json. Call once at startup, before anything is parsed.
+// cJSON items created inside an Arena::Scope must not outlive it.
+void installCJsonHooks();
+}  // namespace HeapStats
+
+#endif  // CJSON_HOOKS_HPP
@@ -0,0 +1,61 @@
+#ifndef HEAP_STATS_HPP
+#define HEAP_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HeapStats
+{
+// Subsystem an allocation is accounted to
+enum class AllocTag : uint8_t
+{
+    Other = 0,
+    Animator,
+    Storage,
+    Http,
+    Json,
+    Frames,
+    Count
+};
+
+inline constexpr size_t numTags = static_cast<size_t>(AllocTag::Count);
+
+const char* toString(AllocTag tag);
+
+struct TagStats
+{
+    // Currently allocated, as reported by the heap (includes rounding)
+    uint32_t bytes;
+    uint32_t peakBytes;
+    uint32_t allocations;
+    // Asked for PSRAM, got internal RAM
+    uint32_t psramFallbacks;
+    uint32_t failures;
+};
+
+/**
+ * Allocates size bytes and accounts them to tag.
+ * With preferPsram the block comes from PSRAM when there is any, internal
+ * RAM is only used as a fallback (and counted as such).
+ */
+void* allocate(size_t size, AllocTag tag, bool preferPsram);
+void deallocate(void* ptr, AllocTag tag);
+// Moves the accounting of a live allocation from one tag to another
+void transfer(const void* ptr, AllocTag from, AllocTag to);
+
+TagStats tagStats(AllocTag tag);
+
+struct HeapInfo
+{
+    size_t freeBytes;
+    size_t minimumFreeBytes;
+    size_t largestFreeBlock;
+    // 0 when all free memory is one block
+    uint8_t fragmentationPercent;
+};
+
+// caps is MALLOC_CAP_INTERNAL or MALLOC_CAP_SPIRAM
+HeapInfo heapInfo(uint32_t caps);
+}  // namespace HeapStats
+
+#endif  // HEAP_STATS_HPP
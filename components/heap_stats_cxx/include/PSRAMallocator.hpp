@@ -0,0 +1,62 @@
+#ifndef PSRAM_ALLOCATOR_HPP
+#define PSRAM_ALLOCATOR_HPP
+
+#include "HeapStats.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Allocates from PSRAM, falls back to internal RAM when PSRAM is full.
+ * Allocations are accounted to the tag, which follows the memory when a
+ * container is moved, copied or swapped.
+ */
+template<class T> class PSRAMAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::true_type;
+
+    PSRAMAllocator(HeapStats::AllocTag tag = HeapStats::AllocTag::Other) noexcept
+        : tag_{ tag }
+    {
+    }
+
+    template<class U>
+    constexpr PSRAMAllocator(const PSRAMAllocator<U>& other) noexcept
+        : tag_{ other.tag() }
+    {
+    }
+
+    [[nodiscard]] value_type* allocate(std::size_t n)
+    {
+        return static_cast<value_type*>(HeapStats::allocate(
+            n * sizeof(value_type), tag_, true));
+    }
+
+    void deallocate(value_type* p, std::size_t) noexcept
+    {
+        HeapStats::deallocate(p, tag_);
+    }
+
+    HeapStats::AllocTag tag() const { return tag_; }
+
+private:
+    HeapStats::AllocTag tag_;
+};
+
+template<class T, class U>
+bool operator==(const PSRAMAllocator<T>&, const PSRAMAllocator<U>&)
+{
+    return true;
+}
+
+template<class T, class U>
+bool operator!=(const PSRAMAllocator<T>& x, const PSRAMAllocator<U>& y)
+{
+    return !(x == y);
+}
+#endif  // PSRAM_ALLOCATOR_HPP
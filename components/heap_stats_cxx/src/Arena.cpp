@@ -0,0 +1,155 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+
+namespace HeapStats
+{
+
+static thread_local Arena* currentArena = nullptr;
+
+static constexpr size_t alignment = alignof(std::max_align_t);
+
+static size_t alignUp(size_t value)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+Arena::Arena(size_t chunkSize, AllocTag tag)
+    : chunkSize_{ chunkSize }
+    , tag_{ tag }
+{
+}
+
+Arena::~Arena()
+{
+    while (head_)
+    {
+        Chunk* next = head_->next;
+        deallocate(head_, tag_);
+        head_ = next;
+    }
+}
+
+Arena::Chunk* Arena::addChunk(size_t minSize)
+{
+    // Grows geometrically, so even big requests need only a few chunks, but
+    // not past maxChunkSize: a doubled chunk may not fit in PSRAM any more
+    size_t size = std::max(capacity_, chunkSize_);
+    size = std::min(size, std::max(maxChunkSize, chunkSize_));
+    if (minSize > size)
+    {
+        size = alignUp(minSize);
+    }
+    auto* chunk
+        = static_cast<Chunk*>(HeapStats::allocate(sizeof(Chunk) + size, tag_, true));
+    if (!chunk)
+    {
+        return nullptr;
+    }
+    chunk->next = head_;
+    chunk->size = size;
+    chunk->used = 0;
+    head_ = chunk;
+    capacity_ += size;
+    return chunk;
+}
+
+void* Arena::allocate(size_t size)
+{
+    size = alignUp(size > 0 ? size : 1);
+    Chunk* chunk = head_;
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        chunk = addChunk(size);
+        if (!chunk)
+        {
+            return nullptr;
+        }
+    }
+    void* p = chunk->data + chunk->used;
+    chunk->used += size;
+    used_ += size;
+    if (used_ > peakUsed_)
+    {
+        peakUsed_ = used_;
+    }
+    return p;
+}
+
+bool Arena::owns(const void* ptr) const
+{
+    const auto* p = static_cast<const unsigned char*>(ptr);
+    for (const Chunk* chunk = head_; chunk; chunk = chunk->next)
+    {
+        if (p >= chunk->data && p < chunk->data + chunk->size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Arena::reset()
+{
+    // Keep one regular chunk around, oversized ones go back to the heap
+    Chunk* kept = nullptr;
+    while (head_)
+    {
+        Chunk* next = head_->next;
+        if (!kept && head_->size == chunkSize_)
+        {
+            kept = head_;
+            kept->used = 0;
+            kept->next = nullptr;
+        }
+        else
+        {
+            deallocate(head_, tag_);
+        }
+        head_ = next;
+    }
+    head_ = kept;
+    capacity_ = kept ? kept->size : 0;
+    used_ = 0;
+}
+
+Arena* Arena::current() { return currentArena; }
+
+void* Arena::allocateScratch(size_t size, AllocTag tag, bool preferPsram)
+{
+    if (currentArena)
+    {
+        return currentArena->allocate(size);
+    }
+    return HeapStats::allocate(size, tag, preferPsram);
+}
+
+void Arena::deallocateScratch(void* ptr, AllocTag tag)
+{
+    if (currentArena && currentArena->owns(ptr))
+    {
+        return;
+    }
+    HeapStats::deallocate(ptr, tag);
+}
+
+Arena::Scope::Scope(Arena* arena)
+    : arena_{ arena }
+    , previous_{ currentArena }
+{
+    if (arena_)
+    {
+        currentArena = arena_;
+    }
+}
+
+Arena::Scope::~Scope()
+{
+    if (arena_)
+    {
+        currentArena = previous_;
+        arena_->reset();
+    }
+}
+
+}  // namespace HeapStats
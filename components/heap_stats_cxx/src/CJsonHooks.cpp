@@ -0,0 +1,23 @@
+#include "CJsonHooks.hpp"
+#include "Arena.hpp"
+
+#include <cJSON.h>
+
+namespace HeapStats
+{
+
+static void* jsonMalloc(size_t size)
+{
+    // Without an arena same placement as plain malloc(), only accounted
+    return Arena::allocateScratch(size, AllocTag::Json, false);
+}
+
+static void jsonFree(void* ptr) { Arena::deallocateScratch(ptr, AllocTag::Json); }
+
+void installCJsonHooks()
+{
+    cJSON_Hooks hooks{ .malloc_fn = jsonMalloc, .free_fn = jsonFree };
+    cJSON_InitHooks(&hooks);
+}
+
+}  // namespace HeapStats
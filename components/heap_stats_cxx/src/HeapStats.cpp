@@ -0,0 +1,139 @@
+#include "HeapStats.hpp"
+
+#include "sdkconfig.h"
+#include <esp_heap_caps.h>
+
+#include <array>
+#include <atomic>
+
+namespace HeapStats
+{
+
+namespace
+{
+struct Counters
+{
+    std::atomic<uint32_t> bytes{ 0 };
+    std::atomic<uint32_t> peakBytes{ 0 };
+    std::atomic<uint32_t> allocations{ 0 };
+    std::atomic<uint32_t> psramFallbacks{ 0 };
+    std::atomic<uint32_t> failures{ 0 };
+};
+
+std::array<Counters, numTags> counters;
+
+Counters& countersFor(AllocTag tag)
+{
+    const auto i = static_cast<size_t>(tag);
+    return counters[i < numTags ? i : 0];
+}
+
+void add(Counters& c, uint32_t size)
+{
+    const uint32_t bytes
+        = c.bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint32_t peak = c.peakBytes.load(std::memory_order_relaxed);
+    while (bytes > peak
+           && !c.peakBytes.compare_exchange_weak(
+               peak, bytes, std::memory_order_relaxed))
+    {
+    }
+}
+}  // namespace
+
+const char* toString(AllocTag tag)
+{
+    switch (tag)
+    {
+    case AllocTag::Other:
+        return "other";
+    case AllocTag::Animator:
+        return "animator";
+    case AllocTag::Storage:
+        return "storage";
+    case AllocTag::Http:
+        return "http";
+    case AllocTag::Json:
+        return "json";
+    case AllocTag::Frames:
+        return "frames";
+    default:
+        return "invalid";
+    }
+}
+
+void* allocate(size_t size, AllocTag tag, bool preferPsram)
+{
+    Counters& c = countersFor(tag);
+    void* p = nullptr;
+#if CONFIG_SPIRAM
+    if (preferPsram)
+    {
+        p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    }
+#endif  // CONFIG_SPIRAM
+    if (!p)
+    {
+        p = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+        if (p && preferPsram)
+        {
+            c.psramFallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!p)
+    {
+        c.failures.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    add(c, heap_caps_get_allocated_size(p));
+    return p;
+}
+
+void deallocate(void* ptr, AllocTag tag)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    countersFor(tag).bytes.fetch_sub(
+        heap_caps_get_allocated_size(ptr), std::memory_order_relaxed);
+    heap_caps_free(ptr);
+}
+
+void transfer(const void* ptr, AllocTag from, AllocTag to)
+{
+    if (!ptr || from == to)
+    {
+        return;
+    }
+    const uint32_t size = heap_caps_get_allocated_size(const_cast<void*>(ptr));
+    countersFor(from).bytes.fetch_sub(size, std::memory_order_relaxed);
+    add(countersFor(to), size);
+}
+
+TagStats tagStats(AllocTag tag)
+{
+    const Counters& c = countersFor(tag);
+    return { c.bytes.load(std::memory_order_relaxed),
+             c.peakBytes.load(std::memory_order_relaxed),
+             c.allocations.load(std::memory_order_relaxed),
+             c.psramFallbacks.load(std::memory_order_relaxed),
+             c.failures.load(std::memory_order_relaxed) };
+}
+
+HeapInfo heapInfo(uint32_t caps)
+{
+    HeapInfo info{};
+    info.freeBytes = heap_caps_get_free_size(caps);
+    info.minimumFreeBytes = heap_caps_get_minimum_free_size(caps);
+    info.largestFreeBlock = heap_caps_get_largest_free_block(caps);
+    if (info.freeBytes > 0)
+    {
+        info.fragmentationPercent = static_cast<uint8_t>(
+            100 - (100 * info.largestFreeBlock) / info.freeBytes);
+    }
+    return info;
+}
+
+}  // namespace HeapStats
@@ -0,0 +1,212 @@
+#ifndef COMPOSITOR_HPP
+#define COMPOSITOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * OverlayLayer: content drawn over the animation, e.g. a clock.
+ * With Blend::Alpha every pixel has its own alpha, with Blend::ColorKey
+ * pixels of the key colour are transparent and all others opaque.
+ * Subclasses draw in refresh(), and only when their content changed.
+ */
+template<typename MatrixT> class OverlayLayer
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    static constexpr size_t N = MatrixT::numPixels;
+
+    enum class Blend : uint8_t
+    {
+        Alpha,
+        ColorKey,
+    };
+
+    virtual ~OverlayLayer() = default;
+
+    // Called from the animator task before every frame. Returns true when
+    // the content was redrawn.
+    virtual bool refresh(int64_t nowUs) = 0;
+
+    // Pixel i in logical order, 0 is transparent
+    uint8_t alpha(size_t i) const
+    {
+        if (blend_ == Blend::ColorKey)
+        {
+            const RGB& p = pixels_[i];
+            return p.r == key_.r && p.g == key_.g && p.b == key_.b ? 0 : 255;
+        }
+        return alpha_[i];
+    }
+    const RGB& pixel(size_t i) const { return pixels_[i]; }
+
+protected:
+    explicit OverlayLayer(Blend blend, RGB key = { 0, 0, 0 })
+        : blend_{ blend }
+        , key_{ key }
+    {
+        clear();
+    }
+
+    // Everything transparent
+    void clear()
+    {
+        pixels_.fill(key_);
+        alpha_.fill(0);
+    }
+
+    // alpha is ignored with a colour key
+    void setPixel(uint16_t x, uint16_t y, RGB color, uint8_t alpha = 255)
+    {
+        if (x < MatrixT::width && y < MatrixT::height)
+        {
+            const size_t i = static_cast<size_t>(y) * MatrixT::width + x;
+            pixels_[i] = color;
+            alpha_[i] = alpha;
+        }
+    }
+
+private:
+    Blend blend_;
+    RGB key_;
+    std::array<RGB, N> pixels_;
+    std::array<uint8_t, N> alpha_;
+};
+
+/**
+ * Compositor: draws overlay layers over the content in the matrix buffer.
+ * The layers are flattened into one sparse list of covered pixels, rebuilt
+ * only when a layer changed, so a frame costs a pass over the covered
+ * pixels and nothing else. restore() puts back the content under them,
+ * which keeps delta clips (that patch the previous frame) correct.
+ * Not thread-safe, MatrixAnimator calls it under its lock.
+ */
+template<typename MatrixT> class Compositor
+{
+public:
+    using Layer = OverlayLayer<MatrixT>;
+    using WireColor = typename MatrixT::WireColor;
+
+    // Layers are drawn in the order they were added, later ones on top
+    void add(Layer& layer)
+    {
+        layers_.push_back(&layer);
+        layersChanged_ = true;
+    }
+
+    void remove(Layer& layer)
+    {
+        std::erase(layers_, &layer);
+        layersChanged_ = true;
+    }
+
+    // Lets every layer redraw, rebuilds the composite when one did.
+    // True when the composite changed.
+    bool refresh(int64_t nowUs)
+    {
+        bool changed = layersChanged_;
+        for (auto* layer: layers_)
+        {
+            changed |= layer->refresh(nowUs);
+        }
+        if (changed)
+        {
+            rebuild();
+        }
+        layersChanged_ = false;
+        return changed;
+    }
+
+    // Draws the composite over the content in matrix
+    void apply(MatrixT& matrix)
+    {
+        under_.clear();
+        for (const auto& covered: composite_)
+        {
+            const uint16_t x = covered.pixel % MatrixT::width;
+            const uint16_t y = covered.pixel / MatrixT::width;
+            const WireColor base = matrix.wirePixel(x, y);
+            under_.push_back({ covered.pixel, base });
+
+            const uint32_t rest = 255 - covered.alpha;
+            auto over = [rest](uint8_t top, uint8_t bottom)
+            { return static_cast<uint8_t>(top + (bottom * rest + 127) / 255); };
+            matrix.setWirePixel(
+                x,
+                y,
+                { over(covered.color.g, base.g),
+                  over(covered.color.r, base.r),
+                  over(covered.color.b, base.b) });
+        }
+    }
+
+    // Puts back the content apply() drew over
+    void restore(MatrixT& matrix)
+    {
+        for (const auto& saved: under_)
+        {
+            matrix.setWirePixel(
+                saved.pixel % MatrixT::width, saved.pixel / MatrixT::width, saved.color);
+        }
+        under_.clear();
+    }
+
+    // Pixels the overlays cover
+    size_t covered() const { return composite_.size(); }
+
+private:
+    struct Covered
+    {
+        uint16_t pixel;
+        // Corrected and premultiplied by alpha
+        WireColor color;
+        uint8_t alpha;
+    };
+
+    struct Saved
+    {
+        uint16_t pixel;
+        WireColor color;
+    };
+
+    void rebuild()
+    {
+        composite_.clear();
+        for (size_t i = 0; i < MatrixT::numPixels; ++i)
+        {
+            uint32_t g = 0, r = 0, b = 0, alpha = 0;
+            for (const auto* layer: layers_)
+            {
+                const uint32_t a = layer->alpha(i);
+                if (a == 0)
+                {
+                    continue;
+                }
+                const WireColor top = MatrixT::toWire(layer->pixel(i));
+                const uint32_t rest = 255 - a;
+                g = (top.g * a + g * rest + 127) / 255;
+                r = (top.r * a + r * rest + 127) / 255;
+                b = (top.b * a + b * rest + 127) / 255;
+                alpha = a + (alpha * rest + 127) / 255;
+            }
+            if (alpha > 0)
+            {
+                composite_.push_back(
+                    { static_cast<uint16_t>(i),
+                      { static_cast<uint8_t>(g),
+                        static_cast<uint8_t>(r),
+                        static_cast<uint8_t>(b) },
+                      static_cast<uint8_t>(alpha) });
+            }
+        }
+    }
+
+    std::vector<Layer*> layers_;
+    bool layersChanged_{ false };
+    std::vector<Covered> composite_;
+    std::vector<Saved> under_;
+};
+
+#endif  // COMPOSITOR_HPP
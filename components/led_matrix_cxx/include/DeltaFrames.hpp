@@ -0,0 +1,216 @@
+#ifndef DELTA_FRAMES_HPP
+#define DELTA_FRAMES_HPP
+
+#include "FramePool.hpp"
+#include "PSRAMallocator.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * DeltaFrames: keyframes plus lists of changed pixels, for animations where
+ * only a few pixels change from one frame to the next.
+ * Rendering the frame after the previous one only patches the changed
+ * pixels into the matrix buffer. Frame 0 is always a keyframe, as is any
+ * frame that changes too many pixels.
+ * Colours are stored corrected, in transmit order. Change lists are packed
+ * into slots of a regular FrameSequence, a list never spans two slots.
+ */
+template<typename MatrixT> class DeltaFrames
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr size_t N = MatrixT::numPixels;
+    using Frame = std::array<RGB, N>;
+    using Frames = FrameSequence<Frame>;
+
+    // One change: logical pixel index (little endian), then g, r, b
+    static constexpr size_t changeBytes = 5;
+    // With more changes a keyframe takes less space
+    static constexpr size_t maxChanges = sizeof(Frame) / changeBytes;
+
+    // Pool slots fromFrames() would use
+    static size_t slotsNeeded(const Frames& frames) { return plan(frames, nullptr); }
+
+    // nullopt when the pool is out of memory
+    static std::optional<DeltaFrames> fromFrames(const Frames& frames)
+    {
+        DeltaFrames result;
+        result.entries_.reserve(frames.size());
+        if (!result.slots_.resize(plan(frames, &result.entries_)))
+        {
+            return std::nullopt;
+        }
+
+        for (size_t f = 0; f < frames.size(); ++f)
+        {
+            const Entry& entry = result.entries_[f];
+            uint8_t* out = result.slotData(entry.slot) + entry.offset;
+            const Frame& frame = frames[f];
+            if (entry.keyframe)
+            {
+                ++result.keyframes_;
+                for (size_t i = 0; i < N; ++i, out += 3)
+                {
+                    const auto color = MatrixT::toWire(frame[i]);
+                    out[0] = color.g;
+                    out[1] = color.r;
+                    out[2] = color.b;
+                }
+                continue;
+            }
+            const Frame& previous = frames[f - 1];
+            for (size_t i = 0; i < N; ++i)
+            {
+                if (equal(frame[i], previous[i]))
+                {
+                    continue;
+                }
+                const auto color = MatrixT::toWire(frame[i]);
+                out[0] = static_cast<uint8_t>(i);
+                out[1] = static_cast<uint8_t>(i >> 8);
+                out[2] = color.g;
+                out[3] = color.r;
+                out[4] = color.b;
+                out += changeBytes;
+            }
+        }
+        return result;
+    }
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    // Pool slots in use, each one the size of an RGB frame
+    size_t slots() const { return slots_.size(); }
+    size_t keyframes() const { return keyframes_; }
+    bool isKeyframe(size_t frame) const { return entries_[frame].keyframe; }
+    size_t changes(size_t frame) const { return entries_[frame].changes; }
+
+    static constexpr size_t none = SIZE_MAX;
+
+    // Renders frame over previous, the frame rendered last (none when not
+    // known). Any other jump replays from the closest keyframe before frame.
+    void render(MatrixT& matrix, size_t frame, size_t previous) const
+    {
+        size_t from = frame;
+        const bool follows
+            = previous != none && (previous == frame || previous + 1 == frame);
+        if (!follows)
+        {
+            while (!entries_[from].keyframe)
+            {
+                --from;
+            }
+        }
+        for (size_t f = from; f <= frame; ++f)
+        {
+            apply(matrix, f);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        uint16_t slot;
+        uint16_t offset;
+        uint16_t changes;
+        bool keyframe;
+    };
+    using Entries = std::vector<Entry, PSRAMAllocator<Entry>>;
+
+    static bool equal(const RGB& a, const RGB& b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b;
+    }
+
+    static size_t countChanges(const Frame& from, const Frame& to)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            count += equal(from[i], to[i]) ? 0 : 1;
+        }
+        return count;
+    }
+
+    // Places every frame in a slot, returns the number of slots
+    static size_t plan(const Frames& frames, Entries* entries)
+    {
+        static constexpr size_t slotBytes = sizeof(Frame);
+        size_t slots = 0;
+        size_t deltaSlot = 0;
+        size_t used = slotBytes;
+        for (size_t f = 0; f < frames.size(); ++f)
+        {
+            const size_t changes
+                = f == 0 ? N : countChanges(frames[f - 1], frames[f]);
+            Entry entry{};
+            if (f == 0 || changes > maxChanges)
+            {
+                entry = { static_cast<uint16_t>(slots++), 0, 0, true };
+            }
+            else
+            {
+                const size_t bytes = changes * changeBytes;
+                if (used + bytes > slotBytes)
+                {
+                    deltaSlot = slots++;
+                    used = 0;
+                }
+                entry = { static_cast<uint16_t>(deltaSlot),
+                          static_cast<uint16_t>(used),
+                          static_cast<uint16_t>(changes),
+                          false };
+                used += bytes;
+            }
+            if (entries)
+            {
+                entries->push_back(entry);
+            }
+        }
+        return slots;
+    }
+
+    void apply(MatrixT& matrix, size_t frame) const
+    {
+        const Entry& entry = entries_[frame];
+        const uint8_t* in = slotData(entry.slot) + entry.offset;
+        if (entry.keyframe)
+        {
+            for (size_t i = 0; i < N; ++i, in += 3)
+            {
+                put(matrix, i, in);
+            }
+            return;
+        }
+        for (size_t k = 0; k < entry.changes; ++k, in += changeBytes)
+        {
+            put(matrix, in[0] | (in[1] << 8), in + 2);
+        }
+    }
+
+    static void put(MatrixT& matrix, size_t i, const uint8_t* grb)
+    {
+        matrix.setWirePixel(
+            i % MatrixT::width, i / MatrixT::width, { grb[0], grb[1], grb[2] });
+    }
+
+    uint8_t* slotData(size_t slot)
+    {
+        return reinterpret_cast<uint8_t*>(slots_[slot].data());
+    }
+    const uint8_t* slotData(size_t slot) const
+    {
+        return reinterpret_cast<const uint8_t*>(slots_[slot].data());
+    }
+
+    Entries entries_{ PSRAMAllocator<Entry>{ HeapStats::AllocTag::Frames } };
+    size_t keyframes_{ 0 };
+    Frames slots_;
+};
+
+#endif  // DELTA_FRAMES_HPP
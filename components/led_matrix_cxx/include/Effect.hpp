@@ -0,0 +1,538 @@
+#ifndef EFFECT_HPP
+#define EFFECT_HPP
+
+#include "PSRAMallocator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/**
+ * Effect: a procedural animation and its settings. Effects are computed
+ * for every output frame (see EffectRenderer), so they take no stored
+ * frames and a preset is just these few bytes.
+ */
+struct Effect
+{
+    enum class Kind : uint8_t
+    {
+        // Overlaid sine waves through a rainbow
+        Plasma = 0,
+        // Diagonal rainbow bands
+        Rainbow,
+        // Smooth value noise through a rainbow
+        Noise,
+        // Heat rising from sparks at the bottom
+        Fire,
+        // Falling drops with fading trails
+        MatrixRain,
+        // Conway's game of life on a torus, reseeded when it settles
+        Life,
+    };
+
+    struct Params
+    {
+        // How fast it moves
+        uint8_t speed{ 128 };
+        // Size of the pattern: waves and noise get larger when lower,
+        // flames higher and trails longer when higher
+        uint8_t scale{ 128 };
+        // Brightness of the rainbow effects, how often fire sparks and
+        // drops start, how many cells life seeds
+        uint8_t intensity{ 128 };
+        // Colour of the rain and of living cells
+        uint8_t r{ 0 }, g{ 255 }, b{ 64 };
+    };
+
+    Kind kind{ Kind::Plasma };
+    Params params{};
+
+    // Output frame period, the effect is redrawn this often
+    static constexpr uint32_t frameMs = 20;
+
+    static const char* toString(Kind kind);
+    static std::optional<Kind> parseKind(std::string_view name);
+};
+
+/**
+ * Fixed point helpers for effects. Angles are in 1/256 turns.
+ */
+namespace EffectMath
+{
+namespace detail
+{
+constexpr double sine(double turns)
+{
+    constexpr double pi = 3.14159265358979323846;
+    double x = 2 * pi * (turns - static_cast<int>(turns));
+    if (x > pi)
+    {
+        x -= 2 * pi;
+    }
+    // Taylor series, plenty on [-pi, pi] for 8 bits
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n)
+    {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr std::array<uint8_t, 256> makeSineTable()
+{
+    std::array<uint8_t, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        const double value = 128 + 127 * sine(i / 256.0);
+        table[i] = static_cast<uint8_t>(value + 0.5);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> makePermutation()
+{
+    std::array<uint8_t, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        table[i] = static_cast<uint8_t>(i);
+    }
+    // Fisher-Yates with a fixed LCG, the same pattern on every build
+    uint32_t state = 0x2545F491;
+    for (size_t i = table.size() - 1; i > 0; --i)
+    {
+        state = state * 1664525 + 1013904223;
+        std::swap(table[i], table[(state >> 16) % (i + 1)]);
+    }
+    return table;
+}
+}  // namespace detail
+
+// 128 + 127 * sin(angle)
+inline constexpr std::array<uint8_t, 256> sineTable = detail::makeSineTable();
+inline constexpr std::array<uint8_t, 256> permutation = detail::makePermutation();
+
+constexpr uint8_t sin8(uint8_t angle) { return sineTable[angle]; }
+
+// a + (b - a) * t / 256
+constexpr uint8_t lerp8(uint8_t a, uint8_t b, uint8_t t)
+{
+    return static_cast<uint8_t>(a + (((b - a) * t) >> 8));
+}
+
+// Value noise in [0, 255], coordinates in 1/256 lattice cells
+constexpr uint8_t noise8(uint32_t x, uint32_t y, uint32_t z)
+{
+    auto hash = [](uint32_t ix, uint32_t iy, uint32_t iz)
+    {
+        return permutation
+            [(permutation[(permutation[ix & 255] + iy) & 255] + iz) & 255];
+    };
+    // Smoothstep, so the cells do not show
+    auto ease = [](uint32_t f)
+    { return static_cast<uint8_t>((f * f * (3 * 256 - 2 * f)) >> 16); };
+
+    const uint32_t ix = x >> 8, iy = y >> 8, iz = z >> 8;
+    const uint8_t fx = ease(x & 255), fy = ease(y & 255), fz = ease(z & 255);
+    auto plane = [&](uint32_t cz)
+    {
+        const uint8_t top = lerp8(hash(ix, iy, cz), hash(ix + 1, iy, cz), fx);
+        const uint8_t bottom
+            = lerp8(hash(ix, iy + 1, cz), hash(ix + 1, iy + 1, cz), fx);
+        return lerp8(top, bottom, fy);
+    };
+    return lerp8(plane(iz), plane(iz + 1), fz);
+}
+}  // namespace EffectMath
+
+/**
+ * EffectRenderer: draws an effect into the matrix, one frame per render()
+ * call. Every effect computes a palette index per pixel with integer math,
+ * the palette (256 colours, corrected once when the effect starts or is
+ * tuned) turns the indices into output colours. Stateful effects (fire,
+ * rain, life) step at their own pace, independent of the frame rate.
+ * MatrixAnimator plays it as a clip of one frame.
+ */
+template<typename MatrixT> class EffectRenderer
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr uint16_t W = MatrixT::width;
+    static constexpr uint16_t H = MatrixT::height;
+    static constexpr size_t N = MatrixT::numPixels;
+
+    explicit EffectRenderer(Effect effect)
+        : effect_{ effect }
+    {
+        levels_.resize(N, 0);
+        palette_.resize(256);
+        if (effect_.kind == Effect::Kind::Life)
+        {
+            cells_.resize(N, 0);
+            next_.resize(N, 0);
+            seed();
+        }
+        if (effect_.kind == Effect::Kind::MatrixRain)
+        {
+            drops_.resize(W, noDrop);
+        }
+        buildPalette();
+    }
+
+    // A clip of one frame, rendered anew every time
+    size_t size() const { return 1; }
+    const Effect& effect() const { return effect_; }
+
+    // Takes effect with the next frame, the effect's state is kept
+    void tune(const Effect::Params& params)
+    {
+        effect_.params = params;
+        buildPalette();
+    }
+
+    // Times the effect from startUs instead of the first render() call
+    void startAt(int64_t startUs) { startUs_ = startUs; }
+
+    // Draws the effect as it is nowUs, the first call sets the start time
+    void render(MatrixT& matrix, int64_t nowUs)
+    {
+        if (startUs_ < 0)
+        {
+            startUs_ = nowUs;
+        }
+        const uint32_t timeMs = static_cast<uint32_t>((nowUs - startUs_) / 1000);
+        const Effect::Params& p = effect_.params;
+        // Animation phase in 1/256 turns, speed 128 turns about every 2 s
+        const uint8_t t = static_cast<uint8_t>(
+            (static_cast<uint64_t>(timeMs) * (p.speed + 1)) >> 10);
+
+        switch (effect_.kind)
+        {
+        case Effect::Kind::Plasma:
+            plasma(t);
+            break;
+        case Effect::Kind::Rainbow:
+            rainbow(t);
+            break;
+        case Effect::Kind::Noise:
+            noise(timeMs);
+            break;
+        default:
+            stepUntil(timeMs);
+            break;
+        }
+        matrix.setIndexedPixels(levels_.data(), 8, palette_.data());
+    }
+
+private:
+    using Bytes = std::vector<uint8_t, PSRAMAllocator<uint8_t>>;
+    static constexpr uint8_t noDrop = 255;
+    // Steps a late frame may catch up on, more are dropped
+    static constexpr uint32_t maxCatchUp = 4;
+
+    uint8_t random8()
+    {
+        // xorshift32
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return static_cast<uint8_t>(rng_ >> 24);
+    }
+
+    uint8_t& level(uint16_t x, uint16_t y) { return levels_[y * W + x]; }
+
+    void plasma(uint8_t t)
+    {
+        using EffectMath::sin8;
+        const uint32_t s = effect_.params.scale / 8 + 1;
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                const uint32_t sum = sin8(static_cast<uint8_t>(x * s + t))
+                    + sin8(static_cast<uint8_t>(y * s + 2 * t))
+                    + sin8(static_cast<uint8_t>((x + y) * s / 2 + 3 * t));
+                level(x, y) = static_cast<uint8_t>(sum / 3 + t);
+            }
+        }
+    }
+
+    void rainbow(uint8_t t)
+    {
+        const uint32_t s = effect_.params.scale / 16 + 1;
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                level(x, y) = static_cast<uint8_t>((x + y) * s + t);
+            }
+        }
+    }
+
+    void noise(uint32_t timeMs)
+    {
+        // Lattice cells per pixel: 1/4 at scale 128
+        const uint32_t s = effect_.params.scale / 2 + 1;
+        const uint32_t z = static_cast<uint32_t>(
+            (static_cast<uint64_t>(timeMs) * (effect_.params.speed + 1)) >> 8);
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                level(x, y) = static_cast<uint8_t>(
+                    EffectMath::noise8(x * s, y * s, z) + (z >> 4));
+            }
+        }
+    }
+
+    // Time between two steps of a stateful effect
+    uint32_t stepMs() const
+    {
+        const uint32_t slow = 255 - effect_.params.speed;
+        switch (effect_.kind)
+        {
+        case Effect::Kind::Fire:
+            return 15 + slow / 4;
+        case Effect::Kind::MatrixRain:
+            return 25 + slow / 2;
+        default:
+            return 60 + slow * 4;
+        }
+    }
+
+    void stepUntil(uint32_t timeMs)
+    {
+        const uint32_t period = stepMs();
+        if (timeMs - lastStepMs_ > period * maxCatchUp)
+        {
+            lastStepMs_ = timeMs - period * maxCatchUp;
+        }
+        while (timeMs - lastStepMs_ >= period)
+        {
+            lastStepMs_ += period;
+            switch (effect_.kind)
+            {
+            case Effect::Kind::Fire:
+                fireStep();
+                break;
+            case Effect::Kind::MatrixRain:
+                rainStep();
+                break;
+            default:
+                lifeStep();
+                break;
+            }
+        }
+    }
+
+    // After Fire2012: every column cools, heat drifts up, sparks ignite
+    // near the bottom
+    void fireStep()
+    {
+        const uint32_t cooling = 20 + ((255 - effect_.params.scale) >> 3);
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            for (uint16_t y = 0; y < H; ++y)
+            {
+                const uint8_t cool = static_cast<uint8_t>((random8() * cooling) >> 8);
+                level(x, y) = level(x, y) > cool ? level(x, y) - cool : 0;
+            }
+            for (uint16_t y = 0; y + 2 < H; ++y)
+            {
+                level(x, y) = static_cast<uint8_t>(
+                    (level(x, y + 1) + 2 * level(x, y + 2)) / 3);
+            }
+            if (random8() < effect_.params.intensity)
+            {
+                const uint16_t y = H - 1 - random8() % 3;
+                level(x, y) = static_cast<uint8_t>(
+                    std::min(255, level(x, y) + 160 + random8() % 96));
+            }
+        }
+    }
+
+    void rainStep()
+    {
+        // Trails fade, longer with a higher scale
+        const uint32_t keep = 160 + effect_.params.scale / 4;
+        for (auto& value: levels_)
+        {
+            value = static_cast<uint8_t>((value * keep) >> 8);
+        }
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            uint8_t& head = drops_[x];
+            if (head != noDrop)
+            {
+                head = head + 1 < H ? head + 1 : noDrop;
+            }
+            else if (random8() < effect_.params.intensity / 4)
+            {
+                head = 0;
+            }
+            if (head != noDrop)
+            {
+                level(x, head) = 255;
+            }
+        }
+    }
+
+    void lifeStep()
+    {
+        uint32_t population = 0;
+        uint32_t hash = 2166136261u;
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                uint32_t neighbours = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        if (dx != 0 || dy != 0)
+                        {
+                            neighbours += cells_[((y + H + dy) % H) * W
+                                                 + (x + W + dx) % W];
+                        }
+                    }
+                }
+                const size_t i = y * W + x;
+                const bool alive
+                    = neighbours == 3 || (neighbours == 2 && cells_[i]);
+                next_[i] = alive;
+                population += alive;
+                hash = (hash ^ (alive ? i + 1 : 0)) * 16777619u;
+            }
+        }
+        cells_.swap(next_);
+
+        // Dead cells fade out
+        for (size_t i = 0; i < N; ++i)
+        {
+            levels_[i] = cells_[i] ? 255 : static_cast<uint8_t>(levels_[i] / 2);
+        }
+
+        // Still lifes and blinkers repeat one of the last two generations
+        const bool repeating = hash == hashes_[0] || hash == hashes_[1];
+        hashes_[1] = hashes_[0];
+        hashes_[0] = hash;
+        stale_ = repeating ? stale_ + 1 : 0;
+        if (population == 0 || stale_ > 8 || ++generation_ > 1000)
+        {
+            seed();
+        }
+    }
+
+    void seed()
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            cells_[i] = random8() < effect_.params.intensity / 2;
+            levels_[i] = cells_[i] ? 255 : levels_[i];
+        }
+        stale_ = 0;
+        generation_ = 0;
+    }
+
+    void buildPalette()
+    {
+        const Effect::Params& p = effect_.params;
+        const RGB color{ p.r, p.g, p.b };
+        auto scaled = [](RGB c, uint8_t level)
+        {
+            return RGB{ static_cast<uint8_t>((c.r * (level + 1)) >> 8),
+                        static_cast<uint8_t>((c.g * (level + 1)) >> 8),
+                        static_cast<uint8_t>((c.b * (level + 1)) >> 8) };
+        };
+
+        for (size_t i = 0; i < 256; ++i)
+        {
+            const uint8_t v = static_cast<uint8_t>(i);
+            RGB rgb;
+            switch (effect_.kind)
+            {
+            case Effect::Kind::Fire:
+                rgb = heat(v);
+                break;
+            case Effect::Kind::MatrixRain:
+                // Drop heads light up towards white
+                rgb = v < 224 ? scaled(color, v * 255 / 224)
+                              : RGB{ EffectMath::lerp8(p.r, 255, (v - 224) * 8),
+                                     EffectMath::lerp8(p.g, 255, (v - 224) * 8),
+                                     EffectMath::lerp8(p.b, 255, (v - 224) * 8) };
+                break;
+            case Effect::Kind::Life:
+                rgb = scaled(color, v);
+                break;
+            default:
+                rgb = scaled(hue(v), p.intensity);
+                break;
+            }
+            palette_[i] = MatrixT::toWire(rgb);
+        }
+    }
+
+    // Fully saturated colour wheel
+    static RGB hue(uint8_t h)
+    {
+        const uint8_t rise = static_cast<uint8_t>((h % 43) * 6);
+        const uint8_t fall = static_cast<uint8_t>(255 - rise);
+        switch (h / 43)
+        {
+        case 0:
+            return { 255, rise, 0 };
+        case 1:
+            return { fall, 255, 0 };
+        case 2:
+            return { 0, 255, rise };
+        case 3:
+            return { 0, fall, 255 };
+        case 4:
+            return { rise, 0, 255 };
+        default:
+            return { 255, 0, fall };
+        }
+    }
+
+    // Black, red, yellow, white
+    static RGB heat(uint8_t v)
+    {
+        const uint8_t ramp = static_cast<uint8_t>((v % 85) * 3);
+        if (v < 85)
+        {
+            return { ramp, 0, 0 };
+        }
+        if (v < 170)
+        {
+            return { 255, ramp, 0 };
+        }
+        return { 255, 255, ramp };
+    }
+
+    Effect effect_;
+    int64_t startUs_{ -1 };
+    uint32_t lastStepMs_{ 0 };
+    uint32_t rng_{ 0x9E3779B9 };
+    // Palette index per pixel, also the state of fire and rain
+    Bytes levels_{ PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Animator } };
+    // Life only, next_ is where a generation is computed
+    Bytes cells_{ PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Animator } };
+    Bytes next_{ PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Animator } };
+    std::array<uint32_t, 2> hashes_{};
+    uint32_t stale_{ 0 };
+    uint32_t generation_{ 0 };
+    // Rain only, head row per column
+    Bytes drops_{ PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Animator } };
+    std::vector<WireColor, PSRAMAllocator<WireColor>> palette_{
+        PSRAMAllocator<WireColor>{ HeapStats::AllocTag::Animator }
+    };
+};
+
+#endif  // EFFECT_HPP
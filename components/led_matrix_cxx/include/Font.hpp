@@ -0,0 +1,307 @@
+#ifndef FONT_HPP
+#define FONT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bitmap fonts for printable ASCII, built at compile time into one atlas
+ * layout: 8 column bytes per glyph (bit y set = pixel in row y), trimmed
+ * to the columns a glyph uses, so text is set proportionally.
+ */
+namespace Fonts
+{
+inline constexpr char first = ' ';
+inline constexpr char last = '~';
+inline constexpr size_t glyphCount = last - first + 1;
+
+struct Glyph
+{
+    // First used column and number of used columns
+    uint8_t left;
+    uint8_t width;
+};
+
+struct Atlas
+{
+    uint8_t height;
+    std::array<std::array<uint8_t, 8>, glyphCount> columns;
+    std::array<Glyph, glyphCount> glyphs;
+
+    // Characters outside the atlas show as '?'
+    static constexpr size_t index(char c)
+    {
+        return c >= first && c <= last ? c - first : '?' - first;
+    }
+    constexpr const Glyph& glyph(char c) const { return glyphs[index(c)]; }
+    constexpr uint8_t column(char c, uint8_t x) const
+    {
+        return columns[index(c)][glyph(c).left + x];
+    }
+};
+
+namespace detail
+{
+constexpr void trim(Atlas& atlas, uint8_t cellWidth, uint8_t spaceWidth)
+{
+    for (size_t g = 0; g < glyphCount; ++g)
+    {
+        int left = -1, right = -1;
+        for (int x = 0; x < cellWidth; ++x)
+        {
+            if (atlas.columns[g][x])
+            {
+                left = left < 0 ? x : left;
+                right = x;
+            }
+        }
+        atlas.glyphs[g] = left < 0
+            ? Glyph{ 0, spaceWidth }
+            : Glyph{ static_cast<uint8_t>(left), static_cast<uint8_t>(right - left + 1) };
+    }
+}
+
+// Glyphs given as columns, bit 0 the top row
+template<size_t Width>
+constexpr Atlas fromColumns(
+    const std::array<std::array<uint8_t, Width>, glyphCount>& glyphs,
+    uint8_t height,
+    uint8_t spaceWidth)
+{
+    Atlas atlas{ height, {}, {} };
+    for (size_t g = 0; g < glyphCount; ++g)
+    {
+        for (size_t x = 0; x < Width; ++x)
+        {
+            atlas.columns[g][x] = glyphs[g][x];
+        }
+    }
+    trim(atlas, Width, spaceWidth);
+    return atlas;
+}
+
+// Glyphs given as 8 rows, bit 0 the leftmost column
+constexpr Atlas fromRows(
+    const std::array<std::array<uint8_t, 8>, glyphCount>& glyphs, uint8_t spaceWidth)
+{
+    Atlas atlas{ 8, {}, {} };
+    for (size_t g = 0; g < glyphCount; ++g)
+    {
+        for (size_t y = 0; y < 8; ++y)
+        {
+            for (size_t x = 0; x < 8; ++x)
+            {
+                if (glyphs[g][y] & (1u << x))
+                {
+                    atlas.columns[g][x] |= static_cast<uint8_t>(1u << y);
+                }
+            }
+        }
+    }
+    trim(atlas, 8, spaceWidth);
+    return atlas;
+}
+
+inline constexpr std::array<std::array<uint8_t, 5>, glyphCount> columns5x7{ {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x00, 0x00, 0x5F, 0x00, 0x00 },  // !
+    { 0x00, 0x07, 0x00, 0x07, 0x00 },  // "
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 },  // #
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 },  // $
+    { 0x23, 0x13, 0x08, 0x64, 0x62 },  // %
+    { 0x36, 0x49, 0x55, 0x22, 0x50 },  // &
+    { 0x00, 0x05, 0x03, 0x00, 0x00 },  // '
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 },  // (
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 },  // )
+    { 0x08, 0x2A, 0x1C, 0x2A, 0x08 },  // *
+    { 0x08, 0x08, 0x3E, 0x08, 0x08 },  // +
+    { 0x00, 0x50, 0x30, 0x00, 0x00 },  // ,
+    { 0x08, 0x08, 0x08, 0x08, 0x08 },  // -
+    { 0x00, 0x60, 0x60, 0x00, 0x00 },  // .
+    { 0x20, 0x10, 0x08, 0x04, 0x02 },  // /
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E },  // 0
+    { 0x00, 0x42, 0x7F, 0x40, 0x00 },  // 1
+    { 0x42, 0x61, 0x51, 0x49, 0x46 },  // 2
+    { 0x21, 0x41, 0x45, 0x4B, 0x31 },  // 3
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 },  // 4
+    { 0x27, 0x45, 0x45, 0x45, 0x39 },  // 5
+    { 0x3C, 0x4A, 0x49, 0x49, 0x30 },  // 6
+    { 0x01, 0x71, 0x09, 0x05, 0x03 },  // 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 },  // 8
+    { 0x06, 0x49, 0x49, 0x29, 0x1E },  // 9
+    { 0x00, 0x36, 0x36, 0x00, 0x00 },  // :
+    { 0x00, 0x56, 0x36, 0x00, 0x00 },  // ;
+    { 0x08, 0x14, 0x22, 0x41, 0x00 },  // <
+    { 0x14, 0x14, 0x14, 0x14, 0x14 },  // =
+    { 0x00, 0x41, 0x22, 0x14, 0x08 },  // >
+    { 0x02, 0x01, 0x51, 0x09, 0x06 },  // ?
+    { 0x32, 0x49, 0x79, 0x41, 0x3E },  // @
+    { 0x7E, 0x11, 0x11, 0x11, 0x7E },  // A
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 },  // B
+    { 0x3E, 0x41, 0x41, 0x41, 0x22 },  // C
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C },  // D
+    { 0x7F, 0x49, 0x49, 0x49, 0x41 },  // E
+    { 0x7F, 0x09, 0x09, 0x09, 0x01 },  // F
+    { 0x3E, 0x41, 0x49, 0x49, 0x7A },  // G
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F },  // H
+    { 0x00, 0x41, 0x7F, 0x41, 0x00 },  // I
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 },  // J
+    { 0x7F, 0x08, 0x14, 0x22, 0x41 },  // K
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 },  // L
+    { 0x7F, 0x02, 0x0C, 0x02, 0x7F },  // M
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F },  // N
+    { 0x3E, 0x41, 0x41, 0x41, 0x3E },  // O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 },  // P
+    { 0x3E, 0x41, 0x51, 0x21, 0x5E },  // Q
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 },  // R
+    { 0x46, 0x49, 0x49, 0x49, 0x31 },  // S
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 },  // T
+    { 0x3F, 0x40, 0x40, 0x40, 0x3F },  // U
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F },  // V
+    { 0x3F, 0x40, 0x38, 0x40, 0x3F },  // W
+    { 0x63, 0x14, 0x08, 0x14, 0x63 },  // X
+    { 0x07, 0x08, 0x70, 0x08, 0x07 },  // Y
+    { 0x61, 0x51, 0x49, 0x45, 0x43 },  // Z
+    { 0x00, 0x7F, 0x41, 0x41, 0x00 },  // [
+    { 0x02, 0x04, 0x08, 0x10, 0x20 },  // backslash
+    { 0x00, 0x41, 0x41, 0x7F, 0x00 },  // ]
+    { 0x04, 0x02, 0x01, 0x02, 0x04 },  // ^
+    { 0x40, 0x40, 0x40, 0x40, 0x40 },  // _
+    { 0x00, 0x01, 0x02, 0x04, 0x00 },  // `
+    { 0x20, 0x54, 0x54, 0x54, 0x78 },  // a
+    { 0x7F, 0x48, 0x44, 0x44, 0x38 },  // b
+    { 0x38, 0x44, 0x44, 0x44, 0x20 },  // c
+    { 0x38, 0x44, 0x44, 0x48, 0x7F },  // d
+    { 0x38, 0x54, 0x54, 0x54, 0x18 },  // e
+    { 0x08, 0x7E, 0x09, 0x01, 0x02 },  // f
+    { 0x0C, 0x52, 0x52, 0x52, 0x3E },  // g
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 },  // h
+    { 0x00, 0x44, 0x7D, 0x40, 0x00 },  // i
+    { 0x20, 0x40, 0x44, 0x3D, 0x00 },  // j
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 },  // k
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 },  // l
+    { 0x7C, 0x04, 0x18, 0x04, 0x78 },  // m
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 },  // n
+    { 0x38, 0x44, 0x44, 0x44, 0x38 },  // o
+    { 0x7C, 0x14, 0x14, 0x14, 0x08 },  // p
+    { 0x08, 0x14, 0x14, 0x18, 0x7C },  // q
+    { 0x7C, 0x08, 0x04, 0x04, 0x08 },  // r
+    { 0x48, 0x54, 0x54, 0x54, 0x20 },  // s
+    { 0x04, 0x3F, 0x44, 0x40, 0x20 },  // t
+    { 0x3C, 0x40, 0x40, 0x20, 0x7C },  // u
+    { 0x1C, 0x20, 0x40, 0x20, 0x1C },  // v
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C },  // w
+    { 0x44, 0x28, 0x10, 0x28, 0x44 },  // x
+    { 0x0C, 0x50, 0x50, 0x50, 0x3C },  // y
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 },  // z
+    { 0x00, 0x08, 0x36, 0x41, 0x00 },  // {
+    { 0x00, 0x00, 0x7F, 0x00, 0x00 },  // |
+    { 0x00, 0x41, 0x36, 0x08, 0x00 },  // }
+    { 0x08, 0x04, 0x08, 0x10, 0x08 },  // ~
+} };
+
+inline constexpr std::array<std::array<uint8_t, 8>, glyphCount> rows8x8{ {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },  // !
+    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // "
+    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 },  // #
+    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 },  // $
+    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 },  // %
+    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 },  // &
+    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '
+    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 },  // (
+    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 },  // )
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },  // *
+    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 },  // +
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 },  // ,
+    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 },  // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },  // .
+    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 },  // /
+    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 },  // 0
+    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 },  // 1
+    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 },  // 2
+    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 },  // 3
+    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 },  // 4
+    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 },  // 5
+    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 },  // 6
+    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 },  // 7
+    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 },  // 8
+    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 },  // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 },  // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 },  // ;
+    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 },  // <
+    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 },  // =
+    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 },  // >
+    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 },  // ?
+    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 },  // @
+    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 },  // A
+    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 },  // B
+    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 },  // C
+    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 },  // D
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 },  // E
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 },  // F
+    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 },  // G
+    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 },  // H
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // I
+    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 },  // J
+    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 },  // K
+    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 },  // L
+    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 },  // M
+    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 },  // N
+    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 },  // O
+    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 },  // P
+    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 },  // Q
+    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 },  // R
+    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 },  // S
+    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // T
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 },  // U
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },  // V
+    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 },  // W
+    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 },  // X
+    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 },  // Y
+    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 },  // Z
+    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 },  // [
+    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 },  // backslash
+    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },  // ]
+    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 },  // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },  // _
+    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },  // `
+    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 },  // a
+    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 },  // b
+    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 },  // c
+    { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 },  // d
+    { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 },  // e
+    { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 },  // f
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F },  // g
+    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 },  // h
+    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // i
+    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E },  // j
+    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 },  // k
+    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // l
+    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 },  // m
+    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 },  // n
+    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 },  // o
+    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F },  // p
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 },  // q
+    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 },  // r
+    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 },  // s
+    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 },  // t
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 },  // u
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },  // v
+    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 },  // w
+    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 },  // x
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F },  // y
+    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 },  // z
+    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 },  // {
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },  // |
+    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 },  // }
+    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ~
+} };
+}  // namespace detail
+
+inline constexpr Atlas font5x7 = detail::fromColumns(detail::columns5x7, 7, 3);
+inline constexpr Atlas font8x8 = detail::fromRows(detail::rows8x8, 4);
+}  // namespace Fonts
+
+#endif  // FONT_HPP
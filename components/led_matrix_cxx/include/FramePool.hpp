@@ -0,0 +1,322 @@
+#ifndef FRAME_POOL_HPP
+#define FRAME_POOL_HPP
+
+#include "HeapStats.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * FramePool: fixed-size blocks of FramesPerBlock frames each, allocated in
+ * PSRAM. Released blocks go to a free list instead of back to the heap, so
+ * uploading animations over and over recycles the same blocks and never
+ * needs one large contiguous region. The free list holds at most
+ * maxIdleBytes, blocks past that are freed right away so the peak of one
+ * long animation is not kept from other PSRAM users. trim() hands all idle
+ * blocks back. All members are safe to call from any task.
+ */
+template<typename Frame, size_t FramesPerBlock = 16> class FramePool
+{
+    static_assert(std::is_trivially_copyable_v<Frame>);
+
+public:
+    static constexpr size_t framesPerBlock = FramesPerBlock;
+    static constexpr size_t maxIdleBytes = 64 * 1024;
+
+    struct Block
+    {
+        Block* next;
+        Frame frames[FramesPerBlock];
+    };
+
+    static constexpr size_t maxFreeBlocks
+        = sizeof(Block) < maxIdleBytes ? maxIdleBytes / sizeof(Block) : 1;
+
+    struct Stats
+    {
+        uint32_t blockBytes;
+        uint32_t blocks;
+        uint32_t freeBlocks;
+        uint32_t failures;
+    };
+
+    // One pool per frame type, shared by everyone storing frames
+    static FramePool& instance()
+    {
+        static FramePool pool;
+        return pool;
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // A block from the free list, or a new one; nullptr when out of memory
+    Block* acquire()
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Block* block = free_;
+        if (block)
+        {
+            free_ = block->next;
+            --freeBlocks_;
+        }
+        xSemaphoreGive(lock_);
+        if (block)
+        {
+            return block;
+        }
+
+        void* p = HeapStats::allocate(
+            sizeof(Block), HeapStats::AllocTag::Frames, true);
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        if (p)
+        {
+            ++blocks_;
+        }
+        else
+        {
+            ++failures_;
+        }
+        xSemaphoreGive(lock_);
+        return p ? new (p) Block : nullptr;
+    }
+
+    void release(Block* block)
+    {
+        if (!block)
+        {
+            return;
+        }
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool keep = freeBlocks_ < maxFreeBlocks;
+        if (keep)
+        {
+            block->next = free_;
+            free_ = block;
+            ++freeBlocks_;
+        }
+        else
+        {
+            --blocks_;
+        }
+        xSemaphoreGive(lock_);
+        if (!keep)
+        {
+            HeapStats::deallocate(block, HeapStats::AllocTag::Frames);
+        }
+    }
+
+    // Frees all idle blocks, returns how many
+    size_t trim()
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Block* block = free_;
+        const size_t count = freeBlocks_;
+        free_ = nullptr;
+        blocks_ -= freeBlocks_;
+        freeBlocks_ = 0;
+        xSemaphoreGive(lock_);
+
+        while (block)
+        {
+            Block* next = block->next;
+            HeapStats::deallocate(block, HeapStats::AllocTag::Frames);
+            block = next;
+        }
+        return count;
+    }
+
+    Stats stats() const
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Stats stats{ sizeof(Block), blocks_, freeBlocks_, failures_ };
+        xSemaphoreGive(lock_);
+        return stats;
+    }
+
+private:
+    FramePool() { lock_ = xSemaphoreCreateMutex(); }
+
+    SemaphoreHandle_t lock_;
+    Block* free_{ nullptr };
+    uint32_t blocks_{ 0 };
+    uint32_t freeBlocks_{ 0 };
+    uint32_t failures_{ 0 };
+};
+
+/**
+ * FrameSequence: indexed frame storage on top of FramePool blocks.
+ * Move-only, the blocks go back to the pool on clear() or destruction.
+ * Growing fails (returns false) instead of aborting when the pool is out
+ * of memory.
+ */
+template<typename Frame, size_t FramesPerBlock = 16> class FrameSequence
+{
+public:
+    using Pool = FramePool<Frame, FramesPerBlock>;
+
+    class const_iterator
+    {
+    public:
+        const_iterator(const FrameSequence* sequence, size_t index)
+            : sequence_{ sequence }
+            , index_{ index }
+        {
+        }
+
+        const Frame& operator*() const { return (*sequence_)[index_]; }
+        const Frame* operator->() const { return &(*sequence_)[index_]; }
+        const_iterator& operator++()
+        {
+            ++index_;
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const
+        {
+            return index_ == other.index_;
+        }
+        bool operator!=(const const_iterator& other) const
+        {
+            return index_ != other.index_;
+        }
+
+    private:
+        const FrameSequence* sequence_;
+        size_t index_;
+    };
+
+    FrameSequence() = default;
+    ~FrameSequence() { clear(); }
+
+    FrameSequence(FrameSequence&& other) noexcept
+        : blocks_{ std::move(other.blocks_) }
+        , size_{ std::exchange(other.size_, 0) }
+    {
+        other.blocks_.clear();
+    }
+
+    FrameSequence& operator=(FrameSequence&& other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            blocks_ = std::move(other.blocks_);
+            size_ = std::exchange(other.size_, 0);
+            other.blocks_.clear();
+        }
+        return *this;
+    }
+
+    FrameSequence(const FrameSequence&) = delete;
+    FrameSequence& operator=(const FrameSequence&) = delete;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return blocks_.size() * FramesPerBlock; }
+
+    Frame& operator[](size_t i)
+    {
+        return blocks_[i / FramesPerBlock]->frames[i % FramesPerBlock];
+    }
+    const Frame& operator[](size_t i) const
+    {
+        return blocks_[i / FramesPerBlock]->frames[i % FramesPerBlock];
+    }
+
+    // The frames of block b in use, contiguous in memory, so they can be
+    // streamed to or from a file without another buffer
+    size_t blockCount() const { return (size_ + FramesPerBlock - 1) / FramesPerBlock; }
+    std::span<Frame> block(size_t b)
+    {
+        const size_t left = size_ - b * FramesPerBlock;
+        return { blocks_[b]->frames, left < FramesPerBlock ? left : FramesPerBlock };
+    }
+    std::span<const Frame> block(size_t b) const
+    {
+        const size_t left = size_ - b * FramesPerBlock;
+        return { blocks_[b]->frames, left < FramesPerBlock ? left : FramesPerBlock };
+    }
+
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, size_ }; }
+
+    // Takes all blocks for n frames up front, or none of them
+    bool reserve(size_t n)
+    {
+        const size_t needed = (n + FramesPerBlock - 1) / FramesPerBlock;
+        const size_t had = blocks_.size();
+        if (needed <= had)
+        {
+            return true;
+        }
+        blocks_.reserve(needed);
+        while (blocks_.size() < needed)
+        {
+            auto* block = Pool::instance().acquire();
+            if (!block)
+            {
+                while (blocks_.size() > had)
+                {
+                    Pool::instance().release(blocks_.back());
+                    blocks_.pop_back();
+                }
+                return false;
+            }
+            blocks_.push_back(block);
+        }
+        return true;
+    }
+
+    // Frames added here are left uninitialized, shrinking returns the
+    // blocks that are no longer needed
+    bool resize(size_t n)
+    {
+        if (!reserve(n))
+        {
+            return false;
+        }
+        const size_t needed = (n + FramesPerBlock - 1) / FramesPerBlock;
+        while (blocks_.size() > needed)
+        {
+            Pool::instance().release(blocks_.back());
+            blocks_.pop_back();
+        }
+        size_ = n;
+        return true;
+    }
+
+    bool push_back(const Frame& frame)
+    {
+        if (size_ == capacity() && !reserve(size_ + 1))
+        {
+            return false;
+        }
+        std::memcpy(&(*this)[size_], &frame, sizeof(Frame));
+        ++size_;
+        return true;
+    }
+
+    void clear()
+    {
+        for (auto* block: blocks_)
+        {
+            Pool::instance().release(block);
+        }
+        blocks_.clear();
+        size_ = 0;
+    }
+
+private:
+    std::vector<typename Pool::Block*> blocks_;
+    size_t size_{ 0 };
+};
+
+#endif  // FRAME_POOL_HPP
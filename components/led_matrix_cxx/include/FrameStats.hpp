@@ -0,0 +1,261 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * FrameStats: per-frame timing of the render loop.
+ * One writer (the render task) records samples and applies resets, any
+ * number of readers (e.g. HTTP handlers) take snapshots. Nothing here blocks or allocates.
+ * Timestamps are the low 32 bits of esp_timer_get_time() in µs, differences
+ * are computed with unsigned arithmetic so they survive the wrap-around.
+ */
+class FrameStats
+{
+public:
+    struct Sample
+    {
+        uint32_t convertStartUs;
+        uint32_t transmitStartUs;
+        uint32_t transmitDoneUs;
+    };
+
+    // Upper bounds of the histogram buckets, the last bucket is open
+    static constexpr std::array<uint32_t, 9> bucketBoundsUs{
+        1'000, 2'000, 5'000, 10'000, 20'000, 50'000, 100'000, 200'000, 500'000
+    };
+    static constexpr size_t numBuckets = bucketBoundsUs.size() + 1;
+    using Histogram = std::array<uint32_t, numBuckets>;
+
+    static constexpr size_t historySize = 64;
+
+    struct Summary
+    {
+        uint32_t intervalUs;
+        uint32_t frames;
+        uint32_t deadlineMisses;
+        // Means are moving averages over roughly the last 16 frames
+        uint32_t meanPeriodUs;
+        uint32_t maxPeriodUs;
+        uint32_t meanRenderUs;
+        uint32_t maxRenderUs;
+        // Time between the conversion start of consecutive frames
+        Histogram period;
+        // Conversion start until transmit done
+        Histogram render;
+    };
+
+    // Clears all counters, a frame is late when its period exceeds
+    // intervalUs + slackUs. Callable from any task, the render task applies
+    // it with its next record(), snapshots read as cleared until then.
+    void reset(uint32_t intervalUs, uint32_t slackUs)
+    {
+        pendingIntervalUs_.store(intervalUs, std::memory_order_relaxed);
+        pendingSlackUs_.store(slackUs, std::memory_order_relaxed);
+        resetPending_.store(true, std::memory_order_release);
+    }
+
+    // Period the next frame is expected after, for per-frame durations
+    void setInterval(uint32_t intervalUs)
+    {
+        intervalUs_.store(intervalUs, std::memory_order_relaxed);
+    }
+
+    // The next frame starts a new period instead of ending one, after the
+    // render task paused on purpose (a held frame, a restart). Called by
+    // the render task only.
+    void restartPeriod() { havePrevious_.store(false, std::memory_order_relaxed); }
+
+    // Called by the render task only
+    void record(const Sample& sample)
+    {
+        if (resetPending_.exchange(false, std::memory_order_acq_rel))
+        {
+            clear();
+        }
+
+        const uint32_t renderUs = sample.transmitDoneUs - sample.convertStartUs;
+        average(avgRenderUs_, renderUs, frames_.load(std::memory_order_relaxed));
+        raise(maxRenderUs_, renderUs);
+        add(render_[bucket(renderUs)], 1);
+
+        if (havePrevious_.exchange(true, std::memory_order_acq_rel))
+        {
+            const uint32_t periodUs = sample.convertStartUs - previousStartUs_;
+            average(
+                avgPeriodUs_, periodUs, periods_.load(std::memory_order_relaxed));
+            raise(maxPeriodUs_, periodUs);
+            add(period_[bucket(periodUs)], 1);
+            add(periods_, 1);
+            if (periodUs > intervalUs_.load(std::memory_order_relaxed)
+                               + slackUs_.load(std::memory_order_relaxed))
+            {
+                add(deadlineMisses_, 1);
+            }
+        }
+        previousStartUs_ = sample.convertStartUs;
+        add(frames_, 1);
+        push(sample);
+    }
+
+    Summary summary() const
+    {
+        Summary s{};
+        if (resetPending_.load(std::memory_order_acquire))
+        {
+            s.intervalUs = pendingIntervalUs_.load(std::memory_order_relaxed);
+            return s;
+        }
+        s.intervalUs = intervalUs_.load(std::memory_order_relaxed);
+        s.frames = frames_.load(std::memory_order_relaxed);
+        s.deadlineMisses = deadlineMisses_.load(std::memory_order_relaxed);
+        s.maxPeriodUs = maxPeriodUs_.load(std::memory_order_relaxed);
+        s.maxRenderUs = maxRenderUs_.load(std::memory_order_relaxed);
+        s.meanPeriodUs = avgPeriodUs_.load(std::memory_order_relaxed);
+        s.meanRenderUs = avgRenderUs_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < numBuckets; ++i)
+        {
+            s.period[i] = period_[i].load(std::memory_order_relaxed);
+            s.render[i] = render_[i].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    // Copies up to out.size() of the newest samples, oldest first.
+    // Slots overwritten while copying are skipped.
+    size_t recent(std::span<Sample> out) const
+    {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        const uint32_t available = head < historySize ? head : historySize;
+        const uint32_t count
+            = available < out.size() ? available : static_cast<uint32_t>(out.size());
+
+        size_t copied = 0;
+        for (uint32_t n = head - count; n != head; ++n)
+        {
+            const Slot& slot = ring_[n % historySize];
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            Sample sample{
+                slot.convertStartUs.load(std::memory_order_relaxed),
+                slot.transmitStartUs.load(std::memory_order_relaxed),
+                slot.transmitDoneUs.load(std::memory_order_relaxed),
+            };
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t after = slot.seq.load(std::memory_order_relaxed);
+            // seq is 2 * (n + 1) once sample n is completely written
+            if (before == after && before == 2 * (n + 1))
+            {
+                out[copied++] = sample;
+            }
+        }
+        return copied;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> seq{ 0 };
+        std::atomic<uint32_t> convertStartUs{ 0 };
+        std::atomic<uint32_t> transmitStartUs{ 0 };
+        std::atomic<uint32_t> transmitDoneUs{ 0 };
+    };
+
+    // Render task only, see reset()
+    void clear()
+    {
+        intervalUs_.store(
+            pendingIntervalUs_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        slackUs_.store(
+            pendingSlackUs_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        frames_.store(0, std::memory_order_relaxed);
+        periods_.store(0, std::memory_order_relaxed);
+        deadlineMisses_.store(0, std::memory_order_relaxed);
+        avgPeriodUs_.store(0, std::memory_order_relaxed);
+        maxPeriodUs_.store(0, std::memory_order_relaxed);
+        avgRenderUs_.store(0, std::memory_order_relaxed);
+        maxRenderUs_.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < numBuckets; ++i)
+        {
+            period_[i].store(0, std::memory_order_relaxed);
+            render_[i].store(0, std::memory_order_relaxed);
+        }
+        havePrevious_.store(false, std::memory_order_relaxed);
+    }
+
+    static size_t bucket(uint32_t us)
+    {
+        size_t i = 0;
+        while (i < bucketBoundsUs.size() && us > bucketBoundsUs[i])
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    // Single writer, so plain load + store is enough
+    static void add(std::atomic<uint32_t>& counter, uint32_t value)
+    {
+        counter.store(
+            counter.load(std::memory_order_relaxed) + value,
+            std::memory_order_relaxed);
+    }
+
+    // Moving average over roughly the last 16 values, the first value seeds it
+    static void average(std::atomic<uint32_t>& avg, uint32_t value, uint32_t count)
+    {
+        const uint32_t old = avg.load(std::memory_order_relaxed);
+        const int64_t delta = static_cast<int64_t>(value) - old;
+        avg.store(
+            count == 0 ? value : static_cast<uint32_t>(old + delta / 16),
+            std::memory_order_relaxed);
+    }
+
+    static void raise(std::atomic<uint32_t>& maximum, uint32_t value)
+    {
+        if (value > maximum.load(std::memory_order_relaxed))
+        {
+            maximum.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void push(const Sample& sample)
+    {
+        const uint32_t n = head_.load(std::memory_order_relaxed);
+        Slot& slot = ring_[n % historySize];
+        slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.convertStartUs.store(sample.convertStartUs, std::memory_order_relaxed);
+        slot.transmitStartUs.store(sample.transmitStartUs, std::memory_order_relaxed);
+        slot.transmitDoneUs.store(sample.transmitDoneUs, std::memory_order_relaxed);
+        slot.seq.store(2 * (n + 1), std::memory_order_release);
+        head_.store(n + 1, std::memory_order_release);
+    }
+
+    std::atomic<uint32_t> intervalUs_{ 0 };
+    std::atomic<uint32_t> slackUs_{ 0 };
+    std::atomic<uint32_t> frames_{ 0 };
+    std::atomic<uint32_t> periods_{ 0 };
+    std::atomic<uint32_t> deadlineMisses_{ 0 };
+    // 32-bit only, 64-bit atomics are not lock-free on the ESP32
+    std::atomic<uint32_t> avgPeriodUs_{ 0 };
+    std::atomic<uint32_t> maxPeriodUs_{ 0 };
+    std::atomic<uint32_t> avgRenderUs_{ 0 };
+    std::atomic<uint32_t> maxRenderUs_{ 0 };
+    std::array<std::atomic<uint32_t>, numBuckets> period_{};
+    std::array<std::atomic<uint32_t>, numBuckets> render_{};
+    std::atomic<bool> havePrevious_{ false };
+    std::atomic<bool> resetPending_{ false };
+    std::atomic<uint32_t> pendingIntervalUs_{ 0 };
+    std::atomic<uint32_t> pendingSlackUs_{ 0 };
+    uint32_t previousStartUs_{ 0 };
+
+    std::atomic<uint32_t> head_{ 0 };
+    std::array<Slot, historySize> ring_{};
+};
+
+#endif  // FRAME_STATS_HPP
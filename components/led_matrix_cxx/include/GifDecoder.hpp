@@ -0,0 +1,179 @@
+#ifndef GIF_DECODER_HPP
+#define GIF_DECODER_HPP
+
+#include "PSRAMallocator.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+/**
+ * GifDecoder: decodes an animated GIF as its bytes arrive, any number of
+ * bytes at a time, into frames of a fixed (small) size.
+ * Nothing GIF sized is kept: every decoded pixel is added straight to the
+ * output pixel it falls in (a box filter), and frames are composed
+ * (transparency, disposal) at the output size. Memory is the LZW tables
+ * plus a few output frames, whatever the size of the GIF.
+ */
+class GifDecoder
+{
+public:
+    struct Color
+    {
+        uint8_t r, g, b;
+    };
+
+    // Gets every composed frame and how long it shows, returns false to
+    // stop decoding
+    using FrameCallback = std::function<bool(std::span<const Color> frame, uint32_t delayMs)>;
+
+    // Browsers show frames with a delay under 20 ms for this long
+    static constexpr uint32_t defaultDelayMs = 100;
+    // Largest logical screen accepted, in either direction
+    static constexpr uint16_t maxScreenSize = 4096;
+    // Memory per output pixel: the sums and two composed frames
+    static constexpr size_t bytesPerPixel
+        = sizeof(std::array<uint32_t, 4>) + 2 * sizeof(Color);
+
+    // Allocates everything for a width x height output up front, check ok()
+    GifDecoder(uint16_t width, uint16_t height, FrameCallback onFrame);
+
+    // The output buffers were allocated. When not, feed() fails at once.
+    bool ok() const { return ok_; }
+
+    // Decodes the next size bytes. false once the GIF is invalid or the
+    // callback stopped decoding, further bytes are ignored then.
+    bool feed(const uint8_t* data, size_t size);
+    // The trailer was read, the GIF is complete
+    bool done() const { return state_ == State::Done; }
+    // Why feed() failed, nullptr while it did not
+    const char* error() const { return error_; }
+    size_t frames() const { return frames_; }
+
+private:
+    enum class State : uint8_t
+    {
+        Header,
+        ScreenDescriptor,
+        GlobalColorTable,
+        Block,
+        ExtensionLabel,
+        ExtensionSize,
+        ExtensionData,
+        ImageDescriptor,
+        LocalColorTable,
+        LzwMinimumCodeSize,
+        ImageDataSize,
+        ImageData,
+        Done,
+        Failed,
+    };
+
+    static constexpr uint16_t maxCodes = 4096;
+    static constexpr uint16_t noCode = 0xFFFF;
+
+    template<typename T> using Vector = std::vector<T, PSRAMAllocator<T>>;
+
+    // Reserves size elements, false when the allocator returned nothing
+    template<typename T> static bool reserve(Vector<T>& vector, size_t size);
+    bool step(uint8_t byte);
+    bool fail(const char* error);
+    // Collects count bytes into fields_ in state
+    void expect(State state, size_t count);
+    bool fieldsRead();
+    bool screen();
+    void startImage(uint8_t minimumCodeSize);
+    bool decode(uint8_t byte);
+    bool code(uint16_t code);
+    void pixel(uint8_t index);
+    void nextRow();
+    void enterRow();
+    bool endImage();
+    // Screen pixels in [from, to) that are in cell, along one axis
+    static uint32_t overlap(
+        const Vector<uint16_t>& starts,
+        const Vector<uint16_t>& ends,
+        size_t cell,
+        uint32_t from,
+        uint32_t to);
+
+    const uint16_t width_;
+    const uint16_t height_;
+    FrameCallback onFrame_;
+    bool ok_{ false };
+    State state_{ State::Header };
+    const char* error_{ nullptr };
+    size_t frames_{ 0 };
+
+    // Fixed size fields being read, or the graphic control extension
+    std::array<uint8_t, 9> fields_{};
+    size_t fieldsRead_{ 0 };
+    size_t fieldsNeeded_{ 0 };
+    // Bytes left in the current sub-block or colour table
+    size_t remaining_{ 0 };
+    bool graphicControl_{ false };
+
+    uint16_t screenWidth_{ 0 };
+    uint16_t screenHeight_{ 0 };
+    // Screen columns [start, end) of every output column, the same for
+    // rows. Output pixels overlap when the GIF is smaller than the output.
+    Vector<uint16_t> columnStarts_{ PSRAMAllocator<uint16_t>{ HeapStats::AllocTag::Frames } };
+    Vector<uint16_t> columnEnds_{ PSRAMAllocator<uint16_t>{ HeapStats::AllocTag::Frames } };
+    Vector<uint16_t> rowStarts_{ PSRAMAllocator<uint16_t>{ HeapStats::AllocTag::Frames } };
+    Vector<uint16_t> rowEnds_{ PSRAMAllocator<uint16_t>{ HeapStats::AllocTag::Frames } };
+    std::array<Color, 256> globalColors_{};
+    std::array<Color, 256> localColors_{};
+    bool hasGlobalColors_{ false };
+    // Colour table being read, and the one the image uses
+    Color* table_{ nullptr };
+    const Color* colors_{ nullptr };
+
+    // From the graphic control extension, for the next image only
+    uint8_t disposal_{ 0 };
+    bool transparent_{ false };
+    uint8_t transparentIndex_{ 0 };
+    uint32_t delayMs_{ defaultDelayMs };
+
+    // Image being decoded
+    uint16_t left_{ 0 }, top_{ 0 }, imageWidth_{ 0 }, imageHeight_{ 0 };
+    bool interlaced_{ false };
+    uint8_t pass_{ 0 };
+    uint16_t x_{ 0 }, y_{ 0 };
+    uint32_t pixelsLeft_{ 0 };
+    // Output rows [rowFirst_, rowEnd_) of the current screen row, and
+    // the first output column the current pixel may be in
+    size_t rowFirst_{ 0 };
+    size_t rowEnd_{ 0 };
+    size_t column_{ 0 };
+
+    // Disposal of the image shown last, applied before the next one
+    uint8_t previousDisposal_{ 0 };
+    uint16_t previousLeft_{ 0 }, previousTop_{ 0 }, previousWidth_{ 0 }, previousHeight_{ 0 };
+
+    // LZW state
+    uint8_t minimumCodeSize_{ 0 };
+    uint8_t codeSize_{ 0 };
+    uint16_t clearCode_{ 0 };
+    uint16_t nextCode_{ 0 };
+    uint16_t previousCode_{ noCode };
+    uint8_t firstByte_{ 0 };
+    uint32_t bits_{ 0 };
+    uint8_t bitCount_{ 0 };
+    bool endOfData_{ false };
+    Vector<uint16_t> prefixes_{ PSRAMAllocator<uint16_t>{ HeapStats::AllocTag::Frames } };
+    Vector<uint8_t> suffixes_{ PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Frames } };
+    Vector<uint8_t> stack_{ PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Frames } };
+
+    // Per output pixel: the sum and count of the opaque image pixels in it
+    Vector<std::array<uint32_t, 4>> sums_{
+        PSRAMAllocator<std::array<uint32_t, 4>>{ HeapStats::AllocTag::Frames }
+    };
+    Vector<Color> canvas_{ PSRAMAllocator<Color>{ HeapStats::AllocTag::Frames } };
+    // The canvas before an image that is disposed by restoring it
+    Vector<Color> saved_{ PSRAMAllocator<Color>{ HeapStats::AllocTag::Frames } };
+};
+
+#endif  // GIF_DECODER_HPP
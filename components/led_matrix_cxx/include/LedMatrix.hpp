@@ -17,48 +17,34 @@ enum class WS2812MatrixRotation : uint8_t
 };
 
 /**
- * WS2812Matrix: Template class for driving a WS2812 pixel matrix via RMT.
- * Width, Height: dimensions of the matrix.
- * Serpentine: if true, uses serpentine mapping between rows.
+ * WS2812Colors: colours as they are set and as they are transmitted, the
+ * same for every matrix.
  */
-template<
-    uint16_t Width,
-    uint16_t Height,
-    bool Serpentine = true,
-    WS2812MatrixRotation Rotation = WS2812MatrixRotation::Rot0,
-    bool MirrorX = false,
-    bool MirrorY = false>
-class WS2812Matrix
+struct WS2812Colors
 {
-private:
-    inline static constexpr const char* TAG = "WS2812Matrix";
-
-public:
-    static constexpr size_t numPixels = Width * Height;
-
     struct RGB
     {
         uint8_t r, g, b;
 
-        RGB scaleAndGammaCorrect() const {
-            // Color correction factors
-            constexpr float r_correction = 240.0f / 255.0f;
-            constexpr float g_correction = 250.0f / 255.0f;
-            constexpr float b_correction = 190.0f / 255.0f;
+        // Color correction factors
+        static constexpr float r_correction = 240.0f / 255.0f;
+        static constexpr float g_correction = 250.0f / 255.0f;
+        static constexpr float b_correction = 190.0f / 255.0f;
+        static constexpr float gamma = 2.5f;
+        static constexpr uint8_t maxBrightness = 70;
 
+        RGB scaleAndGammaCorrect() const {
             // Apply color correction
             float rc = r * r_correction;
             float gc = g * g_correction;
             float bc = b * b_correction;
 
             // Gamma correction
-            constexpr float gamma = 2.5f;
             rc = 255.0f * std::pow(rc / 255.0f, gamma);
             gc = 255.0f * std::pow(gc / 255.0f, gamma);
             bc = 255.0f * std::pow(bc / 255.0f, gamma);
 
             // Limit maximum brightness
-            constexpr uint8_t maxBrightness = 70;
             float maxChannel = std::max({rc, gc, bc});
             if (maxChannel > maxBrightness) {
                 float scale = maxBrightness / maxChannel;
@@ -75,24 +61,216 @@ public:
         }
     };
 
+    // A corrected colour in transmit (GRB) order
+    struct WireColor
+    {
+        uint8_t g, r, b;
+    };
+
+    static WireColor toWire(RGB color)
+    {
+        const auto scaled = color.scaleAndGammaCorrect();
+        return { scaled.g, scaled.r, scaled.b };
+    }
+
+    // toWire() for colours computed anew every frame: colour and gamma
+    // correction come from tables, only the brightness limit is computed.
+    // Within one step of toWire().
+    static WireColor toWireFast(RGB color)
+    {
+        // Corrected channels in 8.8 fixed point, before the limit
+        static const auto tables = []
+        {
+            std::array<std::array<uint16_t, 256>, 3> t{};
+            const float corrections[3]
+                = { RGB::r_correction, RGB::g_correction, RGB::b_correction };
+            for (size_t c = 0; c < 3; ++c)
+            {
+                for (size_t v = 0; v < 256; ++v)
+                {
+                    t[c][v] = static_cast<uint16_t>(std::round(
+                        256.0f * 255.0f
+                        * std::pow(v * corrections[c] / 255.0f, RGB::gamma)));
+                }
+            }
+            return t;
+        }();
+        uint32_t r = tables[0][color.r];
+        uint32_t g = tables[1][color.g];
+        uint32_t b = tables[2][color.b];
+        constexpr uint32_t limit = uint32_t{ RGB::maxBrightness } << 8;
+        const uint32_t maxChannel = std::max({ r, g, b });
+        if (maxChannel > limit)
+        {
+            r = r * limit / maxChannel;
+            g = g * limit / maxChannel;
+            b = b * limit / maxChannel;
+        }
+        return { static_cast<uint8_t>((g + 128) >> 8),
+                 static_cast<uint8_t>((r + 128) >> 8),
+                 static_cast<uint8_t>((b + 128) >> 8) };
+    }
+};
+
+/**
+ * WS2812Layout: where the pixels of a Width x Height panel are in the
+ * transmitted (physical) order.
+ * Serpentine: if true, uses serpentine mapping between rows.
+ */
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine = true,
+    WS2812MatrixRotation Rotation = WS2812MatrixRotation::Rot0,
+    bool MirrorX = false,
+    bool MirrorY = false>
+struct WS2812Layout
+{
+    // Position of a logical pixel in the transmitted order
+    static constexpr size_t index(uint16_t x, uint16_t y)
+    {
+        // 1) Rotate
+        uint16_t tx = x, ty = y;
+        if constexpr (Rotation == WS2812MatrixRotation::Rot90)
+        {
+            tx = Height - 1 - y;
+            ty = x;
+        }
+        else if constexpr (Rotation == WS2812MatrixRotation::Rot180)
+        {
+            tx = Width - 1 - x;
+            ty = Height - 1 - y;
+        }
+        else if constexpr (Rotation == WS2812MatrixRotation::Rot270)
+        {
+            tx = y;
+            ty = Width - 1 - x;
+        }
+
+        // 2) Mirror
+        if constexpr (MirrorX)
+        {
+            // after 90/270 swap dims, but compile-time math still works:
+            tx
+                = ((Rotation == WS2812MatrixRotation::Rot90
+                    || Rotation == WS2812MatrixRotation::Rot270)
+                       ? Height - 1 - tx
+                       : Width - 1 - tx);
+        }
+        if constexpr (MirrorY)
+        {
+            ty
+                = ((Rotation == WS2812MatrixRotation::Rot90
+                    || Rotation == WS2812MatrixRotation::Rot270)
+                       ? Width - 1 - ty
+                       : Height - 1 - ty);
+        }
+
+        // 3) Serpentine / straight index
+        //    we invert y so row-0 is bottom of panel
+        constexpr uint16_t W = Width;
+        constexpr uint16_t H = Height;
+        uint16_t row = (H - 1) - ty;
+
+        if constexpr (Serpentine)
+        {
+            if (row & 1)
+            {
+                // odd row ⇒ left-to-right reversed
+                return row * W + (W - 1 - tx);
+            }
+            else
+            {
+                // even row ⇒ normal
+                return row * W + tx;
+            }
+        }
+        else
+        {
+            return row * W + tx;
+        }
+    }
+};
+
+/**
+ * WS2812Output: one RMT TX channel with its WS2812 encoder.
+ */
+class WS2812Output
+{
+    inline static constexpr const char* TAG = "WS2812Output";
+
+public:
+    // memBlockSymbols: RMT memory of the channel, more of it means fewer
+    // refills while transmitting, less leaves some for other channels
+    explicit WS2812Output(gpio_num_t gpio, size_t memBlockSymbols = 64);
+    ~WS2812Output();
+    WS2812Output(const WS2812Output&) = delete;
+    WS2812Output& operator=(const WS2812Output&) = delete;
+
+    bool init();
+    // Starts sending size GRB bytes, data has to stay as it is until wait()
+    bool transmit(const uint8_t* data, size_t size);
+    // Until everything transmitted is out
+    bool wait();
+
+private:
+    gpio_num_t gpio_;
+    size_t memBlockSymbols_;
+    rmt_channel_handle_t channel_ = nullptr;
+    rmt_encoder_handle_t encoder_ = nullptr;
+};
+
+/**
+ * WS2812Matrix: Template class for driving a WS2812 pixel matrix via RMT.
+ * Width, Height: dimensions of the matrix.
+ * Layout parameters: see WS2812Layout.
+ */
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine = true,
+    WS2812MatrixRotation Rotation = WS2812MatrixRotation::Rot0,
+    bool MirrorX = false,
+    bool MirrorY = false>
+class WS2812Matrix : public WS2812Colors
+{
+private:
+    inline static constexpr const char* TAG = "WS2812Matrix";
+
+public:
+    static constexpr uint16_t width = Width;
+    static constexpr uint16_t height = Height;
+    static constexpr size_t numPixels = Width * Height;
+
+    // The transmit buffer, 3 bytes (GRB) per pixel in physical order
+    using WireFrame = std::array<uint8_t, numPixels * 3>;
+
     explicit WS2812Matrix(gpio_num_t gpio);
-    ~WS2812Matrix();
 
     bool init();
 
     void setPixel(uint16_t x, uint16_t y, RGB color);
+    // Colour that is already corrected, e.g. from a palette
+    void setWirePixel(uint16_t x, uint16_t y, WireColor color);
+    WireColor wirePixel(uint16_t x, uint16_t y) const;
+    const WireFrame& wireFrame() const { return pixels_; }
     void setAllPixels(const std::array<RGB, numPixels>& pixels);
+    // One palette index per pixel in logical order: numPixels bytes with 8
+    // bits per index, numPixels / 2 with 4 bits (low nibble first)
+    void setIndexedPixels(
+        const uint8_t* indices, uint8_t bitsPerIndex, const WireColor* palette);
     void fill(RGB color);
     void clear();
     bool update();
 
-private:
+    // Position of a logical pixel in the transmitted (physical) order
     size_t index(uint16_t x, uint16_t y) const;
 
-    gpio_num_t gpio_;
-    std::array<uint8_t, numPixels * 3> pixels_;
-    rmt_channel_handle_t rmtChannel_ = nullptr;
-    rmt_encoder_handle_t rmtEncoder_ = nullptr;
+private:
+    using Layout = WS2812Layout<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>;
+
+    WS2812Output output_;
+    WireFrame pixels_;
 };
 
 // Alias for a 16×16 serpentine matrix, used in the project
@@ -0,0 +1,114 @@
+#ifndef LIVE_FRAME_HPP
+#define LIVE_FRAME_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * LiveFrame: a frame that is drawn remotely while it is shown, e.g. by the
+ * designer over a WebSocket. Messages replace the whole frame or change
+ * single pixels; MatrixAnimator plays it as a clip of one frame and
+ * renders it again after every change, at most once per frameMs, so
+ * messages that arrive faster are merged.
+ * Colours are corrected when a message is applied, rendering only copies.
+ *
+ * Messages (binary):
+ *   Frame:  0x01, then N times r, g, b, in logical order
+ *   Pixels: 0x02, then any number of index (2 bytes, little endian), r, g, b
+ */
+template<typename MatrixT> class LiveFrame
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr uint16_t W = MatrixT::width;
+    static constexpr uint16_t H = MatrixT::height;
+    static constexpr size_t N = MatrixT::numPixels;
+
+    enum class Message : uint8_t
+    {
+        Frame = 1,
+        Pixels = 2,
+    };
+    static constexpr size_t frameMessageSize = 1 + 3 * N;
+    static constexpr size_t pixelSize = 5;
+    // Every pixel changed one by one
+    static constexpr size_t maxMessageSize = 1 + pixelSize * N;
+    // Up to 60 frames per second
+    static constexpr uint32_t frameMs = 16;
+
+    // Starts black
+    LiveFrame() { wire_.fill(MatrixT::toWireFast({ 0, 0, 0 })); }
+
+    // A clip of one frame
+    size_t size() const { return 1; }
+
+    // Applies a message, false (and the frame is unchanged) when it is not
+    // one of the above
+    bool apply(std::span<const uint8_t> message)
+    {
+        if (message.empty())
+        {
+            return false;
+        }
+        const auto payload = message.subspan(1);
+        switch (static_cast<Message>(message[0]))
+        {
+        case Message::Frame:
+            if (message.size() != frameMessageSize)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < N; ++i)
+            {
+                wire_[i] = MatrixT::toWireFast(
+                    { payload[3 * i], payload[3 * i + 1], payload[3 * i + 2] });
+            }
+            return true;
+        case Message::Pixels:
+            if (payload.size() % pixelSize != 0)
+            {
+                return false;
+            }
+            // All or nothing
+            for (size_t i = 0; i < payload.size(); i += pixelSize)
+            {
+                if (index(payload.subspan(i)) >= N)
+                {
+                    return false;
+                }
+            }
+            for (size_t i = 0; i < payload.size(); i += pixelSize)
+            {
+                wire_[index(payload.subspan(i))] = MatrixT::toWireFast(
+                    { payload[i + 2], payload[i + 3], payload[i + 4] });
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void render(MatrixT& matrix) const
+    {
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                matrix.setWirePixel(x, y, wire_[y * W + x]);
+            }
+        }
+    }
+
+private:
+    static size_t index(std::span<const uint8_t> pixel)
+    {
+        return pixel[0] | (static_cast<size_t>(pixel[1]) << 8);
+    }
+
+    // Logical order
+    std::array<WireColor, N> wire_;
+};
+
+#endif  // LIVE_FRAME_HPP
@@ -1,40 +1,123 @@
 #ifndef MATRIX_ANIMATOR_HPP
 #define MATRIX_ANIMATOR_HPP
 
-#include "PSRAMallocator.hpp"
+#include "Compositor.hpp"
+#include "FramePool.hpp"
+#include "DeltaFrames.hpp"
+#include "Effect.hpp"
+#include "FrameStats.hpp"
+#include "LiveFrame.hpp"
+#include "PaletteFrames.hpp"
+#include "PixelShader.hpp"
+#include "PlaybackClock.hpp"
+#include "ScrollingText.hpp"
+#include "SpriteFrames.hpp"
+#include "Timeline.hpp"
+#include "Transition.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include <array>
-#include <vector>
+#include <optional>
+#include <span>
+#include <variant>
 
 template<typename MatrixT> class MatrixAnimator
 {
 public:
     using RGB = typename MatrixT::RGB;
     static constexpr size_t N = MatrixT::numPixels;
-    using VectorAllocator = PSRAMAllocator<std::array<RGB, N>>;
-    using Vector = std::vector<std::array<RGB, N>, VectorAllocator>;
+    using Frame = std::array<RGB, N>;
+    using Frames = FrameSequence<Frame>;
+    using Palette = PaletteFrames<MatrixT>;
+    using Delta = DeltaFrames<MatrixT>;
+    using Procedural = EffectRenderer<MatrixT>;
+    using Text = TextRenderer<MatrixT>;
+    using Sprites = SpriteFrames<MatrixT>;
+    using Shader = ShaderRenderer<MatrixT>;
+    using Live = LiveFrame<MatrixT>;
+    // Frames in whichever representation takes the fewest pool slots,
+    // sprites over a background, an effect, text or shader drawn for
+    // every frame, or a frame drawn remotely
+    using Clip = std::variant<Frames, Palette, Delta, Procedural, Text, Sprites, Shader, Live>;
 
     MatrixAnimator(MatrixT& matrix);
     ~MatrixAnimator();
 
-    // Starts (or restarts) animation: takes ownership of frames and fps
+    // Starts (or restarts) animation: takes ownership of frames, each one
+    // is shown for interval ms, in a loop.
+    // Frames are kept as a palette or as deltas when that takes less memory.
     void start(
-        Vector&& frames,
+        Frames&& frames,
         uint32_t interval);
+    // Same, played as the timeline says, blending in from what is on the
+    // matrix as transition says. Returns false (and keeps the current
+    // animation) when the timeline does not fit the frames.
+    bool start(Frames&& frames, Timeline&& timeline, Transition transition = {});
+    // Same, with frames converted ahead of time by toClip(), so start()
+    // itself is quick
+    bool start(Clip&& clip, Timeline&& timeline, Transition transition = {});
+    // A still frame, e.g. a design, played so that it can transition in
+    bool show(const Frame& frame, Transition transition);
+    // Plays a procedural effect at the effect frame rate
+    bool play(Effect effect, Transition transition = {});
+    // New settings for the effect playing, false when none is
+    bool tune(const Effect::Params& params);
+    // The effect playing, if any
+    std::optional<Effect> effect() const;
+    // Scrolls text, redrawn as often as its speed needs
+    bool scroll(ScrollingText text, Transition transition = {});
+    // The text scrolling, if any
+    std::optional<ScrollingText> text() const;
+    // Runs a user shader at the effect frame rate
+    bool play(PixelShader shader, Transition transition = {});
+    // The shader running, if any
+    std::optional<PixelShader> shader() const;
+    // Applies a LiveFrame message to the live frame, which is shown until
+    // something else is played. Without one playing, a live frame starts
+    // from black (cutting to it). false for an invalid message.
+    bool draw(std::span<const uint8_t> message);
+    // The conversion start() does, safe to run in any task
+    static Clip toClip(Frames&& frames);
+    // Plays by clock instead of counting ticks, so devices sharing it
+    // show the same frame at the same time. Once timelines (designs, live
+    // frames) still play from their start. nullptr runs freely again.
+    void synchronize(const PlaybackClock* clock);
     // Stops the animation task
     void stop();
+    // Layers drawn over every frame, see Compositor.hpp. A layer must stay
+    // alive until it is removed.
+    void addOverlay(OverlayLayer<MatrixT>& layer);
+    void removeOverlay(OverlayLayer<MatrixT>& layer);
+    // Timing of the rendered frames, reset on every start()
+    const FrameStats& frameStats() const { return frameStats_; }
 
 private:
+    // How often a held (ended) timeline checks for a restart
+    static constexpr uint32_t holdPollMs = 50;
+    // Frame period while a transition runs
+    static constexpr uint32_t transitionStepMs = 20;
+
     static void taskEntry(void* arg);
+    static size_t size(const Clip& clip);
+    // sharedUs: time since the clock's epoch when synchronized
+    void render(Clip& clip, size_t frame, size_t previous, std::optional<int64_t> sharedUs);
+    // Copies the matrix buffer to from_, false when out of memory
+    bool snapshot();
 
     MatrixT& matrix_;
     TaskHandle_t taskHandle_{ nullptr };
     SemaphoreHandle_t lock_;
-    Vector frames_;
-    uint32_t interval_{ 0 };
+    Clip frames_;
+    Timeline timeline_;
+    Transition transition_;
+    Compositor<MatrixT> compositor_;
+    const PlaybackClock* clock_{ nullptr };
+    // What was on the matrix when the transition started, task only
+    typename MatrixT::WireFrame* from_{ nullptr };
     bool running_{ false };
+    bool restart_{ false };
+    FrameStats frameStats_;
 };
 
 #endif  // MATRIX_ANIMATOR_HPP
@@ -0,0 +1,252 @@
+#ifndef MULTI_LED_MATRIX_HPP
+#define MULTI_LED_MATRIX_HPP
+
+#include "LedMatrix.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * WS2812Panel: one panel of a MultiWS2812Matrix, showing the Width x Height
+ * pixels at (X, Y) of the matrix. The other parameters are its layout, see
+ * WS2812Layout.
+ */
+template<
+    uint16_t X,
+    uint16_t Y,
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine = true,
+    WS2812MatrixRotation Rotation = WS2812MatrixRotation::Rot0,
+    bool MirrorX = false,
+    bool MirrorY = false>
+struct WS2812Panel
+{
+    static constexpr uint16_t x = X;
+    static constexpr uint16_t y = Y;
+    static constexpr uint16_t width = Width;
+    static constexpr uint16_t height = Height;
+    static constexpr size_t numPixels = size_t{ Width } * Height;
+    using Layout = WS2812Layout<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>;
+};
+
+/**
+ * MultiWS2812Matrix: a Width x Height matrix made of panels, each on its
+ * own GPIO and RMT channel. It has the interface of a WS2812Matrix, but
+ * MatrixAnimator is only instantiated for SplitLedMatrix below, any other
+ * multi-panel type needs its own instantiation in MatrixAnimator.cpp.
+ * The wire frame is the transmit buffers of the panels one after another,
+ * in the order of Panels. Where a pixel is in it comes from a table built
+ * at compile time.
+ * update() starts every channel before waiting for any, so a frame takes
+ * as long as the largest panel takes, not all of them.
+ */
+template<uint16_t Width, uint16_t Height, typename... Panels> class MultiWS2812Matrix
+    : public WS2812Colors
+{
+public:
+    static constexpr uint16_t width = Width;
+    static constexpr uint16_t height = Height;
+    static constexpr size_t numPixels = size_t{ Width } * Height;
+    static constexpr size_t numPanels = sizeof...(Panels);
+
+    // The transmit buffers, 3 bytes (GRB) per pixel in physical order
+    using WireFrame = std::array<uint8_t, numPixels * 3>;
+
+    // One GPIO per panel, in the order of Panels
+    explicit MultiWS2812Matrix(const std::array<gpio_num_t, numPanels>& gpios)
+        : outputs_{ makeOutputs(gpios, std::make_index_sequence<numPanels>{}) }
+    {
+    }
+
+    bool init()
+    {
+        for (auto& output: outputs_)
+        {
+            if (!output.init())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void setPixel(uint16_t x, uint16_t y, RGB color) { setWirePixel(x, y, toWire(color)); }
+
+    void setWirePixel(uint16_t x, uint16_t y, WireColor color)
+    {
+        if (x < Width && y < Height)
+        {
+            put(index(x, y), color);
+        }
+    }
+
+    WireColor wirePixel(uint16_t x, uint16_t y) const
+    {
+        if (x >= Width || y >= Height)
+        {
+            return { 0, 0, 0 };
+        }
+        const size_t idx = 3 * index(x, y);
+        return { pixels_[idx + 0], pixels_[idx + 1], pixels_[idx + 2] };
+    }
+
+    const WireFrame& wireFrame() const { return pixels_; }
+
+    void setAllPixels(const std::array<RGB, numPixels>& pixels)
+    {
+        for (size_t li = 0; li < numPixels; ++li)
+        {
+            put(indices_[li], toWire(pixels[li]));
+        }
+    }
+
+    // One palette index per pixel in logical order: numPixels bytes with 8
+    // bits per index, numPixels / 2 with 4 bits (low nibble first)
+    void setIndexedPixels(const uint8_t* indices, uint8_t bitsPerIndex, const WireColor* palette)
+    {
+        for (size_t li = 0; li < numPixels; ++li)
+        {
+            const uint8_t paletteIndex = bitsPerIndex == 4
+                ? (li & 1 ? indices[li / 2] >> 4 : indices[li / 2] & 0x0F)
+                : indices[li];
+            put(indices_[li], palette[paletteIndex]);
+        }
+    }
+
+    void fill(RGB color)
+    {
+        const WireColor wire = toWire(color);
+        for (size_t i = 0; i < numPixels; ++i)
+        {
+            put(i, wire);
+        }
+    }
+
+    void clear() { fill({ 0, 0, 0 }); }
+
+    bool update()
+    {
+        // Every panel is on the wire before the first one is waited for
+        bool transmitted = true;
+        for (size_t i = 0; i < numPanels; ++i)
+        {
+            transmitted
+                = outputs_[i].transmit(pixels_.data() + 3 * offsets_[i], 3 * sizes_[i])
+                && transmitted;
+        }
+        bool done = true;
+        for (auto& output: outputs_)
+        {
+            done = output.wait() && done;
+        }
+        return transmitted && done;
+    }
+
+    // Position of a logical pixel in the wire frame
+    size_t index(uint16_t x, uint16_t y) const
+    {
+        return indices_[static_cast<size_t>(y) * Width + x];
+    }
+
+private:
+    // The ESP32-S3 has 4 TX channels with 48 symbols of RMT memory each,
+    // a channel taking more leaves too little for the others
+    static constexpr size_t maxPanels = 4;
+    static constexpr size_t memBlockSymbols = 48;
+
+    static constexpr std::array<size_t, numPanels> sizes_{ Panels::numPixels... };
+
+    // First pixel of every panel in the wire frame
+    static constexpr std::array<size_t, numPanels> offsets_ = []
+    {
+        std::array<size_t, numPanels> offsets{};
+        for (size_t i = 1; i < numPanels; ++i)
+        {
+            offsets[i] = offsets[i - 1] + sizes_[i - 1];
+        }
+        return offsets;
+    }();
+
+    // Every pixel is on exactly one panel
+    static constexpr bool tiled()
+    {
+        std::array<uint8_t, numPixels> panels{};
+        bool inside = true;
+        auto cover = [&]<typename Panel>()
+        {
+            if (Panel::x + Panel::width > Width || Panel::y + Panel::height > Height)
+            {
+                inside = false;
+                return;
+            }
+            for (uint16_t y = 0; y < Panel::height; ++y)
+            {
+                for (uint16_t x = 0; x < Panel::width; ++x)
+                {
+                    ++panels[static_cast<size_t>(Panel::y + y) * Width + Panel::x + x];
+                }
+            }
+        };
+        (cover.template operator()<Panels>(), ...);
+        for (uint8_t count: panels)
+        {
+            inside = inside && count == 1;
+        }
+        return inside;
+    }
+
+    static_assert(numPanels > 0 && numPanels <= maxPanels, "1 to 4 panels, one per RMT channel");
+    static_assert(numPixels <= 65536, "Wire frame positions are 16 bits");
+    static_assert(tiled(), "The panels have to cover the matrix without overlapping");
+
+    // Wire frame position of every logical pixel
+    static constexpr std::array<uint16_t, numPixels> indices_ = []
+    {
+        std::array<uint16_t, numPixels> indices{};
+        size_t panel = 0;
+        auto place = [&]<typename Panel>()
+        {
+            for (uint16_t y = 0; y < Panel::height; ++y)
+            {
+                for (uint16_t x = 0; x < Panel::width; ++x)
+                {
+                    indices[static_cast<size_t>(Panel::y + y) * Width + Panel::x + x]
+                        = static_cast<uint16_t>(offsets_[panel] + Panel::Layout::index(x, y));
+                }
+            }
+            ++panel;
+        };
+        (place.template operator()<Panels>(), ...);
+        return indices;
+    }();
+
+    template<size_t... I>
+    static std::array<WS2812Output, numPanels>
+    makeOutputs(const std::array<gpio_num_t, numPanels>& gpios, std::index_sequence<I...>)
+    {
+        return { WS2812Output{ gpios[I], memBlockSymbols }... };
+    }
+
+    void put(size_t index, WireColor color)
+    {
+        pixels_[3 * index + 0] = color.g;
+        pixels_[3 * index + 1] = color.r;
+        pixels_[3 * index + 2] = color.b;
+    }
+
+    std::array<WS2812Output, numPanels> outputs_;
+    WireFrame pixels_{};
+};
+
+// The project's 16x16 matrix as two 16x8 halves on their own channels,
+// for panels wired as two strings
+using SplitLedMatrix = MultiWS2812Matrix<
+    16,
+    16,
+    WS2812Panel<0, 0, 16, 8, true, WS2812MatrixRotation::Rot0>,
+    WS2812Panel<0, 8, 16, 8, true, WS2812MatrixRotation::Rot0>>;
+
+#endif  // MULTI_LED_MATRIX_HPP
@@ -0,0 +1,148 @@
+#ifndef PALETTE_FRAMES_HPP
+#define PALETTE_FRAMES_HPP
+
+#include "FramePool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * PaletteFrames: frames stored as indices into one palette of up to 256
+ * colours, 4 bits per pixel with at most 16 colours and 8 bits otherwise.
+ * Colour correction runs once per palette entry, rendering a frame is one
+ * table lookup per pixel.
+ * The indices are packed into the slots of a regular FrameSequence (3 or 6
+ * frames per RGB frame), so they share the frame pool with RGB animations.
+ */
+template<typename MatrixT> class PaletteFrames
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr size_t N = MatrixT::numPixels;
+    using Frame = std::array<RGB, N>;
+    using Frames = FrameSequence<Frame>;
+    static constexpr size_t maxColors = 256;
+
+    // nullopt when the frames use more than maxColors colours or the pool
+    // is out of memory
+    static std::optional<PaletteFrames> fromFrames(const Frames& frames)
+    {
+        PaletteFrames result;
+        std::unordered_map<uint32_t, uint8_t> lookup;
+        lookup.reserve(maxColors);
+        for (const Frame& frame: frames)
+        {
+            for (const RGB& pixel: frame)
+            {
+                if (lookup.contains(key(pixel)))
+                {
+                    continue;
+                }
+                if (result.palette_.size() == maxColors)
+                {
+                    return std::nullopt;
+                }
+                lookup.emplace(key(pixel), result.palette_.size());
+                result.palette_.push_back(pixel);
+            }
+        }
+
+        result.bits_ = result.palette_.size() <= 16 ? 4 : 8;
+        result.wire_.reserve(result.palette_.size());
+        for (const RGB& color: result.palette_)
+        {
+            result.wire_.push_back(MatrixT::toWire(color));
+        }
+
+        const size_t perSlot = result.framesPerSlot();
+        if (!result.slots_.reserve((frames.size() + perSlot - 1) / perSlot))
+        {
+            return std::nullopt;
+        }
+        Frame slot;
+        auto* bytes = reinterpret_cast<uint8_t*>(slot.data());
+        for (size_t f = 0; f < frames.size(); ++f)
+        {
+            uint8_t* out = bytes + (f % perSlot) * result.frameBytes();
+            const Frame& frame = frames[f];
+            if (result.bits_ == 4)
+            {
+                for (size_t i = 0; i < N; i += 2)
+                {
+                    const uint8_t low = lookup[key(frame[i])];
+                    const uint8_t high
+                        = i + 1 < N ? lookup[key(frame[i + 1])] : 0;
+                    out[i / 2] = static_cast<uint8_t>(low | (high << 4));
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < N; ++i)
+                {
+                    out[i] = lookup[key(frame[i])];
+                }
+            }
+            if ((f + 1) % perSlot == 0 || f + 1 == frames.size())
+            {
+                result.slots_.push_back(slot);
+            }
+        }
+        result.size_ = frames.size();
+        return result;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    uint8_t bitsPerIndex() const { return bits_; }
+    size_t paletteSize() const { return palette_.size(); }
+    // Pool slots in use, each one the size of an RGB frame
+    size_t slots() const { return slots_.size(); }
+
+    RGB pixel(size_t frame, size_t i) const
+    {
+        const uint8_t* indices = data(frame);
+        if (bits_ == 4)
+        {
+            return palette_[i & 1 ? indices[i / 2] >> 4 : indices[i / 2] & 0x0F];
+        }
+        return palette_[indices[i]];
+    }
+
+    void render(MatrixT& matrix, size_t frame) const
+    {
+        matrix.setIndexedPixels(data(frame), bits_, wire_.data());
+    }
+
+private:
+    static uint32_t key(const RGB& color)
+    {
+        return (uint32_t{ color.r } << 16) | (uint32_t{ color.g } << 8)
+            | color.b;
+    }
+
+    size_t frameBytes() const { return bits_ == 4 ? (N + 1) / 2 : N; }
+    size_t framesPerSlot() const { return sizeof(Frame) / frameBytes(); }
+
+    const uint8_t* data(size_t frame) const
+    {
+        const size_t perSlot = framesPerSlot();
+        const auto* slot
+            = reinterpret_cast<const uint8_t*>(slots_[frame / perSlot].data());
+        return slot + (frame % perSlot) * frameBytes();
+    }
+
+    std::vector<RGB> palette_;
+    // palette_ after colour correction, what render() looks up
+    std::vector<WireColor> wire_;
+    uint8_t bits_{ 8 };
+    size_t size_{ 0 };
+    Frames slots_;
+};
+
+#endif  // PALETTE_FRAMES_HPP
@@ -0,0 +1,204 @@
+#ifndef PIXEL_SHADER_HPP
+#define PIXEL_SHADER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <esp_log.h>
+
+/**
+ * PixelShader: a user program run for every pixel of every frame, so
+ * effects can be added without reflashing. Programs are written in a small
+ * assembly language (see assemble()) and run on a register machine with
+ * 16 registers of Q16.16 fixed point numbers.
+ *
+ * Registers start at 0, except x and y (the pixel, 0 at the top left) and
+ * t (seconds since the shader started, wraps after about 9 hours). The
+ * colour is read from r, g and b afterwards, clamped to [0, 1].
+ * Every pixel gets stepsPerPixel instructions, a pixel that runs out keeps
+ * the colour its registers hold by then, so a program cannot stall the
+ * animation task.
+ */
+struct PixelShader
+{
+    enum class Op : uint8_t
+    {
+        End = 0,
+        // d = b
+        Mov,
+        // d = a op b
+        Add,
+        Sub,
+        Mul,
+        // 0 when dividing by 0
+        Div,
+        // Floored, the sign of b, 0 for b = 0
+        Mod,
+        Min,
+        Max,
+        // d = a < b ? 1 : 0
+        Lt,
+        // d = op b
+        Abs,
+        Floor,
+        Fract,
+        // Angles in turns, 1 is a full circle
+        Sin,
+        Cos,
+        // 0 for negative numbers
+        Sqrt,
+        // Smooth value noise in [0, 1] at (a, b), one lattice cell per unit
+        Noise,
+        // Jumps to value
+        Jmp,
+        // Jumps to value when a is 0
+        Jz,
+    };
+
+    struct Instruction
+    {
+        Op op{ Op::End };
+        uint8_t d{ 0 };
+        uint8_t a{ 0 };
+        // immediate: use value instead of a register
+        uint8_t b{ 0 };
+        // Immediate operand or jump target
+        int32_t value{ 0 };
+    };
+
+    static constexpr size_t registers = 16;
+    // Registers with a meaning, see above
+    static constexpr uint8_t x = 0, y = 1, t = 2, r = 3, g = 4, b = 5;
+    static constexpr uint8_t immediate = 0xFF;
+    static constexpr int32_t one = 1 << 16;
+    static constexpr size_t maxInstructions = 128;
+    // Twice the longest program, so straight programs always finish and
+    // loops get some room
+    static constexpr uint32_t stepsPerPixel = 256;
+    // Longest source accepted, in bytes
+    static constexpr size_t maxSourceLength = 8192;
+    // Output frame period, the shader is run this often
+    static constexpr uint32_t frameMs = 20;
+
+    using Registers = std::array<int32_t, registers>;
+
+    /**
+     * Assembles source, one instruction per line:
+     *
+     *     ; red waves, blue below row 8
+     *         mul r6, x, 0.07
+     *         add r6, r6, t
+     *         sin r, r6
+     *         lt r7, y, 8
+     *         jz r7, bottom
+     *         end
+     *     bottom:
+     *         mov b, 1
+     *
+     * An instruction is its name (the Op, in lower case) and its operands:
+     * the destination register, then the sources. The last source may be
+     * a number instead of a register. Registers are r0 to r15, or x, y, t,
+     * r, g and b. Jumps take a label, a name followed by ':'. ';' starts a
+     * comment.
+     * Returns nothing, and the line and reason in error, when the source
+     * does not assemble.
+     */
+    static std::optional<PixelShader> assemble(
+        std::string_view source, std::string* error = nullptr);
+
+    // Runs code on regs, each instruction takes one step off budget.
+    // false when the budget ran out before the code ended.
+    static bool execute(
+        const Instruction* code, size_t size, Registers& regs, uint32_t& budget);
+
+    const std::string& source() const { return source_; }
+    const std::vector<Instruction>& code() const { return code_; }
+
+private:
+    std::string source_;
+    std::vector<Instruction> code_;
+};
+
+/**
+ * ShaderRenderer: runs a PixelShader for every pixel, one frame per
+ * render() call. Colours change every frame, so they are corrected with
+ * LedMatrix::toWireFast() instead of a palette.
+ * MatrixAnimator plays it as a clip of one frame.
+ */
+template<typename MatrixT> class ShaderRenderer
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    static constexpr uint16_t W = MatrixT::width;
+    static constexpr uint16_t H = MatrixT::height;
+
+    explicit ShaderRenderer(PixelShader shader)
+        : shader_{ std::move(shader) }
+    {
+    }
+
+    // A clip of one frame, rendered anew every time
+    size_t size() const { return 1; }
+    const PixelShader& shader() const { return shader_; }
+    // Pixels that ran out of steps, over all frames so far
+    uint32_t exhaustedPixels() const { return exhausted_; }
+
+    // Times the shader from startUs instead of the first render() call
+    void startAt(int64_t startUs) { startUs_ = startUs; }
+
+    // Draws the shader as it is nowUs, the first call sets the start time
+    void render(MatrixT& matrix, int64_t nowUs)
+    {
+        if (startUs_ < 0)
+        {
+            startUs_ = nowUs;
+        }
+        const int32_t t = static_cast<int32_t>(
+            static_cast<uint64_t>(nowUs - startUs_) * PixelShader::one / 1000000);
+        const auto& code = shader_.code();
+        const uint32_t exhaustedBefore = exhausted_;
+        PixelShader::Registers regs;
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                regs.fill(0);
+                regs[PixelShader::x] = x * PixelShader::one;
+                regs[PixelShader::y] = y * PixelShader::one;
+                regs[PixelShader::t] = t;
+                uint32_t budget = PixelShader::stepsPerPixel;
+                exhausted_ += !PixelShader::execute(code.data(), code.size(), regs, budget);
+                const RGB color{ channel(regs[PixelShader::r]),
+                                 channel(regs[PixelShader::g]),
+                                 channel(regs[PixelShader::b]) };
+                matrix.setWirePixel(x, y, MatrixT::toWireFast(color));
+            }
+        }
+        if (exhaustedBefore == 0 && exhausted_ != 0)
+        {
+            ESP_LOGW(TAG, "Shader ran out of steps, pixels show partial results");
+        }
+    }
+
+private:
+    inline static constexpr const char* TAG = "ShaderRenderer";
+
+    // [0, 1] to [0, 255]
+    static uint8_t channel(int32_t value)
+    {
+        const int32_t clamped = std::clamp<int32_t>(value, 0, PixelShader::one);
+        return static_cast<uint8_t>((clamped * 255 + PixelShader::one / 2) >> 16);
+    }
+
+    PixelShader shader_;
+    int64_t startUs_{ -1 };
+    uint32_t exhausted_{ 0 };
+};
+
+#endif  // PIXEL_SHADER_HPP
@@ -0,0 +1,22 @@
+#ifndef PLAYBACK_CLOCK_HPP
+#define PLAYBACK_CLOCK_HPP
+
+#include <cstdint>
+#include <optional>
+
+/**
+ * PlaybackClock: time shared by several devices. Animators following the
+ * same clock show the same frame at the same time, see
+ * MatrixAnimator::synchronize().
+ */
+class PlaybackClock
+{
+public:
+    virtual ~PlaybackClock() = default;
+
+    // Microseconds since the shared animation epoch, nothing while this
+    // device has no shared time. Called from the animator task.
+    virtual std::optional<int64_t> sinceEpochUs() const = 0;
+};
+
+#endif  // PLAYBACK_CLOCK_HPP
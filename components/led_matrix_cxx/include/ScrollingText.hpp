@@ -0,0 +1,173 @@
+#ifndef SCROLLING_TEXT_HPP
+#define SCROLLING_TEXT_HPP
+
+#include "Font.hpp"
+#include "PSRAMallocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * ScrollingText: a message and how it scrolls. The text is set in one of
+ * the built-in fonts (see Font.hpp) when it starts, so a stored message is
+ * just the string and these settings.
+ */
+struct ScrollingText
+{
+    enum class Font : uint8_t
+    {
+        Small = 0,  // 5x7
+        Large,      // 8x8
+    };
+
+    struct Color
+    {
+        uint8_t r, g, b;
+    };
+
+    std::string text;
+    Font font{ Font::Small };
+    Color color{ 255, 255, 255 };
+    Color background{ 0, 0, 0 };
+    // Pixels per second
+    uint16_t speed{ 20 };
+    // Starts over once scrolled out, otherwise scrolls through once and
+    // leaves the background
+    bool loop{ true };
+
+    static constexpr uint16_t minSpeed = 1;
+    static constexpr uint16_t maxSpeed = 200;
+    // Longest text accepted, in bytes
+    static constexpr size_t maxLength = 512;
+
+    // Time between two redraws: one pixel of movement, but at most 50 fps
+    uint32_t frameMs() const
+    {
+        return std::max<uint32_t>(20, 1000 / std::max(speed, minSpeed));
+    }
+
+    static const Fonts::Atlas& atlas(Font font)
+    {
+        return font == Font::Large ? Fonts::font8x8 : Fonts::font5x7;
+    }
+    static const char* toString(Font font);
+    static std::optional<Font> parseFont(std::string_view name);
+};
+
+/**
+ * TextRenderer: scrolls a ScrollingText from right to left across the
+ * matrix, vertically centred. The text is laid out once into a strip of
+ * glyph columns, a frame copies the visible part of the strip. The scroll
+ * position follows the time since the first frame, so late frames do not
+ * slow the text down. MatrixAnimator plays it as a clip of one frame.
+ */
+template<typename MatrixT> class TextRenderer
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr uint16_t W = MatrixT::width;
+    static constexpr uint16_t H = MatrixT::height;
+
+    explicit TextRenderer(ScrollingText text)
+        : text_{ std::move(text) }
+    {
+        const ScrollingText::Color& c = text_.color;
+        const ScrollingText::Color& b = text_.background;
+        foreground_ = MatrixT::toWire(RGB{ c.r, c.g, c.b });
+        background_ = MatrixT::toWire(RGB{ b.r, b.g, b.b });
+        layout();
+    }
+
+    // A clip of one frame, rendered anew every time
+    size_t size() const { return 1; }
+    const ScrollingText& text() const { return text_; }
+    // Width of the set text in pixels
+    size_t width() const { return strip_.size(); }
+
+    // Times the text from startUs instead of the first render() call
+    void startAt(int64_t startUs) { startUs_ = startUs; }
+
+    // Draws the text as it is nowUs, the first call sets the start time
+    void render(MatrixT& matrix, int64_t nowUs)
+    {
+        if (startUs_ < 0)
+        {
+            startUs_ = nowUs;
+        }
+        // Enters at the right edge, done when the last column left
+        const uint64_t period = W + strip_.size();
+        const uint64_t moved
+            = static_cast<uint64_t>(nowUs - startUs_) * text_.speed / 1000000;
+        const uint64_t offset = text_.loop ? moved % period : std::min(moved, period);
+
+        const Fonts::Atlas& atlas = ScrollingText::atlas(text_.font);
+        const uint16_t top = (H - std::min<uint16_t>(atlas.height, H)) / 2;
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            const int64_t column = static_cast<int64_t>(offset) + x - W;
+            const uint8_t bits = column >= 0 && column < static_cast<int64_t>(strip_.size())
+                ? strip_[column]
+                : 0;
+            for (uint16_t y = 0; y < H; ++y)
+            {
+                const bool on = y >= top && y - top < 8 && (bits >> (y - top)) & 1;
+                matrix.setWirePixel(x, y, on ? foreground_ : background_);
+            }
+        }
+    }
+
+private:
+    void layout()
+    {
+        const Fonts::Atlas& atlas = ScrollingText::atlas(text_.font);
+        size_t columns = 0;
+        forEachChar([&](char c) { columns += atlas.glyph(c).width + 1; });
+        strip_.reserve(columns);
+        forEachChar(
+            [&](char c)
+            {
+                for (uint8_t x = 0; x < atlas.glyph(c).width; ++x)
+                {
+                    strip_.push_back(atlas.column(c, x));
+                }
+                // One column between letters
+                strip_.push_back(0);
+            });
+        if (!strip_.empty())
+        {
+            strip_.pop_back();
+        }
+    }
+
+    // One character per code point: bytes past ASCII show as '?', UTF-8
+    // continuation bytes are skipped
+    template<typename F> void forEachChar(F&& f) const
+    {
+        for (const char byte: text_.text)
+        {
+            const auto u = static_cast<uint8_t>(byte);
+            if ((u & 0xC0) == 0x80)
+            {
+                continue;
+            }
+            f(u < 0x80 ? byte : '?');
+        }
+    }
+
+    ScrollingText text_;
+    WireColor foreground_{};
+    WireColor background_{};
+    int64_t startUs_{ -1 };
+    // One byte per pixel column, bit y set = pixel in row y of the font
+    std::vector<uint8_t, PSRAMAllocator<uint8_t>> strip_{
+        PSRAMAllocator<uint8_t>{ HeapStats::AllocTag::Animator }
+    };
+};
+
+#endif  // SCROLLING_TEXT_HPP
@@ -0,0 +1,220 @@
+#ifndef SPRITE_FRAMES_HPP
+#define SPRITE_FRAMES_HPP
+
+#include "PSRAMallocator.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * SpriteFrames: animations of sprites moving over a still background. A
+ * frame is a list of placements (sprite, position, flips) instead of
+ * pixels, so a few small sprites take a few bytes per frame instead of a
+ * full frame.
+ * Colours are corrected once, when the background and sprites are added.
+ * Rendering the frame after the previous one only restores the background
+ * under the previous placements before drawing the new ones.
+ */
+template<typename MatrixT> class SpriteFrames
+{
+public:
+    using RGB = typename MatrixT::RGB;
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr uint16_t W = MatrixT::width;
+    static constexpr uint16_t H = MatrixT::height;
+    static constexpr size_t N = MatrixT::numPixels;
+    using Frame = std::array<RGB, N>;
+
+    // Sprite ids are one byte
+    static constexpr size_t maxSprites = 256;
+    static constexpr size_t none = SIZE_MAX;
+
+    struct Sprite
+    {
+        // At most the size of the matrix
+        uint8_t width{ 0 };
+        uint8_t height{ 0 };
+        // Row by row
+        std::vector<RGB> pixels;
+        // One per pixel, 0 where the background shows through
+        std::vector<uint8_t> opaque;
+    };
+
+    struct Placement
+    {
+        static constexpr uint8_t flipX = 1;
+        static constexpr uint8_t flipY = 2;
+
+        uint8_t sprite;
+        // Top left corner, sprites may hang over the edges
+        int8_t x;
+        int8_t y;
+        uint8_t flags;
+    };
+
+    SpriteFrames()
+        : SpriteFrames(Frame{})
+    {
+    }
+
+    explicit SpriteFrames(const Frame& background)
+        : background_(background)
+    {
+        backgroundWire_.reserve(N);
+        for (const RGB& color: background)
+        {
+            backgroundWire_.push_back(MatrixT::toWire(color));
+        }
+        starts_.push_back(0);
+    }
+
+    // false when the sprite is empty, larger than the matrix, its pixels do
+    // not match its size, or there are maxSprites already
+    bool addSprite(Sprite sprite)
+    {
+        const size_t pixels = size_t{ sprite.width } * sprite.height;
+        if (pixels == 0 || sprite.width > W || sprite.height > H
+            || sprite.pixels.size() != pixels || sprite.opaque.size() != pixels
+            || sprites_.size() == maxSprites)
+        {
+            return false;
+        }
+        offsets_.push_back(static_cast<uint32_t>(spriteWire_.size()));
+        for (const RGB& color: sprite.pixels)
+        {
+            spriteWire_.push_back(MatrixT::toWire(color));
+        }
+        sprites_.push_back(std::move(sprite));
+        return true;
+    }
+
+    // Appends a frame, false when a placement names a missing sprite
+    bool addFrame(std::span<const Placement> placements)
+    {
+        for (const Placement& placement: placements)
+        {
+            if (placement.sprite >= sprites_.size())
+            {
+                return false;
+            }
+        }
+        placements_.insert(placements_.end(), placements.begin(), placements.end());
+        starts_.push_back(static_cast<uint32_t>(placements_.size()));
+        return true;
+    }
+
+    size_t size() const { return starts_.size() - 1; }
+    bool empty() const { return size() == 0; }
+    const Frame& background() const { return background_; }
+    size_t spriteCount() const { return sprites_.size(); }
+    const Sprite& sprite(size_t id) const { return sprites_[id]; }
+    std::span<const Placement> placements(size_t frame) const
+    {
+        return { placements_.data() + starts_[frame],
+                 placements_.data() + starts_[frame + 1] };
+    }
+
+    // Renders frame, over previous when that is the frame rendered last
+    // (none when not known)
+    void render(MatrixT& matrix, size_t frame, size_t previous) const
+    {
+        if (previous != none && previous < size())
+        {
+            for (const Placement& placement: placements(previous))
+            {
+                restore(matrix, placement);
+            }
+        }
+        else
+        {
+            for (uint16_t y = 0; y < H; ++y)
+            {
+                for (uint16_t x = 0; x < W; ++x)
+                {
+                    matrix.setWirePixel(x, y, backgroundWire_[y * W + x]);
+                }
+            }
+        }
+        for (const Placement& placement: placements(frame))
+        {
+            draw(matrix, placement);
+        }
+    }
+
+private:
+    template<typename T> using Vector = std::vector<T, PSRAMAllocator<T>>;
+
+    // Calls f(matrix x, matrix y, sprite pixel index) for the pixels of a
+    // placement that are on the matrix
+    template<typename F> void forEachPixel(const Placement& placement, F&& f) const
+    {
+        const Sprite& sprite = sprites_[placement.sprite];
+        for (int sy = 0; sy < sprite.height; ++sy)
+        {
+            const int y = placement.y + sy;
+            if (y < 0 || y >= H)
+            {
+                continue;
+            }
+            const int row = placement.flags & Placement::flipY
+                ? sprite.height - 1 - sy
+                : sy;
+            for (int sx = 0; sx < sprite.width; ++sx)
+            {
+                const int x = placement.x + sx;
+                if (x < 0 || x >= W)
+                {
+                    continue;
+                }
+                const int column = placement.flags & Placement::flipX
+                    ? sprite.width - 1 - sx
+                    : sx;
+                f(static_cast<uint16_t>(x),
+                  static_cast<uint16_t>(y),
+                  static_cast<size_t>(row * sprite.width + column));
+            }
+        }
+    }
+
+    void draw(MatrixT& matrix, const Placement& placement) const
+    {
+        const Sprite& sprite = sprites_[placement.sprite];
+        const WireColor* wire = spriteWire_.data() + offsets_[placement.sprite];
+        forEachPixel(
+            placement,
+            [&](uint16_t x, uint16_t y, size_t i)
+            {
+                if (sprite.opaque[i])
+                {
+                    matrix.setWirePixel(x, y, wire[i]);
+                }
+            });
+    }
+
+    void restore(MatrixT& matrix, const Placement& placement) const
+    {
+        forEachPixel(
+            placement,
+            [&](uint16_t x, uint16_t y, size_t)
+            { matrix.setWirePixel(x, y, backgroundWire_[y * W + x]); });
+    }
+
+    Frame background_;
+    std::vector<Sprite> sprites_;
+    // The background and sprites as sent, after colour correction
+    Vector<WireColor> backgroundWire_{ PSRAMAllocator<WireColor>{
+        HeapStats::AllocTag::Animator } };
+    Vector<WireColor> spriteWire_{ PSRAMAllocator<WireColor>{
+        HeapStats::AllocTag::Animator } };
+    // Where each sprite starts in spriteWire_
+    Vector<uint32_t> offsets_{ PSRAMAllocator<uint32_t>{ HeapStats::AllocTag::Animator } };
+    Vector<Placement> placements_{ PSRAMAllocator<Placement>{
+        HeapStats::AllocTag::Animator } };
+    // Frame f is placements_[starts_[f]] up to placements_[starts_[f + 1]]
+    Vector<uint32_t> starts_{ PSRAMAllocator<uint32_t>{ HeapStats::AllocTag::Animator } };
+};
+
+#endif  // SPRITE_FRAMES_HPP
@@ -0,0 +1,203 @@
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+#include "FramePool.hpp"
+#include "PSRAMallocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Timeline: which frame to show for how long, and how to loop.
+ * Entries reference frames by index, so a frame shown several times is
+ * stored once, and every entry has its own duration, so a hold is one
+ * entry instead of many copies of a frame.
+ */
+struct Timeline
+{
+    enum class LoopMode : uint8_t
+    {
+        // From the last entry back to the first
+        Loop = 0,
+        // Forward, then backward, the end entries are shown once per turn
+        PingPong,
+        // Stop on the last entry and keep showing it
+        Once,
+        // Play up to loopEnd, then repeat loopStart..loopEnd
+        Segment,
+    };
+
+    struct Entry
+    {
+        uint16_t frame;
+        uint32_t durationMs;
+    };
+    using Entries = std::vector<Entry, PSRAMAllocator<Entry>>;
+
+    // Playback position, see begin() and advance()
+    struct Cursor
+    {
+        size_t entry;
+        bool backward;
+        // A Once timeline has ended
+        bool holding;
+    };
+
+    // Where playback is at some time, see seek()
+    struct Position
+    {
+        Cursor cursor;
+        // Until the next entry is due, 0 while holding
+        uint64_t remainingUs;
+    };
+
+    Entries entries{ PSRAMAllocator<Entry>{ HeapStats::AllocTag::Frames } };
+    LoopMode mode{ LoopMode::Loop };
+    // Inclusive entry range, Segment mode only
+    uint16_t loopStart{ 0 };
+    uint16_t loopEnd{ 0 };
+
+    // Every frame once, in order, all with the same duration
+    static Timeline uniform(size_t numFrames, uint32_t durationMs);
+    // Frame 0 shown once and then held. The entry is short, so a player
+    // picks up the next start() quickly.
+    static Timeline still();
+    static constexpr uint32_t stillMs = 50;
+
+    // Non-empty, positive durations and every reference below numFrames
+    bool valid(size_t numFrames) const;
+
+    Cursor begin() const { return { 0, false, false }; }
+    void advance(Cursor& cursor) const;
+    // Where playback from begin() is after elapsedUs, for players that
+    // follow a clock instead of counting entries. Walks the entries, so
+    // it takes time proportional to their number.
+    Position seek(uint64_t elapsedUs) const;
+
+    static const char* toString(LoopMode mode);
+    static std::optional<LoopMode> parseLoopMode(std::string_view name);
+};
+
+/**
+ * Stores every distinct frame once. frames is compacted in place (frames
+ * no entry uses are dropped), the entries are pointed at the remaining
+ * frames and consecutive entries showing the same frame merge into one.
+ * Afterwards the first entry shows frame 0.
+ * timeline must be valid for frames.
+ */
+template<typename Frame, size_t FramesPerBlock>
+void deduplicate(FrameSequence<Frame, FramesPerBlock>& frames, Timeline& timeline)
+{
+    auto hash = [](const Frame& frame)
+    {
+        // FNV-1a
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&frame);
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < sizeof(Frame); ++i)
+        {
+            h = (h ^ bytes[i]) * 16777619u;
+        }
+        return h;
+    };
+
+    std::vector<bool> used(frames.size(), false);
+    for (const auto& entry: timeline.entries)
+    {
+        used[entry.frame] = true;
+    }
+
+    // Distinct frames move to the front, in their original order
+    std::vector<uint16_t> remap(frames.size(), 0);
+    std::unordered_multimap<uint32_t, uint16_t> seen;
+    size_t unique = 0;
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        if (!used[i])
+        {
+            continue;
+        }
+        const uint32_t h = hash(frames[i]);
+        auto [it, end] = seen.equal_range(h);
+        for (; it != end; ++it)
+        {
+            if (std::memcmp(&frames[it->second], &frames[i], sizeof(Frame)) == 0)
+            {
+                break;
+            }
+        }
+        if (it != end)
+        {
+            remap[i] = it->second;
+            continue;
+        }
+        if (unique != i)
+        {
+            std::memcpy(&frames[unique], &frames[i], sizeof(Frame));
+        }
+        remap[i] = static_cast<uint16_t>(unique);
+        seen.emplace(h, static_cast<uint16_t>(unique));
+        ++unique;
+    }
+    frames.resize(unique);
+
+    // Rewrite the entries, without merging across the segment bounds.
+    // PingPong shows the end entries once per turn and the others twice,
+    // so the end entries are never merged with their neighbours.
+    const bool segment = timeline.mode == Timeline::LoopMode::Segment;
+    const bool pingPong = timeline.mode == Timeline::LoopMode::PingPong;
+    auto& entries = timeline.entries;
+    size_t out = 0;
+    uint16_t loopStart = 0;
+    uint16_t loopEnd = 0;
+    for (size_t k = 0; k < entries.size(); ++k)
+    {
+        Timeline::Entry entry{ remap[entries[k].frame], entries[k].durationMs };
+        const bool boundary
+            = (segment && (k == timeline.loopStart || k == timeline.loopEnd + 1u))
+            || (pingPong && (k == 1 || k + 1 == entries.size()));
+        if (out > 0 && !boundary && entries[out - 1].frame == entry.frame)
+        {
+            entries[out - 1].durationMs += entry.durationMs;
+        }
+        else
+        {
+            entries[out++] = entry;
+        }
+        if (k == timeline.loopStart)
+        {
+            loopStart = static_cast<uint16_t>(out - 1);
+        }
+        if (k == timeline.loopEnd)
+        {
+            loopEnd = static_cast<uint16_t>(out - 1);
+        }
+    }
+    entries.resize(out);
+    if (segment)
+    {
+        timeline.loopStart = loopStart;
+        timeline.loopEnd = loopEnd;
+    }
+
+    // Readers that only look at the first frame (boot) see the right one
+    const uint16_t first = entries.empty() ? 0 : entries.front().frame;
+    if (first != 0)
+    {
+        Frame swapped = frames[0];
+        std::memcpy(&frames[0], &frames[first], sizeof(Frame));
+        std::memcpy(&frames[first], &swapped, sizeof(Frame));
+        for (auto& entry: entries)
+        {
+            entry.frame = entry.frame == first ? 0
+                : entry.frame == 0             ? first
+                                               : entry.frame;
+        }
+    }
+}
+
+#endif  // TIMELINE_HPP
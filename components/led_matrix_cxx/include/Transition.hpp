@@ -0,0 +1,134 @@
+#ifndef TRANSITION_HPP
+#define TRANSITION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+/**
+ * Transition: how new content replaces what is on the matrix.
+ * blendTransition() mixes the two one output frame at a time, straight in
+ * the matrix buffer, so no intermediate frames are ever stored.
+ */
+struct Transition
+{
+    enum class Kind : uint8_t
+    {
+        // Hard switch, the default
+        Cut = 0,
+        // Both fade over each other
+        Crossfade,
+        // The new content is uncovered from left to right
+        Wipe,
+        // Pixels switch over one by one, in a fixed scattered order
+        Dissolve,
+        // The new content pushes the old one out to the left
+        Slide,
+    };
+
+    // Progress runs from 0 (old content only) to full (new content only)
+    static constexpr uint32_t full = 256;
+
+    Kind kind{ Kind::Cut };
+    uint32_t durationMs{ 0 };
+
+    bool isCut() const { return kind == Kind::Cut || durationMs == 0; }
+
+    static const char* toString(Kind kind);
+    static std::optional<Kind> parseKind(std::string_view name);
+};
+
+/**
+ * Blends from (a copy of MatrixT::wireFrame()) into the new content, which
+ * must already be rendered into matrix. Works on corrected colours.
+ */
+template<typename MatrixT>
+void blendTransition(
+    MatrixT& matrix,
+    const typename MatrixT::WireFrame& from,
+    Transition::Kind kind,
+    uint32_t progress)
+{
+    using WireColor = typename MatrixT::WireColor;
+    static constexpr uint16_t W = MatrixT::width;
+    static constexpr uint16_t H = MatrixT::height;
+    if (kind == Transition::Kind::Cut || progress >= Transition::full)
+    {
+        return;
+    }
+
+    auto old = [&](uint16_t x, uint16_t y)
+    {
+        const uint8_t* p = &from[3 * matrix.index(x, y)];
+        return WireColor{ p[0], p[1], p[2] };
+    };
+
+    switch (kind)
+    {
+    case Transition::Kind::Crossfade:
+    {
+        const uint32_t rest = Transition::full - progress;
+        auto mix = [&](uint8_t a, uint8_t b)
+        { return static_cast<uint8_t>((a * rest + b * progress) >> 8); };
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                const WireColor a = old(x, y);
+                const WireColor b = matrix.wirePixel(x, y);
+                matrix.setWirePixel(
+                    x, y, { mix(a.g, b.g), mix(a.r, b.r), mix(a.b, b.b) });
+            }
+        }
+        break;
+    }
+    case Transition::Kind::Wipe:
+    {
+        const uint16_t edge = static_cast<uint16_t>(progress * W / Transition::full);
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = edge; x < W; ++x)
+            {
+                matrix.setWirePixel(x, y, old(x, y));
+            }
+        }
+        break;
+    }
+    case Transition::Kind::Dissolve:
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                // Multiplicative hash of the position, top 8 bits
+                const uint32_t i = static_cast<uint32_t>(y) * W + x;
+                if (((i * 2654435761u) >> 24) >= progress)
+                {
+                    matrix.setWirePixel(x, y, old(x, y));
+                }
+            }
+        }
+        break;
+    case Transition::Kind::Slide:
+    {
+        const uint16_t shift = static_cast<uint16_t>(progress * W / Transition::full);
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            // Right to left, so the new content is read before it moves
+            for (uint16_t x = W; x-- > 0;)
+            {
+                matrix.setWirePixel(
+                    x,
+                    y,
+                    x + shift < W ? old(x + shift, y)
+                                  : matrix.wirePixel(x + shift - W, y));
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+#endif  // TRANSITION_HPP
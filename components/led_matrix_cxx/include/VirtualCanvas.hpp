@@ -0,0 +1,77 @@
+#ifndef VIRTUAL_CANVAS_HPP
+#define VIRTUAL_CANVAS_HPP
+
+#include "LedMatrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/**
+ * VirtualCanvas: one picture across several devices mounted side by side,
+ * a video wall. Every device shows its tile, the rectangle of the canvas
+ * at (tileX, tileY).
+ * rotation is how the matrix is mounted, turned clockwise: with Rot90 its
+ * top left pixel shows the top right one of the tile, and the tile is
+ * matrixHeight canvas pixels wide.
+ * Canvas frames are 3 bytes per pixel, row after row. crop() takes them a
+ * piece at a time, so nothing canvas sized is needed to show a tile.
+ * A GIF for the wall is decoded at the canvas size though, so valid()
+ * keeps the canvas small enough for a GifDecoder to fit in PSRAM.
+ */
+struct VirtualCanvas
+{
+    uint16_t width{ 0 };
+    uint16_t height{ 0 };
+    // Canvas pixel at the top left corner of the tile
+    uint16_t tileX{ 0 };
+    uint16_t tileY{ 0 };
+    // Of the matrix frames, in logical order
+    uint16_t matrixWidth{ 0 };
+    uint16_t matrixHeight{ 0 };
+    WS2812MatrixRotation rotation{ WS2812MatrixRotation::Rot0 };
+
+    // Largest canvas side, that of the largest GIF
+    static constexpr uint16_t maxSize = 4096;
+    // PSRAM a GifDecoder at the canvas size may take
+    static constexpr size_t maxDecoderBytes = 2 * 1024 * 1024;
+
+    // A canvas that is just the matrix
+    static constexpr VirtualCanvas single(uint16_t width, uint16_t height)
+    {
+        return { width, height, 0, 0, width, height, WS2812MatrixRotation::Rot0 };
+    }
+
+    bool operator==(const VirtualCanvas&) const = default;
+
+    // The tile is inside the canvas, and the canvas within the limits
+    bool valid() const;
+    // Canvas pixels the tile covers
+    uint16_t tileWidth() const { return turned() ? matrixHeight : matrixWidth; }
+    uint16_t tileHeight() const { return turned() ? matrixWidth : matrixHeight; }
+    // Bytes of a canvas frame
+    size_t channels() const { return size_t{ width } * height * 3; }
+    // Bytes [firstChannel(), endChannel()) of a canvas frame are the rows
+    // the tile is in, nothing else of the frame is shown
+    size_t firstChannel() const { return size_t{ tileY } * width * 3; }
+    size_t endChannel() const { return (size_t{ tileY } + tileHeight()) * width * 3; }
+
+    // Matrix pixel (logical index) showing canvas pixel (x, y)
+    std::optional<size_t> pixelAt(uint16_t x, uint16_t y) const;
+    // Writes the bytes of the tile among bytes, which start at byte offset
+    // of a canvas frame, into tile: 3 bytes per matrix pixel in logical
+    // order. Returns how many it wrote.
+    size_t crop(size_t offset, std::span<const uint8_t> bytes, std::span<uint8_t> tile) const;
+
+private:
+    bool turned() const
+    {
+        return rotation == WS2812MatrixRotation::Rot90
+            || rotation == WS2812MatrixRotation::Rot270;
+    }
+    // Matrix pixel showing tile pixel (u, v)
+    size_t matrixIndex(uint16_t u, uint16_t v) const;
+};
+
+#endif  // VIRTUAL_CANVAS_HPP
@@ -0,0 +1,40 @@
+#include "Effect.hpp"
+
+const char* Effect::toString(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::Plasma:
+        return "plasma";
+    case Kind::Rainbow:
+        return "rainbow";
+    case Kind::Noise:
+        return "noise";
+    case Kind::Fire:
+        return "fire";
+    case Kind::MatrixRain:
+        return "matrix-rain";
+    case Kind::Life:
+        return "life";
+    default:
+        return "invalid";
+    }
+}
+
+std::optional<Effect::Kind> Effect::parseKind(std::string_view name)
+{
+    for (auto kind:
+         { Kind::Plasma,
+           Kind::Rainbow,
+           Kind::Noise,
+           Kind::Fire,
+           Kind::MatrixRain,
+           Kind::Life })
+    {
+        if (name == toString(kind))
+        {
+            return kind;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,538 @@
+#include "GifDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+uint16_t le16(const uint8_t* bytes) { return static_cast<uint16_t>(bytes[0] | bytes[1] << 8); }
+
+// Interlaced images send rows 0, 8, 16..., then 4, 12..., 2, 6..., 1, 3...
+constexpr uint8_t passStart[] = { 0, 4, 2, 1 };
+constexpr uint8_t passStep[] = { 8, 8, 4, 2 };
+}  // namespace
+
+GifDecoder::GifDecoder(uint16_t width, uint16_t height, FrameCallback onFrame)
+    : width_{ width }
+    , height_{ height }
+    , onFrame_{ std::move(onFrame) }
+{
+    const size_t pixels = size_t{ width } * height;
+    // Exceptions are off, so every buffer is reserved and checked before
+    // anything is written to it. saved_ gets its memory now too, it is
+    // only ever assigned canvas_.
+    ok_ = reserve(columnStarts_, width) && reserve(columnEnds_, width)
+        && reserve(rowStarts_, height) && reserve(rowEnds_, height)
+        && reserve(prefixes_, maxCodes) && reserve(suffixes_, maxCodes)
+        && reserve(stack_, maxCodes + 1) && reserve(sums_, pixels)
+        && reserve(canvas_, pixels) && reserve(saved_, pixels);
+    if (!ok_)
+    {
+        fail("out of memory");
+        return;
+    }
+    columnStarts_.resize(width);
+    columnEnds_.resize(width);
+    rowStarts_.resize(height);
+    rowEnds_.resize(height);
+    prefixes_.resize(maxCodes);
+    suffixes_.resize(maxCodes);
+    stack_.resize(maxCodes + 1);
+    sums_.resize(pixels);
+    canvas_.resize(pixels, Color{ 0, 0, 0 });
+    expect(State::Header, 6);
+}
+
+template<typename T> bool GifDecoder::reserve(Vector<T>& vector, size_t size)
+{
+    if (size > vector.max_size())
+    {
+        return false;
+    }
+    vector.reserve(size);
+    return size == 0 || vector.data() != nullptr;
+}
+
+bool GifDecoder::feed(const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size && state_ != State::Done; ++i)
+    {
+        if (state_ == State::Failed || !step(data[i]))
+        {
+            return false;
+        }
+    }
+    return state_ != State::Failed;
+}
+
+bool GifDecoder::fail(const char* error)
+{
+    error_ = error;
+    state_ = State::Failed;
+    return false;
+}
+
+void GifDecoder::expect(State state, size_t count)
+{
+    state_ = state;
+    fieldsRead_ = 0;
+    fieldsNeeded_ = count;
+}
+
+bool GifDecoder::step(uint8_t byte)
+{
+    switch (state_)
+    {
+    case State::Header:
+    case State::ScreenDescriptor:
+    case State::ImageDescriptor:
+        fields_[fieldsRead_++] = byte;
+        return fieldsRead_ < fieldsNeeded_ || fieldsRead();
+
+    case State::GlobalColorTable:
+    case State::LocalColorTable:
+    {
+        // fieldsRead_ counts the bytes of the table
+        uint8_t* color = &table_[fieldsRead_ / 3].r;
+        color[fieldsRead_ % 3] = byte;
+        ++fieldsRead_;
+        if (--remaining_ == 0)
+        {
+            state_ = state_ == State::GlobalColorTable ? State::Block
+                                                       : State::LzwMinimumCodeSize;
+        }
+        return true;
+    }
+
+    case State::Block:
+        switch (byte)
+        {
+        case 0x21:
+            state_ = State::ExtensionLabel;
+            return true;
+        case 0x2C:
+            expect(State::ImageDescriptor, 9);
+            return true;
+        case 0x3B:
+            state_ = State::Done;
+            return true;
+        default:
+            return fail("unknown block");
+        }
+
+    case State::ExtensionLabel:
+        graphicControl_ = byte == 0xF9;
+        fieldsRead_ = 0;
+        state_ = State::ExtensionSize;
+        return true;
+
+    case State::ExtensionSize:
+        if (byte != 0)
+        {
+            remaining_ = byte;
+            state_ = State::ExtensionData;
+            return true;
+        }
+        if (graphicControl_ && fieldsRead_ >= 4)
+        {
+            disposal_ = (fields_[0] >> 2) & 7;
+            transparent_ = fields_[0] & 1;
+            const uint32_t delayMs = le16(&fields_[1]) * 10u;
+            delayMs_ = delayMs < 20 ? defaultDelayMs : delayMs;
+            transparentIndex_ = fields_[3];
+        }
+        state_ = State::Block;
+        return true;
+
+    case State::ExtensionData:
+        // Only the first 4 bytes of a graphic control extension matter
+        if (graphicControl_ && fieldsRead_ < 4)
+        {
+            fields_[fieldsRead_++] = byte;
+        }
+        if (--remaining_ == 0)
+        {
+            state_ = State::ExtensionSize;
+        }
+        return true;
+
+    case State::LzwMinimumCodeSize:
+        if (byte < 2 || byte > 8)
+        {
+            return fail("bad LZW code size");
+        }
+        startImage(byte);
+        state_ = State::ImageDataSize;
+        return true;
+
+    case State::ImageDataSize:
+        if (byte != 0)
+        {
+            remaining_ = byte;
+            state_ = State::ImageData;
+            return true;
+        }
+        state_ = State::Block;
+        return endImage();
+
+    case State::ImageData:
+        if (--remaining_ == 0)
+        {
+            state_ = State::ImageDataSize;
+        }
+        return decode(byte);
+
+    default:
+        return true;
+    }
+}
+
+bool GifDecoder::fieldsRead()
+{
+    const uint8_t* f = fields_.data();
+    switch (state_)
+    {
+    case State::Header:
+        if (std::memcmp(f, "GIF87a", 6) != 0 && std::memcmp(f, "GIF89a", 6) != 0)
+        {
+            return fail("not a GIF");
+        }
+        expect(State::ScreenDescriptor, 7);
+        return true;
+
+    case State::ScreenDescriptor:
+        screenWidth_ = le16(f);
+        screenHeight_ = le16(f + 2);
+        if (!screen())
+        {
+            return fail("bad screen size");
+        }
+        hasGlobalColors_ = f[4] & 0x80;
+        if (hasGlobalColors_)
+        {
+            table_ = globalColors_.data();
+            remaining_ = (2u << (f[4] & 7)) * 3;
+            fieldsRead_ = 0;
+            state_ = State::GlobalColorTable;
+        }
+        else
+        {
+            state_ = State::Block;
+        }
+        return true;
+
+    default:
+        // Image descriptor
+        left_ = le16(f);
+        top_ = le16(f + 2);
+        imageWidth_ = le16(f + 4);
+        imageHeight_ = le16(f + 6);
+        interlaced_ = f[8] & 0x40;
+        if (f[8] & 0x80)
+        {
+            table_ = localColors_.data();
+            colors_ = localColors_.data();
+            remaining_ = (2u << (f[8] & 7)) * 3;
+            fieldsRead_ = 0;
+            state_ = State::LocalColorTable;
+            return true;
+        }
+        if (!hasGlobalColors_)
+        {
+            return fail("no colour table");
+        }
+        colors_ = globalColors_.data();
+        state_ = State::LzwMinimumCodeSize;
+        return true;
+    }
+}
+
+bool GifDecoder::screen()
+{
+    if (screenWidth_ == 0 || screenHeight_ == 0 || screenWidth_ > maxScreenSize
+        || screenHeight_ > maxScreenSize)
+    {
+        return false;
+    }
+    // Output pixel i covers screen pixels [i * screen / out, (i + 1) *
+    // screen / out), at least one
+    auto spans = [](Vector<uint16_t>& starts, Vector<uint16_t>& ends, uint32_t screen)
+    {
+        const uint32_t out = starts.size();
+        for (uint32_t i = 0; i < out; ++i)
+        {
+            starts[i] = static_cast<uint16_t>(i * screen / out);
+            ends[i] = static_cast<uint16_t>(
+                std::max((i + 1) * screen / out, uint32_t{ starts[i] } + 1u));
+        }
+    };
+    spans(columnStarts_, columnEnds_, screenWidth_);
+    spans(rowStarts_, rowEnds_, screenHeight_);
+    return true;
+}
+
+uint32_t GifDecoder::overlap(
+    const Vector<uint16_t>& starts,
+    const Vector<uint16_t>& ends,
+    size_t cell,
+    uint32_t from,
+    uint32_t to)
+{
+    const uint32_t start = std::max<uint32_t>(starts[cell], from);
+    const uint32_t end = std::min<uint32_t>(ends[cell], to);
+    return end > start ? end - start : 0;
+}
+
+void GifDecoder::startImage(uint8_t minimumCodeSize)
+{
+    // What the image before leaves behind
+    if (previousDisposal_ == 2)
+    {
+        // Back to the (black) background where it was
+        for (size_t ty = 0; ty < height_; ++ty)
+        {
+            const uint32_t rows = overlap(
+                rowStarts_, rowEnds_, ty, previousTop_, previousTop_ + previousHeight_);
+            const uint32_t rowSpan = rowEnds_[ty] - rowStarts_[ty];
+            for (size_t tx = 0; rows != 0 && tx < width_; ++tx)
+            {
+                const uint32_t area = rowSpan * (columnEnds_[tx] - columnStarts_[tx]);
+                const uint32_t covered = rows
+                    * overlap(columnStarts_,
+                              columnEnds_,
+                              tx,
+                              previousLeft_,
+                              previousLeft_ + previousWidth_);
+                Color& color = canvas_[ty * width_ + tx];
+                color.r = static_cast<uint8_t>(color.r * (area - covered) / area);
+                color.g = static_cast<uint8_t>(color.g * (area - covered) / area);
+                color.b = static_cast<uint8_t>(color.b * (area - covered) / area);
+            }
+        }
+    }
+    else if (previousDisposal_ == 3 && !saved_.empty())
+    {
+        canvas_.assign(saved_.begin(), saved_.end());
+    }
+    if (disposal_ == 3)
+    {
+        // Within the capacity reserved up front
+        saved_.assign(canvas_.begin(), canvas_.end());
+    }
+
+    pass_ = 0;
+    x_ = 0;
+    y_ = 0;
+    pixelsLeft_ = uint32_t{ imageWidth_ } * imageHeight_;
+    enterRow();
+
+    minimumCodeSize_ = minimumCodeSize;
+    clearCode_ = 1 << minimumCodeSize;
+    codeSize_ = minimumCodeSize + 1;
+    nextCode_ = clearCode_ + 2;
+    previousCode_ = noCode;
+    bits_ = 0;
+    bitCount_ = 0;
+    endOfData_ = false;
+}
+
+bool GifDecoder::decode(uint8_t byte)
+{
+    if (endOfData_)
+    {
+        return true;
+    }
+    bits_ |= uint32_t{ byte } << bitCount_;
+    bitCount_ += 8;
+    while (bitCount_ >= codeSize_ && !endOfData_)
+    {
+        const uint16_t next = bits_ & ((1u << codeSize_) - 1);
+        bits_ >>= codeSize_;
+        bitCount_ -= codeSize_;
+        if (!code(next))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GifDecoder::code(uint16_t code)
+{
+    if (code == clearCode_)
+    {
+        codeSize_ = minimumCodeSize_ + 1;
+        nextCode_ = clearCode_ + 2;
+        previousCode_ = noCode;
+        return true;
+    }
+    if (code == clearCode_ + 1)
+    {
+        endOfData_ = true;
+        return true;
+    }
+    if (previousCode_ == noCode)
+    {
+        if (code > clearCode_)
+        {
+            return fail("bad LZW code");
+        }
+        firstByte_ = static_cast<uint8_t>(code);
+        previousCode_ = code;
+        pixel(firstByte_);
+        return true;
+    }
+    if (code > nextCode_)
+    {
+        return fail("bad LZW code");
+    }
+
+    // The string of code, last byte first. The code not in the table yet
+    // is the previous string and its first byte.
+    size_t depth = 0;
+    uint16_t walk = code;
+    if (code == nextCode_)
+    {
+        stack_[depth++] = firstByte_;
+        walk = previousCode_;
+    }
+    while (walk > clearCode_ + 1)
+    {
+        stack_[depth++] = suffixes_[walk];
+        walk = prefixes_[walk];
+    }
+    firstByte_ = static_cast<uint8_t>(walk);
+    stack_[depth++] = firstByte_;
+
+    if (nextCode_ < maxCodes)
+    {
+        prefixes_[nextCode_] = previousCode_;
+        suffixes_[nextCode_] = firstByte_;
+        ++nextCode_;
+        if (nextCode_ == (1u << codeSize_) && codeSize_ < 12)
+        {
+            ++codeSize_;
+        }
+    }
+    previousCode_ = code;
+    while (depth != 0)
+    {
+        pixel(stack_[--depth]);
+    }
+    return true;
+}
+
+void GifDecoder::pixel(uint8_t index)
+{
+    if (pixelsLeft_ == 0)
+    {
+        return;
+    }
+    --pixelsLeft_;
+    const uint32_t sx = uint32_t{ left_ } + x_;
+    if (rowFirst_ < rowEnd_ && sx < screenWidth_
+        && !(transparent_ && index == transparentIndex_))
+    {
+        while (columnEnds_[column_] <= sx)
+        {
+            ++column_;
+        }
+        const Color& color = colors_[index];
+        for (size_t tx = column_; tx < width_ && columnStarts_[tx] <= sx; ++tx)
+        {
+            for (size_t ty = rowFirst_; ty < rowEnd_; ++ty)
+            {
+                auto& sum = sums_[ty * width_ + tx];
+                sum[0] += color.r;
+                sum[1] += color.g;
+                sum[2] += color.b;
+                ++sum[3];
+            }
+        }
+    }
+    if (++x_ == imageWidth_)
+    {
+        nextRow();
+    }
+}
+
+void GifDecoder::nextRow()
+{
+    x_ = 0;
+    if (interlaced_)
+    {
+        y_ += passStep[pass_];
+        while (y_ >= imageHeight_ && pass_ < 3)
+        {
+            ++pass_;
+            y_ = passStart[pass_];
+        }
+    }
+    else
+    {
+        ++y_;
+    }
+    enterRow();
+}
+
+void GifDecoder::enterRow()
+{
+    column_ = 0;
+    rowFirst_ = rowEnd_ = 0;
+    const uint32_t sy = uint32_t{ top_ } + y_;
+    if (y_ >= imageHeight_ || sy >= screenHeight_)
+    {
+        return;
+    }
+    while (rowEnds_[rowFirst_] <= sy)
+    {
+        ++rowFirst_;
+    }
+    rowEnd_ = rowFirst_;
+    while (rowEnd_ < height_ && rowStarts_[rowEnd_] <= sy)
+    {
+        ++rowEnd_;
+    }
+}
+
+bool GifDecoder::endImage()
+{
+    // Opaque pixels replace their share of the canvas
+    for (size_t ty = 0; ty < height_; ++ty)
+    {
+        const uint32_t rowSpan = rowEnds_[ty] - rowStarts_[ty];
+        for (size_t tx = 0; tx < width_; ++tx)
+        {
+            const size_t i = ty * width_ + tx;
+            auto& sum = sums_[i];
+            if (sum[3] == 0)
+            {
+                continue;
+            }
+            const uint32_t area = rowSpan * (columnEnds_[tx] - columnStarts_[tx]);
+            const uint32_t kept = area - std::min(sum[3], area);
+            Color& color = canvas_[i];
+            color.r = static_cast<uint8_t>((sum[0] + color.r * kept + area / 2) / area);
+            color.g = static_cast<uint8_t>((sum[1] + color.g * kept + area / 2) / area);
+            color.b = static_cast<uint8_t>((sum[2] + color.b * kept + area / 2) / area);
+            sum = {};
+        }
+    }
+
+    previousDisposal_ = disposal_;
+    previousLeft_ = left_;
+    previousTop_ = top_;
+    previousWidth_ = imageWidth_;
+    previousHeight_ = imageHeight_;
+    const uint32_t delayMs = delayMs_;
+    disposal_ = 0;
+    transparent_ = false;
+    delayMs_ = defaultDelayMs;
+
+    ++frames_;
+    if (!onFrame_(std::span<const Color>{ canvas_.data(), canvas_.size() }, delayMs))
+    {
+        return fail("stopped");
+    }
+    return true;
+}
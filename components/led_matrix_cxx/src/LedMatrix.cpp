@@ -6,45 +6,23 @@
 
 #include "freertos/FreeRTOS.h"
 
-template<
-    uint16_t Width,
-    uint16_t Height,
-    bool Serpentine,
-    WS2812MatrixRotation Rotation,
-    bool MirrorX,
-    bool MirrorY>
-WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
-    WS2812Matrix(gpio_num_t gpio)
+WS2812Output::WS2812Output(gpio_num_t gpio, size_t memBlockSymbols)
     : gpio_(gpio)
+    , memBlockSymbols_(memBlockSymbols)
 {
 }
 
-template<
-    uint16_t Width,
-    uint16_t Height,
-    bool Serpentine,
-    WS2812MatrixRotation Rotation,
-    bool MirrorX,
-    bool MirrorY>
-WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
-    ~WS2812Matrix()
+WS2812Output::~WS2812Output()
 {
-    rmt_del_encoder(rmtEncoder_);
-    if (rmtChannel_)
+    rmt_del_encoder(encoder_);
+    if (channel_)
     {
-        rmt_disable(rmtChannel_);
-        rmt_del_channel(rmtChannel_);
+        rmt_disable(channel_);
+        rmt_del_channel(channel_);
     }
 }
 
-template<
-    uint16_t Width,
-    uint16_t Height,
-    bool Serpentine,
-    WS2812MatrixRotation Rotation,
-    bool MirrorX,
-    bool MirrorY>
-bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::init()
+bool WS2812Output::init()
 {
     static constexpr uint32_t resolution = 10'000'000;  // 10 MHz
 
@@ -52,7 +30,7 @@ bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::init()
         .gpio_num = gpio_,
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = resolution,
-        .mem_block_symbols = 64,
+        .mem_block_symbols = memBlockSymbols_,
         .trans_queue_depth = 4,
         .intr_priority = 0,
         .flags = { .invert_out = false,
@@ -62,7 +40,7 @@ bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::init()
                   .allow_pd = false },
     };
 
-    esp_err_t err = rmt_new_tx_channel(&txConfig, &rmtChannel_);
+    esp_err_t err = rmt_new_tx_channel(&txConfig, &channel_);
     if (err != ESP_OK)
     {
         ESP_LOGE(
@@ -71,14 +49,14 @@ bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::init()
     }
 
     led_strip_encoder_config_t encoder_config{ .resolution = resolution };
-    err = rmt_new_led_strip_encoder(&encoder_config, &rmtEncoder_);
+    err = rmt_new_led_strip_encoder(&encoder_config, &encoder_);
     if (err != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to create RMT encoder: %s", esp_err_to_name(err));
         return false;
     }
 
-    err = rmt_enable(rmtChannel_);
+    err = rmt_enable(channel_);
     if (err != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to enable RMT channel: %s", esp_err_to_name(err));
@@ -88,6 +66,61 @@ bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::init()
     return true;
 }
 
+bool WS2812Output::transmit(const uint8_t* data, size_t size)
+{
+    rmt_transmit_config_t tx_cfg = {
+        .loop_count = 0,
+        .flags = { .eot_level = false, .queue_nonblocking = false }
+    };
+
+    esp_err_t err = rmt_transmit(channel_, encoder_, data, size, &tx_cfg);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to transmit RMT data: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+bool WS2812Output::wait()
+{
+    esp_err_t err = rmt_tx_wait_all_done(channel_, portMAX_DELAY);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(
+            TAG,
+            "Timeout or error waiting for RMT transmission to complete: %s",
+            esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine,
+    WS2812MatrixRotation Rotation,
+    bool MirrorX,
+    bool MirrorY>
+WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
+    WS2812Matrix(gpio_num_t gpio)
+    : output_(gpio)
+{
+}
+
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine,
+    WS2812MatrixRotation Rotation,
+    bool MirrorX,
+    bool MirrorY>
+bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::init()
+{
+    return output_.init();
+}
+
 template<
     uint16_t Width,
     uint16_t Height,
@@ -108,6 +141,45 @@ void WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
     }
 }
 
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine,
+    WS2812MatrixRotation Rotation,
+    bool MirrorX,
+    bool MirrorY>
+void WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
+    setWirePixel(uint16_t x, uint16_t y, WireColor color)
+{
+    if (x < Width && y < Height)
+    {
+        auto idx = 3 * index(x, y);
+        pixels_[idx + 0] = color.g;
+        pixels_[idx + 1] = color.r;
+        pixels_[idx + 2] = color.b;
+    }
+}
+
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine,
+    WS2812MatrixRotation Rotation,
+    bool MirrorX,
+    bool MirrorY>
+typename WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
+    WireColor
+    WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
+        wirePixel(uint16_t x, uint16_t y) const
+{
+    if (x >= Width || y >= Height)
+    {
+        return { 0, 0, 0 };
+    }
+    const auto idx = 3 * index(x, y);
+    return { pixels_[idx + 0], pixels_[idx + 1], pixels_[idx + 2] };
+}
+
 template<
     uint16_t Width,
     uint16_t Height,
@@ -132,6 +204,36 @@ void WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
     }
 }
 
+template<
+    uint16_t Width,
+    uint16_t Height,
+    bool Serpentine,
+    WS2812MatrixRotation Rotation,
+    bool MirrorX,
+    bool MirrorY>
+void WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
+    setIndexedPixels(
+        const uint8_t* indices, uint8_t bitsPerIndex, const WireColor* palette)
+{
+    // Colours are corrected once per palette entry, here it's only a lookup
+    auto put = [&](uint16_t x, uint16_t y, uint8_t paletteIndex)
+    {
+        const WireColor& color = palette[paletteIndex];
+        size_t idx = 3 * index(x, y);
+        pixels_[idx + 0] = color.g;
+        pixels_[idx + 1] = color.r;
+        pixels_[idx + 2] = color.b;
+    };
+
+    for (size_t li = 0; li < numPixels; ++li)
+    {
+        const uint8_t paletteIndex = bitsPerIndex == 4
+            ? (li & 1 ? indices[li / 2] >> 4 : indices[li / 2] & 0x0F)
+            : indices[li];
+        put(li % Width, li / Width, paletteIndex);
+    }
+}
+
 template<
     uint16_t Width,
     uint16_t Height,
@@ -174,34 +276,7 @@ template<
 bool WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::
     update()
 {
-    rmt_transmit_config_t tx_cfg = {
-        .loop_count = 0,
-        .flags = { .eot_level = false, .queue_nonblocking = false }
-    };
-
-    esp_err_t err = rmt_transmit(
-        rmtChannel_,
-        rmtEncoder_,
-        reinterpret_cast<const uint8_t*>(pixels_.data()),
-        pixels_.size(),
-        &tx_cfg);
-    if (err != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Failed to transmit RMT data: %s", esp_err_to_name(err));
-        return false;
-    }
-
-    err = rmt_tx_wait_all_done(rmtChannel_, portMAX_DELAY);
-    if (err != ESP_OK)
-    {
-        ESP_LOGE(
-            TAG,
-            "Timeout or error waiting for RMT transmission to complete: %s",
-            esp_err_to_name(err));
-        return false;
-    }
-
-    return true;
+    return output_.transmit(pixels_.data(), pixels_.size()) && output_.wait();
 }
 
 template<
@@ -215,66 +290,7 @@ size_t
 WS2812Matrix<Width, Height, Serpentine, Rotation, MirrorX, MirrorY>::index(
     uint16_t x, uint16_t y) const
 {
-    // 1) Rotate
-    uint16_t tx = x, ty = y;
-    if constexpr (Rotation == WS2812MatrixRotation::Rot90)
-    {
-        tx = Height - 1 - y;
-        ty = x;
-    }
-    else if constexpr (Rotation == WS2812MatrixRotation::Rot180)
-    {
-        tx = Width - 1 - x;
-        ty = Height - 1 - y;
-    }
-    else if constexpr (Rotation == WS2812MatrixRotation::Rot270)
-    {
-        tx = y;
-        ty = Width - 1 - x;
-    }
-
-    // 2) Mirror
-    if constexpr (MirrorX)
-    {
-        // after 90/270 swap dims, but compile-time math still works:
-        tx
-            = ((Rotation == WS2812MatrixRotation::Rot90
-                || Rotation == WS2812MatrixRotation::Rot270)
-                   ? Height - 1 - tx
-                   : Width - 1 - tx);
-    }
-    if constexpr (MirrorY)
-    {
-        ty
-            = ((Rotation == WS2812MatrixRotation::Rot90
-                || Rotation == WS2812MatrixRotation::Rot270)
-                   ? Width - 1 - ty
-                   : Height - 1 - ty);
-    }
-
-    // 3) Serpentine / straight index
-    //    we invert y so row-0 is bottom of panel
-    constexpr uint16_t W = Width;
-    constexpr uint16_t H = Height;
-    uint16_t row = (H - 1) - ty;
-
-    if constexpr (Serpentine)
-    {
-        if (row & 1)
-        {
-            // odd row ⇒ left-to-right reversed
-            return row * W + (W - 1 - tx);
-        }
-        else
-        {
-            // even row ⇒ normal
-            return row * W + tx;
-        }
-    }
-    else
-    {
-        return row * W + tx;
-    }
+    return Layout::index(x, y);
 }
 
 // Explicit instantiation for the 16×16 serpentine matrix
@@ -1,8 +1,12 @@
 #include "MatrixAnimator.hpp"
 #include "LedMatrix.hpp"
+#include "MultiLedMatrix.hpp"
 #include "freertos/projdefs.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
+
+#include <algorithm>
 
 static const char* TAG = "MatrixAnimator";
 
@@ -16,32 +20,288 @@ MatrixAnimator<MatrixT>::MatrixAnimator(MatrixT& matrix)
 template<typename MatrixT> MatrixAnimator<MatrixT>::~MatrixAnimator()
 {
     stop();
+    if (from_)
+    {
+        HeapStats::deallocate(from_, HeapStats::AllocTag::Frames);
+    }
     if (lock_)
     {
         vSemaphoreDelete(lock_);
     }
 }
 
+template<typename MatrixT>
+typename MatrixAnimator<MatrixT>::Clip
+MatrixAnimator<MatrixT>::toClip(Frames&& frames)
+{
+    // Whichever representation takes the fewest pool slots
+    auto palette = Palette::fromFrames(frames);
+    const size_t best = palette ? palette->slots() : frames.size();
+    if (Delta::slotsNeeded(frames) < best)
+    {
+        if (auto delta = Delta::fromFrames(frames))
+        {
+            ESP_LOGI(
+                TAG,
+                "%u frames as deltas, %u keyframes",
+                static_cast<unsigned>(delta->size()),
+                static_cast<unsigned>(delta->keyframes()));
+            return std::move(*delta);
+        }
+    }
+    if (palette)
+    {
+        ESP_LOGI(
+            TAG,
+            "%u frames with %u colours, %u-bit palette",
+            static_cast<unsigned>(palette->size()),
+            static_cast<unsigned>(palette->paletteSize()),
+            palette->bitsPerIndex());
+        return std::move(*palette);
+    }
+    return std::move(frames);
+}
+
+template<typename MatrixT>
+size_t MatrixAnimator<MatrixT>::size(const Clip& clip)
+{
+    return std::visit([](const auto& frames) { return frames.size(); }, clip);
+}
+
+template<typename MatrixT>
+void MatrixAnimator<MatrixT>::render(
+    Clip& clip, size_t frame, size_t previous, std::optional<int64_t> sharedUs)
+{
+    // Drawn content runs from its first frame, or from the shared epoch
+    const int64_t nowUs = sharedUs.value_or(esp_timer_get_time());
+    auto timed = [&sharedUs](auto& renderer)
+    {
+        if (sharedUs)
+        {
+            renderer.startAt(0);
+        }
+    };
+    if (auto* frames = std::get_if<Frames>(&clip))
+    {
+        matrix_.setAllPixels((*frames)[frame]);
+    }
+    else if (auto* palette = std::get_if<Palette>(&clip))
+    {
+        palette->render(matrix_, frame);
+    }
+    else if (auto* delta = std::get_if<Delta>(&clip))
+    {
+        delta->render(matrix_, frame, previous);
+    }
+    else if (auto* sprites = std::get_if<Sprites>(&clip))
+    {
+        sprites->render(matrix_, frame, previous);
+    }
+    else if (auto* procedural = std::get_if<Procedural>(&clip))
+    {
+        timed(*procedural);
+        procedural->render(matrix_, nowUs);
+    }
+    else if (auto* text = std::get_if<Text>(&clip))
+    {
+        timed(*text);
+        text->render(matrix_, nowUs);
+    }
+    else if (auto* shader = std::get_if<Shader>(&clip))
+    {
+        timed(*shader);
+        shader->render(matrix_, nowUs);
+    }
+    else
+    {
+        std::get<Live>(clip).render(matrix_);
+    }
+}
+
 template<typename MatrixT>
 void MatrixAnimator<MatrixT>::start(
-    Vector&& frames,
+    Frames&& frames,
     uint32_t interval)
+{
+    Timeline timeline = Timeline::uniform(frames.size(), interval);
+    start(std::move(frames), std::move(timeline));
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::start(
+    Frames&& frames, Timeline&& timeline, Transition transition)
+{
+    return start(toClip(std::move(frames)), std::move(timeline), transition);
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::show(const Frame& frame, Transition transition)
+{
+    Frames frames;
+    if (!frames.push_back(frame))
+    {
+        ESP_LOGE(TAG, "No memory for a frame");
+        return false;
+    }
+    return start(std::move(frames), Timeline::still(), transition);
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::play(Effect effect, Transition transition)
+{
+    ESP_LOGI(TAG, "Playing effect: %s", Effect::toString(effect.kind));
+    return start(
+        Clip{ std::in_place_type<Procedural>, effect },
+        Timeline::uniform(1, Effect::frameMs),
+        transition);
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::tune(const Effect::Params& params)
 {
     xSemaphoreTake(lock_, portMAX_DELAY);
-    // Stop any existing animation
-    running_ = false;
+    auto* procedural = std::get_if<Procedural>(&frames_);
+    if (procedural)
+    {
+        procedural->tune(params);
+    }
     xSemaphoreGive(lock_);
-    if (taskHandle_)
+    return procedural != nullptr;
+}
+
+template<typename MatrixT>
+std::optional<Effect> MatrixAnimator<MatrixT>::effect() const
+{
+    std::optional<Effect> effect;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (running_)
     {
-        // wait for previous task to exit
-        vTaskDelay(pdMS_TO_TICKS(10));
+        if (auto* procedural = std::get_if<Procedural>(&frames_))
+        {
+            effect = procedural->effect();
+        }
+    }
+    xSemaphoreGive(lock_);
+    return effect;
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::scroll(ScrollingText text, Transition transition)
+{
+    ESP_LOGI(
+        TAG,
+        "Scrolling %u bytes of text at %u px/s",
+        static_cast<unsigned>(text.text.size()),
+        text.speed);
+    const uint32_t frameMs = text.frameMs();
+    return start(
+        Clip{ std::in_place_type<Text>, std::move(text) },
+        Timeline::uniform(1, frameMs),
+        transition);
+}
+
+template<typename MatrixT>
+std::optional<ScrollingText> MatrixAnimator<MatrixT>::text() const
+{
+    std::optional<ScrollingText> text;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (running_)
+    {
+        if (auto* renderer = std::get_if<Text>(&frames_))
+        {
+            text = renderer->text();
+        }
+    }
+    xSemaphoreGive(lock_);
+    return text;
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::play(PixelShader shader, Transition transition)
+{
+    ESP_LOGI(
+        TAG, "Running shader of %u instructions", static_cast<unsigned>(shader.code().size()));
+    return start(
+        Clip{ std::in_place_type<Shader>, std::move(shader) },
+        Timeline::uniform(1, PixelShader::frameMs),
+        transition);
+}
+
+template<typename MatrixT>
+std::optional<PixelShader> MatrixAnimator<MatrixT>::shader() const
+{
+    std::optional<PixelShader> shader;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (running_)
+    {
+        if (auto* renderer = std::get_if<Shader>(&frames_))
+        {
+            shader = renderer->shader();
+        }
+    }
+    xSemaphoreGive(lock_);
+    return shader;
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::draw(std::span<const uint8_t> message)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    auto* live = running_ ? std::get_if<Live>(&frames_) : nullptr;
+    const bool applied = live && live->apply(message);
+    if (applied)
+    {
+        // Rendered again from the start of its (only) entry
+        restart_ = true;
+    }
+    xSemaphoreGive(lock_);
+    if (live)
+    {
+        if (applied && taskHandle_)
+        {
+            // Wakes a held frame up
+            xTaskNotifyGive(taskHandle_);
+        }
+        return applied;
     }
 
-    // Move in the new frames
+    Live fresh;
+    if (!fresh.apply(message))
+    {
+        return false;
+    }
+    ESP_LOGI(TAG, "Drawing live");
+    // Held after one entry, which keeps changes at most Live::frameMs apart
+    Timeline timeline = Timeline::uniform(1, Live::frameMs);
+    timeline.mode = Timeline::LoopMode::Once;
+    return start(Clip{ std::in_place_type<Live>, std::move(fresh) }, std::move(timeline));
+}
+
+template<typename MatrixT>
+bool MatrixAnimator<MatrixT>::start(
+    Clip&& clip, Timeline&& timeline, Transition transition)
+{
+    if (!timeline.valid(size(clip)))
+    {
+        ESP_LOGE(
+            TAG,
+            "Timeline does not match %u frames",
+            static_cast<unsigned>(size(clip)));
+        return false;
+    }
+
+    const uint32_t firstMs = timeline.entries.front().durationMs;
+
+    // The task picks up the new frames with its next frame, the blocks of
+    // the previous animation go back to the frame pool
     xSemaphoreTake(lock_, portMAX_DELAY);
-    frames_ = std::move(frames);
-    interval_ = interval;
+    frames_ = std::move(clip);
+    timeline_ = std::move(timeline);
+    transition_ = transition;
+    restart_ = true;
     running_ = true;
+    // Late means at least one tick after the requested time
+    frameStats_.reset(firstMs * 1000, portTICK_PERIOD_MS * 1000);
     xSemaphoreGive(lock_);
 
     // Create the task
@@ -55,6 +315,7 @@ void MatrixAnimator<MatrixT>::start(
             tskIDLE_PRIORITY + 1,
             &taskHandle_);
     }
+    return true;
 }
 
 template<typename MatrixT> void MatrixAnimator<MatrixT>::stop()
@@ -72,40 +333,209 @@ template<typename MatrixT> void MatrixAnimator<MatrixT>::stop()
     }
 }
 
+template<typename MatrixT>
+void MatrixAnimator<MatrixT>::synchronize(const PlaybackClock* clock)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    clock_ = clock;
+    xSemaphoreGive(lock_);
+}
+
+template<typename MatrixT>
+void MatrixAnimator<MatrixT>::addOverlay(OverlayLayer<MatrixT>& layer)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    compositor_.add(layer);
+    xSemaphoreGive(lock_);
+}
+
+template<typename MatrixT>
+void MatrixAnimator<MatrixT>::removeOverlay(OverlayLayer<MatrixT>& layer)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    compositor_.remove(layer);
+    xSemaphoreGive(lock_);
+}
+
 template<typename MatrixT> void MatrixAnimator<MatrixT>::taskEntry(void* arg)
 {
     auto* self = static_cast<MatrixAnimator*>(arg);
     TickType_t lastWake = xTaskGetTickCount();
 
-    size_t frameIndex = 0;
+    Timeline::Cursor cursor{};
+    size_t previous = Delta::none;
+    // Part of the current entry already waited for, in transition steps
+    TickType_t entryElapsed = 0;
+    bool blending = false;
+    int64_t blendStartUs = 0;
     while (true)
     {
-        // Copy out local pointers under lock
+        // Frames may be replaced by start(), render them under the lock
+        FrameStats::Sample sample;
         xSemaphoreTake(self->lock_, portMAX_DELAY);
         bool run = self->running_;
-        auto interval = self->interval_;
-        auto& buf = self->frames_;
+        if (self->restart_)
+        {
+            // The outgoing content without the overlays
+            self->compositor_.restore(self->matrix_);
+            cursor = self->timeline_.begin();
+            previous = Delta::none;
+            entryElapsed = 0;
+            self->restart_ = false;
+            blending = !self->transition_.isCut() && self->snapshot();
+            blendStartUs = esp_timer_get_time();
+            // Not late, the frame before belongs to what was cut short
+            self->frameStats_.restartPeriod();
+        }
+        // Following a clock, the position is where the clock says, and the
+        // next frame is due when its entry starts
+        std::optional<int64_t> sharedUs;
+        if (self->clock_ && self->timeline_.mode != Timeline::LoopMode::Once)
+        {
+            sharedUs = self->clock_->sinceEpochUs();
+        }
+        int64_t dueUs = 0;
+        if (sharedUs)
+        {
+            const auto position
+                = self->timeline_.seek(static_cast<uint64_t>(std::max<int64_t>(*sharedUs, 0)));
+            cursor = position.cursor;
+            dueUs = esp_timer_get_time() + static_cast<int64_t>(position.remainingUs);
+        }
+        const size_t count = size(self->frames_);
+        // A held frame is still rendered while it transitions in
+        const bool holding = cursor.holding && !blending;
+        uint32_t durationMs = 0;
+        bool overlaysChanged = false;
+        if (run && count > 0 && !holding)
+        {
+            const auto& entry = self->timeline_.entries[cursor.entry];
+            durationMs = entry.durationMs;
+            sample.convertStartUs = static_cast<uint32_t>(esp_timer_get_time());
+            // Overlays come off first, render() may patch the last frame
+            self->compositor_.restore(self->matrix_);
+            self->render(self->frames_, entry.frame, previous, sharedUs);
+            previous = entry.frame;
+            if (blending)
+            {
+                const int64_t elapsedUs = esp_timer_get_time() - blendStartUs;
+                const uint32_t progress = static_cast<uint32_t>(std::min<int64_t>(
+                    elapsedUs * Transition::full
+                        / (int64_t{ self->transition_.durationMs } * 1000),
+                    Transition::full));
+                blendTransition(
+                    self->matrix_, *self->from_, self->transition_.kind, progress);
+                // The matrix no longer holds the plain frame
+                previous = Delta::none;
+                blending = progress < Transition::full;
+            }
+            self->compositor_.refresh(esp_timer_get_time());
+            self->compositor_.apply(self->matrix_);
+        }
+        else if (run && count > 0)
+        {
+            // Held frames only go out again when an overlay changed
+            overlaysChanged = self->compositor_.refresh(esp_timer_get_time());
+            if (overlaysChanged)
+            {
+                self->compositor_.restore(self->matrix_);
+                self->compositor_.apply(self->matrix_);
+            }
+        }
         xSemaphoreGive(self->lock_);
 
-        if (!run || buf.empty())
+        if (!run || count == 0)
         {
             break;
         }
+        if (holding)
+        {
+            // A Once timeline has ended, its last frame stays on
+            if (overlaysChanged)
+            {
+                self->matrix_.update();
+            }
+            // draw() notifies, no need to wait for the next poll
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(holdPollMs));
+            lastWake = xTaskGetTickCount();
+            // The hold is not a late frame
+            self->frameStats_.restartPeriod();
+            continue;
+        }
 
-        // Render this frame
-        self->matrix_.setAllPixels(buf[frameIndex]);
+        sample.transmitStartUs = static_cast<uint32_t>(esp_timer_get_time());
         self->matrix_.update();
+        sample.transmitDoneUs = static_cast<uint32_t>(esp_timer_get_time());
+        self->frameStats_.record(sample);
 
-        // Next frame
-        frameIndex = (frameIndex + 1) % buf.size();
+        if (sharedUs)
+        {
+            if (blending)
+            {
+                dueUs = std::min(
+                    dueUs, esp_timer_get_time() + int64_t{ transitionStepMs } * 1000);
+            }
+            self->frameStats_.setInterval(durationMs * 1000);
+            // Woken at most a tick after the due time, never before it,
+            // so the clock shows the next entry
+            constexpr int64_t tickUs = int64_t{ portTICK_PERIOD_MS } * 1000;
+            for (int64_t untilUs = dueUs - esp_timer_get_time(); untilUs > 0;
+                 untilUs = dueUs - esp_timer_get_time())
+            {
+                vTaskDelay(static_cast<TickType_t>(untilUs / tickUs + 1));
+            }
+            entryElapsed = 0;
+            lastWake = xTaskGetTickCount();
+            continue;
+        }
 
-        // Delay until next frame
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(interval));
+        // The next frame is due after this entry's duration, or after one
+        // step while blending
+        TickType_t wait = pdMS_TO_TICKS(durationMs) - entryElapsed;
+        const bool entryDone
+            = !blending || wait <= pdMS_TO_TICKS(transitionStepMs);
+        if (!entryDone)
+        {
+            wait = pdMS_TO_TICKS(transitionStepMs);
+        }
+        // Entries shorter than a tick still show for one, a wait of 0
+        // fails the assert in vTaskDelayUntil()
+        wait = std::max<TickType_t>(wait, 1);
+        entryElapsed = entryDone ? 0 : entryElapsed + wait;
+        self->frameStats_.setInterval(
+            blending ? wait * portTICK_PERIOD_MS * 1000 : durationMs * 1000);
+
+        // Next entry, unless start() brought a new timeline meanwhile
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        if (!self->restart_ && entryDone)
+        {
+            self->timeline_.advance(cursor);
+        }
+        xSemaphoreGive(self->lock_);
+
+        vTaskDelayUntil(&lastWake, wait);
     }
 
     ESP_LOGI(TAG, "Animation task exiting");
     vTaskDelete(nullptr);
 }
 
-// Explicit template instantiation
+template<typename MatrixT> bool MatrixAnimator<MatrixT>::snapshot()
+{
+    if (!from_)
+    {
+        from_ = static_cast<typename MatrixT::WireFrame*>(HeapStats::allocate(
+            sizeof(typename MatrixT::WireFrame), HeapStats::AllocTag::Frames, true));
+        if (!from_)
+        {
+            ESP_LOGW(TAG, "No memory for a transition, cutting");
+            return false;
+        }
+    }
+    *from_ = matrix_.wireFrame();
+    return true;
+}
+
+// Explicit template instantiations
 template class MatrixAnimator<LedMatrix>;
+template class MatrixAnimator<SplitLedMatrix>;
@@ -0,0 +1,431 @@
+#include "PixelShader.hpp"
+
+#include "Effect.hpp"
+
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+using Op = PixelShader::Op;
+
+// What an instruction takes after its name
+enum class Operands : uint8_t
+{
+    None,
+    // d, b
+    Unary,
+    // d, a, b
+    Binary,
+    // label
+    Jump,
+    // a, label
+    Branch,
+};
+
+struct Mnemonic
+{
+    const char* name;
+    Op op;
+    Operands operands;
+};
+
+constexpr Mnemonic mnemonics[] = {
+    { "end", Op::End, Operands::None },       { "mov", Op::Mov, Operands::Unary },
+    { "add", Op::Add, Operands::Binary },     { "sub", Op::Sub, Operands::Binary },
+    { "mul", Op::Mul, Operands::Binary },     { "div", Op::Div, Operands::Binary },
+    { "mod", Op::Mod, Operands::Binary },     { "min", Op::Min, Operands::Binary },
+    { "max", Op::Max, Operands::Binary },     { "lt", Op::Lt, Operands::Binary },
+    { "abs", Op::Abs, Operands::Unary },      { "floor", Op::Floor, Operands::Unary },
+    { "fract", Op::Fract, Operands::Unary },  { "sin", Op::Sin, Operands::Unary },
+    { "cos", Op::Cos, Operands::Unary },      { "sqrt", Op::Sqrt, Operands::Unary },
+    { "noise", Op::Noise, Operands::Binary }, { "jmp", Op::Jmp, Operands::Jump },
+    { "jz", Op::Jz, Operands::Branch },
+};
+
+constexpr std::pair<const char*, uint8_t> aliases[] = {
+    { "x", PixelShader::x }, { "y", PixelShader::y }, { "t", PixelShader::t },
+    { "r", PixelShader::r }, { "g", PixelShader::g }, { "b", PixelShader::b },
+};
+
+bool isIdentifier(std::string_view word)
+{
+    if (word.empty() || std::isdigit(static_cast<unsigned char>(word[0])))
+    {
+        return false;
+    }
+    return std::all_of(
+        word.begin(),
+        word.end(),
+        [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+
+std::optional<uint8_t> parseRegister(std::string_view word)
+{
+    for (const auto& [name, index]: aliases)
+    {
+        if (word == name)
+        {
+            return index;
+        }
+    }
+    if (word.size() < 2 || word.size() > 3 || word[0] != 'r')
+    {
+        return std::nullopt;
+    }
+    unsigned index = 0;
+    for (char c: word.substr(1))
+    {
+        if (!std::isdigit(static_cast<unsigned char>(c)))
+        {
+            return std::nullopt;
+        }
+        index = index * 10 + (c - '0');
+    }
+    if (index >= PixelShader::registers)
+    {
+        return std::nullopt;
+    }
+    return static_cast<uint8_t>(index);
+}
+
+// Decimal number to Q16.16, rounded
+std::optional<int32_t> parseNumber(std::string_view word)
+{
+    if (word.empty() || word.size() > 32)
+    {
+        return std::nullopt;
+    }
+    const std::string text{ word };
+    char* end = nullptr;
+    const double value = std::strtod(text.c_str(), &end);
+    if (end != text.c_str() + text.size() || !(value > -32768.0 && value < 32768.0))
+    {
+        return std::nullopt;
+    }
+    const double scaled = value * PixelShader::one;
+    return static_cast<int32_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+// Splits at whitespace and commas
+std::vector<std::string_view> split(std::string_view line)
+{
+    std::vector<std::string_view> words;
+    size_t start = 0;
+    for (size_t i = 0; i <= line.size(); ++i)
+    {
+        const bool separator = i == line.size() || line[i] == ','
+            || std::isspace(static_cast<unsigned char>(line[i]));
+        if (separator)
+        {
+            if (i > start)
+            {
+                words.push_back(line.substr(start, i - start));
+            }
+            start = i + 1;
+        }
+    }
+    return words;
+}
+
+int32_t saturate(int64_t value)
+{
+    return static_cast<int32_t>(std::clamp<int64_t>(value, INT32_MIN, INT32_MAX));
+}
+
+// turns in Q16.16, only the fraction matters
+int32_t sine(uint32_t turns)
+{
+    // Between two entries of the 8 bit table
+    const uint32_t angle = turns & 0xFFFF;
+    const int32_t s0 = EffectMath::sin8(static_cast<uint8_t>(angle >> 8));
+    const int32_t s1 = EffectMath::sin8(static_cast<uint8_t>((angle >> 8) + 1));
+    const int32_t value = s0 * 256 + (s1 - s0) * static_cast<int32_t>(angle & 255);
+    // 128 + 127 * sin, in 1/256
+    return static_cast<int32_t>(
+        static_cast<int64_t>(value - 128 * 256) * PixelShader::one / (127 * 256));
+}
+
+int32_t squareRoot(int32_t value)
+{
+    if (value <= 0)
+    {
+        return 0;
+    }
+    // sqrt(v / 2^16) * 2^16 = sqrt(v * 2^16)
+    uint64_t n = static_cast<uint64_t>(value) << 16;
+    uint64_t root = 0;
+    uint64_t bit = uint64_t{ 1 } << 46;
+    while (bit > n)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<int32_t>(root);
+}
+}  // namespace
+
+std::optional<PixelShader> PixelShader::assemble(std::string_view source, std::string* error)
+{
+    size_t lineNumber = 0;
+    auto fail = [&](const std::string& reason) -> std::optional<PixelShader>
+    {
+        if (error)
+        {
+            *error = lineNumber ? "line " + std::to_string(lineNumber) + ": " + reason
+                                : reason;
+        }
+        return std::nullopt;
+    };
+    if (source.size() > maxSourceLength)
+    {
+        return fail("longer than " + std::to_string(maxSourceLength) + " bytes");
+    }
+
+    PixelShader shader;
+    shader.source_ = std::string{ source };
+    std::vector<std::pair<std::string_view, int32_t>> labels;
+    // Jumps to labels not seen yet: instruction, label, line
+    struct Fixup
+    {
+        size_t instruction;
+        std::string_view label;
+        size_t line;
+    };
+    std::vector<Fixup> fixups;
+
+    while (!source.empty())
+    {
+        ++lineNumber;
+        const size_t newline = source.find('\n');
+        std::string_view line = source.substr(0, newline);
+        source.remove_prefix(newline == std::string_view::npos ? source.size() : newline + 1);
+        line = line.substr(0, line.find(';'));
+
+        std::vector<std::string_view> words = split(line);
+        if (words.empty())
+        {
+            continue;
+        }
+        if (words[0].back() == ':')
+        {
+            const std::string_view label = words[0].substr(0, words[0].size() - 1);
+            if (!isIdentifier(label))
+            {
+                return fail("bad label '" + std::string{ label } + "'");
+            }
+            for (const auto& [name, target]: labels)
+            {
+                if (name == label)
+                {
+                    return fail("label '" + std::string{ label } + "' defined twice");
+                }
+            }
+            labels.emplace_back(label, static_cast<int32_t>(shader.code_.size()));
+            words.erase(words.begin());
+            if (words.empty())
+            {
+                continue;
+            }
+        }
+
+        const Mnemonic* mnemonic = nullptr;
+        for (const Mnemonic& candidate: mnemonics)
+        {
+            if (words[0] == candidate.name)
+            {
+                mnemonic = &candidate;
+            }
+        }
+        if (!mnemonic)
+        {
+            return fail("unknown instruction '" + std::string{ words[0] } + "'");
+        }
+        if (shader.code_.size() == maxInstructions)
+        {
+            return fail("more than " + std::to_string(maxInstructions) + " instructions");
+        }
+
+        static constexpr size_t counts[] = { 0, 2, 3, 1, 2 };
+        const size_t count = counts[static_cast<size_t>(mnemonic->operands)];
+        if (words.size() - 1 != count)
+        {
+            return fail(
+                std::string{ mnemonic->name } + " takes " + std::to_string(count)
+                + " operands");
+        }
+
+        Instruction instruction{ mnemonic->op };
+        auto reg = [&](std::string_view word, uint8_t& field)
+        {
+            const auto index = parseRegister(word);
+            field = index.value_or(0);
+            return index.has_value();
+        };
+        // The last source, a register or a number
+        auto operand = [&](std::string_view word)
+        {
+            if (reg(word, instruction.b))
+            {
+                return true;
+            }
+            const auto number = parseNumber(word);
+            instruction.b = immediate;
+            instruction.value = number.value_or(0);
+            return number.has_value();
+        };
+        bool valid = true;
+        std::string_view label;
+        switch (mnemonic->operands)
+        {
+        case Operands::None:
+            break;
+        case Operands::Unary:
+            valid = reg(words[1], instruction.d) && operand(words[2]);
+            break;
+        case Operands::Binary:
+            valid = reg(words[1], instruction.d) && reg(words[2], instruction.a)
+                && operand(words[3]);
+            break;
+        case Operands::Jump:
+            label = words[1];
+            break;
+        case Operands::Branch:
+            valid = reg(words[1], instruction.a);
+            label = words[2];
+            break;
+        }
+        if (!valid)
+        {
+            return fail("bad operands for " + std::string{ mnemonic->name });
+        }
+        if (!label.empty())
+        {
+            if (!isIdentifier(label))
+            {
+                return fail("bad label '" + std::string{ label } + "'");
+            }
+            fixups.push_back({ shader.code_.size(), label, lineNumber });
+        }
+        shader.code_.push_back(instruction);
+    }
+
+    for (const Fixup& fixup: fixups)
+    {
+        auto found = std::find_if(
+            labels.begin(),
+            labels.end(),
+            [&](const auto& entry) { return entry.first == fixup.label; });
+        if (found == labels.end())
+        {
+            lineNumber = fixup.line;
+            return fail("unknown label '" + std::string{ fixup.label } + "'");
+        }
+        shader.code_[fixup.instruction].value = found->second;
+    }
+    return shader;
+}
+
+bool PixelShader::execute(
+    const Instruction* code, size_t size, Registers& regs, uint32_t& budget)
+{
+    size_t pc = 0;
+    while (pc < size)
+    {
+        if (budget == 0)
+        {
+            return false;
+        }
+        --budget;
+        const Instruction& instruction = code[pc++];
+        const int32_t a = regs[instruction.a];
+        const int32_t b = instruction.b == immediate ? instruction.value : regs[instruction.b];
+        int32_t& d = regs[instruction.d];
+        switch (instruction.op)
+        {
+        case Op::End:
+            return true;
+        case Op::Mov:
+            d = b;
+            break;
+        case Op::Add:
+            d = static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+            break;
+        case Op::Sub:
+            d = static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+            break;
+        case Op::Mul:
+            d = saturate((static_cast<int64_t>(a) * b) >> 16);
+            break;
+        case Op::Div:
+            d = b == 0 ? 0 : saturate(static_cast<int64_t>(a) * one / b);
+            break;
+        case Op::Mod:
+        {
+            int32_t rest = b == 0 || b == -1 ? 0 : a % b;
+            if (rest != 0 && (rest < 0) != (b < 0))
+            {
+                rest += b;
+            }
+            d = rest;
+            break;
+        }
+        case Op::Min:
+            d = std::min(a, b);
+            break;
+        case Op::Max:
+            d = std::max(a, b);
+            break;
+        case Op::Lt:
+            d = a < b ? one : 0;
+            break;
+        case Op::Abs:
+            d = b == INT32_MIN ? INT32_MAX : std::abs(b);
+            break;
+        case Op::Floor:
+            d = static_cast<int32_t>(static_cast<uint32_t>(b) & 0xFFFF0000u);
+            break;
+        case Op::Fract:
+            d = b & 0xFFFF;
+            break;
+        case Op::Sin:
+            d = sine(static_cast<uint32_t>(b));
+            break;
+        case Op::Cos:
+            d = sine(static_cast<uint32_t>(b) + one / 4);
+            break;
+        case Op::Sqrt:
+            d = squareRoot(b);
+            break;
+        case Op::Noise:
+            d = EffectMath::noise8(
+                    static_cast<uint32_t>(a) >> 8, static_cast<uint32_t>(b) >> 8, 0)
+                * one / 255;
+            break;
+        case Op::Jmp:
+            pc = instruction.value;
+            break;
+        case Op::Jz:
+            if (a == 0)
+            {
+                pc = instruction.value;
+            }
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#include "ScrollingText.hpp"
+
+const char* ScrollingText::toString(Font font)
+{
+    switch (font)
+    {
+    case Font::Small:
+        return "5x7";
+    case Font::Large:
+        return "8x8";
+    default:
+        return "invalid";
+    }
+}
+
+std::optional<ScrollingText::Font> ScrollingText::parseFont(std::string_view name)
+{
+    for (auto font: { Font::Small, Font::Large })
+    {
+        if (name == toString(font))
+        {
+            return font;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,188 @@
+#include "Timeline.hpp"
+
+Timeline Timeline::uniform(size_t numFrames, uint32_t durationMs)
+{
+    Timeline timeline;
+    timeline.entries.reserve(numFrames);
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        timeline.entries.push_back({ static_cast<uint16_t>(i), durationMs });
+    }
+    return timeline;
+}
+
+Timeline Timeline::still()
+{
+    Timeline timeline = uniform(1, stillMs);
+    timeline.mode = LoopMode::Once;
+    return timeline;
+}
+
+bool Timeline::valid(size_t numFrames) const
+{
+    if (entries.empty() || entries.size() > UINT16_MAX)
+    {
+        return false;
+    }
+    for (const auto& entry: entries)
+    {
+        if (entry.frame >= numFrames || entry.durationMs == 0)
+        {
+            return false;
+        }
+    }
+    if (mode == LoopMode::Segment)
+    {
+        return loopStart <= loopEnd && loopEnd < entries.size();
+    }
+    return true;
+}
+
+void Timeline::advance(Cursor& cursor) const
+{
+    const size_t n = entries.size();
+    if (cursor.holding || n == 0)
+    {
+        return;
+    }
+    const size_t last = n - 1;
+
+    switch (mode)
+    {
+    case LoopMode::Loop:
+        cursor.entry = cursor.entry < last ? cursor.entry + 1 : 0;
+        break;
+    case LoopMode::PingPong:
+        if (n == 1)
+        {
+            break;
+        }
+        if (cursor.backward && cursor.entry == 0)
+        {
+            cursor.backward = false;
+        }
+        else if (!cursor.backward && cursor.entry >= last)
+        {
+            cursor.backward = true;
+        }
+        cursor.entry = cursor.backward ? cursor.entry - 1 : cursor.entry + 1;
+        break;
+    case LoopMode::Once:
+        if (cursor.entry < last)
+        {
+            ++cursor.entry;
+        }
+        else
+        {
+            cursor.holding = true;
+        }
+        break;
+    case LoopMode::Segment:
+        cursor.entry = cursor.entry < loopEnd && cursor.entry < last
+            ? cursor.entry + 1
+            : loopStart;
+        break;
+    }
+}
+
+Timeline::Position Timeline::seek(uint64_t elapsedUs) const
+{
+    auto durationUs = [this](size_t entry)
+    { return uint64_t{ entries[entry].durationMs } * 1000; };
+    // Total duration of entries first..last
+    auto span = [&](size_t first, size_t last)
+    {
+        uint64_t us = 0;
+        for (size_t entry = first; entry <= last; ++entry)
+        {
+            us += durationUs(entry);
+        }
+        return us;
+    };
+    // The entry shown usIn into first..last, played in order
+    auto find = [&](size_t first, size_t last, uint64_t usIn, bool backward)
+    {
+        for (size_t i = 0; i <= last - first; ++i)
+        {
+            const size_t entry = backward ? last - i : first + i;
+            if (usIn < durationUs(entry))
+            {
+                return Position{ { entry, backward, false }, durationUs(entry) - usIn };
+            }
+            usIn -= durationUs(entry);
+        }
+        return Position{ { backward ? first : last, backward, false }, 0 };
+    };
+
+    const size_t n = entries.size();
+    if (n == 0)
+    {
+        return { begin(), 0 };
+    }
+    const size_t last = n - 1;
+    const uint64_t all = span(0, last);
+    if (all == 0)
+    {
+        return { begin(), 0 };
+    }
+
+    switch (mode)
+    {
+    case LoopMode::PingPong:
+    {
+        // Forward over all entries, back over the inner ones
+        const uint64_t inner = n > 2 ? span(1, last - 1) : 0;
+        const uint64_t usIn = elapsedUs % (all + inner);
+        return usIn < all ? find(0, last, usIn, false) : find(1, last - 1, usIn - all, true);
+    }
+    case LoopMode::Once:
+        if (elapsedUs >= all)
+        {
+            return { { last, false, true }, 0 };
+        }
+        return find(0, last, elapsedUs, false);
+    case LoopMode::Segment:
+    {
+        const uint64_t lead = loopStart > 0 ? span(0, loopStart - 1) : 0;
+        const uint64_t segment = span(loopStart, loopEnd);
+        if (elapsedUs < lead + segment)
+        {
+            return find(0, loopEnd, elapsedUs, false);
+        }
+        return find(loopStart, loopEnd, (elapsedUs - lead) % segment, false);
+    }
+    case LoopMode::Loop:
+    default:
+        return find(0, last, elapsedUs % all, false);
+    }
+}
+
+const char* Timeline::toString(LoopMode mode)
+{
+    switch (mode)
+    {
+    case LoopMode::Loop:
+        return "loop";
+    case LoopMode::PingPong:
+        return "pingpong";
+    case LoopMode::Once:
+        return "once";
+    case LoopMode::Segment:
+        return "segment";
+    default:
+        return "invalid";
+    }
+}
+
+std::optional<Timeline::LoopMode> Timeline::parseLoopMode(std::string_view name)
+{
+    for (auto mode:
+         { LoopMode::Loop, LoopMode::PingPong, LoopMode::Once, LoopMode::Segment })
+    {
+        if (name == toString(mode))
+        {
+            return mode;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,33 @@
+#include "Transition.hpp"
+
+const char* Transition::toString(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::Cut:
+        return "cut";
+    case Kind::Crossfade:
+        return "crossfade";
+    case Kind::Wipe:
+        return "wipe";
+    case Kind::Dissolve:
+        return "dissolve";
+    case Kind::Slide:
+        return "slide";
+    default:
+        return "invalid";
+    }
+}
+
+std::optional<Transition::Kind> Transition::parseKind(std::string_view name)
+{
+    for (auto kind:
+         { Kind::Cut, Kind::Crossfade, Kind::Wipe, Kind::Dissolve, Kind::Slide })
+    {
+        if (name == toString(kind))
+        {
+            return kind;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,92 @@
+#include "VirtualCanvas.hpp"
+
+#include "GifDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(VirtualCanvas::maxSize == GifDecoder::maxScreenSize);
+
+bool VirtualCanvas::valid() const
+{
+    return width <= maxSize && height <= maxSize
+        && size_t{ width } * height * GifDecoder::bytesPerPixel <= maxDecoderBytes
+        && matrixWidth > 0 && matrixHeight > 0
+        && size_t{ tileX } + tileWidth() <= width
+        && size_t{ tileY } + tileHeight() <= height;
+}
+
+std::optional<size_t> VirtualCanvas::pixelAt(uint16_t x, uint16_t y) const
+{
+    if (x < tileX || y < tileY || x - tileX >= tileWidth() || y - tileY >= tileHeight())
+    {
+        return std::nullopt;
+    }
+    return matrixIndex(x - tileX, y - tileY);
+}
+
+size_t VirtualCanvas::crop(
+    size_t offset, std::span<const uint8_t> bytes, std::span<uint8_t> tile) const
+{
+    const size_t rowSize = size_t{ width } * 3;
+    const size_t begin = std::max(offset, firstChannel());
+    const size_t end = std::min(offset + bytes.size(), endChannel());
+    if (rowSize == 0 || tile.size() < size_t{ matrixWidth } * matrixHeight * 3)
+    {
+        return 0;
+    }
+
+    size_t written = 0;
+    for (size_t row = begin - begin % rowSize; row < end; row += rowSize)
+    {
+        // The tile's columns of this row
+        const size_t from = std::max(begin, row + size_t{ tileX } * 3);
+        const size_t to = std::min(end, row + (size_t{ tileX } + tileWidth()) * 3);
+        if (from >= to)
+        {
+            continue;
+        }
+        const auto v = static_cast<uint16_t>(row / rowSize - tileY);
+        if (rotation == WS2812MatrixRotation::Rot0)
+        {
+            // Rows stay rows
+            std::memcpy(
+                tile.data() + size_t{ v } * matrixWidth * 3 + (from - row) - size_t{ tileX } * 3,
+                bytes.data() + (from - offset),
+                to - from);
+        }
+        else
+        {
+            for (size_t channel = from; channel < to; ++channel)
+            {
+                const auto u = static_cast<uint16_t>((channel - row) / 3 - tileX);
+                tile[matrixIndex(u, v) * 3 + (channel - row) % 3] = bytes[channel - offset];
+            }
+        }
+        written += to - from;
+    }
+    return written;
+}
+
+size_t VirtualCanvas::matrixIndex(uint16_t u, uint16_t v) const
+{
+    uint16_t x = u, y = v;
+    switch (rotation)
+    {
+    case WS2812MatrixRotation::Rot0:
+        break;
+    case WS2812MatrixRotation::Rot90:
+        x = v;
+        y = matrixHeight - 1 - u;
+        break;
+    case WS2812MatrixRotation::Rot180:
+        x = matrixWidth - 1 - u;
+        y = matrixHeight - 1 - v;
+        break;
+    case WS2812MatrixRotation::Rot270:
+        x = matrixWidth - 1 - v;
+        y = u;
+        break;
+    }
+    return size_t{ y } * matrixWidth + x;
+}
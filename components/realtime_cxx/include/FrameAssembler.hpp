@@ -0,0 +1,114 @@
+#ifndef FRAME_ASSEMBLER_HPP
+#define FRAME_ASSEMBLER_HPP
+
+#include "RealtimePackets.hpp"
+#include "VirtualCanvas.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * FrameAssembler: puts the packets of the realtime protocols together into
+ * frames of RGB bytes.
+ * DDP data goes to its byte offset. For E1.31 and Art-Net, universes from
+ * the first one on hold 170 pixels (510 channels) each.
+ * Late packets (behind the last one of their stream) are dropped, so
+ * reordering never brings old data back. A frame is complete
+ *  - DDP: with the push flag, or, from senders that never push, with the
+ *    packet that reaches the end of the frame
+ *  - E1.31 with a sync universe: with the sync packet
+ *  - otherwise: once every universe arrived, or with the last universe
+ *    (senders go in order), so a lost packet only costs its part of one
+ *    frame.
+ * With a canvas, the stream is a whole video wall and the frame this
+ * device's tile of it: packets are cropped as they come, and only the
+ * universes of the tile's rows count.
+ */
+class FrameAssembler
+{
+public:
+    using Packet = RealtimePackets::Packet;
+    using Protocol = RealtimePackets::Protocol;
+
+    static constexpr size_t channelsPerUniverse = 510;
+    static constexpr size_t maxUniverses = 32;
+
+    struct Mapping
+    {
+        // Universe of the first pixel
+        uint16_t e131Universe{ 1 };
+        uint16_t artNetUniverse{ 0 };
+        // The stream is this canvas, see VirtualCanvas
+        std::optional<VirtualCanvas> canvas;
+    };
+
+    struct Stats
+    {
+        uint32_t packets;
+        uint32_t frames;
+        // Behind their stream, dropped
+        uint32_t late;
+        // Sequence numbers skipped, E1.31 and Art-Net only
+        uint32_t lost;
+        // For other universes or outside the frame
+        uint32_t ignored;
+    };
+
+    // channels: the frame size in bytes, 3 per pixel (of the tile, with a
+    // canvas)
+    FrameAssembler(size_t channels, Mapping mapping);
+
+    // true when packet completed a frame, which frame() then is
+    bool add(Protocol protocol, const Packet& packet);
+    std::span<const uint8_t> frame() const { return frame_; }
+    // E1.31 and Art-Net universes the frame takes
+    size_t universes() const { return universes_; }
+    // Universes before the first one the frame takes, the rows above the
+    // tile of a canvas
+    size_t skippedUniverses() const { return skipped_; }
+    const Stats& stats() const { return stats_; }
+    // Forgets the sequence numbers and the partial frame, e.g. when a
+    // stream timed out. The frame data is kept.
+    void reset();
+
+private:
+    // Last sequence number of a stream
+    struct Stream
+    {
+        uint8_t last;
+        bool numbered;
+    };
+
+    // false for a late packet, counts skipped numbers as lost
+    bool inOrder(Protocol protocol, Stream& stream, uint8_t sequence);
+    bool addDdp(const Packet& packet);
+    bool addDmx(
+        Protocol protocol, const Packet& packet, uint16_t firstUniverse, Stream* streams);
+    // Stream bytes from offset on into the frame
+    void write(size_t offset, std::span<const uint8_t> data);
+    bool complete();
+
+    const Mapping mapping_;
+    // Bytes of a frame of the stream
+    const size_t streamChannels_;
+    const size_t skipped_;
+    const size_t universes_;
+    std::vector<uint8_t> frame_;
+    Stats stats_{};
+
+    Stream ddpStream_{};
+    // A DDP sender that pushes is waited for
+    bool ddpPushes_{ false };
+    std::array<Stream, maxUniverses> e131Streams_{};
+    std::array<Stream, maxUniverses> artNetStreams_{};
+    // Universes (bit per mapped universe) written since the last frame
+    uint32_t received_{ 0 };
+    // E1.31 sync universe the data waits for, 0 when none
+    uint16_t syncUniverse_{ 0 };
+};
+
+#endif  // FRAME_ASSEMBLER_HPP
@@ -0,0 +1,64 @@
+#ifndef REALTIME_PACKETS_HPP
+#define REALTIME_PACKETS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/**
+ * Parsers for the UDP pixel protocols: DDP, E1.31 (sACN) and Art-Net.
+ * A parsed packet points into the datagram, nothing is copied or
+ * allocated. Packets that carry nothing to show (DDP queries, E1.31
+ * preview data, Art-Net polls, ...) parse as nullopt, like invalid ones.
+ */
+namespace RealtimePackets
+{
+enum class Protocol : uint8_t
+{
+    Ddp,
+    E131,
+    ArtNet,
+};
+
+inline constexpr uint16_t ddpPort = 4048;
+inline constexpr uint16_t e131Port = 5568;
+inline constexpr uint16_t artNetPort = 6454;
+
+struct Packet
+{
+    enum class Type : uint8_t
+    {
+        // Channel data
+        Data,
+        // E1.31: shows the data sent for universe
+        Sync,
+        // E1.31: the source stopped sending
+        Terminated,
+    };
+
+    Type type;
+    // 0 when the sender does not number its packets. DDP counts 1 to 15,
+    // per frame or per packet; E1.31 and Art-Net count per universe.
+    uint8_t sequence;
+    // E1.31 and Art-Net, 0 for DDP
+    uint16_t universe;
+    // DDP: where data goes in the pixel data, in bytes. 0 otherwise.
+    uint32_t offset;
+    std::span<const uint8_t> data;
+    // DDP: the frame is complete, show it
+    bool push;
+    // E1.31: data waits for a sync packet on this universe, 0 when it
+    // shows right away
+    uint16_t syncUniverse;
+};
+
+std::optional<Packet> parseDdp(std::span<const uint8_t> datagram);
+std::optional<Packet> parseE131(std::span<const uint8_t> datagram);
+std::optional<Packet> parseArtNet(std::span<const uint8_t> datagram);
+std::optional<Packet> parse(Protocol protocol, std::span<const uint8_t> datagram);
+
+const char* toString(Protocol protocol);
+}  // namespace RealtimePackets
+
+#endif  // REALTIME_PACKETS_HPP
@@ -0,0 +1,110 @@
+#ifndef REALTIME_RECEIVER_HPP
+#define REALTIME_RECEIVER_HPP
+
+#include "FrameAssembler.hpp"
+#include "RealtimePackets.hpp"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+/**
+ * RealtimeReceiver: listens for DDP, E1.31 and Art-Net on UDP in its own
+ * task and hands on every frame FrameAssembler completes. Datagrams are
+ * received into one buffer and parsed in place, nothing is allocated per
+ * packet.
+ * A stream starts with its first frame and ends after timeoutMs without
+ * one, or when an E1.31 source says it stopped.
+ */
+class RealtimeReceiver
+{
+    inline static constexpr const char* TAG = "RealtimeReceiver";
+
+public:
+    using Protocol = RealtimePackets::Protocol;
+
+    struct Config
+    {
+        bool ddp{ true };
+        bool e131{ true };
+        bool artNet{ false };
+        // 0 picks a free port, see port()
+        uint16_t ddpPort{ RealtimePackets::ddpPort };
+        uint16_t e131Port{ RealtimePackets::e131Port };
+        uint16_t artNetPort{ RealtimePackets::artNetPort };
+        FrameAssembler::Mapping mapping{};
+        // Joins the E1.31 multicast groups of the mapped universes, only
+        // those of the tile with a canvas
+        bool multicast{ true };
+        // E1.31 considers a source lost after 2.5 s
+        uint32_t timeoutMs{ 2500 };
+    };
+
+    struct Callbacks
+    {
+        // A stream starts, right before its first frame
+        std::function<void()> onStart;
+        // 3 bytes per pixel in logical order, valid during the call
+        std::function<void(std::span<const uint8_t> rgb)> onFrame;
+        // The stream ended
+        std::function<void()> onEnd;
+    };
+
+    struct Stats
+    {
+        FrameAssembler::Stats assembled;
+        // Datagrams that are no packet of their protocol
+        uint32_t invalid;
+        uint32_t streams;
+        bool streaming;
+    };
+
+    // channels: the frame size in bytes, 3 per pixel
+    RealtimeReceiver(size_t channels, Config config, Callbacks callbacks);
+    ~RealtimeReceiver();
+
+    // Opens the sockets and starts the task. False when no protocol could
+    // be opened. Starting again while running does nothing.
+    bool start();
+    void stop();
+    // Port protocol is bound to, 0 when it is not open
+    uint16_t port(Protocol protocol) const;
+    Stats stats() const;
+
+private:
+    static constexpr size_t numProtocols = 3;
+    // Ethernet MTU, larger datagrams are truncated (and invalid)
+    static constexpr size_t maxDatagramSize = 1500;
+    // How often the task checks for stop() and for the timeout
+    static constexpr uint32_t pollMs = 100;
+
+    static void taskEntry(void* arg);
+    void run();
+    void receive(Protocol protocol, size_t size, int64_t nowUs);
+    void end(const char* why);
+    int open(Protocol protocol, uint16_t port);
+    void closeSockets();
+
+    const Config config_;
+    Callbacks callbacks_;
+    FrameAssembler assembler_;
+    std::array<int, numProtocols> sockets_{ -1, -1, -1 };
+    std::array<uint16_t, numProtocols> ports_{};
+    std::array<uint8_t, maxDatagramSize> datagram_{};
+    TaskHandle_t taskHandle_{ nullptr };
+    SemaphoreHandle_t lock_;
+
+    // Task only
+    int64_t lastFrameUs_{ 0 };
+    // Guarded by lock_
+    Stats stats_{};
+    bool quit_{ false };
+    bool exited_{ false };
+};
+
+#endif  // REALTIME_RECEIVER_HPP
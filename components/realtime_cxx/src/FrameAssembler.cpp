@@ -0,0 +1,169 @@
+#include "FrameAssembler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+FrameAssembler::FrameAssembler(size_t channels, Mapping mapping)
+    : mapping_{ mapping }
+    , streamChannels_{ mapping.canvas ? mapping.canvas->channels() : channels }
+    , skipped_{ mapping.canvas ? mapping.canvas->firstChannel() / channelsPerUniverse : 0 }
+    , universes_{ std::min(
+          ((mapping.canvas ? mapping.canvas->endChannel() : channels) + channelsPerUniverse - 1)
+                  / channelsPerUniverse
+              - skipped_,
+          maxUniverses) }
+    , frame_(channels, 0)
+{
+}
+
+bool FrameAssembler::add(Protocol protocol, const Packet& packet)
+{
+    ++stats_.packets;
+    switch (protocol)
+    {
+    case Protocol::Ddp:
+        return addDdp(packet);
+    case Protocol::E131:
+        if (packet.type == Packet::Type::Sync)
+        {
+            if (syncUniverse_ != 0 && packet.universe == syncUniverse_ && received_ != 0)
+            {
+                return complete();
+            }
+            ++stats_.ignored;
+            return false;
+        }
+        if (packet.type == Packet::Type::Terminated)
+        {
+            // Up to the receiver, nothing to assemble
+            return false;
+        }
+        return addDmx(protocol, packet, mapping_.e131Universe, e131Streams_.data());
+    case Protocol::ArtNet:
+        return addDmx(protocol, packet, mapping_.artNetUniverse, artNetStreams_.data());
+    }
+    return false;
+}
+
+void FrameAssembler::reset()
+{
+    ddpStream_ = {};
+    ddpPushes_ = false;
+    e131Streams_ = {};
+    artNetStreams_ = {};
+    received_ = 0;
+    syncUniverse_ = 0;
+}
+
+bool FrameAssembler::inOrder(Protocol protocol, Stream& stream, uint8_t sequence)
+{
+    // DDP and Art-Net number from 1, 0 is an unnumbered packet
+    if (sequence == 0 && protocol != Protocol::E131)
+    {
+        return true;
+    }
+    const int cycle = protocol == Protocol::Ddp ? 15 : protocol == Protocol::ArtNet ? 255 : 256;
+    if (stream.numbered)
+    {
+        int diff = (sequence - stream.last + cycle) % cycle;
+        if (diff > cycle / 2)
+        {
+            diff -= cycle;
+        }
+        if (protocol == Protocol::Ddp)
+        {
+            // The packets of a frame may share their number
+            if (diff < 0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // As E1.31 says: further back than 20, the sender restarted
+            if (diff <= 0 && diff > -20)
+            {
+                return false;
+            }
+            if (diff > 1)
+            {
+                stats_.lost += diff - 1;
+            }
+        }
+    }
+    stream.last = sequence;
+    stream.numbered = true;
+    return true;
+}
+
+bool FrameAssembler::addDdp(const Packet& packet)
+{
+    if (!inOrder(Protocol::Ddp, ddpStream_, packet.sequence))
+    {
+        ++stats_.late;
+        return false;
+    }
+    const size_t offset = packet.offset;
+    const bool inFrame = offset < streamChannels_ && !packet.data.empty();
+    if (inFrame)
+    {
+        write(offset, packet.data.first(std::min(packet.data.size(), streamChannels_ - offset)));
+    }
+    if (packet.push)
+    {
+        ddpPushes_ = true;
+        return complete();
+    }
+    if (!inFrame)
+    {
+        ++stats_.ignored;
+        return false;
+    }
+    return !ddpPushes_ && offset + packet.data.size() >= streamChannels_ && complete();
+}
+
+bool FrameAssembler::addDmx(
+    Protocol protocol, const Packet& packet, uint16_t firstUniverse, Stream* streams)
+{
+    if (packet.universe < firstUniverse + skipped_
+        || packet.universe - firstUniverse - skipped_ >= universes_)
+    {
+        ++stats_.ignored;
+        return false;
+    }
+    const size_t index = packet.universe - firstUniverse - skipped_;
+    if (!inOrder(protocol, streams[index], packet.sequence))
+    {
+        ++stats_.late;
+        return false;
+    }
+    const size_t offset = (skipped_ + index) * channelsPerUniverse;
+    const size_t size = std::min(
+        { packet.data.size(), channelsPerUniverse, streamChannels_ - offset });
+    write(offset, packet.data.first(size));
+    received_ |= 1u << index;
+    syncUniverse_ = packet.syncUniverse;
+    if (syncUniverse_ != 0)
+    {
+        return false;
+    }
+    const uint32_t all = universes_ == 32 ? UINT32_MAX : (1u << universes_) - 1;
+    return (received_ == all || index == universes_ - 1) && complete();
+}
+
+void FrameAssembler::write(size_t offset, std::span<const uint8_t> data)
+{
+    if (mapping_.canvas)
+    {
+        mapping_.canvas->crop(offset, data, frame_);
+        return;
+    }
+    std::memcpy(frame_.data() + offset, data.data(), data.size());
+}
+
+bool FrameAssembler::complete()
+{
+    received_ = 0;
+    ++stats_.frames;
+    return true;
+}
@@ -0,0 +1,213 @@
+#include "RealtimePackets.hpp"
+
+#include <cstring>
+
+namespace RealtimePackets
+{
+namespace
+{
+uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+
+uint32_t be32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16
+        | static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+// DDP header, see http://www.3waylabs.com/ddp/
+namespace Ddp
+{
+constexpr uint8_t versionMask = 0xC0;
+constexpr uint8_t version1 = 0x40;
+constexpr uint8_t timecode = 0x10;
+constexpr uint8_t reply = 0x04;
+constexpr uint8_t query = 0x02;
+constexpr uint8_t push = 0x01;
+constexpr size_t headerSize = 10;
+// Destination ids, the others are control and status messages
+constexpr uint8_t reserved = 0;
+constexpr uint8_t display = 1;
+constexpr uint8_t allDevices = 255;
+}  // namespace Ddp
+
+// ANSI E1.31-2018 offsets
+namespace E131
+{
+constexpr uint8_t acnIdentifier[12]
+    = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+constexpr size_t rootVector = 18;
+constexpr uint32_t vectorRootData = 0x00000004;
+constexpr uint32_t vectorRootExtended = 0x00000008;
+constexpr size_t framingVector = 40;
+constexpr uint32_t vectorFramingData = 0x00000002;
+constexpr uint32_t vectorFramingSync = 0x00000001;
+// Data packets
+constexpr size_t syncAddress = 109;
+constexpr size_t sequence = 111;
+constexpr size_t options = 112;
+constexpr uint8_t optionPreview = 0x80;
+constexpr uint8_t optionTerminated = 0x40;
+constexpr size_t universe = 113;
+constexpr size_t dmpVector = 117;
+constexpr size_t addressType = 118;
+constexpr size_t propertyCount = 123;
+constexpr size_t startCode = 125;
+constexpr size_t dataHeaderSize = 126;
+// Sync packets
+constexpr size_t syncSequence = 44;
+constexpr size_t syncUniverse = 45;
+constexpr size_t syncPacketSize = 49;
+}  // namespace E131
+
+namespace ArtNet
+{
+constexpr uint8_t id[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+constexpr uint16_t opDmx = 0x5000;
+constexpr size_t sequence = 12;
+constexpr size_t subUni = 14;
+constexpr size_t net = 15;
+constexpr size_t length = 16;
+constexpr size_t headerSize = 18;
+}  // namespace ArtNet
+}  // namespace
+
+std::optional<Packet> parseDdp(std::span<const uint8_t> datagram)
+{
+    if (datagram.size() < Ddp::headerSize)
+    {
+        return std::nullopt;
+    }
+    const uint8_t* p = datagram.data();
+    const uint8_t flags = p[0];
+    if ((flags & Ddp::versionMask) != Ddp::version1 || (flags & (Ddp::reply | Ddp::query)))
+    {
+        return std::nullopt;
+    }
+    const uint8_t destination = p[3];
+    if (destination != Ddp::display && destination != Ddp::reserved
+        && destination != Ddp::allDevices)
+    {
+        return std::nullopt;
+    }
+    const size_t header = Ddp::headerSize + ((flags & Ddp::timecode) ? 4 : 0);
+    const size_t length = be16(p + 8);
+    if (datagram.size() < header + length)
+    {
+        return std::nullopt;
+    }
+    return Packet{ .type = Packet::Type::Data,
+                   .sequence = static_cast<uint8_t>(p[1] & 0x0F),
+                   .universe = 0,
+                   .offset = be32(p + 4),
+                   .data = datagram.subspan(header, length),
+                   .push = (flags & Ddp::push) != 0,
+                   .syncUniverse = 0 };
+}
+
+std::optional<Packet> parseE131(std::span<const uint8_t> datagram)
+{
+    const uint8_t* p = datagram.data();
+    if (datagram.size() < E131::syncPacketSize
+        || std::memcmp(p + 4, E131::acnIdentifier, sizeof(E131::acnIdentifier)) != 0)
+    {
+        return std::nullopt;
+    }
+    const uint32_t root = be32(p + E131::rootVector);
+    const uint32_t framing = be32(p + E131::framingVector);
+    if (root == E131::vectorRootExtended && framing == E131::vectorFramingSync)
+    {
+        return Packet{ .type = Packet::Type::Sync,
+                       .sequence = p[E131::syncSequence],
+                       .universe = be16(p + E131::syncUniverse),
+                       .offset = 0,
+                       .data = {},
+                       .push = false,
+                       .syncUniverse = 0 };
+    }
+    if (root != E131::vectorRootData || framing != E131::vectorFramingData
+        || datagram.size() < E131::dataHeaderSize)
+    {
+        return std::nullopt;
+    }
+    const uint8_t options = p[E131::options];
+    const uint16_t universe = be16(p + E131::universe);
+    if (options & E131::optionTerminated)
+    {
+        return Packet{ .type = Packet::Type::Terminated,
+                       .sequence = p[E131::sequence],
+                       .universe = universe,
+                       .offset = 0,
+                       .data = {},
+                       .push = false,
+                       .syncUniverse = 0 };
+    }
+    // Property values start with the DMX start code, only 0 is levels
+    const size_t count = be16(p + E131::propertyCount);
+    if ((options & E131::optionPreview) || p[E131::dmpVector] != 0x02
+        || p[E131::addressType] != 0xA1 || count == 0
+        || datagram.size() < E131::startCode + count || p[E131::startCode] != 0)
+    {
+        return std::nullopt;
+    }
+    return Packet{ .type = Packet::Type::Data,
+                   .sequence = p[E131::sequence],
+                   .universe = universe,
+                   .offset = 0,
+                   .data = datagram.subspan(E131::dataHeaderSize, count - 1),
+                   .push = false,
+                   .syncUniverse = be16(p + E131::syncAddress) };
+}
+
+std::optional<Packet> parseArtNet(std::span<const uint8_t> datagram)
+{
+    const uint8_t* p = datagram.data();
+    if (datagram.size() < ArtNet::headerSize
+        || std::memcmp(p, ArtNet::id, sizeof(ArtNet::id)) != 0)
+    {
+        return std::nullopt;
+    }
+    // The op code is the only little endian field
+    const uint16_t opCode = static_cast<uint16_t>(p[8] | p[9] << 8);
+    const size_t length = be16(p + ArtNet::length);
+    if (opCode != ArtNet::opDmx || datagram.size() < ArtNet::headerSize + length)
+    {
+        return std::nullopt;
+    }
+    return Packet{ .type = Packet::Type::Data,
+                   .sequence = p[ArtNet::sequence],
+                   .universe = static_cast<uint16_t>(
+                       (p[ArtNet::net] & 0x7F) << 8 | p[ArtNet::subUni]),
+                   .offset = 0,
+                   .data = datagram.subspan(ArtNet::headerSize, length),
+                   .push = false,
+                   .syncUniverse = 0 };
+}
+
+std::optional<Packet> parse(Protocol protocol, std::span<const uint8_t> datagram)
+{
+    switch (protocol)
+    {
+    case Protocol::Ddp:
+        return parseDdp(datagram);
+    case Protocol::E131:
+        return parseE131(datagram);
+    case Protocol::ArtNet:
+        return parseArtNet(datagram);
+    }
+    return std::nullopt;
+}
+
+const char* toString(Protocol protocol)
+{
+    switch (protocol)
+    {
+    case Protocol::Ddp:
+        return "DDP";
+    case Protocol::E131:
+        return "E1.31";
+    case Protocol::ArtNet:
+        return "Art-Net";
+    }
+    return "unknown";
+}
+}  // namespace RealtimePackets
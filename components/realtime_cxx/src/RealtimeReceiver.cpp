@@ -0,0 +1,299 @@
+#include "RealtimeReceiver.hpp"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+RealtimeReceiver::RealtimeReceiver(size_t channels, Config config, Callbacks callbacks)
+    : config_{ config }
+    , callbacks_{ std::move(callbacks) }
+    , assembler_{ channels, config.mapping }
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+RealtimeReceiver::~RealtimeReceiver()
+{
+    stop();
+    if (lock_)
+    {
+        vSemaphoreDelete(lock_);
+    }
+}
+
+bool RealtimeReceiver::start()
+{
+    if (taskHandle_)
+    {
+        return true;
+    }
+    if (config_.ddp)
+    {
+        sockets_[static_cast<size_t>(Protocol::Ddp)] = open(Protocol::Ddp, config_.ddpPort);
+    }
+    if (config_.e131)
+    {
+        sockets_[static_cast<size_t>(Protocol::E131)] = open(Protocol::E131, config_.e131Port);
+    }
+    if (config_.artNet)
+    {
+        sockets_[static_cast<size_t>(Protocol::ArtNet)]
+            = open(Protocol::ArtNet, config_.artNetPort);
+    }
+    if (std::all_of(sockets_.begin(), sockets_.end(), [](int fd) { return fd < 0; }))
+    {
+        ESP_LOGE(TAG, "No protocol to listen for");
+        return false;
+    }
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    quit_ = false;
+    exited_ = false;
+    xSemaphoreGive(lock_);
+    xTaskCreate(
+        taskEntry, "realtimeTask", 6 * 1024, this, tskIDLE_PRIORITY + 2, &taskHandle_);
+    return true;
+}
+
+void RealtimeReceiver::stop()
+{
+    if (!taskHandle_)
+    {
+        return;
+    }
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    quit_ = true;
+    xSemaphoreGive(lock_);
+
+    // Notices within one poll
+    while (true)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool exited = exited_;
+        xSemaphoreGive(lock_);
+        if (exited)
+        {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    taskHandle_ = nullptr;
+    closeSockets();
+}
+
+uint16_t RealtimeReceiver::port(Protocol protocol) const
+{
+    return ports_[static_cast<size_t>(protocol)];
+}
+
+RealtimeReceiver::Stats RealtimeReceiver::stats() const
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    const Stats stats = stats_;
+    xSemaphoreGive(lock_);
+    return stats;
+}
+
+int RealtimeReceiver::open(Protocol protocol, uint16_t port)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0)
+    {
+        ESP_LOGE(TAG, "No socket for %s", RealtimePackets::toString(protocol));
+        return -1;
+    }
+    const int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    socklen_t length = sizeof(address);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        ESP_LOGE(
+            TAG, "Failed to bind %s to port %u", RealtimePackets::toString(protocol), port);
+        close(fd);
+        return -1;
+    }
+    ports_[static_cast<size_t>(protocol)] = ntohs(address.sin_port);
+
+    if (protocol == Protocol::E131 && config_.multicast)
+    {
+        // 239.255.<universe high byte>.<universe low byte>
+        for (size_t i = 0; i < assembler_.universes(); ++i)
+        {
+            const uint32_t universe
+                = config_.mapping.e131Universe + assembler_.skippedUniverses() + i;
+            ip_mreq group{};
+            group.imr_multiaddr.s_addr = htonl(0xEFFF0000u | (universe & 0xFFFF));
+            group.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group, sizeof(group)) != 0)
+            {
+                ESP_LOGW(
+                    TAG,
+                    "Failed to join the multicast group of universe %u",
+                    static_cast<unsigned>(universe));
+            }
+        }
+    }
+    ESP_LOGI(
+        TAG,
+        "Listening for %s on port %u",
+        RealtimePackets::toString(protocol),
+        ports_[static_cast<size_t>(protocol)]);
+    return fd;
+}
+
+void RealtimeReceiver::closeSockets()
+{
+    for (size_t i = 0; i < numProtocols; ++i)
+    {
+        if (sockets_[i] >= 0)
+        {
+            close(sockets_[i]);
+            sockets_[i] = -1;
+            ports_[i] = 0;
+        }
+    }
+}
+
+void RealtimeReceiver::taskEntry(void* arg)
+{
+    static_cast<RealtimeReceiver*>(arg)->run();
+    vTaskDelete(nullptr);
+}
+
+void RealtimeReceiver::run()
+{
+    while (true)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool quit = quit_;
+        xSemaphoreGive(lock_);
+        if (quit)
+        {
+            break;
+        }
+
+        fd_set ready;
+        FD_ZERO(&ready);
+        int maxFd = -1;
+        for (int fd: sockets_)
+        {
+            if (fd >= 0)
+            {
+                FD_SET(fd, &ready);
+                maxFd = std::max(maxFd, fd);
+            }
+        }
+        timeval timeout{ .tv_sec = 0, .tv_usec = pollMs * 1000 };
+        const int count = select(maxFd + 1, &ready, nullptr, nullptr, &timeout);
+        const int64_t nowUs = esp_timer_get_time();
+        for (size_t i = 0; count > 0 && i < numProtocols; ++i)
+        {
+            if (sockets_[i] < 0 || !FD_ISSET(sockets_[i], &ready))
+            {
+                continue;
+            }
+            // Everything queued, so a frame is shown once all of it is in
+            while (true)
+            {
+                const ssize_t size
+                    = recv(sockets_[i], datagram_.data(), datagram_.size(), MSG_DONTWAIT);
+                if (size < 0)
+                {
+                    break;
+                }
+                receive(static_cast<Protocol>(i), static_cast<size_t>(size), nowUs);
+            }
+        }
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool streaming = stats_.streaming;
+        xSemaphoreGive(lock_);
+        if (streaming && nowUs - lastFrameUs_ > int64_t{ config_.timeoutMs } * 1000)
+        {
+            end("timed out");
+        }
+    }
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    exited_ = true;
+    xSemaphoreGive(lock_);
+}
+
+void RealtimeReceiver::receive(Protocol protocol, size_t size, int64_t nowUs)
+{
+    const auto packet = RealtimePackets::parse(protocol, { datagram_.data(), size });
+    if (packet && packet->type == RealtimePackets::Packet::Type::Terminated)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool streaming = stats_.streaming;
+        xSemaphoreGive(lock_);
+        if (streaming)
+        {
+            end("terminated by the source");
+        }
+        return;
+    }
+    const bool frame = packet && assembler_.add(protocol, *packet);
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    stats_.assembled = assembler_.stats();
+    stats_.invalid += packet ? 0 : 1;
+    const bool starting = frame && !stats_.streaming;
+    if (starting)
+    {
+        stats_.streaming = true;
+        ++stats_.streams;
+    }
+    xSemaphoreGive(lock_);
+
+    if (!frame)
+    {
+        return;
+    }
+    if (starting)
+    {
+        ESP_LOGI(TAG, "%s stream started", RealtimePackets::toString(protocol));
+        if (callbacks_.onStart)
+        {
+            callbacks_.onStart();
+        }
+    }
+    lastFrameUs_ = nowUs;
+    if (callbacks_.onFrame)
+    {
+        callbacks_.onFrame(assembler_.frame());
+    }
+}
+
+void RealtimeReceiver::end(const char* why)
+{
+    assembler_.reset();
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    stats_.streaming = false;
+    const auto stats = stats_.assembled;
+    xSemaphoreGive(lock_);
+    ESP_LOGI(
+        TAG,
+        "Stream %s, %u frames so far, %u packets late, %u lost",
+        why,
+        static_cast<unsigned>(stats.frames),
+        static_cast<unsigned>(stats.late),
+        static_cast<unsigned>(stats.lost));
+    if (callbacks_.onEnd)
+    {
+        callbacks_.onEnd();
+    }
+}
@@ -26,6 +26,7 @@ public:
         WriteFailed,
         ReadFailed,
         RemoveFailed,
+        RenameFailed,
         SerializeFailed,
         DeserializeFailed
     };
@@ -38,6 +39,40 @@ public:
         bool formatIfMountFailed = true;
     };
 
+    enum class Mode
+    {
+        Read,
+        // Replaces an existing file
+        Write
+    };
+
+    /**
+     * An open file, read or written in pieces so large items never have to
+     * be held in memory whole. Closed when destroyed, close() reports
+     * whether buffered writes made it.
+     */
+    class File
+    {
+    public:
+        File(File&& other) noexcept;
+        File& operator=(File&& other) noexcept;
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+        ~File() noexcept;
+
+        std::expected<void, Error> write(std::span<const std::byte> data) noexcept;
+        // Fills buffer completely, fails when the file ends before
+        std::expected<void, Error> read(std::span<std::byte> buffer) noexcept;
+        std::expected<void, Error> seek(size_t offset) noexcept;
+        std::expected<void, Error> close() noexcept;
+
+    private:
+        friend class Spiffs;
+        explicit File(FILE* file) noexcept;
+
+        FILE* file_{ nullptr };
+    };
+
     Spiffs() noexcept;
     ~Spiffs() noexcept;
 
@@ -51,8 +86,15 @@ public:
     std::expected<size_t, Error>
     read(std::string_view path, std::span<std::byte> buffer) const noexcept;
 
+    std::expected<File, Error>
+    open(std::string_view path, Mode mode) const noexcept;
+
     std::expected<void, Error> remove(std::string_view path) const noexcept;
+    // Replaces to when it exists
+    std::expected<void, Error>
+    rename(std::string_view from, std::string_view to) const noexcept;
     std::expected<bool, Error> exists(std::string_view path) const noexcept;
+    std::expected<size_t, Error> size(std::string_view path) const noexcept;
 
     template<typename Serializer, typename T>
     std::expected<void, Error> writeObject(
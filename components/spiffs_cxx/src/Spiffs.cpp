@@ -1,6 +1,8 @@
 #include "Spiffs.hpp"
 #include <string>
 
+#include <sys/stat.h>
+
 Spiffs::Spiffs() noexcept = default;
 
 Spiffs::~Spiffs() noexcept { [[maybe_unused]] const auto ret = deinit(); }
@@ -111,6 +113,124 @@ Spiffs::read(std::string_view path, std::span<std::byte> buffer) const noexcept
     return readBytes;
 }
 
+std::expected<Spiffs::File, Spiffs::Error>
+Spiffs::open(std::string_view path, Mode mode) const noexcept
+{
+    {
+        if (!initialized_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    std::string full = std::string(cfg_.basePath) + '/' + std::string(path);
+    FILE* f = std::fopen(full.c_str(), mode == Mode::Write ? "wb" : "rb");
+    {
+        if (!f)
+        {
+            return std::unexpected(Error::FileOpenFailed);
+        }
+    }
+    return File{ f };
+}
+
+Spiffs::File::File(FILE* file) noexcept
+    : file_{ file }
+{
+}
+
+Spiffs::File::File(File&& other) noexcept
+    : file_{ other.file_ }
+{
+    other.file_ = nullptr;
+}
+
+Spiffs::File& Spiffs::File::operator=(File&& other) noexcept
+{
+    if (this != &other)
+    {
+        [[maybe_unused]] const auto ret = close();
+        file_ = other.file_;
+        other.file_ = nullptr;
+    }
+    return *this;
+}
+
+Spiffs::File::~File() noexcept { [[maybe_unused]] const auto ret = close(); }
+
+std::expected<void, Spiffs::Error>
+Spiffs::File::write(std::span<const std::byte> data) noexcept
+{
+    {
+        if (!file_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    size_t written = std::fwrite(data.data(), 1, data.size(), file_);
+    {
+        if (written != data.size())
+        {
+            return std::unexpected(Error::WriteFailed);
+        }
+    }
+    return {};
+}
+
+std::expected<void, Spiffs::Error>
+Spiffs::File::read(std::span<std::byte> buffer) noexcept
+{
+    {
+        if (!file_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    size_t readBytes = std::fread(buffer.data(), 1, buffer.size(), file_);
+    {
+        if (readBytes != buffer.size())
+        {
+            return std::unexpected(Error::ReadFailed);
+        }
+    }
+    return {};
+}
+
+std::expected<void, Spiffs::Error> Spiffs::File::seek(size_t offset) noexcept
+{
+    {
+        if (!file_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    {
+        if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0)
+        {
+            return std::unexpected(Error::ReadFailed);
+        }
+    }
+    return {};
+}
+
+std::expected<void, Spiffs::Error> Spiffs::File::close() noexcept
+{
+    {
+        if (!file_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    const int ret = std::fclose(file_);
+    file_ = nullptr;
+    {
+        if (ret != 0)
+        {
+            return std::unexpected(Error::WriteFailed);
+        }
+    }
+    return {};
+}
+
 std::expected<void, Spiffs::Error>
 Spiffs::remove(std::string_view path) const noexcept
 {
@@ -130,6 +250,28 @@ Spiffs::remove(std::string_view path) const noexcept
     return {};
 }
 
+std::expected<void, Spiffs::Error>
+Spiffs::rename(std::string_view from, std::string_view to) const noexcept
+{
+    {
+        if (!initialized_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    std::string fullFrom = std::string(cfg_.basePath) + '/' + std::string(from);
+    std::string fullTo = std::string(cfg_.basePath) + '/' + std::string(to);
+    // SPIFFS does not rename onto an existing file
+    ::remove(fullTo.c_str());
+    {
+        if (::rename(fullFrom.c_str(), fullTo.c_str()) != 0)
+        {
+            return std::unexpected(Error::RenameFailed);
+        }
+    }
+    return {};
+}
+
 std::expected<bool, Spiffs::Error>
 Spiffs::exists(std::string_view path) const noexcept
 {
@@ -150,3 +292,23 @@ Spiffs::exists(std::string_view path) const noexcept
     }
     return false;
 }
+
+std::expected<size_t, Spiffs::Error>
+Spiffs::size(std::string_view path) const noexcept
+{
+    {
+        if (!initialized_)
+        {
+            return std::unexpected(Error::NotInitialized);
+        }
+    }
+    std::string full = std::string(cfg_.basePath) + '/' + std::string(path);
+    struct stat st;
+    {
+        if (::stat(full.c_str(), &st) != 0)
+        {
+            return std::unexpected(Error::FileOpenFailed);
+        }
+    }
+    return static_cast<size_t>(st.st_size);
+}
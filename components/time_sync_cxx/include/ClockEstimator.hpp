@@ -0,0 +1,90 @@
+#ifndef CLOCK_ESTIMATOR_HPP
+#define CLOCK_ESTIMATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+/**
+ * ClockEstimator: maps local time onto a reference clock, from NTP style
+ * request/response exchanges with the reference.
+ * An exchange gives the offset between the clocks, off by at most half
+ * its round trip. Of the last few exchanges the one with the shortest
+ * round trip is trusted, so queueing delays do not show. The skew (how
+ * much faster the reference runs) comes from such offsets taken at least
+ * minSkewSpanUs apart, and keeps the mapping right between exchanges.
+ */
+class ClockEstimator
+{
+public:
+    // Exchanges the best one is picked from
+    static constexpr size_t window = 8;
+    // Shorter spans measure mostly jitter
+    static constexpr int64_t minSkewSpanUs = 10'000'000;
+
+    // One request and its response, t1..t4 in NTP terms
+    struct Exchange
+    {
+        // Local time the request was sent
+        int64_t sentUs;
+        // Reference time it arrived and the response was sent
+        int64_t referenceReceivedUs;
+        int64_t referenceSentUs;
+        // Local time the response arrived
+        int64_t receivedUs;
+    };
+
+    struct Stats
+    {
+        uint32_t exchanges;
+        // Reference minus local time, at the exchange the mapping is
+        // based on
+        int64_t offsetUs;
+        // Parts per million the reference runs faster
+        float skewPpm;
+        // Round trip of that exchange
+        uint32_t roundTripUs;
+        // How far the mapping was off at that exchange, plus half its
+        // round trip
+        uint32_t errorUs;
+    };
+
+    // False for an exchange that cannot have happened (e.g. a negative
+    // round trip), it is not used
+    bool add(const Exchange& exchange);
+    // A mapping exists
+    bool valid() const { return base_.has_value(); }
+    // Reference time at localUs, valid() only
+    int64_t toReference(int64_t localUs) const;
+    // Exchanges from here on are with another reference. The mapping
+    // stays until they replace it, so time does not stop meanwhile.
+    void restart();
+    void reset();
+    Stats stats() const { return stats_; }
+
+private:
+    struct Sample
+    {
+        // Halfway between sending and receiving
+        int64_t localUs;
+        int64_t offsetUs;
+        uint32_t roundTripUs;
+    };
+
+    int64_t offsetAt(int64_t localUs) const;
+
+    std::array<Sample, window> samples_{};
+    size_t count_{ 0 };
+    size_t next_{ 0 };
+    // The sample the mapping is based on
+    std::optional<Sample> base_;
+    // An earlier base, where the skew is measured from
+    std::optional<Sample> anchor_;
+    // Reference microseconds per local microsecond, minus 1
+    double skew_{ 0 };
+    bool skewKnown_{ false };
+    Stats stats_{};
+};
+
+#endif  // CLOCK_ESTIMATOR_HPP
@@ -0,0 +1,155 @@
+#ifndef TIME_SYNC_HPP
+#define TIME_SYNC_HPP
+
+#include "ClockEstimator.hpp"
+#include "PlaybackClock.hpp"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/**
+ * TimeSync: one clock for all devices on the network, which animators
+ * follow through PlaybackClock.
+ * Every device announces itself by UDP broadcast. The one with the
+ * highest priority (then the lowest id) leads, the others estimate its
+ * clock from request/response exchanges, see ClockEstimator, and take
+ * over its animation epoch. Nobody leads before listening for
+ * leaderTimeoutMs, and meanwhile any leader heard gives the time, so a
+ * device joining a running group keeps the group's time even when it
+ * then takes over.
+ * A device taking over the lead keeps the time and epoch it followed, so
+ * playback goes on where it was.
+ */
+class TimeSync : public PlaybackClock
+{
+    inline static constexpr const char* TAG = "TimeSync";
+
+public:
+    // Next to DDP's 4048
+    static constexpr uint16_t defaultPort = 4050;
+
+    struct Config
+    {
+        // Unique in the group, e.g. from the MAC address
+        uint32_t id{ 0 };
+        // The highest leads, 0 never does
+        uint8_t priority{ 1 };
+        // 0 picks a free port, see port()
+        uint16_t port{ defaultPort };
+        // Where announcements go, host byte order
+        uint32_t announceAddress{ 0xFFFFFFFF };
+        uint16_t announcePort{ defaultPort };
+        uint32_t announceMs{ 1000 };
+        // Between exchanges with the leader, a quarter of it until the
+        // estimate has a full window
+        uint32_t exchangeMs{ 1000 };
+        // A leader not heard from for this long has left
+        uint32_t leaderTimeoutMs{ 3500 };
+    };
+
+    struct Stats
+    {
+        bool running;
+        bool leading;
+        // Id of the device followed, or of this one when leading
+        uint32_t leaderId;
+        // sinceEpochUs() has a value
+        bool synced;
+        ClockEstimator::Stats clock;
+        // Leaders followed so far
+        uint32_t leaderChanges;
+        // Datagrams that are no sync message
+        uint32_t invalid;
+    };
+
+    explicit TimeSync(Config config);
+    ~TimeSync() override;
+
+    // Opens the socket and starts the task, false when the socket cannot
+    // be opened. Starting again while running does nothing.
+    bool start();
+    void stop();
+    // Port bound to, 0 when not running
+    uint16_t port() const { return port_; }
+    Stats stats() const;
+
+    // The shared time, nothing until this device leads or follows
+    std::optional<int64_t> nowUs() const;
+    std::optional<int64_t> sinceEpochUs() const override;
+
+private:
+    enum class Type : uint8_t
+    {
+        Announce = 1,
+        Request,
+        Response,
+    };
+
+    struct Message
+    {
+        Type type;
+        uint8_t priority;
+        bool leading;
+        bool hasEpoch;
+        uint32_t id;
+        // Announce: the epoch. Request and Response: t1..t3
+        std::array<int64_t, 3> times;
+    };
+
+    struct Peer
+    {
+        uint32_t id;
+        uint8_t priority;
+        // Network byte order, as received
+        uint32_t address;
+        uint16_t port;
+        int64_t heardUs;
+    };
+
+    static constexpr size_t maxMessageSize = 36;
+    // How often the task checks for stop()
+    static constexpr uint32_t pollMs = 100;
+
+    static void taskEntry(void* arg);
+    void run();
+    void receive(const Message& message, uint32_t address, uint16_t port, int64_t localUs);
+    void tick(int64_t localUs);
+    void send(const Message& message, uint32_t address, uint16_t port);
+    static size_t encode(const Message& message, std::array<uint8_t, maxMessageSize>& out);
+    static std::optional<Message> decode(std::span<const uint8_t> datagram);
+    // Which of two devices leads
+    static bool outranks(
+        uint8_t priority, uint32_t id, uint8_t otherPriority, uint32_t otherId);
+    // Guarded by lock_
+    std::optional<int64_t> sharedAt(int64_t localUs) const;
+
+    const Config config_;
+    int socket_{ -1 };
+    uint16_t port_{ 0 };
+    TaskHandle_t taskHandle_{ nullptr };
+    SemaphoreHandle_t lock_;
+
+    // Task only
+    // Leads from here on, unless it heard a device that outranks it
+    int64_t electedAtUs_{ 0 };
+    int64_t nextAnnounceUs_{ 0 };
+    int64_t nextExchangeUs_{ 0 };
+    // t1 of the request waiting for its response
+    std::optional<int64_t> pendingUs_;
+    // Guarded by lock_
+    ClockEstimator clock_;
+    std::optional<Peer> leader_;
+    bool leading_{ false };
+    std::optional<int64_t> epochUs_;
+    Stats stats_{};
+    bool quit_{ false };
+    bool exited_{ false };
+};
+
+#endif  // TIME_SYNC_HPP
@@ -0,0 +1,99 @@
+#include "ClockEstimator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+bool ClockEstimator::add(const Exchange& exchange)
+{
+    const int64_t localUs = exchange.receivedUs - exchange.sentUs;
+    const int64_t referenceUs = exchange.referenceSentUs - exchange.referenceReceivedUs;
+    if (localUs < 0 || referenceUs < 0 || referenceUs > localUs)
+    {
+        return false;
+    }
+    samples_[next_] = {
+        .localUs = exchange.sentUs + localUs / 2,
+        .offsetUs = ((exchange.referenceReceivedUs - exchange.sentUs)
+                     + (exchange.referenceSentUs - exchange.receivedUs))
+            / 2,
+        .roundTripUs = static_cast<uint32_t>(localUs - referenceUs),
+    };
+    next_ = (next_ + 1) % window;
+    count_ = std::min(count_ + 1, window);
+    ++stats_.exchanges;
+
+    // The shortest round trip, the newest of equals
+    const Sample* best = nullptr;
+    for (size_t i = 0; i < count_; ++i)
+    {
+        const Sample& sample = samples_[i];
+        if (!best || sample.roundTripUs < best->roundTripUs
+            || (sample.roundTripUs == best->roundTripUs && sample.localUs > best->localUs))
+        {
+            best = &sample;
+        }
+    }
+    if (base_ && best->localUs == base_->localUs)
+    {
+        // Nothing better than what the mapping is based on
+        return true;
+    }
+
+    const int64_t errorUs = base_ ? std::llabs(best->offsetUs - offsetAt(best->localUs)) : 0;
+    const bool spanned = anchor_ && best->localUs - anchor_->localUs >= minSkewSpanUs;
+    if (!anchor_ || best->roundTripUs * 2 < anchor_->roundTripUs
+        || (!spanned && best->roundTripUs < anchor_->roundTripUs))
+    {
+        // Measured from the better one, a slow exchange at either end
+        // would spoil the skew
+        anchor_ = *best;
+    }
+    else if (spanned)
+    {
+        const double measured = static_cast<double>(best->offsetUs - anchor_->offsetUs)
+            / static_cast<double>(best->localUs - anchor_->localUs);
+        // Smoothed, a single pair still has its round trips in it
+        skew_ = skewKnown_ ? skew_ + (measured - skew_) / 4 : measured;
+        skewKnown_ = true;
+        anchor_ = *best;
+    }
+    base_ = *best;
+
+    stats_.offsetUs = best->offsetUs;
+    stats_.skewPpm = static_cast<float>(skew_ * 1e6);
+    stats_.roundTripUs = best->roundTripUs;
+    stats_.errorUs = static_cast<uint32_t>(
+        std::min<int64_t>(errorUs + best->roundTripUs / 2, UINT32_MAX));
+    return true;
+}
+
+int64_t ClockEstimator::toReference(int64_t localUs) const
+{
+    return localUs + offsetAt(localUs);
+}
+
+void ClockEstimator::restart()
+{
+    count_ = 0;
+    next_ = 0;
+    anchor_.reset();
+}
+
+void ClockEstimator::reset()
+{
+    restart();
+    base_.reset();
+    skew_ = 0;
+    skewKnown_ = false;
+    stats_ = {};
+}
+
+int64_t ClockEstimator::offsetAt(int64_t localUs) const
+{
+    if (!base_)
+    {
+        return 0;
+    }
+    return base_->offsetUs
+        + static_cast<int64_t>(skew_ * static_cast<double>(localUs - base_->localUs));
+}
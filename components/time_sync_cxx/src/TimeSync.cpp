@@ -0,0 +1,469 @@
+#include "TimeSync.hpp"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace
+{
+// "FPTS", version, type, priority, flags, id, then 1 (Announce, Request)
+// or 3 (Response) times, all big endian
+constexpr uint8_t magic[4] = { 'F', 'P', 'T', 'S' };
+constexpr uint8_t version = 1;
+constexpr size_t headerSize = 12;
+constexpr uint8_t flagLeading = 0x01;
+constexpr uint8_t flagEpoch = 0x02;
+
+void put32(uint8_t* out, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        out[i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+    }
+}
+
+uint32_t get32(const uint8_t* in)
+{
+    return (uint32_t{ in[0] } << 24) | (uint32_t{ in[1] } << 16) | (uint32_t{ in[2] } << 8)
+        | in[3];
+}
+}  // namespace
+
+TimeSync::TimeSync(Config config)
+    : config_{ config }
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+TimeSync::~TimeSync()
+{
+    stop();
+    if (lock_)
+    {
+        vSemaphoreDelete(lock_);
+    }
+}
+
+bool TimeSync::start()
+{
+    if (taskHandle_)
+    {
+        return true;
+    }
+    socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket_ < 0)
+    {
+        ESP_LOGE(TAG, "No socket");
+        return false;
+    }
+    const int enable = 1;
+    setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    setsockopt(socket_, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config_.port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    socklen_t length = sizeof(address);
+    if (bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        ESP_LOGE(TAG, "Failed to bind to port %u", config_.port);
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+    port_ = ntohs(address.sin_port);
+
+    const int64_t nowUs = esp_timer_get_time();
+    electedAtUs_ = nowUs + int64_t{ config_.leaderTimeoutMs } * 1000;
+    nextAnnounceUs_ = nowUs;
+    nextExchangeUs_ = nowUs;
+    pendingUs_.reset();
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    quit_ = false;
+    exited_ = false;
+    stats_.running = true;
+    xSemaphoreGive(lock_);
+    ESP_LOGI(
+        TAG,
+        "Listening on port %u as %08lx, priority %u",
+        port_,
+        static_cast<unsigned long>(config_.id),
+        config_.priority);
+    // Above the animator, so exchanges are timestamped right away
+    xTaskCreate(
+        taskEntry, "timeSyncTask", 4 * 1024, this, tskIDLE_PRIORITY + 3, &taskHandle_);
+    return true;
+}
+
+void TimeSync::stop()
+{
+    if (!taskHandle_)
+    {
+        return;
+    }
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    quit_ = true;
+    xSemaphoreGive(lock_);
+
+    // Notices within one poll
+    while (true)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool exited = exited_;
+        xSemaphoreGive(lock_);
+        if (exited)
+        {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    taskHandle_ = nullptr;
+    close(socket_);
+    socket_ = -1;
+    port_ = 0;
+
+    // Out of the group, the time goes on from the estimate
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    leader_.reset();
+    leading_ = false;
+    stats_.running = false;
+    xSemaphoreGive(lock_);
+}
+
+TimeSync::Stats TimeSync::stats() const
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    Stats stats = stats_;
+    stats.leading = leading_;
+    stats.leaderId = leading_ ? config_.id : leader_ ? leader_->id : 0;
+    stats.synced = epochUs_ && sharedAt(esp_timer_get_time());
+    stats.clock = clock_.stats();
+    xSemaphoreGive(lock_);
+    return stats;
+}
+
+std::optional<int64_t> TimeSync::nowUs() const
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    const auto shared = sharedAt(esp_timer_get_time());
+    xSemaphoreGive(lock_);
+    return shared;
+}
+
+std::optional<int64_t> TimeSync::sinceEpochUs() const
+{
+    std::optional<int64_t> sinceUs;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    const auto shared = sharedAt(esp_timer_get_time());
+    if (shared && epochUs_)
+    {
+        sinceUs = *shared - *epochUs_;
+    }
+    xSemaphoreGive(lock_);
+    return sinceUs;
+}
+
+std::optional<int64_t> TimeSync::sharedAt(int64_t localUs) const
+{
+    if (clock_.valid())
+    {
+        return clock_.toReference(localUs);
+    }
+    if (leading_)
+    {
+        return localUs;
+    }
+    return std::nullopt;
+}
+
+bool TimeSync::outranks(
+    uint8_t priority, uint32_t id, uint8_t otherPriority, uint32_t otherId)
+{
+    return priority > otherPriority || (priority == otherPriority && id < otherId);
+}
+
+void TimeSync::taskEntry(void* arg)
+{
+    static_cast<TimeSync*>(arg)->run();
+    vTaskDelete(nullptr);
+}
+
+void TimeSync::run()
+{
+    std::array<uint8_t, 64> datagram;
+    while (true)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool quit = quit_;
+        xSemaphoreGive(lock_);
+        if (quit)
+        {
+            break;
+        }
+
+        // Until whatever is sent next, or the next check for stop()
+        const int64_t untilUs
+            = std::min(nextAnnounceUs_, nextExchangeUs_) - esp_timer_get_time();
+        const int64_t waitUs = std::clamp<int64_t>(untilUs, 0, int64_t{ pollMs } * 1000);
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(socket_, &ready);
+        timeval timeout{ .tv_sec = 0, .tv_usec = static_cast<suseconds_t>(waitUs) };
+        if (select(socket_ + 1, &ready, nullptr, nullptr, &timeout) > 0)
+        {
+            while (true)
+            {
+                sockaddr_in from{};
+                socklen_t length = sizeof(from);
+                const ssize_t size = recvfrom(
+                    socket_,
+                    datagram.data(),
+                    datagram.size(),
+                    MSG_DONTWAIT,
+                    reinterpret_cast<sockaddr*>(&from),
+                    &length);
+                if (size < 0)
+                {
+                    break;
+                }
+                const int64_t localUs = esp_timer_get_time();
+                const auto message
+                    = decode({ datagram.data(), static_cast<size_t>(size) });
+                if (!message)
+                {
+                    xSemaphoreTake(lock_, portMAX_DELAY);
+                    ++stats_.invalid;
+                    xSemaphoreGive(lock_);
+                    continue;
+                }
+                receive(*message, from.sin_addr.s_addr, ntohs(from.sin_port), localUs);
+            }
+        }
+        tick(esp_timer_get_time());
+    }
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    exited_ = true;
+    xSemaphoreGive(lock_);
+}
+
+void TimeSync::receive(
+    const Message& message, uint32_t address, uint16_t port, int64_t localUs)
+{
+    if (message.id == config_.id)
+    {
+        // Our own broadcast
+        return;
+    }
+    switch (message.type)
+    {
+    case Type::Request:
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool leading = leading_;
+        const auto receivedUs = sharedAt(localUs);
+        const auto sentUs = sharedAt(esp_timer_get_time());
+        xSemaphoreGive(lock_);
+        if (receivedUs)
+        {
+            send(
+                { Type::Response,
+                  config_.priority,
+                  leading,
+                  false,
+                  config_.id,
+                  { message.times[0], *receivedUs, *sentUs } },
+                address,
+                port);
+        }
+        break;
+    }
+    case Type::Response:
+    {
+        // Only the answer to the last request, late ones would skew it
+        if (!pendingUs_ || message.times[0] != *pendingUs_)
+        {
+            break;
+        }
+        pendingUs_.reset();
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        if (leader_ && leader_->id == message.id)
+        {
+            clock_.add({ message.times[0], message.times[1], message.times[2], localUs });
+        }
+        xSemaphoreGive(lock_);
+        break;
+    }
+    case Type::Announce:
+    {
+        if (message.priority == 0)
+        {
+            break;
+        }
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool known = leader_ && leader_->id == message.id;
+        // Outranks whoever is followed now. Until its election a device
+        // takes the time from any leader, and carries it on when it
+        // takes over, so a leader only hands over to a leader.
+        const bool outranksThis
+            = outranks(message.priority, message.id, config_.priority, config_.id);
+        const bool better = leader_
+            ? outranks(message.priority, message.id, leader_->priority, leader_->id)
+            : leading_ ? outranksThis && message.leading
+                       : outranksThis || message.leading;
+        if (known || better)
+        {
+            if (!known)
+            {
+                ESP_LOGI(
+                    TAG,
+                    "Following %08lx, priority %u",
+                    static_cast<unsigned long>(message.id),
+                    message.priority);
+                clock_.restart();
+                leading_ = false;
+                ++stats_.leaderChanges;
+                nextExchangeUs_ = localUs;
+                pendingUs_.reset();
+            }
+            leader_ = Peer{ message.id, message.priority, address, port, localUs };
+            if (message.hasEpoch)
+            {
+                epochUs_ = message.times[0];
+            }
+        }
+        xSemaphoreGive(lock_);
+        break;
+    }
+    }
+}
+
+void TimeSync::tick(int64_t localUs)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (leader_ && localUs - leader_->heardUs > int64_t{ config_.leaderTimeoutMs } * 1000)
+    {
+        ESP_LOGW(TAG, "Lost %08lx", static_cast<unsigned long>(leader_->id));
+        leader_.reset();
+        electedAtUs_ = localUs + int64_t{ config_.leaderTimeoutMs } * 1000;
+    }
+    const bool elected = !leading_ && config_.priority > 0 && localUs >= electedAtUs_
+        && (!leader_
+            || outranks(config_.priority, config_.id, leader_->priority, leader_->id));
+    if (elected)
+    {
+        leading_ = true;
+        leader_.reset();
+        // The epoch of the group, or a new one from now
+        if (!epochUs_)
+        {
+            epochUs_ = sharedAt(localUs);
+        }
+        ESP_LOGI(TAG, "Leading");
+    }
+    const Message announce{ Type::Announce,
+                            config_.priority,
+                            leading_,
+                            epochUs_.has_value(),
+                            config_.id,
+                            { epochUs_.value_or(0), 0, 0 } };
+    const auto leader = leader_;
+    const bool filling = clock_.stats().exchanges < ClockEstimator::window;
+    xSemaphoreGive(lock_);
+
+    if (localUs >= nextAnnounceUs_)
+    {
+        send(announce, htonl(config_.announceAddress), config_.announcePort);
+        nextAnnounceUs_ = localUs + int64_t{ config_.announceMs } * 1000;
+    }
+    if (!leader)
+    {
+        nextExchangeUs_ = localUs + int64_t{ config_.exchangeMs } * 1000;
+    }
+    else if (localUs >= nextExchangeUs_)
+    {
+        pendingUs_ = esp_timer_get_time();
+        send(
+            { Type::Request, config_.priority, false, false, config_.id, { *pendingUs_, 0, 0 } },
+            leader->address,
+            leader->port);
+        const uint32_t intervalMs = filling ? config_.exchangeMs / 4 : config_.exchangeMs;
+        nextExchangeUs_ = localUs + int64_t{ intervalMs } * 1000;
+    }
+}
+
+void TimeSync::send(const Message& message, uint32_t address, uint16_t port)
+{
+    std::array<uint8_t, maxMessageSize> out;
+    const size_t size = encode(message, out);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    to.sin_addr.s_addr = address;
+    if (sendto(socket_, out.data(), size, 0, reinterpret_cast<sockaddr*>(&to), sizeof(to))
+        != static_cast<ssize_t>(size))
+    {
+        ESP_LOGD(TAG, "Failed to send to port %u", port);
+    }
+}
+
+size_t TimeSync::encode(const Message& message, std::array<uint8_t, maxMessageSize>& out)
+{
+    std::copy(std::begin(magic), std::end(magic), out.begin());
+    out[4] = version;
+    out[5] = static_cast<uint8_t>(message.type);
+    out[6] = message.priority;
+    out[7] = (message.leading ? flagLeading : 0) | (message.hasEpoch ? flagEpoch : 0);
+    put32(&out[8], message.id);
+    const size_t times = message.type == Type::Response ? 3 : 1;
+    for (size_t i = 0; i < times; ++i)
+    {
+        const auto value = static_cast<uint64_t>(message.times[i]);
+        put32(&out[headerSize + 8 * i], static_cast<uint32_t>(value >> 32));
+        put32(&out[headerSize + 8 * i + 4], static_cast<uint32_t>(value));
+    }
+    return headerSize + 8 * times;
+}
+
+std::optional<TimeSync::Message> TimeSync::decode(std::span<const uint8_t> datagram)
+{
+    if (datagram.size() < headerSize
+        || !std::equal(std::begin(magic), std::end(magic), datagram.begin())
+        || datagram[4] != version)
+    {
+        return std::nullopt;
+    }
+    const auto type = static_cast<Type>(datagram[5]);
+    if (type != Type::Announce && type != Type::Request && type != Type::Response)
+    {
+        return std::nullopt;
+    }
+    const size_t times = type == Type::Response ? 3 : 1;
+    if (datagram.size() != headerSize + 8 * times)
+    {
+        return std::nullopt;
+    }
+    Message message{ type,
+                     datagram[6],
+                     (datagram[7] & flagLeading) != 0,
+                     (datagram[7] & flagEpoch) != 0,
+                     get32(&datagram[8]),
+                     {} };
+    for (size_t i = 0; i < times; ++i)
+    {
+        const uint64_t value = (uint64_t{ get32(&datagram[headerSize + 8 * i]) } << 32)
+            | get32(&datagram[headerSize + 8 * i + 4]);
+        message.times[i] = static_cast<int64_t>(value);
+    }
+    return message;
+}
@@ -0,0 +1,68 @@
+#ifndef HOST_SHIMS_WS2812_SINK_HPP
+#define HOST_SHIMS_WS2812_SINK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace HostSim
+{
+
+/**
+ * Ws2812Sink: Simulated WS2812 strip attached to the host RMT shim.
+ * Every buffer passed to rmt_transmit() is recorded as one GRB frame,
+ * together with the GPIO it was sent on and the transmit timestamps.
+ */
+class Ws2812Sink
+{
+public:
+    struct Frame
+    {
+        int gpio;
+        int64_t startUs;  // rmt_transmit() call
+        int64_t doneUs;  // end of the simulated wire time
+        std::vector<uint8_t> grb;
+    };
+
+    // Bit time of the WS2812 protocol and the latch (reset) time
+    static constexpr int64_t bitTimeNs = 1250;
+    static constexpr int64_t resetTimeUs = 50;
+
+    static Ws2812Sink& instance();
+
+    // When enabled, rmt_tx_wait_all_done() blocks for the time the frame
+    // would take on the wire
+    void setRealtime(bool realtime);
+    bool isRealtime() const;
+
+    void setCapacity(size_t maxFrames);
+    void clear();
+
+    size_t frameCount() const;
+    std::vector<Frame> frames() const;
+    std::optional<Frame> lastFrame() const;
+
+    static int64_t wireTimeUs(size_t bytes)
+    {
+        return static_cast<int64_t>(bytes) * 8 * bitTimeNs / 1000
+            + resetTimeUs;
+    }
+
+    // Called by the RMT shim
+    int64_t capture(int gpio, const uint8_t* data, size_t size);
+
+private:
+    Ws2812Sink() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<Frame> frames_;
+    size_t capacity_{ 4096 };
+    size_t dropped_{ 0 };
+    bool realtime_{ true };
+};
+
+}  // namespace HostSim
+
+#endif  // HOST_SHIMS_WS2812_SINK_HPP
@@ -0,0 +1,26 @@
+/*
+ * Host shim for driver/rmt_encoder.h
+ */
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct rmt_channel_t* rmt_channel_handle_t;
+    typedef struct rmt_encoder_t rmt_encoder_t;
+    typedef struct rmt_encoder_t* rmt_encoder_handle_t;
+
+    struct rmt_encoder_t
+    {
+        esp_err_t (*del)(rmt_encoder_t* encoder);
+    };
+
+    esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Host shim for esp_heap_caps.h, all capabilities map onto the libc heap
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+    void* heap_caps_malloc(size_t size, uint32_t caps);
+    void* heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+    void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps);
+    void heap_caps_free(void* ptr);
+    size_t heap_caps_get_allocated_size(void* ptr);
+    size_t heap_caps_get_free_size(uint32_t caps);
+    size_t heap_caps_get_minimum_free_size(uint32_t caps);
+    size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#ifdef __cplusplus
+}
+
+namespace HostSim
+{
+// When false, MALLOC_CAP_SPIRAM allocations fail, as with a full PSRAM
+void setSpiramAvailable(bool available);
+// Allocations larger than this fail, as with a fragmented heap. 0 lifts the limit.
+void setMaxAllocation(size_t size);
+}  // namespace HostSim
+#endif
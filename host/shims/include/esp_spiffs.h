@@ -0,0 +1,30 @@
+/*
+ * Host shim for esp_spiffs.h, the partition is a directory on the host
+ * filesystem at base_path
+ */
+#pragma once
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        const char* base_path;
+        const char* partition_label;
+        size_t max_files;
+        bool format_if_mount_failed;
+    } esp_vfs_spiffs_conf_t;
+
+    esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf);
+    esp_err_t esp_vfs_spiffs_unregister(const char* partition_label);
+
+#ifdef __cplusplus
+}
+#endif
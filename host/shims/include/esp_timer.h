@@ -0,0 +1,18 @@
+/*
+ * Host shim for esp_timer.h
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Microseconds since the start of the process */
+    int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
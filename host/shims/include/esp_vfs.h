@@ -0,0 +1,4 @@
+/*
+ * Host shim for esp_vfs.h, files are accessed through the host filesystem
+ */
+#pragma once
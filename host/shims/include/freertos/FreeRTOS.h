@@ -0,0 +1,25 @@
+/*
+ * Host shim for freertos/FreeRTOS.h
+ *
+ * Tasks are backed by POSIX threads and the tick is derived from the
+ * monotonic clock, so timing behaviour matches the device at tick
+ * granularity.
+ */
+#pragma once
+
+#include "sdkconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES 25
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portNUM_PROCESSORS CONFIG_FREERTOS_NUMBER_OF_CORES
+
+#include "freertos/projdefs.h"
@@ -0,0 +1,13 @@
+/*
+ * Host shim for freertos/projdefs.h
+ */
+#pragma once
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+
+#define pdMS_TO_TICKS(xTimeInMs)                                               \
+    ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ)  \
+                  / (TickType_t)1000U))
@@ -0,0 +1,29 @@
+/*
+ * Host shim for freertos/semphr.h
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct QueueDefinition* SemaphoreHandle_t;
+
+    SemaphoreHandle_t xSemaphoreCreateMutex(void);
+    SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+    SemaphoreHandle_t xSemaphoreCreateBinary(void);
+    SemaphoreHandle_t
+    xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+    BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+    BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+    BaseType_t
+    xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime);
+    BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex);
+    void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+
+#ifdef __cplusplus
+}
+#endif
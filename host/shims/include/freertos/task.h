@@ -0,0 +1,49 @@
+/*
+ * Host shim for freertos/task.h
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct tskTaskControlBlock* TaskHandle_t;
+    typedef void (*TaskFunction_t)(void*);
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+    BaseType_t xTaskCreate(
+        TaskFunction_t pxTaskCode,
+        const char* pcName,
+        uint32_t usStackDepth,
+        void* pvParameters,
+        UBaseType_t uxPriority,
+        TaskHandle_t* pxCreatedTask);
+    BaseType_t xTaskCreatePinnedToCore(
+        TaskFunction_t pxTaskCode,
+        const char* pcName,
+        uint32_t usStackDepth,
+        void* pvParameters,
+        UBaseType_t uxPriority,
+        TaskHandle_t* pxCreatedTask,
+        BaseType_t xCoreID);
+    void vTaskDelete(TaskHandle_t xTaskToDelete);
+    void vTaskDelay(TickType_t xTicksToDelay);
+    BaseType_t
+    xTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement);
+    TickType_t xTaskGetTickCount(void);
+    TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+    BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+    uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+
+#define vTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement)                    \
+    ((void)xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,10 @@
+/*
+ * Host build configuration, mirrors the options of the firmware sdkconfig
+ * that the host-built components depend on.
+ */
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_SPIRAM 1
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_FREERTOS_NUMBER_OF_CORES 2
@@ -0,0 +1,80 @@
+#include "Ws2812Sink.hpp"
+
+#include <esp_timer.h>
+
+namespace HostSim
+{
+
+Ws2812Sink& Ws2812Sink::instance()
+{
+    static Ws2812Sink sink;
+    return sink;
+}
+
+void Ws2812Sink::setRealtime(bool realtime)
+{
+    std::lock_guard lock{ mutex_ };
+    realtime_ = realtime;
+}
+
+bool Ws2812Sink::isRealtime() const
+{
+    std::lock_guard lock{ mutex_ };
+    return realtime_;
+}
+
+void Ws2812Sink::setCapacity(size_t maxFrames)
+{
+    std::lock_guard lock{ mutex_ };
+    capacity_ = maxFrames;
+}
+
+void Ws2812Sink::clear()
+{
+    std::lock_guard lock{ mutex_ };
+    frames_.clear();
+    dropped_ = 0;
+}
+
+size_t Ws2812Sink::frameCount() const
+{
+    std::lock_guard lock{ mutex_ };
+    return frames_.size() + dropped_;
+}
+
+std::vector<Ws2812Sink::Frame> Ws2812Sink::frames() const
+{
+    std::lock_guard lock{ mutex_ };
+    return frames_;
+}
+
+std::optional<Ws2812Sink::Frame> Ws2812Sink::lastFrame() const
+{
+    std::lock_guard lock{ mutex_ };
+    if (frames_.empty())
+    {
+        return std::nullopt;
+    }
+    return frames_.back();
+}
+
+int64_t Ws2812Sink::capture(int gpio, const uint8_t* data, size_t size)
+{
+    const int64_t now = esp_timer_get_time();
+    Frame frame{ gpio,
+                 now,
+                 now + wireTimeUs(size),
+                 std::vector<uint8_t>(data, data + size) };
+
+    std::lock_guard lock{ mutex_ };
+    // Keep the most recent frames only
+    if (frames_.size() >= capacity_ && !frames_.empty())
+    {
+        frames_.erase(frames_.begin());
+        ++dropped_;
+    }
+    frames_.push_back(std::move(frame));
+    return realtime_ ? frames_.back().doneUs : now;
+}
+
+}  // namespace HostSim
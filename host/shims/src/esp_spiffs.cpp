@@ -0,0 +1,17 @@
+#include <esp_spiffs.h>
+
+#include <filesystem>
+#include <system_error>
+
+extern "C" esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf)
+{
+    if (!conf || !conf->base_path)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(conf->base_path, ec);
+    return ec ? ESP_FAIL : ESP_OK;
+}
+
+extern "C" esp_err_t esp_vfs_spiffs_unregister(const char*) { return ESP_OK; }
@@ -0,0 +1,134 @@
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <malloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace
+{
+const auto processStart = std::chrono::steady_clock::now();
+
+esp_log_level_t logLevel = ESP_LOG_INFO;
+std::mutex logMutex;
+}  // namespace
+
+extern "C" int64_t esp_timer_get_time(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - processStart)
+        .count();
+}
+
+extern "C" const char* esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+        return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+extern "C" void esp_log_level_set(const char* tag, esp_log_level_t level)
+{
+    // Per-tag levels are not supported on the host, any tag sets all
+    (void)tag;
+    logLevel = level;
+}
+
+extern "C" void
+esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+    if (level > logLevel)
+    {
+        return;
+    }
+    static constexpr char letters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+
+    std::lock_guard lock{ logMutex };
+    std::fprintf(
+        stderr,
+        "%c (%lld) %s: ",
+        letters[level],
+        static_cast<long long>(esp_timer_get_time() / 1000),
+        tag);
+    va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+}
+
+static std::atomic<bool> spiramAvailable{ true };
+
+void HostSim::setSpiramAvailable(bool available)
+{
+    spiramAvailable = available;
+}
+
+static std::atomic<size_t> maxAllocation{ 0 };
+
+void HostSim::setMaxAllocation(size_t size)
+{
+    maxAllocation = size;
+}
+
+extern "C" void* heap_caps_malloc(size_t size, uint32_t caps)
+{
+    if (((caps & MALLOC_CAP_SPIRAM) && !spiramAvailable)
+        || (maxAllocation != 0 && size > maxAllocation))
+    {
+        return nullptr;
+    }
+    return std::malloc(size);
+}
+
+extern "C" void* heap_caps_calloc(size_t n, size_t size, uint32_t)
+{
+    return std::calloc(n, size);
+}
+
+extern "C" void* heap_caps_realloc(void* ptr, size_t size, uint32_t)
+{
+    return std::realloc(ptr, size);
+}
+
+extern "C" void heap_caps_free(void* ptr) { std::free(ptr); }
+
+extern "C" size_t heap_caps_get_allocated_size(void* ptr)
+{
+    return malloc_usable_size(ptr);
+}
+
+// The host heap has no fixed size, report nothing free
+extern "C" size_t heap_caps_get_free_size(uint32_t) { return 0; }
+
+extern "C" size_t heap_caps_get_minimum_free_size(uint32_t) { return 0; }
+
+extern "C" size_t heap_caps_get_largest_free_block(uint32_t) { return 0; }
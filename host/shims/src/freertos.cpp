@@ -0,0 +1,299 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <pthread.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct tskTaskControlBlock
+{
+    std::string name;
+    TaskFunction_t function;
+    void* parameters;
+    pthread_t thread;
+    std::mutex notifyMutex;
+    std::condition_variable notifyCv;
+    uint32_t notifyValue{ 0 };
+    std::atomic<bool> finished{ false };
+};
+
+struct QueueDefinition
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    // Recursive mutexes only
+    std::thread::id holder;
+    UBaseType_t depth{ 0 };
+};
+
+namespace
+{
+const auto schedulerStart = std::chrono::steady_clock::now();
+
+thread_local tskTaskControlBlock* currentTask = nullptr;
+
+std::chrono::steady_clock::time_point tickToTimePoint(TickType_t tick)
+{
+    return schedulerStart + std::chrono::milliseconds(tick * portTICK_PERIOD_MS);
+}
+
+void* taskTrampoline(void* arg)
+{
+    auto* task = static_cast<tskTaskControlBlock*>(arg);
+    currentTask = task;
+    task->function(task->parameters);
+    // FreeRTOS tasks must not return
+    vTaskDelete(nullptr);
+    return nullptr;
+}
+}  // namespace
+
+extern "C" BaseType_t xTaskCreate(
+    TaskFunction_t pxTaskCode,
+    const char* pcName,
+    uint32_t usStackDepth,
+    void* pvParameters,
+    UBaseType_t uxPriority,
+    TaskHandle_t* pxCreatedTask)
+{
+    return xTaskCreatePinnedToCore(
+        pxTaskCode,
+        pcName,
+        usStackDepth,
+        pvParameters,
+        uxPriority,
+        pxCreatedTask,
+        tskNO_AFFINITY);
+}
+
+extern "C" BaseType_t xTaskCreatePinnedToCore(
+    TaskFunction_t pxTaskCode,
+    const char* pcName,
+    uint32_t,
+    void* pvParameters,
+    UBaseType_t,
+    TaskHandle_t* pxCreatedTask,
+    BaseType_t)
+{
+    // Task control blocks are never freed, handles of deleted tasks stay
+    // valid for the rest of the process like on the device
+    auto* task = new tskTaskControlBlock{};
+    task->name = pcName ? pcName : "";
+    task->function = pxTaskCode;
+    task->parameters = pvParameters;
+    if (pxCreatedTask)
+    {
+        *pxCreatedTask = task;
+    }
+    if (pthread_create(&task->thread, nullptr, taskTrampoline, task) != 0)
+    {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    if (!xTaskToDelete || xTaskToDelete == currentTask)
+    {
+        if (currentTask)
+        {
+            currentTask->finished = true;
+        }
+        pthread_exit(nullptr);
+    }
+    // Deleting another task stops it at its next blocking call
+    if (!xTaskToDelete->finished.exchange(true))
+    {
+        pthread_cancel(xTaskToDelete->thread);
+    }
+}
+
+extern "C" void vTaskDelay(TickType_t xTicksToDelay)
+{
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(xTicksToDelay * portTICK_PERIOD_MS));
+}
+
+extern "C" BaseType_t
+xTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+    // As the configASSERT() of FreeRTOS, which is on in release builds too
+    if (xTimeIncrement == 0)
+    {
+        std::abort();
+    }
+    const TickType_t wakeTick = *pxPreviousWakeTime + xTimeIncrement;
+    *pxPreviousWakeTime = wakeTick;
+    if (wakeTick <= xTaskGetTickCount())
+    {
+        return pdFALSE;
+    }
+    std::this_thread::sleep_until(tickToTimePoint(wakeTick));
+    return pdTRUE;
+}
+
+extern "C" TickType_t xTaskGetTickCount(void)
+{
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - schedulerStart);
+    return static_cast<TickType_t>(elapsed.count() / portTICK_PERIOD_MS);
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (!currentTask)
+    {
+        // Adopt threads that were not created through xTaskCreate
+        currentTask = new tskTaskControlBlock{};
+        currentTask->name = "main";
+        currentTask->thread = pthread_self();
+    }
+    return currentTask;
+}
+
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    {
+        std::lock_guard lock{ xTaskToNotify->notifyMutex };
+        ++xTaskToNotify->notifyValue;
+    }
+    xTaskToNotify->notifyCv.notify_all();
+    return pdPASS;
+}
+
+extern "C" uint32_t
+ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    std::unique_lock lock{ task->notifyMutex };
+    auto notified = [task] { return task->notifyValue > 0; };
+    if (xTicksToWait == portMAX_DELAY)
+    {
+        task->notifyCv.wait(lock, notified);
+    }
+    else
+    {
+        task->notifyCv.wait_for(
+            lock,
+            std::chrono::milliseconds(xTicksToWait * portTICK_PERIOD_MS),
+            notified);
+    }
+    const uint32_t value = task->notifyValue;
+    if (value > 0)
+    {
+        task->notifyValue = xClearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+extern "C" SemaphoreHandle_t
+xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    auto* semaphore = new QueueDefinition{};
+    semaphore->count = uxInitialCount;
+    semaphore->maxCount = uxMaxCount;
+    return semaphore;
+}
+
+extern "C" BaseType_t
+xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    std::unique_lock lock{ xSemaphore->mutex };
+    auto available = [xSemaphore] { return xSemaphore->count > 0; };
+    if (xBlockTime == portMAX_DELAY)
+    {
+        xSemaphore->cv.wait(lock, available);
+    }
+    else if (!xSemaphore->cv.wait_for(
+                 lock,
+                 std::chrono::milliseconds(xBlockTime * portTICK_PERIOD_MS),
+                 available))
+    {
+        return pdFALSE;
+    }
+    --xSemaphore->count;
+    return pdTRUE;
+}
+
+extern "C" BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    {
+        std::lock_guard lock{ xSemaphore->mutex };
+        if (xSemaphore->count >= xSemaphore->maxCount)
+        {
+            return pdFALSE;
+        }
+        ++xSemaphore->count;
+    }
+    xSemaphore->cv.notify_one();
+    return pdTRUE;
+}
+
+extern "C" BaseType_t
+xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime)
+{
+    {
+        std::lock_guard lock{ xMutex->mutex };
+        if (xMutex->depth > 0 && xMutex->holder == std::this_thread::get_id())
+        {
+            ++xMutex->depth;
+            return pdTRUE;
+        }
+    }
+    if (xSemaphoreTake(xMutex, xBlockTime) != pdTRUE)
+    {
+        return pdFALSE;
+    }
+    std::lock_guard lock{ xMutex->mutex };
+    xMutex->holder = std::this_thread::get_id();
+    xMutex->depth = 1;
+    return pdTRUE;
+}
+
+extern "C" BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex)
+{
+    {
+        std::lock_guard lock{ xMutex->mutex };
+        if (xMutex->depth == 0 || xMutex->holder != std::this_thread::get_id())
+        {
+            return pdFALSE;
+        }
+        if (--xMutex->depth > 0)
+        {
+            return pdTRUE;
+        }
+        xMutex->holder = {};
+    }
+    return xSemaphoreGive(xMutex);
+}
+
+extern "C" void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    delete xSemaphore;
+}
@@ -0,0 +1,132 @@
+#include "Ws2812Sink.hpp"
+
+#include <driver/rmt_tx.h>
+#include <esp_timer.h>
+
+#include "led_strip_encoder.h"
+
+#include <chrono>
+#include <thread>
+
+struct rmt_channel_t
+{
+    gpio_num_t gpio;
+    bool enabled;
+    int64_t doneUs;
+};
+
+namespace
+{
+esp_err_t deleteEncoder(rmt_encoder_t* encoder)
+{
+    delete encoder;
+    return ESP_OK;
+}
+}  // namespace
+
+extern "C" esp_err_t rmt_new_tx_channel(
+    const rmt_tx_channel_config_t* config, rmt_channel_handle_t* ret_chan)
+{
+    if (!config || !ret_chan)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_chan = new rmt_channel_t{ config->gpio_num, false, 0 };
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_del_channel(rmt_channel_handle_t channel)
+{
+    delete channel;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_enable(rmt_channel_handle_t channel)
+{
+    if (!channel)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_disable(rmt_channel_handle_t channel)
+{
+    if (!channel)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    channel->enabled = false;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_transmit(
+    rmt_channel_handle_t tx_channel,
+    rmt_encoder_handle_t encoder,
+    const void* payload,
+    size_t payload_bytes,
+    const rmt_transmit_config_t* config)
+{
+    if (!tx_channel || !encoder || !payload || !config)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!tx_channel->enabled)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Transmissions on one channel are queued back to back
+    const int64_t now = esp_timer_get_time();
+    if (tx_channel->doneUs > now)
+    {
+        std::this_thread::sleep_for(
+            std::chrono::microseconds(tx_channel->doneUs - now));
+    }
+    tx_channel->doneUs = HostSim::Ws2812Sink::instance().capture(
+        tx_channel->gpio, static_cast<const uint8_t*>(payload), payload_bytes);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t
+rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms)
+{
+    if (!tx_channel)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const int64_t remaining = tx_channel->doneUs - esp_timer_get_time();
+    if (remaining <= 0)
+    {
+        return ESP_OK;
+    }
+    if (timeout_ms >= 0 && remaining > static_cast<int64_t>(timeout_ms) * 1000)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return ESP_ERR_TIMEOUT;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(remaining));
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+    if (!encoder)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return encoder->del(encoder);
+}
+
+// The WS2812 symbol encoding is done by the simulated sink, the host
+// encoder only needs to exist
+extern "C" esp_err_t rmt_new_led_strip_encoder(
+    const led_strip_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder)
+{
+    if (!config || !ret_encoder)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_encoder = new rmt_encoder_t{ deleteEncoder };
+    return ESP_OK;
+}
@@ -0,0 +1,112 @@
+#include "Arena.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using HeapStats::AllocTag;
+using HeapStats::Arena;
+
+TEST(ArenaTest, AllocationsAreAlignedAndDistinct)
+{
+    Arena arena{ 1024 };
+    auto* a = static_cast<char*>(arena.allocate(3));
+    auto* b = static_cast<char*>(arena.allocate(17));
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t), 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t), 0u);
+    EXPECT_GE(b - a, 3);
+    EXPECT_TRUE(arena.owns(a));
+    EXPECT_TRUE(arena.owns(b));
+
+    int local = 0;
+    EXPECT_FALSE(arena.owns(&local));
+}
+
+TEST(ArenaTest, GrowsAndKeepsOneChunkOnReset)
+{
+    Arena arena{ 256 };
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_NE(arena.allocate(64), nullptr);
+    }
+    // One oversized block
+    ASSERT_NE(arena.allocate(10'000), nullptr);
+    EXPECT_GE(arena.capacity(), 100u * 64 + 10'000);
+    const size_t peak = arena.peakUsed();
+    EXPECT_GE(peak, 100u * 64 + 10'000);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.capacity(), 256u);
+    EXPECT_EQ(arena.peakUsed(), peak);
+}
+
+TEST(ArenaTest, ChunksStopGrowingAtTheMaximum)
+{
+    Arena arena{ 32 * 1024 };
+    size_t capacity = 0;
+    while (arena.capacity() < 8 * Arena::maxChunkSize)
+    {
+        ASSERT_NE(arena.allocate(4096), nullptr);
+        EXPECT_LE(arena.capacity() - capacity, Arena::maxChunkSize);
+        capacity = arena.capacity();
+    }
+
+    // A block larger than the maximum still fits, in a chunk of its own
+    ASSERT_NE(arena.allocate(2 * Arena::maxChunkSize), nullptr);
+    EXPECT_EQ(arena.capacity() - capacity, 2 * Arena::maxChunkSize);
+}
+
+TEST(ArenaTest, ResetReleasesAllAccountedMemory)
+{
+    const auto before = HeapStats::tagStats(AllocTag::Http).bytes;
+    {
+        Arena arena{ 512, AllocTag::Http };
+        arena.allocate(100'000);
+        EXPECT_GT(HeapStats::tagStats(AllocTag::Http).bytes, before + 100'000);
+        arena.reset();
+    }
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Http).bytes, before);
+}
+
+TEST(ArenaTest, ScopeRoutesScratchAllocationsPerThread)
+{
+    Arena arena{ 4096 };
+    void* outside = Arena::allocateScratch(32, AllocTag::Other, true);
+    EXPECT_FALSE(arena.owns(outside));
+    {
+        Arena::Scope scope{ &arena };
+        EXPECT_EQ(Arena::current(), &arena);
+
+        void* inside = Arena::allocateScratch(32, AllocTag::Other, true);
+        EXPECT_TRUE(arena.owns(inside));
+        Arena::deallocateScratch(inside, AllocTag::Other);
+        // Heap blocks are still freed normally inside a scope
+        Arena::deallocateScratch(outside, AllocTag::Other);
+
+        // Other threads keep using the heap
+        std::thread other(
+            [&arena]
+            {
+                EXPECT_EQ(Arena::current(), nullptr);
+                void* p = Arena::allocateScratch(32, AllocTag::Other, true);
+                EXPECT_FALSE(arena.owns(p));
+                Arena::deallocateScratch(p, AllocTag::Other);
+            });
+        other.join();
+
+        using String = std::basic_string<
+            char,
+            std::char_traits<char>,
+            HeapStats::ArenaAllocator<char>>;
+        String body(1000, 'x');
+        EXPECT_TRUE(arena.owns(body.data()));
+    }
+    EXPECT_EQ(Arena::current(), nullptr);
+    EXPECT_EQ(arena.used(), 0u);
+}
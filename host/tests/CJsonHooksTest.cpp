@@ -0,0 +1,47 @@
+#include "Arena.hpp"
+#include "CJsonHooks.hpp"
+
+#include <cJSON.h>
+
+#include <gtest/gtest.h>
+
+using HeapStats::AllocTag;
+using HeapStats::Arena;
+
+TEST(CJsonHooksTest, ParsesIntoTheCurrentArena)
+{
+    HeapStats::installCJsonHooks();
+    const auto json = HeapStats::tagStats(AllocTag::Json);
+
+    Arena arena;
+    {
+        Arena::Scope scope{ &arena };
+        cJSON* root = cJSON_Parse("{\"frames\":[[\"#ff0000\",\"#00ff00\"]]}");
+        ASSERT_NE(root, nullptr);
+        EXPECT_TRUE(arena.owns(root));
+        EXPECT_GT(arena.used(), 0u);
+
+        char* printed = cJSON_PrintUnformatted(root);
+        EXPECT_STREQ(printed, "{\"frames\":[[\"#ff0000\",\"#00ff00\"]]}");
+        cJSON_free(printed);
+        cJSON_Delete(root);
+    }
+    EXPECT_EQ(arena.used(), 0u);
+    // Nothing went through the general heap
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Json).allocations, json.allocations);
+}
+
+TEST(CJsonHooksTest, WithoutArenaAllocationsAreAccounted)
+{
+    HeapStats::installCJsonHooks();
+    const auto before = HeapStats::tagStats(AllocTag::Json);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "name", "test");
+    auto during = HeapStats::tagStats(AllocTag::Json);
+    EXPECT_GT(during.allocations, before.allocations);
+    EXPECT_GT(during.bytes, before.bytes);
+
+    cJSON_Delete(root);
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Json).bytes, before.bytes);
+}
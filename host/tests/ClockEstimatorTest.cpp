@@ -0,0 +1,90 @@
+#include "ClockEstimator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+// A reference running skewPpm faster, offsetUs ahead at local time 0
+struct Reference
+{
+    double skewPpm;
+    int64_t offsetUs;
+
+    int64_t at(int64_t localUs) const
+    {
+        return localUs + offsetUs + static_cast<int64_t>(localUs * skewPpm / 1e6);
+    }
+
+    // Request out after toUs, answered 100 us later, back after backUs
+    ClockEstimator::Exchange exchange(int64_t sentUs, int64_t toUs, int64_t backUs) const
+    {
+        const int64_t arrivedUs = sentUs + toUs;
+        return { sentUs, at(arrivedUs), at(arrivedUs + 100), arrivedUs + 100 + backUs };
+    }
+};
+}  // namespace
+
+TEST(ClockEstimatorTest, FollowsOffsetAndSkewThroughJitter)
+{
+    const Reference reference{ 80, 5'000'000 };
+    std::mt19937 rng{ 7 };
+    std::uniform_int_distribution<int64_t> jitter{ 0, 400 };
+    ClockEstimator estimator;
+
+    int64_t localUs = 1'000'000;
+    for (int i = 0; i < 120; ++i, localUs += 1'000'000)
+    {
+        // Every third exchange is queued 30 ms on its way back
+        const int64_t backUs = 2'000 + jitter(rng) + (i % 3 == 0 ? 30'000 : 0);
+        ASSERT_TRUE(estimator.add(reference.exchange(localUs, 2'000 + jitter(rng), backUs)));
+    }
+    ASSERT_TRUE(estimator.valid());
+    EXPECT_NEAR(estimator.toReference(localUs), reference.at(localUs), 500);
+    // Without exchanges the skew keeps it close, 80 ppm alone would be
+    // 2.4 ms off after 30 s
+    localUs += 30'000'000;
+    EXPECT_NEAR(estimator.toReference(localUs), reference.at(localUs), 1'000);
+
+    const auto stats = estimator.stats();
+    EXPECT_EQ(stats.exchanges, 120u);
+    EXPECT_NEAR(stats.skewPpm, 80, 15);
+    EXPECT_LT(stats.roundTripUs, 5'000u);
+    // Well within a frame
+    EXPECT_LT(stats.errorUs, 5'000u);
+}
+
+TEST(ClockEstimatorTest, RejectsExchangesThatCannotHappen)
+{
+    ClockEstimator estimator;
+    // The response before the request
+    EXPECT_FALSE(estimator.add({ 1'000, 5'000, 5'100, 900 }));
+    // The reference took longer than the whole round trip
+    EXPECT_FALSE(estimator.add({ 1'000, 5'000, 9'000, 2'000 }));
+    EXPECT_FALSE(estimator.valid());
+    EXPECT_EQ(estimator.stats().exchanges, 0u);
+}
+
+TEST(ClockEstimatorTest, RestartKeepsTheMappingUntilTheNewReferenceAnswers)
+{
+    const Reference first{ 0, 1'000'000 };
+    const Reference second{ 0, 1'003'000 };
+    ClockEstimator estimator;
+    for (int64_t localUs = 0; localUs < 5'000'000; localUs += 500'000)
+    {
+        estimator.add(first.exchange(localUs, 1'000, 1'000));
+    }
+    EXPECT_EQ(estimator.toReference(6'000'000), first.at(6'000'000));
+
+    estimator.restart();
+    ASSERT_TRUE(estimator.valid());
+    EXPECT_EQ(estimator.toReference(6'000'000), first.at(6'000'000));
+    // The old samples had shorter round trips, they are not used anymore
+    estimator.add(second.exchange(6'000'000, 2'000, 2'000));
+    EXPECT_EQ(estimator.toReference(7'000'000), second.at(7'000'000));
+    EXPECT_EQ(estimator.stats().errorUs, 3'000u + 2'000u);
+
+    estimator.reset();
+    EXPECT_FALSE(estimator.valid());
+}
@@ -0,0 +1,81 @@
+#include "ClockOverlay.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr uint16_t W = LedMatrix::width;
+constexpr uint16_t H = LedMatrix::height;
+
+size_t at(uint16_t x, uint16_t y) { return static_cast<size_t>(y) * W + x; }
+
+std::tm makeTime(int hour, int minute, int day, int month)
+{
+    std::tm local{};
+    local.tm_year = 2026 - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = day;
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    return local;
+}
+}  // namespace
+
+TEST(ClockOverlayTest, DrawsTheTimeOnTheBottomBand)
+{
+    ClockOverlay clock;
+    clock.draw({ ClockOverlay::Mode::Time, { 255, 0, 0 }, false }, makeTime(12, 34, 1, 1));
+
+    const uint16_t band = H - ClockOverlay::bandHeight;
+    for (uint16_t x = 0; x < W; ++x)
+    {
+        EXPECT_EQ(clock.alpha(at(x, band - 1)), 0) << "x " << x;
+        EXPECT_GT(clock.alpha(at(x, band)), 0) << "x " << x;
+    }
+    // Top row of "1" is 010, of "2" is 111
+    EXPECT_LT(clock.alpha(at(0, band + 1)), 255);
+    EXPECT_EQ(clock.alpha(at(1, band + 1)), 255);
+    EXPECT_EQ(clock.pixel(at(1, band + 1)).r, 255);
+    for (uint16_t x = 4; x < 7; ++x)
+    {
+        EXPECT_EQ(clock.alpha(at(x, band + 1)), 255) << "x " << x;
+    }
+    // Colon
+    EXPECT_EQ(clock.alpha(at(7, band + 2)), 255);
+    EXPECT_LT(clock.alpha(at(7, band + 3)), 255);
+    EXPECT_EQ(clock.alpha(at(7, band + 4)), 255);
+}
+
+TEST(ClockOverlayTest, DrawsTheDateOnTheTopBand)
+{
+    ClockOverlay clock;
+    clock.draw({ ClockOverlay::Mode::Date, { 255, 255, 255 }, true }, makeTime(0, 0, 5, 3));
+
+    EXPECT_GT(clock.alpha(at(0, 0)), 0);
+    EXPECT_EQ(clock.alpha(at(0, ClockOverlay::bandHeight)), 0);
+    // Dot instead of the colon
+    EXPECT_LT(clock.alpha(at(7, 2)), 255);
+    EXPECT_EQ(clock.alpha(at(7, 5)), 255);
+    // "0" of "05" has its left column lit, "3" of "03" does not
+    EXPECT_EQ(clock.alpha(at(0, 3)), 255);
+    EXPECT_LT(clock.alpha(at(13, 2)), 255);
+}
+
+TEST(ClockOverlayTest, OffDrawsNothing)
+{
+    ClockOverlay clock;
+    clock.draw({ ClockOverlay::Mode::Off, { 255, 255, 255 }, false }, makeTime(12, 34, 1, 1));
+    for (size_t i = 0; i < LedMatrix::numPixels; ++i)
+    {
+        EXPECT_EQ(clock.alpha(i), 0);
+    }
+}
+
+TEST(ClockOverlayTest, ModeNamesRoundTrip)
+{
+    for (auto mode: { ClockOverlay::Mode::Off, ClockOverlay::Mode::Time, ClockOverlay::Mode::Date })
+    {
+        EXPECT_EQ(ClockOverlay::parseMode(ClockOverlay::toString(mode)), mode);
+    }
+    EXPECT_FALSE(ClockOverlay::parseMode("weekday").has_value());
+}
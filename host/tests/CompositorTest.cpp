@@ -0,0 +1,186 @@
+#include "Compositor.hpp"
+#include "DeltaFrames.hpp"
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+using RGB = LedMatrix::RGB;
+using WireColor = LedMatrix::WireColor;
+constexpr uint16_t W = LedMatrix::width;
+constexpr uint16_t H = LedMatrix::height;
+
+class TestLayer : public OverlayLayer<LedMatrix>
+{
+public:
+    explicit TestLayer(Blend blend, RGB key = { 0, 0, 0 })
+        : OverlayLayer{ blend, key }
+    {
+    }
+
+    bool refresh(int64_t) override
+    {
+        const bool changed = changed_;
+        changed_ = false;
+        return changed;
+    }
+
+    void set(uint16_t x, uint16_t y, RGB color, uint8_t alpha = 255)
+    {
+        setPixel(x, y, color, alpha);
+        changed_ = true;
+    }
+
+private:
+    bool changed_{ false };
+};
+
+void fillContent(LedMatrix& matrix)
+{
+    for (uint16_t y = 0; y < H; ++y)
+    {
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            matrix.setWirePixel(x, y, { 200, static_cast<uint8_t>(x), 0 });
+        }
+    }
+}
+
+bool sameColor(WireColor a, WireColor b) { return a.g == b.g && a.r == b.r && a.b == b.b; }
+}  // namespace
+
+TEST(CompositorTest, AlphaLayersBlendOverTheContent)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    fillContent(matrix);
+    TestLayer layer{ TestLayer::Blend::Alpha };
+    layer.set(1, 2, { 255, 255, 255 });
+    layer.set(3, 4, { 0, 0, 0 }, 128);
+
+    Compositor<LedMatrix> compositor;
+    compositor.add(layer);
+    ASSERT_TRUE(compositor.refresh(0));
+    EXPECT_EQ(compositor.covered(), 2u);
+    compositor.apply(matrix);
+
+    EXPECT_TRUE(sameColor(matrix.wirePixel(1, 2), LedMatrix::toWire({ 255, 255, 255 })));
+    EXPECT_EQ(matrix.wirePixel(3, 4).g, (200 * 127 + 127) / 255);
+    EXPECT_TRUE(sameColor(matrix.wirePixel(5, 6), { 200, 5, 0 }));
+}
+
+TEST(CompositorTest, ColorKeyPixelsAreTransparent)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    fillContent(matrix);
+    const RGB key{ 0, 255, 0 };
+    TestLayer layer{ TestLayer::Blend::ColorKey, key };
+    layer.set(1, 1, key);
+    layer.set(2, 1, { 0, 0, 255 });
+
+    Compositor<LedMatrix> compositor;
+    compositor.add(layer);
+    compositor.refresh(0);
+    EXPECT_EQ(compositor.covered(), 1u);
+    compositor.apply(matrix);
+
+    EXPECT_TRUE(sameColor(matrix.wirePixel(1, 1), { 200, 1, 0 }));
+    EXPECT_TRUE(sameColor(matrix.wirePixel(2, 1), LedMatrix::toWire({ 0, 0, 255 })));
+}
+
+TEST(CompositorTest, RestorePutsTheContentBack)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    fillContent(matrix);
+    const auto content = matrix.wireFrame();
+    TestLayer layer{ TestLayer::Blend::Alpha };
+    for (uint16_t x = 0; x < W; ++x)
+    {
+        layer.set(x, 7, { 255, 0, 0 }, 100);
+    }
+
+    Compositor<LedMatrix> compositor;
+    compositor.add(layer);
+    compositor.refresh(0);
+    compositor.apply(matrix);
+    EXPECT_NE(matrix.wireFrame(), content);
+    compositor.restore(matrix);
+    EXPECT_EQ(matrix.wireFrame(), content);
+}
+
+TEST(CompositorTest, RebuildsOnlyWhenALayerChanged)
+{
+    TestLayer layer{ TestLayer::Blend::Alpha };
+    Compositor<LedMatrix> compositor;
+    compositor.add(layer);
+    EXPECT_TRUE(compositor.refresh(0));
+    EXPECT_FALSE(compositor.refresh(1));
+    layer.set(0, 0, { 1, 2, 3 });
+    EXPECT_TRUE(compositor.refresh(2));
+    EXPECT_EQ(compositor.covered(), 1u);
+    compositor.remove(layer);
+    EXPECT_TRUE(compositor.refresh(3));
+    EXPECT_EQ(compositor.covered(), 0u);
+}
+
+TEST(CompositorTest, AnimatorKeepsDeltaFramesRightUnderAnOverlay)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(false);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+
+    // A pixel walking along the first row, under a half transparent pixel
+    // on its way and an opaque bar further down
+    MatrixAnimator<LedMatrix>::Frames frames;
+    for (size_t f = 0; f < W; ++f)
+    {
+        std::array<RGB, LedMatrix::numPixels> frame;
+        frame.fill({ 0, 0, 40 });
+        frame[f] = { 255, 255, 255 };
+        ASSERT_TRUE(frames.push_back(frame));
+    }
+    TestLayer layer{ TestLayer::Blend::Alpha };
+    layer.set(5, 0, { 255, 0, 0 }, 128);
+    for (uint16_t x = 0; x < W; ++x)
+    {
+        layer.set(x, 12, { 0, 255, 0 });
+    }
+
+    // What each frame looks like with the overlay drawn over it
+    Compositor<LedMatrix> reference;
+    reference.add(layer);
+    reference.refresh(0);
+    std::vector<std::vector<uint8_t>> expected;
+    for (const auto& frame: frames)
+    {
+        matrix.setAllPixels(frame);
+        reference.apply(matrix);
+        matrix.update();
+        expected.push_back(Ws2812Sink::instance().lastFrame()->grb);
+    }
+    matrix.clear();
+    Ws2812Sink::instance().clear();
+
+    auto delta = DeltaFrames<LedMatrix>::fromFrames(frames);
+    ASSERT_TRUE(delta.has_value());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+    animator.addOverlay(layer);
+    ASSERT_TRUE(animator.start(std::move(*delta), Timeline::uniform(W, 10)));
+    vTaskDelay(pdMS_TO_TICKS(250));
+    animator.stop();
+    animator.removeOverlay(layer);
+
+    const auto sent = Ws2812Sink::instance().frames();
+    ASSERT_GT(sent.size(), expected.size());
+    for (size_t i = 0; i < sent.size(); ++i)
+    {
+        EXPECT_EQ(sent[i].grb, expected[i % expected.size()]) << "frame " << i;
+    }
+}
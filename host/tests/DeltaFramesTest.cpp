@@ -0,0 +1,163 @@
+#include "DeltaFrames.hpp"
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+using Delta = DeltaFrames<LedMatrix>;
+using Frame = Delta::Frame;
+
+// Gradient background with one bright pixel walking along the first row,
+// every frame differs from the one before in two pixels
+Delta::Frames makeWalkingPixel(size_t numFrames)
+{
+    Delta::Frames frames;
+    for (size_t f = 0; f < numFrames; ++f)
+    {
+        Frame frame;
+        for (size_t i = 0; i < frame.size(); ++i)
+        {
+            frame[i] = { static_cast<uint8_t>(i), 0, static_cast<uint8_t>(255 - i) };
+        }
+        frame[f % 16] = { 255, 255, 255 };
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+Frame makeUniform(uint8_t level)
+{
+    Frame frame;
+    frame.fill({ level, level, level });
+    return frame;
+}
+
+std::vector<uint8_t> transmitted(LedMatrix& matrix)
+{
+    matrix.update();
+    return Ws2812Sink::instance().lastFrame()->grb;
+}
+
+// What setAllPixels() sends for every frame
+std::vector<std::vector<uint8_t>> expectedOutput(
+    LedMatrix& matrix, const Delta::Frames& frames)
+{
+    std::vector<std::vector<uint8_t>> expected;
+    for (const auto& frame: frames)
+    {
+        matrix.setAllPixels(frame);
+        expected.push_back(transmitted(matrix));
+    }
+    matrix.clear();
+    return expected;
+}
+
+class DeltaFramesTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        Ws2812Sink::instance().clear();
+        Ws2812Sink::instance().setRealtime(false);
+    }
+};
+}  // namespace
+
+TEST_F(DeltaFramesTest, SmallChangesAreStoredAsDeltas)
+{
+    const auto frames = makeWalkingPixel(40);
+    auto delta = Delta::fromFrames(frames);
+    ASSERT_TRUE(delta.has_value());
+    EXPECT_EQ(delta->size(), 40u);
+    EXPECT_EQ(delta->keyframes(), 1u);
+    EXPECT_TRUE(delta->isKeyframe(0));
+    EXPECT_EQ(delta->changes(1), 2u);
+    // One keyframe and 39 * 2 changes of 5 bytes
+    EXPECT_EQ(delta->slots(), 2u);
+    EXPECT_EQ(Delta::slotsNeeded(frames), delta->slots());
+}
+
+TEST_F(DeltaFramesTest, LargeChangesBecomeKeyframes)
+{
+    Delta::Frames frames;
+    frames.push_back(makeUniform(0));
+    frames.push_back(makeUniform(0));
+    frames.push_back(makeUniform(200));
+    auto delta = Delta::fromFrames(frames);
+    ASSERT_TRUE(delta.has_value());
+    EXPECT_FALSE(delta->isKeyframe(1));
+    EXPECT_EQ(delta->changes(1), 0u);
+    EXPECT_TRUE(delta->isKeyframe(2));
+    EXPECT_EQ(delta->keyframes(), 2u);
+}
+
+TEST_F(DeltaFramesTest, PlayingInOrderRendersEveryFrame)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+
+    auto frames = makeWalkingPixel(20);
+    frames.push_back(makeUniform(90));
+    auto delta = Delta::fromFrames(frames);
+    ASSERT_TRUE(delta.has_value());
+    const auto expected = expectedOutput(matrix, frames);
+
+    // Twice, so the wrap-around to the first keyframe is covered
+    size_t previous = Delta::none;
+    for (size_t round = 0; round < 2; ++round)
+    {
+        for (size_t f = 0; f < frames.size(); ++f)
+        {
+            delta->render(matrix, f, previous);
+            EXPECT_EQ(transmitted(matrix), expected[f]) << "frame " << f;
+            previous = f;
+        }
+    }
+}
+
+TEST_F(DeltaFramesTest, JumpsReplayFromTheKeyframe)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+
+    const auto frames = makeWalkingPixel(12);
+    auto delta = Delta::fromFrames(frames);
+    ASSERT_TRUE(delta.has_value());
+    const auto expected = expectedOutput(matrix, frames);
+
+    // Backwards, as in a ping-pong timeline, and a jump forward
+    size_t previous = Delta::none;
+    for (size_t f: { 11, 10, 9, 3, 7 })
+    {
+        delta->render(matrix, f, previous);
+        EXPECT_EQ(transmitted(matrix), expected[f]) << "frame " << f;
+        previous = f;
+    }
+}
+
+TEST_F(DeltaFramesTest, AnimatorPlaysDeltaFrames)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+
+    const auto expected = expectedOutput(matrix, makeWalkingPixel(16));
+    Ws2812Sink::instance().clear();
+
+    MatrixAnimator<LedMatrix> animator{ matrix };
+    animator.start(makeWalkingPixel(16), 10);
+    vTaskDelay(pdMS_TO_TICKS(250));
+    animator.stop();
+
+    const auto sent = Ws2812Sink::instance().frames();
+    ASSERT_GT(sent.size(), expected.size());
+    for (size_t i = 0; i < sent.size(); ++i)
+    {
+        EXPECT_EQ(sent[i].grb, expected[i % expected.size()]) << "frame " << i;
+    }
+}
@@ -0,0 +1,174 @@
+#include "Effect.hpp"
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+using HostSim::Ws2812Sink;
+using Kind = Effect::Kind;
+
+namespace
+{
+constexpr Kind allKinds[] = { Kind::Plasma, Kind::Rainbow,    Kind::Noise,
+                              Kind::Fire,   Kind::MatrixRain, Kind::Life };
+
+// Renders effect at timeMs into matrix, returns the transmit buffer
+LedMatrix::WireFrame renderAt(
+    EffectRenderer<LedMatrix>& effect, LedMatrix& matrix, uint32_t timeMs)
+{
+    effect.render(matrix, int64_t{ timeMs } * 1000);
+    return matrix.wireFrame();
+}
+
+// Distinct colours in the frame
+size_t colours(const LedMatrix::WireFrame& frame)
+{
+    std::set<uint32_t> seen;
+    for (size_t i = 0; i < frame.size(); i += 3)
+    {
+        seen.insert(frame[i] << 16 | frame[i + 1] << 8 | frame[i + 2]);
+    }
+    return seen.size();
+}
+}  // namespace
+
+TEST(EffectTest, SineTableIsASine)
+{
+    using EffectMath::sin8;
+    EXPECT_EQ(sin8(0), 128);
+    EXPECT_EQ(sin8(64), 255);
+    EXPECT_EQ(sin8(128), 128);
+    EXPECT_EQ(sin8(192), 1);
+    for (int i = 1; i < 64; ++i)
+    {
+        EXPECT_GE(sin8(i), sin8(i - 1));
+        EXPECT_EQ(sin8(i) - 128, 128 - sin8(256 - i)) << i;
+    }
+}
+
+TEST(EffectTest, NoiseIsSmooth)
+{
+    // Neighbours 1/16 cell apart differ by far less than the full range
+    for (uint32_t x = 0; x < 16 * 256; x += 16)
+    {
+        const int a = EffectMath::noise8(x, 300, 700);
+        const int b = EffectMath::noise8(x + 16, 300, 700);
+        EXPECT_LE(std::abs(a - b), 48) << "x " << x;
+    }
+}
+
+TEST(EffectTest, EveryEffectMovesAndHasDetail)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    for (Kind kind: allKinds)
+    {
+        EffectRenderer<LedMatrix> effect{ { kind, {} } };
+        renderAt(effect, matrix, 0);
+        const auto early = renderAt(effect, matrix, 1000);
+        const auto late = renderAt(effect, matrix, 3000);
+        EXPECT_NE(early, late) << Effect::toString(kind);
+        EXPECT_GT(colours(late), 2u) << Effect::toString(kind);
+    }
+}
+
+TEST(EffectTest, SameSettingsRenderTheSame)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    for (Kind kind: allKinds)
+    {
+        EffectRenderer<LedMatrix> a{ { kind, {} } };
+        EffectRenderer<LedMatrix> b{ { kind, {} } };
+        for (uint32_t t = 0; t <= 1000; t += 20)
+        {
+            ASSERT_EQ(renderAt(a, matrix, t), renderAt(b, matrix, t))
+                << Effect::toString(kind) << " at " << t;
+        }
+    }
+}
+
+TEST(EffectTest, FireIsHotterAtTheBottom)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    EffectRenderer<LedMatrix> fire{ { Kind::Fire, {} } };
+    uint32_t top = 0, bottom = 0;
+    for (uint32_t t = 0; t <= 2000; t += 20)
+    {
+        renderAt(fire, matrix, t);
+        for (uint16_t x = 0; x < LedMatrix::width; ++x)
+        {
+            const auto hot = matrix.wirePixel(x, LedMatrix::height - 1);
+            const auto cold = matrix.wirePixel(x, 0);
+            bottom += hot.r + hot.g;
+            top += cold.r + cold.g;
+        }
+    }
+    EXPECT_GT(bottom, 4 * top);
+}
+
+TEST(EffectTest, TuningChangesTheColours)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    EffectRenderer<LedMatrix> life{ { Kind::Life, {} } };
+    renderAt(life, matrix, 0);
+    // Green by default, only living cells are at full level
+    bool anyGreen = false;
+    for (uint16_t x = 0; x < LedMatrix::width; ++x)
+    {
+        anyGreen |= matrix.wirePixel(x, 3).g > 0;
+        EXPECT_EQ(matrix.wirePixel(x, 3).r, 0);
+    }
+    EXPECT_TRUE(anyGreen);
+
+    Effect::Params red{};
+    red.r = 255;
+    red.g = 0;
+    red.b = 0;
+    life.tune(red);
+    renderAt(life, matrix, 0);
+    for (uint16_t x = 0; x < LedMatrix::width; ++x)
+    {
+        EXPECT_EQ(matrix.wirePixel(x, 3).g, 0);
+    }
+}
+
+TEST(EffectTest, AnimatorPlaysEffectsWithoutStoredFrames)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+    auto& pool = FramePool<MatrixAnimator<LedMatrix>::Frame>::instance();
+    auto inUse = [&pool]
+    {
+        const auto stats = pool.stats();
+        return stats.blocks - stats.freeBlocks;
+    };
+    const uint32_t pooled = inUse();
+
+    ASSERT_TRUE(animator.play({ Kind::Plasma, {} }));
+    vTaskDelay(pdMS_TO_TICKS(300));
+    EXPECT_EQ(inUse(), pooled);
+    ASSERT_TRUE(animator.effect().has_value());
+    EXPECT_EQ(animator.effect()->kind, Kind::Plasma);
+
+    Effect::Params faster{};
+    faster.speed = 255;
+    EXPECT_TRUE(animator.tune(faster));
+    EXPECT_EQ(animator.effect()->params.speed, 255);
+    animator.stop();
+    EXPECT_FALSE(animator.effect().has_value());
+
+    // About one frame every Effect::frameMs, and each one different
+    const auto frames = Ws2812Sink::instance().frames();
+    EXPECT_GE(frames.size(), 8u);
+    for (size_t i = 1; i < frames.size(); ++i)
+    {
+        EXPECT_NE(frames[i].grb, frames[i - 1].grb) << "frame " << i;
+    }
+}
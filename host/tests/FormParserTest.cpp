@@ -0,0 +1,33 @@
+#include "FormParser.hpp"
+
+#include <gtest/gtest.h>
+
+using EspHttpServer::FormParser;
+
+TEST(FormParserTest, ParsesFields)
+{
+    FormParser parser{ "ssid=home&password=secret" };
+    EXPECT_EQ(parser.get("ssid"), "home");
+    EXPECT_EQ(parser.get("password"), "secret");
+    EXPECT_FALSE(parser.get("missing").has_value());
+}
+
+TEST(FormParserTest, DecodesUrlEncoding)
+{
+    FormParser parser{ "ssid=my+home%21&password=a%26b" };
+    EXPECT_EQ(parser.get("ssid"), "my home!");
+    EXPECT_EQ(parser.get("password"), "a&b");
+}
+
+TEST(FormParserTest, StopsAtMalformedField)
+{
+    FormParser parser{ "ssid=home&broken&password=secret" };
+    EXPECT_EQ(parser.get("ssid"), "home");
+    EXPECT_FALSE(parser.get("password").has_value());
+}
+
+TEST(FormParserTest, TruncatesToBufferSize)
+{
+    FormParser<8> parser{ "key=0123456789" };
+    EXPECT_EQ(parser.get("key"), "012");
+}
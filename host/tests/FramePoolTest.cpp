@@ -0,0 +1,110 @@
+#include "FramePool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+namespace
+{
+// Own frame type, so these tests get a pool of their own
+using Frame = std::array<uint8_t, 48>;
+using Sequence = FrameSequence<Frame, 4>;
+
+Frame makeFrame(uint8_t value)
+{
+    Frame frame;
+    frame.fill(value);
+    return frame;
+}
+}  // namespace
+
+TEST(FramePoolTest, SequenceSpansBlocks)
+{
+    Sequence frames;
+    for (uint8_t i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(frames.push_back(makeFrame(i)));
+    }
+    EXPECT_EQ(frames.size(), 10u);
+    EXPECT_EQ(frames.capacity(), 12u);
+
+    uint8_t expected = 0;
+    for (const auto& frame: frames)
+    {
+        EXPECT_EQ(frame[0], expected);
+        EXPECT_EQ(frame[47], expected);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 10);
+
+    ASSERT_EQ(frames.blockCount(), 3u);
+    EXPECT_EQ(frames.block(0).size(), 4u);
+    EXPECT_EQ(frames.block(2).size(), 2u);
+    EXPECT_EQ(frames.block(2)[1][0], 9);
+    EXPECT_EQ(&frames.block(1)[0], &frames[4]);
+}
+
+TEST(FramePoolTest, ReleasedBlocksAreReused)
+{
+    auto& pool = Sequence::Pool::instance();
+    pool.trim();
+    {
+        Sequence frames;
+        ASSERT_TRUE(frames.reserve(8));
+        EXPECT_EQ(pool.stats().blocks, 2u);
+        EXPECT_EQ(pool.stats().freeBlocks, 0u);
+    }
+    EXPECT_EQ(pool.stats().freeBlocks, 2u);
+
+    const auto allocations
+        = HeapStats::tagStats(HeapStats::AllocTag::Frames).allocations;
+    {
+        Sequence frames;
+        ASSERT_TRUE(frames.reserve(5));
+        EXPECT_EQ(pool.stats().freeBlocks, 0u);
+    }
+    EXPECT_EQ(
+        HeapStats::tagStats(HeapStats::AllocTag::Frames).allocations,
+        allocations);
+    EXPECT_EQ(pool.stats().blocks, 2u);
+
+    EXPECT_EQ(pool.trim(), 2u);
+    EXPECT_EQ(pool.stats().blocks, 0u);
+}
+
+TEST(FramePoolTest, IdleBlocksAreCapped)
+{
+    auto& pool = Sequence::Pool::instance();
+    pool.trim();
+    const size_t extra = 3;
+    {
+        Sequence frames;
+        ASSERT_TRUE(frames.reserve((Sequence::Pool::maxFreeBlocks + extra) * 4));
+        EXPECT_EQ(pool.stats().blocks, Sequence::Pool::maxFreeBlocks + extra);
+    }
+    // The peak is not kept, only what fits in maxIdleBytes
+    EXPECT_EQ(pool.stats().freeBlocks, Sequence::Pool::maxFreeBlocks);
+    EXPECT_EQ(pool.stats().blocks, Sequence::Pool::maxFreeBlocks);
+    EXPECT_LE(
+        Sequence::Pool::maxFreeBlocks * pool.stats().blockBytes,
+        Sequence::Pool::maxIdleBytes);
+    pool.trim();
+}
+
+TEST(FramePoolTest, MoveHandsOverBlocks)
+{
+    auto& pool = Sequence::Pool::instance();
+    Sequence a;
+    a.push_back(makeFrame(7));
+    const auto used = pool.stats().blocks - pool.stats().freeBlocks;
+
+    Sequence b = std::move(a);
+    EXPECT_TRUE(a.empty());
+    ASSERT_EQ(b.size(), 1u);
+    EXPECT_EQ(b[0][0], 7);
+    EXPECT_EQ(pool.stats().blocks - pool.stats().freeBlocks, used);
+
+    b.clear();
+    EXPECT_EQ(pool.stats().blocks - pool.stats().freeBlocks, used - 1);
+}
@@ -0,0 +1,129 @@
+#include "FrameStats.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+FrameStats::Sample sampleAt(uint32_t startUs, uint32_t renderUs)
+{
+    return { startUs, startUs + renderUs / 2, startUs + renderUs };
+}
+}  // namespace
+
+TEST(FrameStatsTest, CountsPeriodsAndDeadlineMisses)
+{
+    FrameStats stats;
+    stats.reset(50'000, 10'000);
+
+    stats.record(sampleAt(0, 3'000));
+    stats.record(sampleAt(50'000, 3'000));
+    stats.record(sampleAt(100'000, 3'000));
+    // Late by more than the slack
+    stats.record(sampleAt(170'000, 3'000));
+
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.intervalUs, 50'000u);
+    EXPECT_EQ(summary.frames, 4u);
+    EXPECT_EQ(summary.deadlineMisses, 1u);
+    EXPECT_EQ(summary.maxPeriodUs, 70'000u);
+    EXPECT_EQ(summary.maxRenderUs, 3'000u);
+
+    // 3 ms renders land in the (2, 5] ms bucket
+    EXPECT_EQ(summary.render[2], 4u);
+    // 50 ms periods in (20, 50] ms, the 70 ms one in (50, 100] ms
+    EXPECT_EQ(summary.period[5], 2u);
+    EXPECT_EQ(summary.period[6], 1u);
+}
+
+TEST(FrameStatsTest, HeldFramesAreNotDeadlineMisses)
+{
+    FrameStats stats;
+    stats.reset(50'000, 10'000);
+
+    stats.record(sampleAt(0, 3'000));
+    // Held for a second, then playing again
+    stats.restartPeriod();
+    stats.record(sampleAt(1'000'000, 3'000));
+    stats.record(sampleAt(1'050'000, 3'000));
+
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.frames, 3u);
+    EXPECT_EQ(summary.deadlineMisses, 0u);
+    EXPECT_EQ(summary.maxPeriodUs, 50'000u);
+    EXPECT_EQ(summary.period[5], 1u);
+}
+
+TEST(FrameStatsTest, PeriodSurvivesTimerWrapAround)
+{
+    FrameStats stats;
+    stats.reset(20'000, 0);
+    stats.record(sampleAt(UINT32_MAX - 5'000, 1'000));
+    stats.record(sampleAt(14'999, 1'000));
+
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.maxPeriodUs, 20'000u);
+    EXPECT_EQ(summary.deadlineMisses, 0u);
+}
+
+TEST(FrameStatsTest, RecentReturnsNewestSamplesInOrder)
+{
+    FrameStats stats;
+    stats.reset(10'000, 0);
+    for (uint32_t i = 0; i < FrameStats::historySize + 10; ++i)
+    {
+        stats.record(sampleAt(i * 10'000, 1'000));
+    }
+
+    std::array<FrameStats::Sample, 4> out;
+    ASSERT_EQ(stats.recent(out), out.size());
+    const uint32_t last = FrameStats::historySize + 9;
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        EXPECT_EQ(out[i].convertStartUs, (last - 3 + i) * 10'000);
+    }
+
+    std::array<FrameStats::Sample, FrameStats::historySize + 8> all;
+    EXPECT_EQ(stats.recent(all), FrameStats::historySize);
+}
+
+TEST(FrameStatsTest, ResetClearsCounters)
+{
+    FrameStats stats;
+    stats.reset(10'000, 0);
+    stats.record(sampleAt(0, 1'000));
+    stats.record(sampleAt(50'000, 1'000));
+    stats.reset(20'000, 0);
+
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.frames, 0u);
+    EXPECT_EQ(summary.deadlineMisses, 0u);
+    EXPECT_EQ(summary.intervalUs, 20'000u);
+
+    // The first frame after a reset has no period
+    stats.record(sampleAt(1'000'000, 1'000));
+    EXPECT_EQ(stats.summary().maxPeriodUs, 0u);
+}
+
+TEST(FrameStatsTest, ResetIsAppliedByNextRecord)
+{
+    FrameStats stats;
+    stats.reset(10'000, 0);
+    stats.record(sampleAt(0, 1'000));
+    stats.record(sampleAt(50'000, 1'000));
+
+    // Requested by another task, the counters are only cleared by the
+    // render task but snapshots already read as cleared
+    stats.reset(20'000, 5'000);
+    stats.setInterval(30'000);
+    EXPECT_EQ(stats.summary().frames, 0u);
+    EXPECT_EQ(stats.summary().intervalUs, 20'000u);
+
+    stats.record(sampleAt(60'000, 1'000));
+    stats.record(sampleAt(84'000, 1'000));
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.frames, 2u);
+    EXPECT_EQ(summary.intervalUs, 20'000u);
+    EXPECT_EQ(summary.maxPeriodUs, 24'000u);
+    // Within the new slack
+    EXPECT_EQ(summary.deadlineMisses, 0u);
+}
@@ -0,0 +1,390 @@
+#include "GifDecoder.hpp"
+
+#include <esp_heap_caps.h>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+using Color = GifDecoder::Color;
+
+namespace
+{
+constexpr uint16_t W = 16;
+constexpr uint16_t H = 16;
+
+struct Image
+{
+    uint16_t left{ 0 }, top{ 0 }, width{ 0 }, height{ 0 };
+    // Row by row, in display order
+    std::vector<uint8_t> indices;
+    uint16_t delayCs{ 0 };
+    uint8_t disposal{ 0 };
+    int transparent{ -1 };
+    bool interlaced{ false };
+};
+
+void put16(std::vector<uint8_t>& out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+// A plain LZW encoder, codes grow to 12 bits and the table is cleared
+// when full
+void lzw(std::vector<uint8_t>& out, const std::vector<uint8_t>& indices, uint8_t minimumCodeSize)
+{
+    const uint16_t clear = 1 << minimumCodeSize;
+    uint8_t codeSize = minimumCodeSize + 1;
+    uint16_t next = clear + 2;
+    std::map<std::pair<int, uint8_t>, uint16_t> table;
+    std::vector<uint8_t> data;
+    uint32_t bits = 0;
+    uint8_t bitCount = 0;
+    auto emit = [&](uint16_t code)
+    {
+        bits |= uint32_t{ code } << bitCount;
+        bitCount += codeSize;
+        while (bitCount >= 8)
+        {
+            data.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    };
+
+    emit(clear);
+    int prefix = -1;
+    for (uint8_t index: indices)
+    {
+        if (prefix < 0)
+        {
+            prefix = index;
+            continue;
+        }
+        auto found = table.find({ prefix, index });
+        if (found != table.end())
+        {
+            prefix = found->second;
+            continue;
+        }
+        emit(static_cast<uint16_t>(prefix));
+        if (next == 4096)
+        {
+            emit(clear);
+            table.clear();
+            codeSize = minimumCodeSize + 1;
+            next = clear + 2;
+        }
+        else
+        {
+            if (next == (1u << codeSize) && codeSize < 12)
+            {
+                ++codeSize;
+            }
+            table[{ prefix, index }] = next++;
+        }
+        prefix = index;
+    }
+    if (prefix >= 0)
+    {
+        emit(static_cast<uint16_t>(prefix));
+    }
+    emit(clear + 1);
+    if (bitCount > 0)
+    {
+        data.push_back(static_cast<uint8_t>(bits));
+    }
+
+    out.push_back(minimumCodeSize);
+    for (size_t i = 0; i < data.size(); i += 255)
+    {
+        const size_t size = std::min<size_t>(255, data.size() - i);
+        out.push_back(static_cast<uint8_t>(size));
+        out.insert(out.end(), data.begin() + i, data.begin() + i + size);
+    }
+    out.push_back(0);
+}
+
+std::vector<uint8_t> makeGif(
+    uint16_t width, uint16_t height, const std::vector<Color>& palette, const std::vector<Image>& images)
+{
+    std::vector<uint8_t> out{ 'G', 'I', 'F', '8', '9', 'a' };
+    put16(out, width);
+    put16(out, height);
+    // Global table of 256 colours
+    out.push_back(0x87);
+    out.push_back(0);
+    out.push_back(0);
+    for (size_t i = 0; i < 256; ++i)
+    {
+        const Color c = i < palette.size() ? palette[i] : Color{ 0, 0, 0 };
+        out.insert(out.end(), { c.r, c.g, c.b });
+    }
+
+    for (const Image& image: images)
+    {
+        out.insert(out.end(), { 0x21, 0xF9, 4 });
+        out.push_back(static_cast<uint8_t>(image.disposal << 2 | (image.transparent >= 0)));
+        put16(out, image.delayCs);
+        out.push_back(static_cast<uint8_t>(std::max(image.transparent, 0)));
+        out.push_back(0);
+
+        out.push_back(0x2C);
+        put16(out, image.left);
+        put16(out, image.top);
+        put16(out, image.width);
+        put16(out, image.height);
+        out.push_back(image.interlaced ? 0x40 : 0);
+
+        std::vector<uint8_t> rows = image.indices;
+        if (image.interlaced)
+        {
+            rows.clear();
+            for (auto [start, step]: { std::pair{ 0, 8 }, { 4, 8 }, { 2, 4 }, { 1, 2 } })
+            {
+                for (int y = start; y < image.height; y += step)
+                {
+                    rows.insert(
+                        rows.end(),
+                        image.indices.begin() + y * image.width,
+                        image.indices.begin() + (y + 1) * image.width);
+                }
+            }
+        }
+        lzw(out, rows, 8);
+    }
+    out.push_back(0x3B);
+    return out;
+}
+
+struct Decoded
+{
+    std::vector<std::vector<Color>> frames;
+    std::vector<uint32_t> delays;
+    bool done{ false };
+};
+
+// Feeds the GIF chunk bytes at a time
+Decoded decode(const std::vector<uint8_t>& gif, size_t chunk = 4096)
+{
+    Decoded decoded;
+    GifDecoder decoder{ W,
+                        H,
+                        [&](std::span<const Color> frame, uint32_t delayMs)
+                        {
+                            decoded.frames.emplace_back(frame.begin(), frame.end());
+                            decoded.delays.push_back(delayMs);
+                            return true;
+                        } };
+    for (size_t i = 0; i < gif.size(); i += chunk)
+    {
+        EXPECT_TRUE(decoder.feed(gif.data() + i, std::min(chunk, gif.size() - i)))
+            << decoder.error();
+    }
+    decoded.done = decoder.done();
+    return decoded;
+}
+
+bool same(const Color& a, const Color& b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+const std::vector<Color> palette{ { 0, 0, 0 }, { 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 }, { 255, 255, 255 } };
+
+// A full screen image of index(x, y)
+template<typename F> Image fill(uint16_t width, uint16_t height, F&& index)
+{
+    Image image{ 0, 0, width, height, {}, 0, 0, -1, false };
+    for (uint16_t y = 0; y < height; ++y)
+    {
+        for (uint16_t x = 0; x < width; ++x)
+        {
+            image.indices.push_back(static_cast<uint8_t>(index(x, y)));
+        }
+    }
+    return image;
+}
+}  // namespace
+
+TEST(GifDecoderTest, DecodesAFrameAtTheOutputSize)
+{
+    // Runs of one colour make codes that are not in the table yet
+    Image image = fill(W, H, [](int x, int y) { return (x / 4 + y) % 5; });
+    image.delayCs = 5;
+    const auto decoded = decode(makeGif(W, H, palette, { image }));
+    ASSERT_TRUE(decoded.done);
+    ASSERT_EQ(decoded.frames.size(), 1u);
+    EXPECT_EQ(decoded.delays[0], 50u);
+    for (size_t i = 0; i < size_t{ W } * H; ++i)
+    {
+        ASSERT_TRUE(same(decoded.frames[0][i], palette[image.indices[i]])) << i;
+    }
+}
+
+TEST(GifDecoderTest, StreamingMatchesWholeBuffer)
+{
+    const auto gif = makeGif(W, H, palette, { fill(W, H, [](int x, int y) { return (x * y) % 5; }) });
+    const auto whole = decode(gif);
+    const auto bytewise = decode(gif, 1);
+    ASSERT_TRUE(bytewise.done);
+    ASSERT_EQ(bytewise.frames.size(), 1u);
+    EXPECT_TRUE(std::equal(
+        whole.frames[0].begin(), whole.frames[0].end(), bytewise.frames[0].begin(), same));
+}
+
+TEST(GifDecoderTest, LargeImagesAreAveraged)
+{
+    // 64x64: 4x4 blocks of one colour, and a fine checkerboard on the right
+    Image image = fill(
+        64,
+        64,
+        [](int x, int y) { return x < 32 ? 1 + (x / 4 + y / 4) % 3 : ((x + y) % 2 ? 4 : 0); });
+    const auto decoded = decode(makeGif(64, 64, palette, { image }));
+    ASSERT_TRUE(decoded.done);
+    const auto& frame = decoded.frames.at(0);
+    EXPECT_TRUE(same(frame[0], palette[1]));
+    EXPECT_TRUE(same(frame[1], palette[2]));
+    // Block (2, 1)
+    EXPECT_TRUE(same(frame[W + 2], palette[1]));
+    // Half white, half black
+    EXPECT_EQ(frame[12].r, 128);
+    EXPECT_EQ(frame[12].b, 128);
+}
+
+TEST(GifDecoderTest, FullTablesAreCleared)
+{
+    // Noise over 256 colours makes far more than 4096 codes
+    std::vector<Color> grey(256);
+    for (size_t i = 0; i < grey.size(); ++i)
+    {
+        grey[i] = { static_cast<uint8_t>(i), static_cast<uint8_t>(i), static_cast<uint8_t>(i) };
+    }
+    uint32_t state = 1;
+    Image image = fill(
+        128,
+        128,
+        [&](int, int)
+        {
+            state = state * 1664525 + 1013904223;
+            return state >> 24;
+        });
+    const auto decoded = decode(makeGif(128, 128, grey, { image }));
+    ASSERT_TRUE(decoded.done);
+
+    // Every output pixel is the mean of its 8x8 block
+    const auto& frame = decoded.frames.at(0);
+    for (uint16_t ty = 0; ty < H; ++ty)
+    {
+        for (uint16_t tx = 0; tx < W; ++tx)
+        {
+            uint32_t sum = 0;
+            for (int y = 0; y < 8; ++y)
+            {
+                for (int x = 0; x < 8; ++x)
+                {
+                    sum += image.indices[(ty * 8 + y) * 128 + tx * 8 + x];
+                }
+            }
+            ASSERT_EQ(frame[ty * W + tx].r, (sum + 32) / 64) << tx << " " << ty;
+        }
+    }
+}
+
+TEST(GifDecoderTest, SmallImagesAreScaledUp)
+{
+    const Image image = fill(8, 8, [](int x, int y) { return 1 + (x + y) % 3; });
+    const auto decoded = decode(makeGif(8, 8, palette, { image }));
+    ASSERT_TRUE(decoded.done);
+    const auto& frame = decoded.frames.at(0);
+    for (uint16_t y = 0; y < H; ++y)
+    {
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            ASSERT_TRUE(same(frame[y * W + x], palette[image.indices[(y / 2) * 8 + x / 2]]));
+        }
+    }
+}
+
+TEST(GifDecoderTest, InterlacedImagesLandOnTheirRows)
+{
+    Image plain = fill(W, H, [](int x, int y) { return (x + 3 * y) % 5; });
+    Image interlaced = plain;
+    interlaced.interlaced = true;
+    const auto expected = decode(makeGif(W, H, palette, { plain }));
+    const auto decoded = decode(makeGif(W, H, palette, { interlaced }));
+    ASSERT_TRUE(decoded.done);
+    EXPECT_TRUE(std::equal(
+        expected.frames[0].begin(), expected.frames[0].end(), decoded.frames[0].begin(), same));
+}
+
+TEST(GifDecoderTest, ComposesTransparencyAndDisposal)
+{
+    Image background = fill(W, H, [](int, int) { return 1; });
+    background.delayCs = 0;
+    // A 2x2 patch, its right column transparent, cleared afterwards
+    Image patch{ 4, 4, 2, 2, { 2, 0, 2, 0 }, 10, 2, 0 };
+    // Draws nothing, shows what the disposal left
+    Image empty{ 0, 0, 1, 1, { 0 }, 10, 0, 0 };
+
+    const auto decoded = decode(makeGif(W, H, palette, { background, patch, empty }));
+    ASSERT_TRUE(decoded.done);
+    ASSERT_EQ(decoded.frames.size(), 3u);
+    // Delays under 20 ms are shown like browsers do
+    EXPECT_EQ(decoded.delays[0], GifDecoder::defaultDelayMs);
+    EXPECT_EQ(decoded.delays[1], 100u);
+
+    const auto& second = decoded.frames[1];
+    EXPECT_TRUE(same(second[4 * W + 4], palette[2]));
+    EXPECT_TRUE(same(second[4 * W + 5], palette[1]));
+    EXPECT_TRUE(same(second[0], palette[1]));
+
+    const auto& third = decoded.frames[2];
+    EXPECT_TRUE(same(third[4 * W + 4], palette[0]));
+    EXPECT_TRUE(same(third[4 * W + 5], palette[0]));
+    EXPECT_TRUE(same(third[4 * W + 6], palette[1]));
+}
+
+TEST(GifDecoderTest, RejectsBrokenInput)
+{
+    GifDecoder decoder{ W, H, [](std::span<const Color>, uint32_t) { return true; } };
+    const uint8_t png[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    EXPECT_FALSE(decoder.feed(png, sizeof(png)));
+    EXPECT_STREQ(decoder.error(), "not a GIF");
+
+    // Cut off in the middle: no error, but not done either
+    auto gif = makeGif(W, H, palette, { fill(W, H, [](int, int) { return 1; }) });
+    gif.resize(gif.size() / 2);
+    EXPECT_FALSE(decode(gif).done);
+
+    // The callback stops decoding
+    size_t calls = 0;
+    GifDecoder stopping{ W,
+                         H,
+                         [&](std::span<const Color>, uint32_t)
+                         {
+                             ++calls;
+                             return false;
+                         } };
+    const auto two = makeGif(
+        W, H, palette, { fill(W, H, [](int, int) { return 1; }), fill(W, H, [](int, int) { return 2; }) });
+    EXPECT_FALSE(stopping.feed(two.data(), two.size()));
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST(GifDecoderTest, ReportsThatTheBuffersDidNotFit)
+{
+    EXPECT_TRUE(GifDecoder(W, H, [](std::span<const Color>, uint32_t) { return true; }).ok());
+
+    // The sums of a 256x256 output take 1 MiB
+    HostSim::setMaxAllocation(512 * 1024);
+    GifDecoder decoder{ 256, 256, [](std::span<const Color>, uint32_t) { return true; } };
+    HostSim::setMaxAllocation(0);
+    EXPECT_FALSE(decoder.ok());
+    const auto gif = makeGif(W, H, palette, { fill(W, H, [](int, int) { return 1; }) });
+    EXPECT_FALSE(decoder.feed(gif.data(), gif.size()));
+    EXPECT_STREQ(decoder.error(), "out of memory");
+}
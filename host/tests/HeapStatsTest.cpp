@@ -0,0 +1,87 @@
+#include "HeapStats.hpp"
+#include "PSRAMallocator.hpp"
+
+#include <esp_heap_caps.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using HeapStats::AllocTag;
+
+TEST(HeapStatsTest, BytesAndPeakFollowAllocations)
+{
+    const auto before = HeapStats::tagStats(AllocTag::Other);
+
+    void* a = HeapStats::allocate(1000, AllocTag::Other, true);
+    void* b = HeapStats::allocate(3000, AllocTag::Other, true);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    const uint32_t sizeA = heap_caps_get_allocated_size(a);
+    const uint32_t sizeB = heap_caps_get_allocated_size(b);
+
+    auto during = HeapStats::tagStats(AllocTag::Other);
+    EXPECT_EQ(during.bytes - before.bytes, sizeA + sizeB);
+    EXPECT_EQ(during.allocations - before.allocations, 2u);
+    EXPECT_GE(during.peakBytes, during.bytes);
+
+    HeapStats::deallocate(a, AllocTag::Other);
+    HeapStats::deallocate(b, AllocTag::Other);
+    auto after = HeapStats::tagStats(AllocTag::Other);
+    EXPECT_EQ(after.bytes, before.bytes);
+    EXPECT_EQ(after.peakBytes, during.peakBytes);
+}
+
+TEST(HeapStatsTest, FallbackToInternalIsCounted)
+{
+    const auto before = HeapStats::tagStats(AllocTag::Http);
+
+    HostSim::setSpiramAvailable(false);
+    void* p = HeapStats::allocate(64, AllocTag::Http, true);
+    void* q = HeapStats::allocate(64, AllocTag::Http, false);
+    HostSim::setSpiramAvailable(true);
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(q, nullptr);
+
+    auto stats = HeapStats::tagStats(AllocTag::Http);
+    // Only the allocation that asked for PSRAM fell back
+    EXPECT_EQ(stats.psramFallbacks - before.psramFallbacks, 1u);
+    HeapStats::deallocate(p, AllocTag::Http);
+    HeapStats::deallocate(q, AllocTag::Http);
+}
+
+TEST(HeapStatsTest, TransferMovesAccounting)
+{
+    const auto storage = HeapStats::tagStats(AllocTag::Storage).bytes;
+    const auto animator = HeapStats::tagStats(AllocTag::Animator).bytes;
+
+    void* p = HeapStats::allocate(500, AllocTag::Storage, true);
+    const uint32_t size = heap_caps_get_allocated_size(p);
+    HeapStats::transfer(p, AllocTag::Storage, AllocTag::Animator);
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Storage).bytes, storage);
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Animator).bytes, animator + size);
+
+    HeapStats::deallocate(p, AllocTag::Animator);
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Animator).bytes, animator);
+}
+
+TEST(HeapStatsTest, AllocatorTagFollowsTheContainer)
+{
+    using Vector = std::vector<int, PSRAMAllocator<int>>;
+    const auto before = HeapStats::tagStats(AllocTag::Json).bytes;
+    {
+        Vector tagged{ PSRAMAllocator<int>{ AllocTag::Json } };
+        tagged.resize(100);
+        EXPECT_GT(HeapStats::tagStats(AllocTag::Json).bytes, before);
+
+        // Move assignment takes the buffer and the tag along
+        Vector other;
+        other = std::move(tagged);
+        EXPECT_EQ(other.get_allocator().tag(), AllocTag::Json);
+
+        // Rebinding keeps the tag
+        PSRAMAllocator<char> rebound{ other.get_allocator() };
+        EXPECT_EQ(rebound.tag(), AllocTag::Json);
+    }
+    EXPECT_EQ(HeapStats::tagStats(AllocTag::Json).bytes, before);
+}
@@ -0,0 +1,112 @@
+#include "HttpMetrics.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using EspHttpServer::HttpMetrics;
+
+namespace
+{
+std::string render(const HttpMetrics& metrics)
+{
+    std::string out;
+    EXPECT_TRUE(metrics.writePrometheus(
+        [&out](const char* data, size_t size)
+        {
+            out.append(data, size);
+            return true;
+        }));
+    return out;
+}
+}  // namespace
+
+TEST(HttpMetricsTest, RoutesAreReusedAndBounded)
+{
+    HttpMetrics metrics;
+    auto* matrix = metrics.add("/matrix", "POST");
+    ASSERT_NE(matrix, nullptr);
+    EXPECT_EQ(metrics.add("/matrix", "POST"), matrix);
+    EXPECT_NE(metrics.add("/matrix", "GET"), matrix);
+
+    static char names[HttpMetrics::maxRoutes][8];
+    for (size_t i = metrics.size(); i < HttpMetrics::maxRoutes; ++i)
+    {
+        snprintf(names[i], sizeof(names[i]), "/r%zu", i);
+        ASSERT_NE(metrics.add(names[i], "GET"), nullptr);
+    }
+    EXPECT_EQ(metrics.add("/one-too-many", "GET"), nullptr);
+    EXPECT_EQ(metrics.add("/matrix", "POST"), matrix);
+}
+
+TEST(HttpMetricsTest, PrometheusTextFormat)
+{
+    HttpMetrics metrics;
+    auto* route = metrics.add("/matrix", "POST");
+    route->record(200, 100, 2, 3'000);
+    route->record(200, 100, 2, 30'000);
+    route->record(400, 5, 12, 2'000'000);
+
+    const auto text = render(metrics);
+    auto contains = [&text](const char* line)
+    {
+        return text.find(line) != std::string::npos;
+    };
+
+    EXPECT_TRUE(contains("# TYPE http_requests_total counter\n"));
+    EXPECT_TRUE(contains(
+        "http_requests_total{route=\"/matrix\",method=\"POST\",status=\"2xx\"} 2\n"));
+    EXPECT_TRUE(contains(
+        "http_requests_total{route=\"/matrix\",method=\"POST\",status=\"4xx\"} 1\n"));
+    EXPECT_TRUE(contains(
+        "http_requests_total{route=\"/matrix\",method=\"POST\",status=\"5xx\"} 0\n"));
+    EXPECT_TRUE(contains(
+        "http_request_bytes_total{route=\"/matrix\",method=\"POST\"} 205\n"));
+    EXPECT_TRUE(contains(
+        "http_response_bytes_total{route=\"/matrix\",method=\"POST\"} 16\n"));
+
+    // Buckets are cumulative
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_bucket{route=\"/matrix\",method=\"POST\",le=\"0.001\"} 0\n"));
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_bucket{route=\"/matrix\",method=\"POST\",le=\"0.005\"} 1\n"));
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_bucket{route=\"/matrix\",method=\"POST\",le=\"0.05\"} 2\n"));
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_bucket{route=\"/matrix\",method=\"POST\",le=\"1\"} 2\n"));
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_bucket{route=\"/matrix\",method=\"POST\",le=\"+Inf\"} 3\n"));
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_sum{route=\"/matrix\",method=\"POST\"} 2.033\n"));
+    EXPECT_TRUE(contains(
+        "http_request_duration_seconds_count{route=\"/matrix\",method=\"POST\"} 3\n"));
+}
+
+TEST(HttpMetricsTest, LatencySumOutlastsAnHourOfHandlerTime)
+{
+    HttpMetrics metrics;
+    auto* upload = metrics.add("/upload-gif", "POST");
+    // 100 minutes, which wrapped a sum in microseconds
+    for (int i = 0; i < 1'000; ++i)
+    {
+        upload->record(200, 0, 2, 6'000'000);
+    }
+    EXPECT_NE(
+        render(metrics).find(
+            "http_request_duration_seconds_sum{route=\"/upload-gif\",method=\"POST\"} 6000.000\n"),
+        std::string::npos);
+}
+
+TEST(HttpMetricsTest, WriterCanAbort)
+{
+    HttpMetrics metrics;
+    metrics.add("/", "GET")->record(200, 0, 10, 100);
+    size_t calls = 0;
+    EXPECT_FALSE(metrics.writePrometheus(
+        [&calls](const char*, size_t)
+        {
+            ++calls;
+            return false;
+        }));
+    EXPECT_EQ(calls, 1u);
+}
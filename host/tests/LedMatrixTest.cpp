@@ -0,0 +1,133 @@
+#include "LedMatrix.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <esp_timer.h>
+
+#include <gtest/gtest.h>
+
+#include <tuple>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+class LedMatrixTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        Ws2812Sink::instance().clear();
+        Ws2812Sink::instance().setRealtime(false);
+    }
+};
+}  // namespace
+
+TEST_F(LedMatrixTest, UpdateTransmitsGrbFrame)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    matrix.clear();
+    ASSERT_TRUE(matrix.update());
+
+    auto frame = Ws2812Sink::instance().lastFrame();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->gpio, GPIO_NUM_6);
+    EXPECT_EQ(frame->grb.size(), LedMatrix::numPixels * 3);
+    for (auto byte: frame->grb)
+    {
+        EXPECT_EQ(byte, 0);
+    }
+}
+
+TEST_F(LedMatrixTest, ChannelsAreSentGreenRedBlue)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    const LedMatrix::RGB color{ 255, 128, 0 };
+    matrix.fill(color);
+    ASSERT_TRUE(matrix.update());
+
+    const auto corrected = color.scaleAndGammaCorrect();
+    auto frame = Ws2812Sink::instance().lastFrame();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->grb[0], corrected.g);
+    EXPECT_EQ(frame->grb[1], corrected.r);
+    EXPECT_EQ(frame->grb[2], corrected.b);
+}
+
+TEST_F(LedMatrixTest, BrightnessIsLimited)
+{
+    const LedMatrix::RGB white{ 255, 255, 255 };
+    const auto corrected = white.scaleAndGammaCorrect();
+    EXPECT_LE(corrected.r, 70);
+    EXPECT_LE(corrected.g, 70);
+    EXPECT_LE(corrected.b, 70);
+    EXPECT_EQ(std::max({ corrected.r, corrected.g, corrected.b }), 70);
+}
+
+TEST_F(LedMatrixTest, FastCorrectionIsWithinOneStep)
+{
+    // A coarse walk through the colour cube, with the channels apart
+    for (int r = 0; r < 256; r += 5)
+    {
+        for (int g = 0; g < 256; g += 7)
+        {
+            for (int b = 0; b < 256; b += 11)
+            {
+                const LedMatrix::RGB color{ static_cast<uint8_t>(r),
+                                            static_cast<uint8_t>(g),
+                                            static_cast<uint8_t>(b) };
+                const auto exact = LedMatrix::toWire(color);
+                const auto fast = LedMatrix::toWireFast(color);
+                ASSERT_LE(std::abs(exact.r - fast.r), 1) << r << " " << g << " " << b;
+                ASSERT_LE(std::abs(exact.g - fast.g), 1) << r << " " << g << " " << b;
+                ASSERT_LE(std::abs(exact.b - fast.b), 1) << r << " " << g << " " << b;
+            }
+        }
+    }
+}
+
+TEST_F(LedMatrixTest, PixelsFollowRotatedSerpentineLayout)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+
+    // The panel is rotated by 270 degrees, columns become physical rows
+    // and odd physical rows run in reverse
+    const std::array<std::tuple<uint16_t, uint16_t, size_t>, 4> cases{ {
+        { 0, 0, 0 },
+        { 0, 5, 5 },
+        { 1, 0, 31 },
+        { 2, 3, 35 },
+    } };
+    for (const auto& [x, y, expected]: cases)
+    {
+        matrix.clear();
+        matrix.setPixel(x, y, { 255, 255, 255 });
+        ASSERT_TRUE(matrix.update());
+
+        auto frame = Ws2812Sink::instance().lastFrame();
+        ASSERT_TRUE(frame.has_value());
+        for (size_t i = 0; i < LedMatrix::numPixels; ++i)
+        {
+            EXPECT_EQ(frame->grb[3 * i] != 0, i == expected)
+                << "(" << x << ", " << y << ") pixel " << i;
+        }
+    }
+}
+
+TEST_F(LedMatrixTest, RealtimeSinkTakesWireTime)
+{
+    Ws2812Sink::instance().setRealtime(true);
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    ASSERT_TRUE(matrix.update());
+
+    auto frame = Ws2812Sink::instance().lastFrame();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(
+        frame->doneUs - frame->startUs,
+        Ws2812Sink::wireTimeUs(LedMatrix::numPixels * 3));
+    EXPECT_GE(esp_timer_get_time(), frame->doneUs);
+}
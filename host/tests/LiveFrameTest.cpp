@@ -0,0 +1,153 @@
+#include "LedMatrix.hpp"
+#include "LiveFrame.hpp"
+#include "MatrixAnimator.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <esp_timer.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+using Live = LiveFrame<LedMatrix>;
+
+std::vector<uint8_t> frameMessage(LedMatrix::RGB color)
+{
+    std::vector<uint8_t> message{ static_cast<uint8_t>(Live::Message::Frame) };
+    for (size_t i = 0; i < LedMatrix::numPixels; ++i)
+    {
+        message.insert(message.end(), { color.r, color.g, color.b });
+    }
+    return message;
+}
+
+std::vector<uint8_t> pixelsMessage(
+    std::initializer_list<std::pair<uint16_t, LedMatrix::RGB>> pixels)
+{
+    std::vector<uint8_t> message{ static_cast<uint8_t>(Live::Message::Pixels) };
+    for (const auto& [index, color]: pixels)
+    {
+        message.insert(
+            message.end(),
+            { static_cast<uint8_t>(index),
+              static_cast<uint8_t>(index >> 8),
+              color.r,
+              color.g,
+              color.b });
+    }
+    return message;
+}
+
+bool sameWire(LedMatrix::WireColor a, LedMatrix::WireColor b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+}  // namespace
+
+TEST(LiveFrameTest, AppliesFramesAndPixels)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    Live live;
+    live.render(matrix);
+    EXPECT_TRUE(sameWire(matrix.wirePixel(3, 4), LedMatrix::toWireFast({ 0, 0, 0 })));
+
+    ASSERT_TRUE(live.apply(frameMessage({ 10, 20, 30 })));
+    ASSERT_TRUE(live.apply(pixelsMessage({ { 0, { 255, 0, 0 } }, { 17, { 0, 0, 255 } } })));
+    live.render(matrix);
+    EXPECT_TRUE(sameWire(matrix.wirePixel(0, 0), LedMatrix::toWireFast({ 255, 0, 0 })));
+    // Logical order, row by row
+    EXPECT_TRUE(sameWire(matrix.wirePixel(1, 1), LedMatrix::toWireFast({ 0, 0, 255 })));
+    EXPECT_TRUE(sameWire(matrix.wirePixel(15, 15), LedMatrix::toWireFast({ 10, 20, 30 })));
+
+    // No pixels is a valid (empty) change
+    EXPECT_TRUE(live.apply(pixelsMessage({})));
+}
+
+TEST(LiveFrameTest, RejectsMalformedMessagesWhole)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    Live live;
+    ASSERT_TRUE(live.apply(frameMessage({ 10, 20, 30 })));
+
+    auto shortFrame = frameMessage({ 255, 255, 255 });
+    shortFrame.pop_back();
+    auto partialPixel = pixelsMessage({ { 1, { 255, 255, 255 } } });
+    partialPixel.push_back(0);
+    EXPECT_FALSE(live.apply({}));
+    EXPECT_FALSE(live.apply(std::vector<uint8_t>{ 0x7F, 1, 2, 3 }));
+    EXPECT_FALSE(live.apply(shortFrame));
+    EXPECT_FALSE(live.apply(partialPixel));
+    // The valid pixel before the bad index is not applied either
+    EXPECT_FALSE(live.apply(pixelsMessage(
+        { { 0, { 255, 255, 255 } }, { LedMatrix::numPixels, { 255, 255, 255 } } })));
+
+    live.render(matrix);
+    for (uint16_t y = 0; y < LedMatrix::height; ++y)
+    {
+        for (uint16_t x = 0; x < LedMatrix::width; ++x)
+        {
+            EXPECT_TRUE(sameWire(matrix.wirePixel(x, y), LedMatrix::toWireFast({ 10, 20, 30 })));
+        }
+    }
+}
+
+TEST(LiveFrameTest, AnimatorShowsChangesOnlyWhenTheyArrive)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+
+    EXPECT_FALSE(animator.draw(std::vector<uint8_t>{ 0x7F }));
+    ASSERT_TRUE(animator.draw(frameMessage({ 0, 0, 0 })));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    // The frame is held, not sent over and over
+    const size_t shown = Ws2812Sink::instance().frameCount();
+    EXPECT_GE(shown, 1u);
+    EXPECT_LE(shown, 2u);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    EXPECT_EQ(Ws2812Sink::instance().frameCount(), shown);
+
+    // A change goes out right away, not with the next hold poll
+    const int64_t drawnUs = esp_timer_get_time();
+    ASSERT_TRUE(animator.draw(pixelsMessage({ { 0, { 255, 255, 255 } } })));
+    vTaskDelay(pdMS_TO_TICKS(Live::frameMs * 2));
+    animator.stop();
+
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_GT(frames.size(), shown);
+    const auto& changed = frames[shown];
+    EXPECT_LT(changed.startUs - drawnUs, 20'000);
+    EXPECT_EQ(changed.grb[3 * matrix.index(0, 0)], LedMatrix::toWireFast({ 255, 255, 255 }).g);
+    EXPECT_EQ(changed.grb[3 * matrix.index(1, 0)], 0);
+}
+
+TEST(LiveFrameTest, HoldingIsNotADeadlineMiss)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+
+    ASSERT_TRUE(animator.draw(frameMessage({ 0, 0, 0 })));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    // Held far longer than a frame, then changed
+    ASSERT_TRUE(animator.draw(frameMessage({ 255, 0, 0 })));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    ASSERT_TRUE(animator.draw(frameMessage({ 0, 255, 0 })));
+    vTaskDelay(pdMS_TO_TICKS(Live::frameMs * 2));
+    animator.stop();
+
+    const auto summary = animator.frameStats().summary();
+    EXPECT_GE(summary.frames, 3u);
+    EXPECT_EQ(summary.deadlineMisses, 0u);
+}
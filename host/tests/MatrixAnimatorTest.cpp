@@ -0,0 +1,173 @@
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <esp_timer.h>
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+using Animator = MatrixAnimator<LedMatrix>;
+
+Animator::Frames makeFrames(std::initializer_list<uint8_t> levels)
+{
+    Animator::Frames frames;
+    for (auto level: levels)
+    {
+        std::array<LedMatrix::RGB, LedMatrix::numPixels> frame;
+        frame.fill({ level, level, level });
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+// Shared time that started epochUs into local time
+class FixedClock : public PlaybackClock
+{
+public:
+    explicit FixedClock(int64_t epochUs)
+        : epochUs_{ epochUs }
+    {
+    }
+
+    std::optional<int64_t> sinceEpochUs() const override
+    {
+        return esp_timer_get_time() - epochUs_;
+    }
+
+private:
+    int64_t epochUs_;
+};
+}  // namespace
+
+TEST(MatrixAnimatorTest, FramesArePlayedInOrderAtInterval)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    Animator animator{ matrix };
+
+    animator.start(makeFrames({ 0, 128, 255 }), 50);
+    vTaskDelay(pdMS_TO_TICKS(420));
+    animator.stop();
+
+    auto frames = Ws2812Sink::instance().frames();
+    ASSERT_GE(frames.size(), 6u);
+
+    // The three frames cycle
+    for (size_t i = 3; i < frames.size(); ++i)
+    {
+        EXPECT_EQ(frames[i].grb, frames[i - 3].grb) << "frame " << i;
+    }
+    EXPECT_NE(frames[0].grb, frames[1].grb);
+
+    // Frames start on the interval grid (one tick of tolerance)
+    for (size_t i = 1; i < frames.size(); ++i)
+    {
+        const int64_t periodUs = frames[i].startUs - frames[i - 1].startUs;
+        EXPECT_NEAR(periodUs, 50'000, 10'000) << "frame " << i;
+    }
+}
+
+TEST(MatrixAnimatorTest, FrameStatsFollowTheAnimation)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    Animator animator{ matrix };
+
+    animator.start(makeFrames({ 0, 255 }), 50);
+    vTaskDelay(pdMS_TO_TICKS(320));
+    animator.stop();
+
+    auto summary = animator.frameStats().summary();
+    EXPECT_EQ(summary.intervalUs, 50'000u);
+    // The task may be stopped between transmitting and recording
+    EXPECT_NEAR(summary.frames, Ws2812Sink::instance().frameCount(), 1);
+    EXPECT_NEAR(summary.meanPeriodUs, 50'000, 10'000);
+    // Wire time of 256 pixels is about 7.7 ms
+    EXPECT_GE(summary.maxRenderUs, 7'000u);
+
+    std::array<FrameStats::Sample, 4> samples;
+    const size_t count = animator.frameStats().recent(samples);
+    ASSERT_GT(count, 0u);
+    for (size_t i = 0; i < count; ++i)
+    {
+        EXPECT_LE(samples[i].convertStartUs, samples[i].transmitStartUs);
+        EXPECT_LT(samples[i].transmitStartUs, samples[i].transmitDoneUs);
+    }
+}
+
+TEST(MatrixAnimatorTest, FramesGoBackToThePoolOnRestart)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().setRealtime(false);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    auto& pool = Animator::Frames::Pool::instance();
+    {
+        Animator anim{ matrix };
+        anim.start(makeFrames({ 1, 2, 3 }), 50);
+        anim.start(makeFrames({ 4, 5, 6 }), 50);
+        const auto playing = pool.stats();
+        EXPECT_GE(playing.freeBlocks, 1u);
+
+        // From here on, new animations only recycle blocks
+        anim.start(makeFrames({ 7, 8, 9 }), 50);
+        EXPECT_EQ(pool.stats().blocks, playing.blocks);
+        anim.stop();
+    }
+    const auto after = pool.stats();
+    EXPECT_EQ(after.freeBlocks, after.blocks);
+}
+
+TEST(MatrixAnimatorTest, FramesFollowAPlaybackClock)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    Animator animator{ matrix };
+    // Mid-entry, as on a device joining a running group
+    const int64_t epochUs = esp_timer_get_time() - 1'000'000 - 125'000;
+    FixedClock clock{ epochUs };
+    animator.synchronize(&clock);
+
+    animator.start(makeFrames({ 10, 20, 30 }), 50);
+    vTaskDelay(pdMS_TO_TICKS(420));
+    animator.stop();
+
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_GE(frames.size(), 6u);
+    const auto grb = [](uint8_t level)
+    {
+        Animator::Frame frame;
+        frame.fill({ level, level, level });
+        LedMatrix reference{ GPIO_NUM_6 };
+        reference.setAllPixels(frame);
+        return reference.wireFrame();
+    };
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        // The frame the clock says, sent within a tick of its entry's start
+        // (the first one right away)
+        const int64_t sinceUs = frames[i].startUs - epochUs;
+        const auto expected = grb(static_cast<uint8_t>(10 * (sinceUs / 50'000 % 3 + 1)));
+        EXPECT_TRUE(std::ranges::equal(frames[i].grb, expected)) << "frame " << i;
+        if (i > 0)
+        {
+            EXPECT_LT(sinceUs % 50'000, 15'000) << "frame " << i;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "MatrixAnimator.hpp"
+#include "MultiLedMatrix.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <esp_timer.h>
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+// Two panels side by side: the left one wired like LedMatrix, the right
+// not serpentine
+using LeftPanel = WS2812Panel<0, 0, 16, 16, true, WS2812MatrixRotation::Rot270>;
+using RightPanel = WS2812Panel<16, 0, 16, 16, false, WS2812MatrixRotation::Rot0>;
+using WideMatrix = MultiWS2812Matrix<32, 16, LeftPanel, RightPanel>;
+
+class MultiLedMatrixTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        Ws2812Sink::instance().clear();
+        Ws2812Sink::instance().setRealtime(false);
+    }
+};
+}  // namespace
+
+TEST_F(MultiLedMatrixTest, EveryPanelGetsItsPixels)
+{
+    WideMatrix matrix{ { GPIO_NUM_6, GPIO_NUM_7 } };
+    ASSERT_TRUE(matrix.init());
+    const WideMatrix::WireColor left{ 1, 2, 3 };
+    const WideMatrix::WireColor right{ 4, 5, 6 };
+    matrix.setWirePixel(3, 5, left);
+    matrix.setWirePixel(16 + 9, 2, right);
+    ASSERT_TRUE(matrix.update());
+
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].gpio, GPIO_NUM_6);
+    EXPECT_EQ(frames[1].gpio, GPIO_NUM_7);
+    EXPECT_EQ(frames[0].grb.size(), 16u * 16 * 3);
+    EXPECT_EQ(frames[1].grb.size(), 16u * 16 * 3);
+
+    const size_t leftIndex = 3 * LeftPanel::Layout::index(3, 5);
+    EXPECT_EQ(frames[0].grb[leftIndex + 0], left.g);
+    EXPECT_EQ(frames[0].grb[leftIndex + 1], left.r);
+    EXPECT_EQ(frames[0].grb[leftIndex + 2], left.b);
+    const size_t rightIndex = 3 * RightPanel::Layout::index(9, 2);
+    EXPECT_EQ(frames[1].grb[rightIndex + 0], right.g);
+    EXPECT_EQ(frames[1].grb[rightIndex + 1], right.r);
+    EXPECT_EQ(frames[1].grb[rightIndex + 2], right.b);
+
+    // The wire frame is the panels' buffers one after another
+    EXPECT_EQ(matrix.index(16 + 9, 2), 16 * 16 + RightPanel::Layout::index(9, 2));
+    EXPECT_EQ(matrix.wirePixel(3, 5).r, left.r);
+    EXPECT_EQ(matrix.wirePixel(32, 0).r, 0);
+}
+
+TEST_F(MultiLedMatrixTest, PanelsAreSentAtOnce)
+{
+    Ws2812Sink::instance().setRealtime(true);
+    WideMatrix matrix{ { GPIO_NUM_6, GPIO_NUM_7 } };
+    ASSERT_TRUE(matrix.init());
+    matrix.fill({ 10, 20, 30 });
+
+    const int64_t start = esp_timer_get_time();
+    ASSERT_TRUE(matrix.update());
+    const int64_t took = esp_timer_get_time() - start;
+
+    // update() waits for the wire, the panels' transfers overlap
+    EXPECT_GE(took, Ws2812Sink::wireTimeUs(16 * 16 * 3));
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_LT(frames[1].startUs, frames[0].doneUs);
+    EXPECT_LT(frames[0].startUs, frames[1].doneUs);
+}
+
+TEST_F(MultiLedMatrixTest, AnimatorDrivesASplitMatrix)
+{
+    SplitLedMatrix matrix{ { GPIO_NUM_6, GPIO_NUM_7 } };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<SplitLedMatrix> animator{ matrix };
+
+    MatrixAnimator<SplitLedMatrix>::Frame frame{};
+    frame[5 * 16 + 3] = { 10, 20, 30 };
+    frame[12 * 16 + 9] = { 40, 50, 60 };
+    ASSERT_TRUE(animator.show(frame, {}));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    animator.stop();
+
+    // Both halves went out, each with its own pixel
+    const auto top = SplitLedMatrix::toWire({ 10, 20, 30 });
+    const auto bottomPixel = SplitLedMatrix::toWire({ 40, 50, 60 });
+    EXPECT_EQ(matrix.wirePixel(3, 5).r, top.r);
+    EXPECT_EQ(matrix.wirePixel(9, 12).b, bottomPixel.b);
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_GE(frames.size(), 2u);
+    const auto& bottom = frames.back().gpio == GPIO_NUM_7 ? frames.back() : frames[frames.size() - 2];
+    EXPECT_EQ(bottom.gpio, GPIO_NUM_7);
+    EXPECT_EQ(bottom.grb.size(), 16u * 8 * 3);
+    using Bottom = WS2812Panel<0, 8, 16, 8>;
+    EXPECT_EQ(bottom.grb[3 * Bottom::Layout::index(9, 4) + 1], bottomPixel.r);
+}
@@ -0,0 +1,102 @@
+#include "LedMatrix.hpp"
+#include "PaletteFrames.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+using Palette = PaletteFrames<LedMatrix>;
+using Frame = Palette::Frame;
+
+// Every pixel gets one of numColors colours, shifted per frame
+Palette::Frames makeFrames(size_t numFrames, size_t numColors)
+{
+    Palette::Frames frames;
+    for (size_t f = 0; f < numFrames; ++f)
+    {
+        Frame frame;
+        for (size_t i = 0; i < frame.size(); ++i)
+        {
+            const size_t c = (i + f) % numColors;
+            frame[i] = { static_cast<uint8_t>(c),
+                         static_cast<uint8_t>(255 - c),
+                         static_cast<uint8_t>(c >> 8) };
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+std::vector<uint8_t> transmitted(LedMatrix& matrix)
+{
+    matrix.update();
+    return Ws2812Sink::instance().lastFrame()->grb;
+}
+
+class PaletteFramesTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        Ws2812Sink::instance().clear();
+        Ws2812Sink::instance().setRealtime(false);
+    }
+};
+}  // namespace
+
+TEST_F(PaletteFramesTest, FewColoursUseFourBitIndices)
+{
+    const auto frames = makeFrames(7, 16);
+    auto palette = Palette::fromFrames(frames);
+    ASSERT_TRUE(palette.has_value());
+    EXPECT_EQ(palette->size(), 7u);
+    EXPECT_EQ(palette->paletteSize(), 16u);
+    EXPECT_EQ(palette->bitsPerIndex(), 4);
+    // Six frames per RGB frame sized slot
+    EXPECT_EQ(palette->slots(), 2u);
+
+    for (size_t f = 0; f < frames.size(); ++f)
+    {
+        for (size_t i = 0; i < LedMatrix::numPixels; ++i)
+        {
+            const auto pixel = palette->pixel(f, i);
+            ASSERT_EQ(pixel.r, frames[f][i].r);
+            ASSERT_EQ(pixel.g, frames[f][i].g);
+        }
+    }
+}
+
+TEST_F(PaletteFramesTest, UpToTwoHundredFiftySixColoursUseEightBits)
+{
+    auto palette = Palette::fromFrames(makeFrames(4, 256));
+    ASSERT_TRUE(palette.has_value());
+    EXPECT_EQ(palette->bitsPerIndex(), 8);
+    EXPECT_EQ(palette->slots(), 2u);
+
+    EXPECT_FALSE(Palette::fromFrames(makeFrames(2, 257)).has_value());
+}
+
+TEST_F(PaletteFramesTest, RendersLikeRgbFrames)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+
+    for (size_t colors: { 5, 200 })
+    {
+        const auto frames = makeFrames(3, colors);
+        auto palette = Palette::fromFrames(frames);
+        ASSERT_TRUE(palette.has_value());
+        for (size_t f = 0; f < frames.size(); ++f)
+        {
+            matrix.setAllPixels(frames[f]);
+            const auto expected = transmitted(matrix);
+            matrix.clear();
+            palette->render(matrix, f);
+            EXPECT_EQ(transmitted(matrix), expected);
+        }
+    }
+}
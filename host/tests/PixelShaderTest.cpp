@@ -0,0 +1,168 @@
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "PixelShader.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+constexpr int32_t one = PixelShader::one;
+
+// Registers after running source once, from all zeros
+PixelShader::Registers run(const char* source)
+{
+    std::string error;
+    const auto shader = PixelShader::assemble(source, &error);
+    EXPECT_TRUE(shader.has_value()) << error;
+    PixelShader::Registers regs{};
+    if (shader)
+    {
+        uint32_t budget = PixelShader::stepsPerPixel;
+        EXPECT_TRUE(PixelShader::execute(
+            shader->code().data(), shader->code().size(), regs, budget));
+    }
+    return regs;
+}
+
+std::string assemblyError(const std::string& source)
+{
+    std::string error;
+    EXPECT_FALSE(PixelShader::assemble(source, &error).has_value()) << source;
+    return error;
+}
+}  // namespace
+
+TEST(PixelShaderTest, ReportsWhereAssemblyFails)
+{
+    EXPECT_EQ(assemblyError("mov r, 1\nfoo r6, 1"), "line 2: unknown instruction 'foo'");
+    EXPECT_EQ(assemblyError("mov r16, 1"), "line 1: bad operands for mov");
+    EXPECT_EQ(assemblyError("add r6, 1, r7"), "line 1: bad operands for add");
+    EXPECT_EQ(assemblyError("sin r6"), "line 1: sin takes 2 operands");
+    EXPECT_EQ(assemblyError("\n\njmp nowhere"), "line 3: unknown label 'nowhere'");
+    EXPECT_EQ(assemblyError("a:\na: end"), "line 2: label 'a' defined twice");
+    EXPECT_EQ(assemblyError("mov r6, 40000"), "line 1: bad operands for mov");
+
+    std::string tooLong;
+    for (size_t i = 0; i <= PixelShader::maxInstructions; ++i)
+    {
+        tooLong += "add r6, r6, 1\n";
+    }
+    EXPECT_EQ(
+        assemblyError(tooLong),
+        "line " + std::to_string(PixelShader::maxInstructions + 1)
+            + ": more than 128 instructions");
+
+    // Comments, labels on instructions, aliases and empty programs are fine
+    EXPECT_TRUE(PixelShader::assemble("; nothing\n").has_value());
+    EXPECT_TRUE(PixelShader::assemble("start: mov g, x ; green\njz r6, start").has_value());
+}
+
+TEST(PixelShaderTest, ComputesInFixedPoint)
+{
+    const auto regs = run(R"(
+        mov r6, 1.5
+        mul r6, r6, -2        ; -3
+        div r7, r6, 0         ; 0
+        mod r8, r6, 2         ; 1, floored
+        floor r9, -0.25       ; -1
+        fract r10, -0.25      ; 0.75
+        sqrt r11, 2
+        sin r12, 0.25         ; a quarter turn
+        cos r13, 0.5
+        lt r14, r6, r7
+        abs r15, r6
+    )");
+    EXPECT_EQ(regs[6], -3 * one);
+    EXPECT_EQ(regs[7], 0);
+    EXPECT_EQ(regs[8], one);
+    EXPECT_EQ(regs[9], -one);
+    EXPECT_EQ(regs[10], one * 3 / 4);
+    EXPECT_NEAR(regs[11], 1.41421 * one, 2);
+    EXPECT_NEAR(regs[12], one, one / 100);
+    EXPECT_NEAR(regs[13], -one, one / 100);
+    EXPECT_EQ(regs[14], one);
+    EXPECT_EQ(regs[15], 3 * one);
+}
+
+TEST(PixelShaderTest, LoopsAndBranches)
+{
+    // Sums 1 to 10
+    const auto regs = run(R"(
+        mov r6, 10
+    loop:
+        add r7, r7, r6
+        sub r6, r6, 1
+        jz r6, done
+        jmp loop
+    done:
+    )");
+    EXPECT_EQ(regs[7], 55 * one);
+}
+
+TEST(PixelShaderTest, BudgetStopsEndlessLoops)
+{
+    const auto shader = PixelShader::assemble("loop:\nadd r6, r6, 1\njmp loop");
+    ASSERT_TRUE(shader.has_value());
+    PixelShader::Registers regs{};
+    uint32_t budget = 100;
+    EXPECT_FALSE(PixelShader::execute(
+        shader->code().data(), shader->code().size(), regs, budget));
+    EXPECT_EQ(budget, 0u);
+    EXPECT_EQ(regs[6], 50 * one);
+}
+
+TEST(PixelShaderTest, RendersEveryPixel)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    // Red on the left half, blue from row 4
+    ShaderRenderer<LedMatrix> renderer{ *PixelShader::assemble(R"(
+        lt r, x, 8
+        lt r6, y, 4
+        jz r6, below
+        end
+    below:
+        mov b, 2              ; clamped to 1
+    )") };
+    renderer.render(matrix, 0);
+
+    const auto red = LedMatrix::toWireFast({ 255, 0, 0 });
+    const auto magenta = LedMatrix::toWireFast({ 255, 0, 255 });
+    const auto black = LedMatrix::toWireFast({ 0, 0, 0 });
+    EXPECT_EQ(matrix.wirePixel(0, 0).r, red.r);
+    EXPECT_EQ(matrix.wirePixel(0, 0).b, red.b);
+    EXPECT_EQ(matrix.wirePixel(7, 15).b, magenta.b);
+    EXPECT_EQ(matrix.wirePixel(8, 0).r, black.r);
+    EXPECT_EQ(renderer.exhaustedPixels(), 0u);
+
+    ShaderRenderer<LedMatrix> spinning{ *PixelShader::assemble("loop: jmp loop") };
+    spinning.render(matrix, 0);
+    EXPECT_EQ(spinning.exhaustedPixels(), LedMatrix::numPixels);
+}
+
+TEST(PixelShaderTest, AnimatorRunsShaders)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+
+    // Brightness follows time
+    const char* source = "fract r6, t\nmov r, r6\nmov g, r6";
+    ASSERT_TRUE(animator.play(*PixelShader::assemble(source)));
+    vTaskDelay(pdMS_TO_TICKS(300));
+    ASSERT_TRUE(animator.shader().has_value());
+    EXPECT_EQ(animator.shader()->source(), source);
+    EXPECT_FALSE(animator.effect().has_value());
+    animator.stop();
+    EXPECT_FALSE(animator.shader().has_value());
+
+    const auto frames = Ws2812Sink::instance().frames();
+    EXPECT_GE(frames.size(), 8u);
+    EXPECT_NE(frames.front().grb, frames.back().grb);
+}
@@ -0,0 +1,125 @@
+#include "PlaylistScheduler.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+
+using HostSim::Ws2812Sink;
+
+namespace
+{
+class PlaylistSchedulerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        basePath_ = std::filesystem::temp_directory_path()
+            / ("framepix_spiffs_"
+               + std::string(::testing::UnitTest::GetInstance()
+                                 ->current_test_info()
+                                 ->name()));
+        std::filesystem::remove_all(basePath_);
+        basePathStr_ = basePath_.string();
+        ASSERT_TRUE(spiffs_.init(Spiffs::Config{ .basePath = basePathStr_ }));
+        ASSERT_TRUE(storage_.init());
+        ASSERT_TRUE(matrix_.init());
+        Ws2812Sink::instance().clear();
+        Ws2812Sink::instance().setRealtime(true);
+
+        StorageManager::Design red{ "red", {} };
+        red.pixels.fill({ 200, 0, 0 });
+        ASSERT_TRUE(storage_.saveDesign(red));
+        StorageManager::Design blue{ "blue", {} };
+        blue.pixels.fill({ 0, 0, 200 });
+        ASSERT_TRUE(storage_.saveDesign(blue));
+    }
+
+    void TearDown() override
+    {
+        animator_.stop();
+        (void)spiffs_.deinit();
+        std::filesystem::remove_all(basePath_);
+    }
+
+    // One letter per colour change on the wire, 'R'ed or 'B'lue
+    static std::string shown()
+    {
+        std::string sequence;
+        for (const auto& frame: Ws2812Sink::instance().frames())
+        {
+            const char c = frame.grb[1] > 0 ? 'R' : frame.grb[2] > 0 ? 'B' : '?';
+            if (sequence.empty() || sequence.back() != c)
+            {
+                sequence += c;
+            }
+        }
+        return sequence;
+    }
+
+    std::filesystem::path basePath_;
+    std::string basePathStr_;
+    Spiffs spiffs_;
+    StorageManager storage_{ spiffs_ };
+    LedMatrix matrix_{ GPIO_NUM_6 };
+    PlaylistScheduler::Animator animator_{ matrix_ };
+};
+}  // namespace
+
+TEST_F(PlaylistSchedulerTest, ItemsTakeTurnsForTheirDwellTime)
+{
+    PlaylistScheduler scheduler{ storage_, animator_ };
+    ASSERT_TRUE(scheduler.start(
+        { { { "red", false, 150, {} }, { "blue", false, 150, {} } }, true }));
+    vTaskDelay(pdMS_TO_TICKS(520));
+    scheduler.stop();
+    EXPECT_FALSE(scheduler.status().running);
+
+    EXPECT_EQ(shown().substr(0, 4), "RBRB");
+
+    // Each switch is one dwell after the previous one, give or take the
+    // animator's hold poll
+    const auto frames = Ws2812Sink::instance().frames();
+    int64_t redUs = -1;
+    int64_t blueUs = -1;
+    for (const auto& frame: frames)
+    {
+        if (redUs < 0 && frame.grb[1] > 0)
+        {
+            redUs = frame.startUs;
+        }
+        if (blueUs < 0 && frame.grb[2] > 0)
+        {
+            blueUs = frame.startUs;
+        }
+    }
+    EXPECT_NEAR(blueUs - redUs, 150'000, 60'000);
+}
+
+TEST_F(PlaylistSchedulerTest, MissingItemsAreSkipped)
+{
+    PlaylistScheduler scheduler{ storage_, animator_ };
+    ASSERT_TRUE(scheduler.start(
+        { { { "gone", false, 100, {} }, { "blue", false, 100, {} } }, true }));
+    vTaskDelay(pdMS_TO_TICKS(150));
+
+    const auto status = scheduler.status();
+    EXPECT_TRUE(status.running);
+    EXPECT_EQ(status.index, 1u);
+    EXPECT_EQ(shown(), "B");
+}
+
+TEST_F(PlaylistSchedulerTest, StopKeepsTheCurrentItem)
+{
+    PlaylistScheduler scheduler{ storage_, animator_ };
+    EXPECT_FALSE(scheduler.start({ {}, true }));
+    ASSERT_TRUE(scheduler.start(
+        { { { "red", false, 60, {} }, { "blue", false, 60, {} } }, true }));
+    vTaskDelay(pdMS_TO_TICKS(30));
+    scheduler.stop();
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    EXPECT_EQ(shown(), "R");
+}
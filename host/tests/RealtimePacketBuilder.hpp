@@ -0,0 +1,101 @@
+#ifndef REALTIME_PACKET_BUILDER_HPP
+#define REALTIME_PACKET_BUILDER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Datagrams as DDP, E1.31 and Art-Net senders send them
+namespace RealtimePacketBuilder
+{
+inline void be16(std::vector<uint8_t>& out, size_t at, uint16_t value)
+{
+    out[at] = static_cast<uint8_t>(value >> 8);
+    out[at + 1] = static_cast<uint8_t>(value);
+}
+
+inline void be32(std::vector<uint8_t>& out, size_t at, uint32_t value)
+{
+    be16(out, at, static_cast<uint16_t>(value >> 16));
+    be16(out, at + 2, static_cast<uint16_t>(value));
+}
+
+inline std::vector<uint8_t> ddp(
+    uint32_t offset, std::span<const uint8_t> data, uint8_t sequence = 0, bool push = false)
+{
+    std::vector<uint8_t> out(10);
+    out[0] = 0x40 | (push ? 0x01 : 0x00);
+    out[1] = sequence;
+    // RGB, 8 bits per channel, to the default output
+    out[2] = 0x0B;
+    out[3] = 1;
+    be32(out, 4, offset);
+    be16(out, 8, static_cast<uint16_t>(data.size()));
+    out.insert(out.end(), data.begin(), data.end());
+    return out;
+}
+
+inline void e131Root(std::vector<uint8_t>& out, uint32_t vector)
+{
+    be16(out, 0, 0x0010);
+    const char id[] = "ASC-E1.17";
+    std::copy(id, id + sizeof(id), out.begin() + 4);
+    be16(out, 16, static_cast<uint16_t>(0x7000 | (out.size() - 16)));
+    be32(out, 18, vector);
+    be16(out, 38, static_cast<uint16_t>(0x7000 | (out.size() - 38)));
+}
+
+inline std::vector<uint8_t> e131(
+    uint16_t universe,
+    std::span<const uint8_t> data,
+    uint8_t sequence,
+    uint16_t syncUniverse = 0,
+    uint8_t options = 0)
+{
+    std::vector<uint8_t> out(126 + data.size());
+    e131Root(out, 0x00000004);
+    be32(out, 40, 0x00000002);
+    out[108] = 100;
+    be16(out, 109, syncUniverse);
+    out[111] = sequence;
+    out[112] = options;
+    be16(out, 113, universe);
+    be16(out, 115, static_cast<uint16_t>(0x7000 | (out.size() - 115)));
+    out[117] = 0x02;
+    out[118] = 0xA1;
+    be16(out, 121, 1);
+    be16(out, 123, static_cast<uint16_t>(data.size() + 1));
+    std::copy(data.begin(), data.end(), out.begin() + 126);
+    return out;
+}
+
+inline std::vector<uint8_t> e131Sync(uint16_t syncUniverse, uint8_t sequence)
+{
+    std::vector<uint8_t> out(49);
+    e131Root(out, 0x00000008);
+    be32(out, 40, 0x00000001);
+    out[44] = sequence;
+    be16(out, 45, syncUniverse);
+    return out;
+}
+
+inline std::vector<uint8_t> artNet(uint16_t universe, std::span<const uint8_t> data, uint8_t sequence)
+{
+    std::vector<uint8_t> out(18);
+    const char id[] = "Art-Net";
+    std::copy(id, id + sizeof(id), out.begin());
+    // OpDmx, little endian, protocol version 14
+    out[8] = 0x00;
+    out[9] = 0x50;
+    out[11] = 14;
+    out[12] = sequence;
+    out[14] = static_cast<uint8_t>(universe);
+    out[15] = static_cast<uint8_t>(universe >> 8);
+    be16(out, 16, static_cast<uint16_t>(data.size()));
+    out.insert(out.end(), data.begin(), data.end());
+    return out;
+}
+}  // namespace RealtimePacketBuilder
+
+#endif  // REALTIME_PACKET_BUILDER_HPP
@@ -0,0 +1,275 @@
+#include "FrameAssembler.hpp"
+#include "RealtimePacketBuilder.hpp"
+#include "RealtimePackets.hpp"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+namespace Build = RealtimePacketBuilder;
+using RealtimePackets::Packet;
+using RealtimePackets::Protocol;
+
+namespace
+{
+// 256 pixels
+constexpr size_t channels = 768;
+
+std::vector<uint8_t> bytes(size_t count, uint8_t first)
+{
+    std::vector<uint8_t> out(count);
+    std::iota(out.begin(), out.end(), first);
+    return out;
+}
+
+bool add(FrameAssembler& assembler, Protocol protocol, const std::vector<uint8_t>& datagram)
+{
+    const auto packet = RealtimePackets::parse(protocol, datagram);
+    EXPECT_TRUE(packet.has_value());
+    return packet && assembler.add(protocol, *packet);
+}
+}  // namespace
+
+TEST(RealtimePacketsTest, ParsesDdp)
+{
+    const auto data = bytes(30, 1);
+    // The packet points into the datagram
+    const auto datagram = Build::ddp(300, data, 7, true);
+    const auto packet = RealtimePackets::parseDdp(datagram);
+    ASSERT_TRUE(packet.has_value());
+    EXPECT_EQ(packet->type, Packet::Type::Data);
+    EXPECT_EQ(packet->offset, 300u);
+    EXPECT_EQ(packet->sequence, 7);
+    EXPECT_TRUE(packet->push);
+    EXPECT_TRUE(std::ranges::equal(packet->data, data));
+
+    // Timecode makes the header 4 bytes longer
+    auto timed = Build::ddp(0, data);
+    timed[0] |= 0x10;
+    timed.insert(timed.begin() + 10, 4, 0xEE);
+    ASSERT_TRUE(RealtimePackets::parseDdp(timed).has_value());
+    EXPECT_EQ(RealtimePackets::parseDdp(timed)->data[0], 1);
+
+    auto query = Build::ddp(0, data);
+    query[0] |= 0x02;
+    auto status = Build::ddp(0, data);
+    status[3] = 251;
+    auto truncated = Build::ddp(0, data);
+    truncated.pop_back();
+    auto version2 = Build::ddp(0, data);
+    version2[0] = 0x80;
+    EXPECT_FALSE(RealtimePackets::parseDdp(query).has_value());
+    EXPECT_FALSE(RealtimePackets::parseDdp(status).has_value());
+    EXPECT_FALSE(RealtimePackets::parseDdp(truncated).has_value());
+    EXPECT_FALSE(RealtimePackets::parseDdp(version2).has_value());
+}
+
+TEST(RealtimePacketsTest, ParsesE131)
+{
+    const auto data = bytes(510, 0);
+    const auto datagram = Build::e131(2, data, 200, 7);
+    const auto packet = RealtimePackets::parseE131(datagram);
+    ASSERT_TRUE(packet.has_value());
+    EXPECT_EQ(packet->type, Packet::Type::Data);
+    EXPECT_EQ(packet->universe, 2);
+    EXPECT_EQ(packet->sequence, 200);
+    EXPECT_EQ(packet->syncUniverse, 7);
+    // Without the start code
+    EXPECT_TRUE(std::ranges::equal(packet->data, data));
+
+    const auto sync = RealtimePackets::parseE131(Build::e131Sync(7, 3));
+    ASSERT_TRUE(sync.has_value());
+    EXPECT_EQ(sync->type, Packet::Type::Sync);
+    EXPECT_EQ(sync->universe, 7);
+
+    const auto terminated = RealtimePackets::parseE131(Build::e131(1, data, 0, 0, 0x40));
+    ASSERT_TRUE(terminated.has_value());
+    EXPECT_EQ(terminated->type, Packet::Type::Terminated);
+
+    auto otherStartCode = Build::e131(1, data, 0);
+    otherStartCode[125] = 0xDD;
+    auto truncated = Build::e131(1, data, 0);
+    truncated.pop_back();
+    auto notAcn = Build::e131(1, data, 0);
+    notAcn[4] = 'X';
+    EXPECT_FALSE(RealtimePackets::parseE131(Build::e131(1, data, 0, 0, 0x80)).has_value());
+    EXPECT_FALSE(RealtimePackets::parseE131(otherStartCode).has_value());
+    EXPECT_FALSE(RealtimePackets::parseE131(truncated).has_value());
+    EXPECT_FALSE(RealtimePackets::parseE131(notAcn).has_value());
+}
+
+TEST(RealtimePacketsTest, ParsesArtNet)
+{
+    const auto data = bytes(512, 0);
+    const auto datagram = Build::artNet(0x0123, data, 9);
+    const auto packet = RealtimePackets::parseArtNet(datagram);
+    ASSERT_TRUE(packet.has_value());
+    EXPECT_EQ(packet->universe, 0x0123);
+    EXPECT_EQ(packet->sequence, 9);
+    EXPECT_TRUE(std::ranges::equal(packet->data, data));
+
+    auto poll = Build::artNet(0, data, 0);
+    poll[9] = 0x20;
+    auto truncated = Build::artNet(0, data, 0);
+    truncated.pop_back();
+    EXPECT_FALSE(RealtimePackets::parseArtNet(poll).has_value());
+    EXPECT_FALSE(RealtimePackets::parseArtNet(truncated).has_value());
+    // Each protocol only takes its own packets
+    EXPECT_FALSE(RealtimePackets::parseDdp(Build::artNet(0, data, 0)).has_value());
+    EXPECT_FALSE(RealtimePackets::parseE131(Build::ddp(0, data)).has_value());
+}
+
+TEST(FrameAssemblerTest, DdpFramesCompleteOnPushOrAtTheEnd)
+{
+    const auto data = bytes(channels, 0);
+    const std::span<const uint8_t> all{ data };
+    {
+        // A sender that never pushes: the last byte completes the frame
+        FrameAssembler assembler{ channels, {} };
+        EXPECT_FALSE(add(assembler, Protocol::Ddp, Build::ddp(0, all.first(480))));
+        EXPECT_TRUE(add(assembler, Protocol::Ddp, Build::ddp(480, all.subspan(480))));
+        EXPECT_TRUE(std::ranges::equal(assembler.frame(), data));
+    }
+    {
+        FrameAssembler assembler{ channels, {} };
+        EXPECT_TRUE(add(assembler, Protocol::Ddp, Build::ddp(0, all.first(480), 1, true)));
+        // Pushed before: the end of the data is not the end of the frame
+        EXPECT_FALSE(add(assembler, Protocol::Ddp, Build::ddp(480, all.subspan(480), 2)));
+        EXPECT_TRUE(add(assembler, Protocol::Ddp, Build::ddp(0, {}, 2, true)));
+        EXPECT_TRUE(std::ranges::equal(assembler.frame(), data));
+        // Beyond the frame
+        EXPECT_FALSE(add(assembler, Protocol::Ddp, Build::ddp(channels, all.first(3), 2)));
+        EXPECT_EQ(assembler.stats().ignored, 1u);
+        EXPECT_EQ(assembler.stats().frames, 2u);
+    }
+}
+
+TEST(FrameAssemblerTest, UniversesMapOntoPixels)
+{
+    FrameAssembler assembler{ channels,
+                              { .e131Universe = 5,
+                                .artNetUniverse = 0,
+                                .canvas = std::nullopt } };
+    EXPECT_EQ(assembler.universes(), 2u);
+    const auto first = bytes(512, 0);
+    const auto second = bytes(512, 100);
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(4, first, 0)));
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(5, first, 0)));
+    EXPECT_TRUE(add(assembler, Protocol::E131, Build::e131(6, second, 0)));
+    // 170 pixels per universe, the two channels left over are not shown
+    EXPECT_EQ(assembler.frame()[509], first[509]);
+    EXPECT_EQ(assembler.frame()[510], second[0]);
+    EXPECT_EQ(assembler.frame()[767], second[257]);
+    EXPECT_EQ(assembler.stats().ignored, 1u);
+
+    // Art-Net from universe 0 on
+    EXPECT_FALSE(add(assembler, Protocol::ArtNet, Build::artNet(0, second, 1)));
+    EXPECT_TRUE(add(assembler, Protocol::ArtNet, Build::artNet(1, first, 1)));
+    EXPECT_EQ(assembler.frame()[0], second[0]);
+    EXPECT_EQ(assembler.frame()[510], first[0]);
+}
+
+TEST(FrameAssemblerTest, CanvasTilesTakeTheirCropOnly)
+{
+    // The bottom right 16x16 tile of a 32x32 canvas
+    const VirtualCanvas canvas{ 32, 32, 16, 16, 16, 16, WS2812MatrixRotation::Rot0 };
+    const auto data = bytes(canvas.channels(), 0);
+    std::vector<uint8_t> crop(channels);
+    canvas.crop(0, data, crop);
+    FrameAssembler assembler{ channels,
+                              { .e131Universe = 1,
+                                .artNetUniverse = 0,
+                                .canvas = canvas } };
+    // Universes 4 to 7 of 7 have the bottom half
+    EXPECT_EQ(assembler.skippedUniverses(), 3u);
+    EXPECT_EQ(assembler.universes(), 4u);
+
+    const std::span<const uint8_t> all{ data };
+    for (size_t offset = 0; offset < all.size(); offset += 1440)
+    {
+        const auto piece = all.subspan(offset, std::min<size_t>(1440, all.size() - offset));
+        EXPECT_EQ(
+            add(assembler, Protocol::Ddp, Build::ddp(offset, piece)),
+            offset + piece.size() == all.size());
+    }
+    EXPECT_TRUE(std::ranges::equal(assembler.frame(), crop));
+
+    FrameAssembler universes{ channels,
+                              { .e131Universe = 1,
+                                .artNetUniverse = 0,
+                                .canvas = canvas } };
+    for (uint16_t universe = 1; universe <= 7; ++universe)
+    {
+        const auto offset = (universe - 1) * FrameAssembler::channelsPerUniverse;
+        const auto piece = all.subspan(
+            offset, std::min(FrameAssembler::channelsPerUniverse, all.size() - offset));
+        // The last universe of the tile completes the frame
+        EXPECT_EQ(add(universes, Protocol::E131, Build::e131(universe, piece, 0)), universe == 7);
+    }
+    EXPECT_TRUE(std::ranges::equal(universes.frame(), crop));
+    EXPECT_EQ(universes.stats().ignored, 3u);
+}
+
+TEST(FrameAssemblerTest, LatePacketsAreDroppedAndGapsCounted)
+{
+    FrameAssembler assembler{ channels, {} };
+    const auto older = bytes(510, 0);
+    const auto newer = bytes(510, 50);
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, older, 254)));
+    // Wraps around, 255 was lost
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, newer, 0)));
+    EXPECT_EQ(assembler.stats().lost, 1u);
+    // 255 arrives after all, and a duplicate: both late
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, older, 255)));
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, older, 0)));
+    EXPECT_EQ(assembler.stats().late, 2u);
+    EXPECT_EQ(assembler.frame()[0], newer[0]);
+    // Far behind is a restarted sender
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, older, 200)));
+    EXPECT_EQ(assembler.frame()[0], older[0]);
+
+    // DDP packets of a frame share their number
+    const auto data = bytes(channels, 0);
+    EXPECT_TRUE(add(assembler, Protocol::Ddp, Build::ddp(0, data, 15, true)));
+    EXPECT_TRUE(add(assembler, Protocol::Ddp, Build::ddp(0, data, 15, true)));
+    EXPECT_TRUE(add(assembler, Protocol::Ddp, Build::ddp(0, data, 1, true)));
+    EXPECT_FALSE(add(assembler, Protocol::Ddp, Build::ddp(0, data, 14, true)));
+    EXPECT_EQ(assembler.stats().late, 3u);
+
+    // Reset forgets the numbers, 200 is not late anymore
+    assembler.reset();
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, newer, 199)));
+    EXPECT_EQ(assembler.stats().late, 3u);
+}
+
+TEST(FrameAssemblerTest, SyncedDataWaitsForTheSyncPacket)
+{
+    FrameAssembler assembler{ channels, {} };
+    const auto data = bytes(510, 0);
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, data, 1, 9)));
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(2, data, 1, 9)));
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131Sync(8, 1)));
+    EXPECT_TRUE(add(assembler, Protocol::E131, Build::e131Sync(9, 1)));
+    // Nothing new since
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131Sync(9, 2)));
+}
+
+TEST(FrameAssemblerTest, ALostUniverseCostsOnlyItsPart)
+{
+    FrameAssembler assembler{ channels, {} };
+    const auto a = bytes(510, 0);
+    const auto b = bytes(510, 1);
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, a, 1)));
+    // Universe 2 of frame 1 is lost, frame 2 still shows
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, b, 2)));
+    EXPECT_TRUE(add(assembler, Protocol::E131, Build::e131(2, b, 2)));
+    EXPECT_EQ(assembler.frame()[0], b[0]);
+    // Universe 1 of frame 3 is lost: universe 2 shows with the old half
+    EXPECT_TRUE(add(assembler, Protocol::E131, Build::e131(2, a, 3)));
+    EXPECT_EQ(assembler.frame()[0], b[0]);
+    EXPECT_EQ(assembler.frame()[510], a[0]);
+    // Noticed with the next packet of universe 1
+    EXPECT_EQ(assembler.stats().lost, 0u);
+    EXPECT_FALSE(add(assembler, Protocol::E131, Build::e131(1, a, 4)));
+    EXPECT_EQ(assembler.stats().lost, 1u);
+}
@@ -0,0 +1,228 @@
+#include "RealtimePacketBuilder.hpp"
+#include "RealtimeReceiver.hpp"
+
+#include <esp_log.h>
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <numeric>
+
+namespace Build = RealtimePacketBuilder;
+using Protocol = RealtimePackets::Protocol;
+
+namespace
+{
+constexpr size_t channels = 768;
+
+// Sends datagrams to the receiver over the loopback interface
+class Sender
+{
+public:
+    Sender() { fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP); }
+    ~Sender() { close(fd_); }
+
+    void send(uint16_t port, const std::vector<uint8_t>& datagram)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(
+            sendto(
+                fd_,
+                datagram.data(),
+                datagram.size(),
+                0,
+                reinterpret_cast<sockaddr*>(&address),
+                sizeof(address)),
+            static_cast<ssize_t>(datagram.size()));
+    }
+
+private:
+    int fd_;
+};
+
+// What the callbacks saw
+struct Seen
+{
+    std::mutex mutex;
+    size_t starts{ 0 };
+    size_t ends{ 0 };
+    std::vector<std::vector<uint8_t>> frames;
+
+    RealtimeReceiver::Callbacks callbacks()
+    {
+        return { .onStart =
+                     [this]
+                 {
+                     std::lock_guard lock{ mutex };
+                     ++starts;
+                 },
+                 .onFrame =
+                     [this](std::span<const uint8_t> rgb)
+                 {
+                     std::lock_guard lock{ mutex };
+                     frames.emplace_back(rgb.begin(), rgb.end());
+                 },
+                 .onEnd =
+                     [this]
+                 {
+                     std::lock_guard lock{ mutex };
+                     ++ends;
+                 } };
+    }
+
+    size_t frameCount()
+    {
+        std::lock_guard lock{ mutex };
+        return frames.size();
+    }
+};
+
+// Free ports, no multicast, so the tests run anywhere
+RealtimeReceiver::Config loopbackConfig(uint32_t timeoutMs = 2500)
+{
+    return { .ddp = true,
+             .e131 = true,
+             .artNet = true,
+             .ddpPort = 0,
+             .e131Port = 0,
+             .artNetPort = 0,
+             .mapping = {},
+             .multicast = false,
+             .timeoutMs = timeoutMs };
+}
+
+template<typename Predicate> bool waitFor(Predicate predicate, uint32_t timeoutMs = 1000)
+{
+    for (uint32_t waited = 0; waited < timeoutMs; waited += portTICK_PERIOD_MS)
+    {
+        if (predicate())
+        {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return predicate();
+}
+
+std::vector<uint8_t> frameData(uint8_t first)
+{
+    std::vector<uint8_t> data(channels);
+    std::iota(data.begin(), data.end(), first);
+    return data;
+}
+}  // namespace
+
+TEST(RealtimeReceiverTest, ShowsDdpFrames)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Seen seen;
+    RealtimeReceiver receiver{ channels, loopbackConfig(), seen.callbacks() };
+    ASSERT_TRUE(receiver.start());
+    const uint16_t port = receiver.port(Protocol::Ddp);
+    ASSERT_NE(port, 0);
+
+    Sender sender;
+    for (uint8_t frame = 1; frame <= 3; ++frame)
+    {
+        const auto data = frameData(frame);
+        const std::span<const uint8_t> all{ data };
+        sender.send(port, Build::ddp(0, all.first(480), frame));
+        sender.send(port, Build::ddp(480, all.subspan(480), frame, true));
+    }
+    sender.send(port, { 1, 2, 3 });
+    ASSERT_TRUE(waitFor([&] { return receiver.stats().invalid == 1; }));
+    receiver.stop();
+
+    ASSERT_EQ(seen.frames.size(), 3u);
+    EXPECT_EQ(seen.frames.back(), frameData(3));
+    EXPECT_EQ(seen.starts, 1u);
+    EXPECT_EQ(seen.ends, 0u);
+    EXPECT_EQ(receiver.stats().streams, 1u);
+    EXPECT_EQ(receiver.port(Protocol::Ddp), 0);
+}
+
+TEST(RealtimeReceiverTest, LossAndReorderingNeverShowOldData)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Seen seen;
+    RealtimeReceiver receiver{ channels, loopbackConfig(), seen.callbacks() };
+    ASSERT_TRUE(receiver.start());
+    const uint16_t port = receiver.port(Protocol::E131);
+    Sender sender;
+
+    auto universe = [](const std::vector<uint8_t>& data, size_t index)
+    {
+        const std::span<const uint8_t> all{ data };
+        return all.subspan(index * 510, std::min<size_t>(510, data.size() - index * 510));
+    };
+    const auto a = frameData(0);
+    const auto b = frameData(100);
+    const auto c = frameData(200);
+    // Frame a in order
+    sender.send(port, Build::e131(1, universe(a, 0), 1));
+    sender.send(port, Build::e131(2, universe(a, 1), 1));
+    // Frame b loses universe 1, frame c arrives with its universes swapped
+    sender.send(port, Build::e131(2, universe(b, 1), 2));
+    sender.send(port, Build::e131(2, universe(c, 1), 3));
+    sender.send(port, Build::e131(1, universe(c, 0), 3));
+    // b's universe 1 turns up late, after c's
+    sender.send(port, Build::e131(1, universe(b, 0), 2));
+    // The next universe 2 shows all of c: the late packet was dropped
+    sender.send(port, Build::e131(2, universe(c, 1), 4));
+    ASSERT_TRUE(waitFor([&] { return receiver.stats().assembled.packets == 7; }));
+    receiver.stop();
+
+    const auto stats = receiver.stats();
+    EXPECT_EQ(stats.assembled.late, 1u);
+    EXPECT_EQ(stats.assembled.lost, 1u);
+    ASSERT_EQ(seen.frames.size(), 4u);
+    EXPECT_EQ(seen.frames[0], a);
+    // A lost universe costs its part of one frame
+    EXPECT_EQ(seen.frames[1][0], a[0]);
+    EXPECT_EQ(seen.frames[1][510], b[510]);
+    // Swapped universes: the first one completes a frame with the old half
+    EXPECT_EQ(seen.frames[2][0], a[0]);
+    EXPECT_EQ(seen.frames[2][510], c[510]);
+    EXPECT_EQ(seen.frames[3], c);
+}
+
+TEST(RealtimeReceiverTest, StreamsEndOnTimeoutOrTermination)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Seen seen;
+    RealtimeReceiver receiver{ channels, loopbackConfig(200), seen.callbacks() };
+    ASSERT_TRUE(receiver.start());
+    Sender sender;
+    const auto data = frameData(0);
+    const std::span<const uint8_t> all{ data };
+
+    // Art-Net, then silence
+    sender.send(receiver.port(Protocol::ArtNet), Build::artNet(0, all.first(510), 1));
+    sender.send(receiver.port(Protocol::ArtNet), Build::artNet(1, all.subspan(510), 1));
+    ASSERT_TRUE(waitFor([&] { return seen.frameCount() == 1; }));
+    EXPECT_TRUE(receiver.stats().streaming);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    EXPECT_EQ(seen.ends, 0u);
+    ASSERT_TRUE(waitFor([&] { return !receiver.stats().streaming; }, 400));
+    EXPECT_EQ(seen.ends, 1u);
+
+    // An E1.31 source that says it stopped ends the stream right away
+    const uint16_t port = receiver.port(Protocol::E131);
+    sender.send(port, Build::e131(1, all.first(510), 1));
+    sender.send(port, Build::e131(2, all.subspan(510), 1));
+    ASSERT_TRUE(waitFor([&] { return receiver.stats().streaming; }));
+    sender.send(port, Build::e131(1, {}, 2, 0, 0x40));
+    ASSERT_TRUE(waitFor([&] { return !receiver.stats().streaming; }, 50));
+    receiver.stop();
+
+    EXPECT_EQ(seen.starts, 2u);
+    EXPECT_EQ(seen.ends, 2u);
+    EXPECT_EQ(receiver.stats().streams, 2u);
+}
@@ -0,0 +1,174 @@
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "ScrollingText.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+using Font = ScrollingText::Font;
+
+namespace
+{
+constexpr uint16_t W = LedMatrix::width;
+
+// Glyphs are trimmed at compile time
+static_assert(Fonts::font5x7.glyph('!').width == 1);
+static_assert(Fonts::font5x7.glyph('I').width == 3);
+static_assert(Fonts::font5x7.glyph('M').width == 5);
+static_assert(Fonts::font5x7.glyph(' ').width == 3);
+static_assert(Fonts::font8x8.glyph('|').width == 2);
+static_assert(Fonts::font8x8.height == 8);
+// 8x8 rows are turned into columns: the bar of 'T' is the top row
+static_assert(Fonts::font8x8.column('T', 0) == 0x03);
+
+ScrollingText message(std::string text, bool loop = true)
+{
+    ScrollingText scrolling;
+    scrolling.text = std::move(text);
+    scrolling.speed = 10;
+    scrolling.loop = loop;
+    return scrolling;
+}
+
+// Renders the text after it moved by pixels columns, a renderer starts
+// with its first render
+void renderAfter(TextRenderer<LedMatrix>& text, LedMatrix& matrix, uint32_t pixels)
+{
+    text.render(matrix, int64_t{ pixels } * 1000000 / text.text().speed);
+}
+
+bool lit(const LedMatrix& matrix, uint16_t x, uint16_t y)
+{
+    const auto pixel = matrix.wirePixel(x, y);
+    return pixel.r || pixel.g || pixel.b;
+}
+
+size_t litPixels(const LedMatrix& matrix)
+{
+    size_t count = 0;
+    for (uint16_t y = 0; y < LedMatrix::height; ++y)
+    {
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            count += lit(matrix, x, y);
+        }
+    }
+    return count;
+}
+}  // namespace
+
+TEST(ScrollingTextTest, LaysOutProportionally)
+{
+    EXPECT_EQ(TextRenderer<LedMatrix>{ message("I") }.width(), 3u);
+    // One column between letters
+    EXPECT_EQ(TextRenderer<LedMatrix>{ message("II") }.width(), 7u);
+    EXPECT_EQ(TextRenderer<LedMatrix>{ message("I!") }.width(), 5u);
+    EXPECT_EQ(TextRenderer<LedMatrix>{ message("") }.width(), 0u);
+}
+
+TEST(ScrollingTextTest, UnknownCharactersShowOnce)
+{
+    // Two bytes of UTF-8 are one '?'
+    TextRenderer<LedMatrix> accented{ message("\xC3\xA9") };
+    TextRenderer<LedMatrix> question{ message("?") };
+    EXPECT_EQ(accented.width(), question.width());
+}
+
+TEST(ScrollingTextTest, ScrollsInFromTheRight)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    TextRenderer<LedMatrix> text{ message("I") };
+    renderAfter(text, matrix, 0);
+    EXPECT_EQ(litPixels(matrix), 0u);
+
+    // The 5x7 font is centred: rows 4 to 10 of 16
+    renderAfter(text, matrix, 2);
+    EXPECT_TRUE(lit(matrix, W - 2, 4));
+    EXPECT_TRUE(lit(matrix, W - 1, 10));
+    EXPECT_FALSE(lit(matrix, W - 2, 7));
+    EXPECT_FALSE(lit(matrix, W - 2, 3));
+    EXPECT_FALSE(lit(matrix, W - 2, 11));
+
+    // The stem of the I, all 7 rows, reaches the left edge
+    renderAfter(text, matrix, W + 1);
+    for (uint16_t y = 4; y <= 10; ++y)
+    {
+        EXPECT_TRUE(lit(matrix, 0, y)) << y;
+    }
+    EXPECT_EQ(litPixels(matrix), 7u + 2u);
+}
+
+TEST(ScrollingTextTest, LoopsOrScrollsThroughOnce)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    TextRenderer<LedMatrix> looping{ message("Hi") };
+    TextRenderer<LedMatrix> once{ message("Hi", false) };
+    const uint32_t period = W + looping.width();
+    renderAfter(looping, matrix, 0);
+    renderAfter(once, matrix, 0);
+
+    renderAfter(looping, matrix, 5);
+    const auto entering = matrix.wireFrame();
+    EXPECT_GT(litPixels(matrix), 0u);
+    renderAfter(looping, matrix, period + 5);
+    EXPECT_EQ(matrix.wireFrame(), entering);
+
+    renderAfter(once, matrix, 5);
+    EXPECT_EQ(matrix.wireFrame(), entering);
+    renderAfter(once, matrix, period + 5);
+    EXPECT_EQ(litPixels(matrix), 0u);
+}
+
+TEST(ScrollingTextTest, DrawsColourAndBackground)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ScrollingText settings = message("I");
+    settings.font = Font::Large;
+    settings.color = { 255, 0, 0 };
+    settings.background = { 0, 0, 255 };
+    TextRenderer<LedMatrix> text{ settings };
+    renderAfter(text, matrix, 0);
+    renderAfter(text, matrix, W);
+
+    const auto foreground = LedMatrix::toWire({ 255, 0, 0 });
+    const auto background = LedMatrix::toWire({ 0, 0, 255 });
+    // Rows 4 to 11 hold the 8x8 font, the top row of the I is lit
+    EXPECT_EQ(matrix.wirePixel(0, 4).r, foreground.r);
+    EXPECT_EQ(matrix.wirePixel(0, 4).b, foreground.b);
+    EXPECT_EQ(matrix.wirePixel(0, 0).b, background.b);
+    EXPECT_EQ(matrix.wirePixel(W - 1, 8).b, background.b);
+}
+
+TEST(ScrollingTextTest, ParsesFontNames)
+{
+    EXPECT_EQ(ScrollingText::parseFont("5x7"), Font::Small);
+    EXPECT_EQ(ScrollingText::parseFont("8x8"), Font::Large);
+    EXPECT_FALSE(ScrollingText::parseFont("6x9").has_value());
+}
+
+TEST(ScrollingTextTest, AnimatorScrollsText)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+
+    ScrollingText fast = message("Hello");
+    fast.speed = 100;
+    ASSERT_TRUE(animator.scroll(fast));
+    vTaskDelay(pdMS_TO_TICKS(300));
+    ASSERT_TRUE(animator.text().has_value());
+    EXPECT_EQ(animator.text()->text, "Hello");
+    EXPECT_FALSE(animator.effect().has_value());
+    animator.stop();
+    EXPECT_FALSE(animator.text().has_value());
+
+    // Redrawn about every 20 ms, and moving
+    const auto frames = Ws2812Sink::instance().frames();
+    EXPECT_GE(frames.size(), 8u);
+    EXPECT_NE(frames.front().grb, frames.back().grb);
+}
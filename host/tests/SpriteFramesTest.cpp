@@ -0,0 +1,161 @@
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "SpriteFrames.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+using Sprites = SpriteFrames<LedMatrix>;
+using Placement = Sprites::Placement;
+using RGB = LedMatrix::RGB;
+
+namespace
+{
+constexpr RGB red{ 255, 0, 0 };
+constexpr RGB blue{ 0, 0, 255 };
+constexpr RGB grey{ 40, 40, 40 };
+
+// 2x2: red on top, blue bottom left, transparent bottom right
+Sprites::Sprite corner()
+{
+    return { 2, 2, { red, red, blue, RGB{} }, { 1, 1, 1, 0 } };
+}
+
+Sprites withBackground(RGB color)
+{
+    Sprites::Frame background;
+    background.fill(color);
+    return Sprites{ background };
+}
+
+bool same(LedMatrix::WireColor a, RGB b)
+{
+    const auto wire = LedMatrix::toWire(b);
+    return a.r == wire.r && a.g == wire.g && a.b == wire.b;
+}
+}  // namespace
+
+TEST(SpriteFramesTest, RejectsInvalidSpritesAndPlacements)
+{
+    Sprites sprites;
+    EXPECT_FALSE(sprites.addSprite({ 0, 0, {}, {} }));
+    EXPECT_FALSE(sprites.addSprite({ 2, 2, { red }, { 1 } }));
+    EXPECT_FALSE(sprites.addSprite(
+        { LedMatrix::width + 1, 1, std::vector<RGB>(LedMatrix::width + 1),
+          std::vector<uint8_t>(LedMatrix::width + 1, 1) }));
+    EXPECT_TRUE(sprites.addSprite(corner()));
+
+    const Placement missing[] = { { 1, 0, 0, 0 } };
+    EXPECT_FALSE(sprites.addFrame(missing));
+    const Placement fine[] = { { 0, 0, 0, 0 } };
+    EXPECT_TRUE(sprites.addFrame(fine));
+    EXPECT_EQ(sprites.size(), 1u);
+}
+
+TEST(SpriteFramesTest, DrawsSpritesOverTheBackground)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    Sprites sprites = withBackground(grey);
+    ASSERT_TRUE(sprites.addSprite(corner()));
+    const Placement frame[] = { { 0, 3, 5, 0 } };
+    ASSERT_TRUE(sprites.addFrame(frame));
+
+    sprites.render(matrix, 0, Sprites::none);
+    EXPECT_TRUE(same(matrix.wirePixel(3, 5), red));
+    EXPECT_TRUE(same(matrix.wirePixel(4, 5), red));
+    EXPECT_TRUE(same(matrix.wirePixel(3, 6), blue));
+    // Transparent, and outside the sprite
+    EXPECT_TRUE(same(matrix.wirePixel(4, 6), grey));
+    EXPECT_TRUE(same(matrix.wirePixel(0, 0), grey));
+}
+
+TEST(SpriteFramesTest, FlipsAndClipsAtTheEdges)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    Sprites sprites = withBackground(grey);
+    ASSERT_TRUE(sprites.addSprite(corner()));
+    const Placement flipped[] = { { 0, 0, 0, Placement::flipX | Placement::flipY } };
+    const Placement hanging[] = { { 0, -1, LedMatrix::height - 1, 0 } };
+    ASSERT_TRUE(sprites.addFrame(flipped));
+    ASSERT_TRUE(sprites.addFrame(hanging));
+
+    sprites.render(matrix, 0, Sprites::none);
+    // Upside down and mirrored: transparent top left, blue top right
+    EXPECT_TRUE(same(matrix.wirePixel(0, 0), grey));
+    EXPECT_TRUE(same(matrix.wirePixel(1, 0), blue));
+    EXPECT_TRUE(same(matrix.wirePixel(0, 1), red));
+
+    // Only the top right pixel of the sprite is on the matrix
+    sprites.render(matrix, 1, Sprites::none);
+    EXPECT_TRUE(same(matrix.wirePixel(0, LedMatrix::height - 1), red));
+    EXPECT_TRUE(same(matrix.wirePixel(1, LedMatrix::height - 1), grey));
+}
+
+TEST(SpriteFramesTest, FollowingFramesMatchFullRenders)
+{
+    LedMatrix incremental{ GPIO_NUM_6 };
+    LedMatrix full{ GPIO_NUM_6 };
+    Sprites sprites = withBackground(grey);
+    ASSERT_TRUE(sprites.addSprite(corner()));
+    ASSERT_TRUE(sprites.addSprite({ 1, 1, { blue }, { 1 } }));
+    // A sprite walking right while another one blinks
+    for (int8_t x = 0; x < 12; ++x)
+    {
+        std::vector<Placement> frame{ { 0, x, 4, 0 } };
+        if (x % 2)
+        {
+            frame.push_back({ 1, 8, 8, 0 });
+        }
+        ASSERT_TRUE(sprites.addFrame(frame));
+    }
+
+    sprites.render(incremental, 0, Sprites::none);
+    for (size_t f = 1; f < sprites.size(); ++f)
+    {
+        sprites.render(incremental, f, f - 1);
+        sprites.render(full, f, Sprites::none);
+        ASSERT_EQ(incremental.wireFrame(), full.wireFrame()) << "frame " << f;
+    }
+}
+
+TEST(SpriteFramesTest, AnimatorPlaysSpritesWithoutPoolSlots)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+    auto& pool = FramePool<MatrixAnimator<LedMatrix>::Frame>::instance();
+    auto inUse = [&pool]
+    {
+        const auto stats = pool.stats();
+        return stats.blocks - stats.freeBlocks;
+    };
+    const uint32_t pooled = inUse();
+
+    Sprites sprites = withBackground(grey);
+    ASSERT_TRUE(sprites.addSprite(corner()));
+    for (int8_t x = 0; x < 4; ++x)
+    {
+        const Placement frame[] = { { 0, x, 0, 0 } };
+        ASSERT_TRUE(sprites.addFrame(frame));
+    }
+    ASSERT_TRUE(animator.start(
+        MatrixAnimator<LedMatrix>::Clip{ std::in_place_type<Sprites>, std::move(sprites) },
+        Timeline::uniform(4, 30)));
+    vTaskDelay(pdMS_TO_TICKS(300));
+    EXPECT_EQ(inUse(), pooled);
+    animator.stop();
+
+    // The four frames cycle
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_GE(frames.size(), 6u);
+    EXPECT_NE(frames[0].grb, frames[1].grb);
+    for (size_t i = 4; i < frames.size(); ++i)
+    {
+        EXPECT_EQ(frames[i].grb, frames[i - 4].grb) << "frame " << i;
+    }
+}
@@ -0,0 +1,590 @@
+#include "StorageManager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+class StorageManagerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        basePath_ = std::filesystem::temp_directory_path()
+            / ("framepix_spiffs_"
+               + std::string(::testing::UnitTest::GetInstance()
+                                 ->current_test_info()
+                                 ->name()));
+        std::filesystem::remove_all(basePath_);
+        basePathStr_ = basePath_.string();
+        ASSERT_TRUE(spiffs_.init(Spiffs::Config{ .basePath = basePathStr_ }));
+        ASSERT_TRUE(storage_.init());
+    }
+
+    void TearDown() override
+    {
+        (void)spiffs_.deinit();
+        std::filesystem::remove_all(basePath_);
+    }
+
+    static std::array<LedMatrix::RGB, LedMatrix::numPixels>
+    gradient(uint8_t offset)
+    {
+        std::array<LedMatrix::RGB, LedMatrix::numPixels> pixels;
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            auto v = static_cast<uint8_t>(i + offset);
+            pixels[i] = { v, static_cast<uint8_t>(255 - v), offset };
+        }
+        return pixels;
+    }
+
+    static bool equal(
+        const std::array<LedMatrix::RGB, LedMatrix::numPixels>& a,
+        const std::array<LedMatrix::RGB, LedMatrix::numPixels>& b)
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].r != b[i].r || a[i].g != b[i].g || a[i].b != b[i].b)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::filesystem::path basePath_;
+    std::string basePathStr_;
+    Spiffs spiffs_;
+    StorageManager storage_{ spiffs_ };
+};
+}  // namespace
+
+TEST_F(StorageManagerTest, DesignRoundTrip)
+{
+    StorageManager::Design design{ "heart", gradient(3) };
+    ASSERT_TRUE(storage_.saveDesign(design));
+
+    auto loaded = storage_.loadDesign("heart");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->name, "heart");
+    EXPECT_TRUE(equal(loaded->pixels, design.pixels));
+    EXPECT_EQ(storage_.listDesigns(), std::vector<std::string>{ "heart" });
+
+    EXPECT_TRUE(storage_.deleteDesign("heart"));
+    EXPECT_FALSE(storage_.loadDesign("heart").has_value());
+}
+
+TEST_F(StorageManagerTest, ConcurrentSavesKeepEveryIndexEntry)
+{
+    // Each save rewrites the whole index, unlocked ones drop each other's
+    // entries
+    auto save = [this](const char* prefix)
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            EXPECT_TRUE(storage_.saveDesign(
+                { prefix + std::to_string(i), gradient(static_cast<uint8_t>(i)) }));
+        }
+    };
+    std::thread other{ save, "b" };
+    save("a");
+    other.join();
+
+    auto designs = storage_.listDesigns();
+    EXPECT_EQ(designs.size(), 40u);
+    for (int i = 0; i < 20; ++i)
+    {
+        for (const char* prefix : { "a", "b" })
+        {
+            const std::string name = prefix + std::to_string(i);
+            EXPECT_NE(std::find(designs.begin(), designs.end(), name), designs.end())
+                << name;
+        }
+    }
+}
+
+TEST_F(StorageManagerTest, AnimationRoundTrip)
+{
+    StorageManager::Animation animation;
+    animation.name = "blink";
+    animation.intervalMs = 120;
+    animation.frames.push_back(gradient(0));
+    animation.frames.push_back(gradient(50));
+    ASSERT_TRUE(storage_.saveAnimation(animation));
+
+    auto loaded = storage_.loadAnimation("blink");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->intervalMs, 120);
+    ASSERT_EQ(loaded->frames.size(), 2u);
+    EXPECT_TRUE(equal(loaded->frames[1], animation.frames[1]));
+}
+
+TEST_F(StorageManagerTest, AnimationsSpanningPoolBlocksAreStreamed)
+{
+    StorageManager::Animation animation;
+    animation.name = "long";
+    animation.intervalMs = 40;
+    for (uint8_t f = 0; f < 40; ++f)
+    {
+        animation.frames.push_back(gradient(f));
+    }
+    ASSERT_TRUE(storage_.saveAnimation(animation));
+
+    // Same bytes as the whole item serialized at once
+    const auto serialized = StorageManager::serializeAnimation(animation);
+    EXPECT_EQ(std::filesystem::file_size(basePath_ / "anim_long.bin"), serialized.size());
+
+    auto loaded = storage_.loadAnimation("long");
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->frames.size(), 40u);
+    ASSERT_EQ(loaded->timeline.entries.size(), 40u);
+    for (size_t f: { 0, 15, 16, 39 })
+    {
+        EXPECT_TRUE(equal(loaded->frames[f], animation.frames[f]));
+    }
+}
+
+TEST_F(StorageManagerTest, BootFrameFollowsLastUsed)
+{
+    StorageManager::Animation animation;
+    animation.name = "blink";
+    animation.intervalMs = 100;
+    animation.frames.push_back(gradient(7));
+    animation.frames.push_back(gradient(9));
+    ASSERT_TRUE(storage_.saveAnimation(animation));
+    ASSERT_TRUE(storage_.saveLastUsed("blink", true));
+
+    auto bootFrame = storage_.loadBootFrame();
+    ASSERT_TRUE(bootFrame.has_value());
+    EXPECT_EQ(bootFrame->name, "blink");
+    EXPECT_TRUE(bootFrame->isAnimation);
+    EXPECT_TRUE(equal(bootFrame->pixels, animation.frames[0]));
+
+    ASSERT_TRUE(storage_.deleteAnimation("blink"));
+    EXPECT_FALSE(storage_.loadBootFrame().has_value());
+    EXPECT_FALSE(storage_.loadLastUsed().has_value());
+}
+
+TEST_F(StorageManagerTest, BootFrameKeepsLongNames)
+{
+    const std::string name(40, 'n');
+    ASSERT_TRUE(storage_.saveDesign({ name, gradient(4) }));
+    ASSERT_TRUE(storage_.saveLastUsed(name, false));
+    auto bootFrame = storage_.loadBootFrame();
+    ASSERT_TRUE(bootFrame.has_value());
+    EXPECT_EQ(bootFrame->name, name);
+    EXPECT_TRUE(storage_.loadDesign(bootFrame->name).has_value());
+
+    // Longer than the 255 bytes a boot frame takes: none, boot goes by
+    // the last used record
+    EXPECT_FALSE(StorageManager::serializeBootFrame({ std::string(256, 't'), false, {} }));
+}
+
+TEST_F(StorageManagerTest, BootFrameFollowsSavesOfLastUsed)
+{
+    ASSERT_TRUE(storage_.saveDesign({ "heart", gradient(3) }));
+    ASSERT_TRUE(storage_.saveLastUsed("heart", false));
+
+    // An animation of the same name is another item
+    StorageManager::Animation animation;
+    animation.name = "heart";
+    animation.intervalMs = 100;
+    animation.frames.push_back(gradient(7));
+    ASSERT_TRUE(storage_.saveAnimation(animation));
+    auto bootFrame = storage_.loadBootFrame();
+    ASSERT_TRUE(bootFrame.has_value());
+    EXPECT_TRUE(equal(bootFrame->pixels, gradient(3)));
+
+    ASSERT_TRUE(storage_.saveDesign({ "heart", gradient(5) }));
+    bootFrame = storage_.loadBootFrame();
+    ASSERT_TRUE(bootFrame.has_value());
+    EXPECT_FALSE(bootFrame->isAnimation);
+    EXPECT_TRUE(equal(bootFrame->pixels, gradient(5)));
+}
+
+TEST_F(StorageManagerTest, AnimationTimelineRoundTrip)
+{
+    StorageManager::Animation animation;
+    animation.name = "bounce";
+    animation.intervalMs = 100;
+    animation.frames.push_back(gradient(1));
+    animation.frames.push_back(gradient(2));
+    animation.timeline.mode = Timeline::LoopMode::Segment;
+    animation.timeline.entries.push_back({ 0, 500 });
+    animation.timeline.entries.push_back({ 1, 40 });
+    animation.timeline.entries.push_back({ 0, 60 });
+    animation.timeline.loopStart = 1;
+    animation.timeline.loopEnd = 2;
+    ASSERT_TRUE(storage_.saveAnimation(animation));
+
+    auto loaded = storage_.loadAnimation("bounce");
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->frames.size(), 2u);
+    EXPECT_EQ(loaded->timeline.mode, Timeline::LoopMode::Segment);
+    EXPECT_EQ(loaded->timeline.loopStart, 1u);
+    EXPECT_EQ(loaded->timeline.loopEnd, 2u);
+    ASSERT_EQ(loaded->timeline.entries.size(), 3u);
+    EXPECT_EQ(loaded->timeline.entries[0].durationMs, 500u);
+    EXPECT_EQ(loaded->timeline.entries[2].frame, 0u);
+    EXPECT_TRUE(equal(loaded->frames[1], animation.frames[1]));
+}
+
+TEST_F(StorageManagerTest, ReadsVersionOneAnimations)
+{
+    StorageManager::Animation animation;
+    animation.name = "old";
+    animation.intervalMs = 50;
+    animation.frames.push_back(gradient(4));
+    animation.frames.push_back(gradient(4));
+    animation.frames.push_back(gradient(8));
+
+    // Version 1 is version 2 without the timeline: 8 byte header, 8 bytes
+    // per entry
+    auto data = StorageManager::serializeAnimation(animation);
+    data.resize(data.size() - 8 - 3 * 8);
+    data[1] = 1;
+
+    auto loaded = StorageManager::deserializeAnimation(data);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->intervalMs, 50);
+    // The held frame is stored once
+    ASSERT_EQ(loaded->frames.size(), 2u);
+    ASSERT_EQ(loaded->timeline.entries.size(), 2u);
+    EXPECT_EQ(loaded->timeline.entries[0].durationMs, 100u);
+    EXPECT_EQ(loaded->timeline.entries[1].durationMs, 50u);
+    EXPECT_TRUE(equal(loaded->frames[1], animation.frames[2]));
+
+    data[1] = 2;
+    EXPECT_FALSE(StorageManager::deserializeAnimation(data).has_value());
+}
+
+TEST_F(StorageManagerTest, PlaylistRoundTrip)
+{
+    EXPECT_FALSE(storage_.loadPlaylist().has_value());
+
+    StorageManager::Playlist playlist{
+        { { "heart", false, 5000, {} }, { "blink", true, 12000, {} } }, true
+    };
+    ASSERT_TRUE(storage_.savePlaylist(playlist));
+
+    auto loaded = storage_.loadPlaylist();
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_TRUE(loaded->active);
+    ASSERT_EQ(loaded->items.size(), 2u);
+    EXPECT_EQ(loaded->items[1].name, "blink");
+    EXPECT_TRUE(loaded->items[1].isAnimation);
+    EXPECT_EQ(loaded->items[1].dwellMs, 12000u);
+
+    ASSERT_TRUE(storage_.clearStorage());
+    EXPECT_FALSE(storage_.loadPlaylist().has_value());
+}
+
+TEST_F(StorageManagerTest, ClockRoundTrip)
+{
+    EXPECT_FALSE(storage_.loadClock().has_value());
+
+    ASSERT_TRUE(storage_.saveClock({ ClockOverlay::Mode::Date, { 10, 20, 30 }, true }));
+    auto loaded = storage_.loadClock();
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->mode, ClockOverlay::Mode::Date);
+    EXPECT_EQ(loaded->color.g, 20);
+    EXPECT_TRUE(loaded->top);
+
+    ASSERT_TRUE(storage_.clearStorage());
+    EXPECT_FALSE(storage_.loadClock().has_value());
+}
+
+TEST_F(StorageManagerTest, CanvasAnimationsPlayTheTile)
+{
+    // Two frames of a 32x16 canvas, every pixel a different red and green
+    {
+        StorageManager::CanvasAnimationWriter writer{ storage_, "wall", 32, 16 };
+        for (uint8_t frame = 0; frame < 2; ++frame)
+        {
+            std::vector<uint8_t> pixels;
+            for (uint8_t y = 0; y < 16; ++y)
+            {
+                for (uint8_t x = 0; x < 32; ++x)
+                {
+                    pixels.insert(pixels.end(), { x, y, frame });
+                }
+            }
+            ASSERT_TRUE(writer.addFrame(pixels));
+        }
+        ASSERT_TRUE(writer.finish(80, {}));
+    }
+    EXPECT_EQ(storage_.listAnimations(), std::vector<std::string>{ "wall" });
+
+    // The right half, mounted upside down
+    const VirtualCanvas canvas{ 32, 16, 16, 0, 16, 16, WS2812MatrixRotation::Rot180 };
+    ASSERT_TRUE(storage_.saveCanvas(canvas));
+    EXPECT_EQ(storage_.loadCanvas(), canvas);
+    storage_.setCanvas(canvas);
+
+    auto loaded = storage_.loadAnimation("wall");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->intervalMs, 80);
+    ASSERT_EQ(loaded->frames.size(), 2u);
+    ASSERT_EQ(loaded->timeline.entries.size(), 2u);
+    // Top left shows the bottom right corner of the canvas
+    EXPECT_EQ(loaded->frames[0][0].r, 31);
+    EXPECT_EQ(loaded->frames[0][0].g, 15);
+    EXPECT_EQ(loaded->frames[1][255].r, 16);
+    EXPECT_EQ(loaded->frames[1][255].g, 0);
+    EXPECT_EQ(loaded->frames[1][255].b, 1);
+
+    ASSERT_TRUE(storage_.saveLastUsed("wall", true));
+    auto bootFrame = storage_.loadBootFrame();
+    ASSERT_TRUE(bootFrame.has_value());
+    EXPECT_TRUE(equal(bootFrame->pixels, loaded->frames[0]));
+
+    // Not on a canvas this small
+    storage_.setCanvas({ 64, 16, 48, 0, 16, 16, WS2812MatrixRotation::Rot0 });
+    EXPECT_FALSE(storage_.loadAnimation("wall").has_value());
+}
+
+TEST_F(StorageManagerTest, CanvasAnimationsReadTheTileRows)
+{
+    // A 16x48 canvas with the tile in the middle rows
+    {
+        StorageManager::CanvasAnimationWriter writer{ storage_, "tall", 16, 48 };
+        for (uint8_t frame = 0; frame < 3; ++frame)
+        {
+            std::vector<uint8_t> pixels;
+            for (uint8_t y = 0; y < 48; ++y)
+            {
+                for (uint8_t x = 0; x < 16; ++x)
+                {
+                    pixels.insert(pixels.end(), { x, y, frame });
+                }
+            }
+            ASSERT_TRUE(writer.addFrame(pixels));
+        }
+        Timeline timeline;
+        timeline.entries = { { 0, 40 }, { 2, 30 }, { 1, 50 } };
+        ASSERT_TRUE(writer.finish(30, timeline));
+    }
+    storage_.setCanvas({ 16, 48, 0, 16, 16, 16, WS2812MatrixRotation::Rot0 });
+
+    auto loaded = storage_.loadAnimation("tall");
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->frames.size(), 3u);
+    ASSERT_EQ(loaded->timeline.entries.size(), 3u);
+    EXPECT_EQ(loaded->timeline.entries[2].durationMs, 50u);
+    const auto& second = loaded->frames[loaded->timeline.entries[1].frame];
+    EXPECT_EQ(second[0].g, 16);
+    EXPECT_EQ(second[0].b, 2);
+    EXPECT_EQ(loaded->frames[0][255].r, 15);
+    EXPECT_EQ(loaded->frames[0][255].g, 31);
+    EXPECT_EQ(loaded->frames[0][255].b, 0);
+
+    ASSERT_TRUE(storage_.saveLastUsed("tall", true));
+    auto bootFrame = storage_.loadBootFrame();
+    ASSERT_TRUE(bootFrame.has_value());
+    EXPECT_TRUE(equal(bootFrame->pixels, loaded->frames[0]));
+}
+
+TEST_F(StorageManagerTest, UnfinishedCanvasAnimationsAreDropped)
+{
+    {
+        StorageManager::CanvasAnimationWriter writer{ storage_, "wall", 16, 16 };
+        ASSERT_TRUE(writer.addFrame(std::vector<uint8_t>(16 * 16 * 3)));
+    }
+    {
+        // A frame of the wrong size fails the whole animation
+        StorageManager::CanvasAnimationWriter writer{ storage_, "wall", 16, 16 };
+        EXPECT_FALSE(writer.addFrame(std::vector<uint8_t>(32 * 16 * 3)));
+        EXPECT_FALSE(writer.finish(100, {}));
+    }
+    EXPECT_TRUE(storage_.listAnimations().empty());
+    EXPECT_FALSE(std::filesystem::exists(basePath_ / "canvas_upload.tmp"));
+}
+
+TEST_F(StorageManagerTest, CanvasMustHoldTheTile)
+{
+    EXPECT_FALSE(storage_.loadCanvas().has_value());
+    EXPECT_EQ(storage_.canvas(), VirtualCanvas::single(16, 16));
+    ASSERT_TRUE(storage_.saveCanvas({ 32, 16, 16, 8, 16, 16, WS2812MatrixRotation::Rot0 }));
+    EXPECT_FALSE(storage_.loadCanvas().has_value());
+}
+
+TEST_F(StorageManagerTest, EffectPresetRoundTrip)
+{
+    EXPECT_TRUE(storage_.listEffectPresets().empty());
+
+    Effect fire{ Effect::Kind::Fire, {} };
+    fire.params.speed = 200;
+    ASSERT_TRUE(storage_.saveEffectPreset("campfire", fire));
+    ASSERT_TRUE(storage_.saveEffectPreset("calm", { Effect::Kind::Plasma, {} }));
+    fire.params.intensity = 10;
+    ASSERT_TRUE(storage_.saveEffectPreset("campfire", fire));
+    EXPECT_EQ(storage_.listEffectPresets().size(), 2u);
+
+    auto loaded = storage_.loadEffectPreset("campfire");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->kind, Effect::Kind::Fire);
+    EXPECT_EQ(loaded->params.speed, 200);
+    EXPECT_EQ(loaded->params.intensity, 10);
+
+    ASSERT_TRUE(storage_.deleteEffectPreset("campfire"));
+    EXPECT_FALSE(storage_.loadEffectPreset("campfire").has_value());
+    EXPECT_FALSE(storage_.deleteEffectPreset("campfire"));
+    EXPECT_EQ(storage_.listEffectPresets().size(), 1u);
+}
+
+TEST_F(StorageManagerTest, SpriteAnimationRoundTrip)
+{
+    using Sprites = SpriteFrames<LedMatrix>;
+    Sprites sprites{ gradient(7) };
+    ASSERT_TRUE(sprites.addSprite({ 3, 1, { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } }, { 1, 0, 1 } }));
+    ASSERT_TRUE(sprites.addSprite({ 1, 1, { { 255, 0, 0 } }, { 1 } }));
+    const Sprites::Placement first[] = { { 0, -2, 3, Sprites::Placement::flipX },
+                                         { 1, 15, 15, 0 } };
+    ASSERT_TRUE(sprites.addFrame(first));
+    ASSERT_TRUE(sprites.addFrame({}));
+
+    StorageManager::SpriteAnimation animation{ "walk", 80, std::move(sprites), {} };
+    animation.timeline = Timeline::uniform(2, 80);
+    animation.timeline.entries[1].durationMs = 500;
+    ASSERT_TRUE(storage_.saveSpriteAnimation(animation));
+    EXPECT_EQ(storage_.listSpriteAnimations(), std::vector<std::string>{ "walk" });
+
+    auto loaded = storage_.loadSpriteAnimation("walk");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->intervalMs, 80);
+    EXPECT_TRUE(equal(loaded->frames.background(), gradient(7)));
+    ASSERT_EQ(loaded->frames.spriteCount(), 2u);
+    EXPECT_EQ(loaded->frames.sprite(0).width, 3);
+    EXPECT_EQ(loaded->frames.sprite(0).pixels[2].b, 9);
+    EXPECT_EQ(loaded->frames.sprite(0).opaque, (std::vector<uint8_t>{ 1, 0, 1 }));
+    ASSERT_EQ(loaded->frames.size(), 2u);
+    ASSERT_EQ(loaded->frames.placements(0).size(), 2u);
+    EXPECT_EQ(loaded->frames.placements(0)[0].x, -2);
+    EXPECT_EQ(loaded->frames.placements(0)[0].flags, Sprites::Placement::flipX);
+    EXPECT_TRUE(loaded->frames.placements(1).empty());
+    EXPECT_EQ(loaded->timeline.entries[1].durationMs, 500u);
+
+    // Cut short, it does not load
+    auto data = StorageManager::serializeSpriteAnimation(animation);
+    data.pop_back();
+    EXPECT_FALSE(StorageManager::deserializeSpriteAnimation(data).has_value());
+
+    ASSERT_TRUE(storage_.deleteSpriteAnimation("walk"));
+    EXPECT_FALSE(storage_.loadSpriteAnimation("walk").has_value());
+    EXPECT_TRUE(storage_.listSpriteAnimations().empty());
+}
+
+TEST_F(StorageManagerTest, MessageRoundTrip)
+{
+    EXPECT_TRUE(storage_.listMessages().empty());
+
+    ScrollingText hello;
+    hello.text = "Hello, world!";
+    hello.font = ScrollingText::Font::Large;
+    hello.color = { 255, 128, 0 };
+    hello.speed = 35;
+    hello.loop = false;
+    ASSERT_TRUE(storage_.saveMessage("hello", hello));
+    ASSERT_TRUE(storage_.saveMessage("bye", ScrollingText{ "Bye" }));
+    EXPECT_EQ(storage_.listMessages().size(), 2u);
+
+    auto loaded = storage_.loadMessage("hello");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->text, "Hello, world!");
+    EXPECT_EQ(loaded->font, ScrollingText::Font::Large);
+    EXPECT_EQ(loaded->color.g, 128);
+    EXPECT_EQ(loaded->speed, 35);
+    EXPECT_FALSE(loaded->loop);
+
+    // Effect presets live in their own file
+    EXPECT_TRUE(storage_.listEffectPresets().empty());
+    ASSERT_TRUE(storage_.deleteMessage("hello"));
+    EXPECT_FALSE(storage_.loadMessage("hello").has_value());
+    EXPECT_EQ(storage_.listMessages().size(), 1u);
+}
+
+TEST_F(StorageManagerTest, NamedEntriesSurviveLargeFiles)
+{
+    // Well past the 10 KB the files used to be read with
+    constexpr int messages = 40;
+    for (int i = 0; i < messages; ++i)
+    {
+        ScrollingText message{ std::string(500, static_cast<char>('a' + i % 26)) };
+        ASSERT_TRUE(storage_.saveMessage("message" + std::to_string(i), message));
+    }
+    ASSERT_GT(std::filesystem::file_size(basePath_ / "messages.json"), 10240u);
+    EXPECT_EQ(storage_.listMessages().size(), size_t{ messages });
+    auto loaded = storage_.loadMessage("message0");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->text, std::string(500, 'a'));
+
+    constexpr int presets = 300;
+    for (int i = 0; i < presets; ++i)
+    {
+        Effect effect{ Effect::Kind::Fire, {} };
+        effect.params.speed = static_cast<uint8_t>(i);
+        ASSERT_TRUE(storage_.saveEffectPreset("preset" + std::to_string(i), effect));
+    }
+    ASSERT_GT(std::filesystem::file_size(basePath_ / "effects.json"), 10240u);
+    EXPECT_EQ(storage_.listEffectPresets().size(), size_t{ presets });
+    auto preset = storage_.loadEffectPreset("preset7");
+    ASSERT_TRUE(preset.has_value());
+    EXPECT_EQ(preset->params.speed, 7);
+
+    // A few long shader sources are enough
+    const std::string source
+        = "; " + std::string(PixelShader::maxSourceLength / 2, '-') + "\nmov r, x\n";
+    auto shader = PixelShader::assemble(source);
+    ASSERT_TRUE(shader.has_value());
+    constexpr int shaders = 4;
+    for (int i = 0; i < shaders; ++i)
+    {
+        ASSERT_TRUE(storage_.saveShader("shader" + std::to_string(i), *shader));
+    }
+    ASSERT_GT(std::filesystem::file_size(basePath_ / "shaders.json"), 10240u);
+    EXPECT_EQ(storage_.listShaders().size(), size_t{ shaders });
+    auto loadedShader = storage_.loadShader("shader0");
+    ASSERT_TRUE(loadedShader.has_value());
+    EXPECT_EQ(loadedShader->source(), source);
+}
+
+TEST_F(StorageManagerTest, UnreadableNamedEntriesAreNotOverwritten)
+{
+    ASSERT_TRUE(storage_.saveMessage("hello", ScrollingText{ "Hello" }));
+    // Cut off, cJSON_Parse() takes trailing garbage but not this
+    const auto path = basePath_ / "messages.json";
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+    EXPECT_FALSE(storage_.saveMessage("bye", ScrollingText{ "Bye" }));
+    EXPECT_FALSE(storage_.deleteMessage("hello"));
+    std::ifstream file{ basePath_ / "messages.json" };
+    std::string content{ std::istreambuf_iterator<char>{ file }, {} };
+    EXPECT_NE(content.find("Hello"), std::string::npos);
+    EXPECT_EQ(content.find("Bye"), std::string::npos);
+}
+
+TEST_F(StorageManagerTest, ShaderRoundTrip)
+{
+    EXPECT_TRUE(storage_.listShaders().empty());
+
+    const char* source = "; stripes\nfract r6, x\nlt r, r6, 0.5\n";
+    auto shader = PixelShader::assemble(source);
+    ASSERT_TRUE(shader.has_value());
+    ASSERT_TRUE(storage_.saveShader("stripes", *shader));
+    EXPECT_EQ(storage_.listShaders(), std::vector<std::string>{ "stripes" });
+
+    // Stored as source, assembled again
+    auto loaded = storage_.loadShader("stripes");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->source(), source);
+    EXPECT_EQ(loaded->code().size(), shader->code().size());
+
+    ASSERT_TRUE(storage_.deleteShader("stripes"));
+    EXPECT_FALSE(storage_.loadShader("stripes").has_value());
+}
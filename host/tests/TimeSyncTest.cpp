@@ -0,0 +1,127 @@
+#include "TimeSync.hpp"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+// Two ports nothing listens on
+std::array<uint16_t, 2> freePorts()
+{
+    std::array<int, 2> fds;
+    std::array<uint16_t, 2> ports;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        fds[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        bind(fds[i], reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        getsockname(fds[i], reinterpret_cast<sockaddr*>(&address), &length);
+        ports[i] = ntohs(address.sin_port);
+    }
+    for (int fd: fds)
+    {
+        close(fd);
+    }
+    return ports;
+}
+
+// Announces to the other device over loopback, quickly
+TimeSync::Config loopbackConfig(uint32_t id, uint8_t priority, uint16_t port, uint16_t other)
+{
+    return { .id = id,
+             .priority = priority,
+             .port = port,
+             .announceAddress = INADDR_LOOPBACK,
+             .announcePort = other,
+             .announceMs = 50,
+             .exchangeMs = 40,
+             .leaderTimeoutMs = 300 };
+}
+
+template<typename Predicate> bool waitFor(Predicate predicate, uint32_t timeoutMs = 2000)
+{
+    for (uint32_t waited = 0; waited < timeoutMs; waited += portTICK_PERIOD_MS)
+    {
+        if (predicate())
+        {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return predicate();
+}
+
+// Where the shared epoch is in local time
+int64_t epochOffsetUs(const TimeSync& sync)
+{
+    return esp_timer_get_time() - sync.sinceEpochUs().value_or(0);
+}
+}  // namespace
+
+TEST(TimeSyncTest, HigherPriorityLeadsAndTheLeadPassesOnWithoutAJump)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    const auto [portA, portB] = freePorts();
+    TimeSync a{ loopbackConfig(5, 2, portA, portB) };
+    TimeSync b{ loopbackConfig(3, 1, portB, portA) };
+    ASSERT_TRUE(a.start());
+    ASSERT_TRUE(b.start());
+    EXPECT_FALSE(b.sinceEpochUs().has_value());
+
+    ASSERT_TRUE(waitFor([&] { return a.stats().leading && b.stats().synced; }));
+    EXPECT_FALSE(b.stats().leading);
+    EXPECT_EQ(b.stats().leaderId, 5u);
+    // Both on the same time, well within a frame
+    EXPECT_NEAR(epochOffsetUs(a), epochOffsetUs(b), 2'000);
+    EXPECT_LT(b.stats().clock.errorUs, 16'667u);
+
+    // Not a sync message
+    const int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(portB);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const char junk[] = "FPTS?";
+    sendto(fd, junk, sizeof(junk), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+    close(fd);
+    EXPECT_TRUE(waitFor([&] { return b.stats().invalid == 1; }));
+
+    // B takes over when A leaves, and keeps playing on A's time
+    const int64_t epochUs = epochOffsetUs(b);
+    a.stop();
+    ASSERT_TRUE(waitFor([&] { return b.stats().leading; }));
+    EXPECT_TRUE(b.stats().synced);
+    EXPECT_NEAR(epochOffsetUs(b), epochUs, 2'000);
+    b.stop();
+}
+
+TEST(TimeSyncTest, AJoiningLeaderKeepsTheGroupTime)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    const auto [portA, portB] = freePorts();
+    TimeSync a{ loopbackConfig(5, 1, portA, portB) };
+    ASSERT_TRUE(a.start());
+    ASSERT_TRUE(waitFor([&] { return a.stats().leading; }));
+    const int64_t epochUs = epochOffsetUs(a);
+
+    // B outranks A, but first takes A's time
+    TimeSync b{ loopbackConfig(3, 2, portB, portA) };
+    ASSERT_TRUE(b.start());
+    ASSERT_TRUE(waitFor([&] { return b.stats().leading && a.stats().leaderId == 3; }));
+    ASSERT_TRUE(waitFor([&] { return a.stats().synced; }));
+    EXPECT_FALSE(a.stats().leading);
+    EXPECT_EQ(a.stats().leaderChanges, 1u);
+    EXPECT_NEAR(epochOffsetUs(a), epochUs, 2'000);
+    EXPECT_NEAR(epochOffsetUs(b), epochUs, 2'000);
+    b.stop();
+    a.stop();
+}
@@ -0,0 +1,253 @@
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "Timeline.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using HostSim::Ws2812Sink;
+using LoopMode = Timeline::LoopMode;
+
+namespace
+{
+using Animator = MatrixAnimator<LedMatrix>;
+
+Timeline makeTimeline(size_t numEntries, LoopMode mode)
+{
+    Timeline timeline = Timeline::uniform(numEntries, 10);
+    timeline.mode = mode;
+    return timeline;
+}
+
+// Entry indices visited, starting at begin()
+std::vector<size_t> play(const Timeline& timeline, size_t steps)
+{
+    std::vector<size_t> visited;
+    auto cursor = timeline.begin();
+    for (size_t i = 0; i < steps && !cursor.holding; ++i)
+    {
+        visited.push_back(cursor.entry);
+        timeline.advance(cursor);
+    }
+    return visited;
+}
+
+Animator::Frames makeFrames(std::initializer_list<uint8_t> levels)
+{
+    Animator::Frames frames;
+    for (auto level: levels)
+    {
+        Animator::Frame frame;
+        frame.fill({ level, level, level });
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+uint8_t level(const Animator::Frame& frame) { return frame[0].r; }
+}  // namespace
+
+TEST(TimelineTest, LoopModes)
+{
+    using V = std::vector<size_t>;
+    EXPECT_EQ(play(makeTimeline(3, LoopMode::Loop), 7), (V{ 0, 1, 2, 0, 1, 2, 0 }));
+    EXPECT_EQ(
+        play(makeTimeline(3, LoopMode::PingPong), 8), (V{ 0, 1, 2, 1, 0, 1, 2, 1 }));
+    EXPECT_EQ(play(makeTimeline(3, LoopMode::Once), 7), (V{ 0, 1, 2 }));
+
+    auto segment = makeTimeline(5, LoopMode::Segment);
+    segment.loopStart = 1;
+    segment.loopEnd = 3;
+    EXPECT_EQ(play(segment, 9), (V{ 0, 1, 2, 3, 1, 2, 3, 1, 2 }));
+
+    EXPECT_EQ(play(makeTimeline(1, LoopMode::PingPong), 3), (V{ 0, 0, 0 }));
+}
+
+TEST(TimelineTest, SeekFindsWherePlaybackIs)
+{
+    // Entries 10 ms each: seek() lands where advance() gets to
+    for (auto mode: { LoopMode::Loop, LoopMode::PingPong, LoopMode::Once, LoopMode::Segment })
+    {
+        auto timeline = makeTimeline(4, mode);
+        timeline.loopStart = 1;
+        timeline.loopEnd = 2;
+        const auto visited = play(timeline, 12);
+        for (size_t i = 0; i < visited.size(); ++i)
+        {
+            const auto position = timeline.seek(i * 10'000 + 4'000);
+            EXPECT_EQ(position.cursor.entry, visited[i])
+                << Timeline::toString(mode) << " " << i;
+            EXPECT_EQ(position.remainingUs, 6'000u);
+            EXPECT_FALSE(position.cursor.holding);
+        }
+    }
+    EXPECT_TRUE(makeTimeline(4, LoopMode::Once).seek(40'000).cursor.holding);
+
+    Timeline timeline;
+    timeline.entries.push_back({ 0, 100 });
+    timeline.entries.push_back({ 1, 20 });
+    // Ten loops later
+    EXPECT_EQ(timeline.seek(1'200'000 + 110'000).cursor.entry, 1u);
+    EXPECT_EQ(timeline.seek(1'200'000 + 110'000).remainingUs, 10'000u);
+    EXPECT_EQ(timeline.seek(1'200'000).cursor.entry, 0u);
+}
+
+TEST(TimelineTest, Validation)
+{
+    auto timeline = makeTimeline(3, LoopMode::Segment);
+    timeline.loopStart = 1;
+    timeline.loopEnd = 2;
+    EXPECT_TRUE(timeline.valid(3));
+    EXPECT_FALSE(timeline.valid(2));
+
+    timeline.loopEnd = 3;
+    EXPECT_FALSE(timeline.valid(3));
+
+    EXPECT_FALSE(Timeline{}.valid(3));
+    auto zero = Timeline::uniform(2, 0);
+    EXPECT_FALSE(zero.valid(2));
+}
+
+TEST(TimelineTest, LoopModeNamesRoundTrip)
+{
+    for (auto mode: { LoopMode::Loop, LoopMode::PingPong, LoopMode::Once, LoopMode::Segment })
+    {
+        EXPECT_EQ(Timeline::parseLoopMode(Timeline::toString(mode)), mode);
+    }
+    EXPECT_FALSE(Timeline::parseLoopMode("bounce").has_value());
+}
+
+TEST(TimelineTest, DeduplicateMergesHoldsAndSharesFrames)
+{
+    // A, A, A, B, A, C, C at 10 ms each
+    auto frames = makeFrames({ 1, 1, 1, 2, 1, 3, 3 });
+    auto timeline = Timeline::uniform(frames.size(), 10);
+    deduplicate(frames, timeline);
+
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(level(frames[0]), 1);
+    EXPECT_EQ(level(frames[1]), 2);
+    EXPECT_EQ(level(frames[2]), 3);
+
+    ASSERT_EQ(timeline.entries.size(), 4u);
+    EXPECT_EQ(timeline.entries[0].frame, 0);
+    EXPECT_EQ(timeline.entries[0].durationMs, 30u);
+    EXPECT_EQ(timeline.entries[1].frame, 1);
+    EXPECT_EQ(timeline.entries[2].frame, 0);
+    EXPECT_EQ(timeline.entries[3].frame, 2);
+    EXPECT_EQ(timeline.entries[3].durationMs, 20u);
+}
+
+TEST(TimelineTest, DeduplicateKeepsSegmentBounds)
+{
+    // Intro A A, loop A B B, outro B
+    auto frames = makeFrames({ 1, 1, 1, 2, 2, 2 });
+    auto timeline = Timeline::uniform(frames.size(), 10);
+    timeline.mode = LoopMode::Segment;
+    timeline.loopStart = 2;
+    timeline.loopEnd = 4;
+    deduplicate(frames, timeline);
+
+    ASSERT_TRUE(timeline.valid(frames.size()));
+    ASSERT_EQ(timeline.entries.size(), 4u);
+    EXPECT_EQ(timeline.loopStart, 1);
+    EXPECT_EQ(timeline.loopEnd, 2);
+    EXPECT_EQ(timeline.entries[0].durationMs, 20u);
+    EXPECT_EQ(timeline.entries[2].durationMs, 20u);
+    EXPECT_EQ(timeline.entries[3].durationMs, 10u);
+}
+
+TEST(TimelineTest, DeduplicateKeepsPingPongEnds)
+{
+    // The end entries show once per turn, the inner ones twice: only the
+    // inner B B may become one entry
+    auto frames = makeFrames({ 1, 1, 2, 2, 3, 3 });
+    auto timeline = Timeline::uniform(frames.size(), 10);
+    timeline.mode = LoopMode::PingPong;
+    deduplicate(frames, timeline);
+
+    ASSERT_TRUE(timeline.valid(frames.size()));
+    ASSERT_EQ(timeline.entries.size(), 5u);
+    const uint8_t levels[] = { 1, 1, 2, 3, 3 };
+    const uint32_t durations[] = { 10, 10, 20, 10, 10 };
+    for (size_t i = 0; i < timeline.entries.size(); ++i)
+    {
+        EXPECT_EQ(level(frames[timeline.entries[i].frame]), levels[i]) << "entry " << i;
+        EXPECT_EQ(timeline.entries[i].durationMs, durations[i]) << "entry " << i;
+    }
+}
+
+TEST(TimelineTest, DeduplicateStartsWithFrameZero)
+{
+    auto frames = makeFrames({ 1, 2, 3 });
+    Timeline timeline;
+    timeline.entries.push_back({ 2, 10 });
+    timeline.entries.push_back({ 1, 10 });
+    deduplicate(frames, timeline);
+
+    // Frame 0 was never shown, frame 2 moved to the front
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(timeline.entries[0].frame, 0);
+    EXPECT_EQ(level(frames[0]), 3);
+    EXPECT_EQ(level(frames[timeline.entries[1].frame]), 2);
+}
+
+TEST(TimelineTest, AnimatorHoldsTheLastFrameOfAOnceTimeline)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    Animator animator{ matrix };
+
+    Timeline timeline;
+    timeline.mode = LoopMode::Once;
+    timeline.entries.push_back({ 0, 120 });
+    timeline.entries.push_back({ 1, 30 });
+    timeline.entries.push_back({ 0, 30 });
+    ASSERT_TRUE(animator.start(makeFrames({ 10, 200 }), std::move(timeline)));
+    vTaskDelay(pdMS_TO_TICKS(400));
+    animator.stop();
+
+    const auto frames = Ws2812Sink::instance().frames();
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_NEAR(frames[1].startUs - frames[0].startUs, 120'000, 15'000);
+    EXPECT_NEAR(frames[2].startUs - frames[1].startUs, 30'000, 15'000);
+    EXPECT_EQ(frames[2].grb, frames[0].grb);
+    EXPECT_NE(frames[1].grb, frames[0].grb);
+}
+
+TEST(TimelineTest, AnimatorShowsEntriesShorterThanATickForOne)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    Animator animator{ matrix };
+
+    Timeline timeline = Timeline::uniform(2, 5);
+    ASSERT_LT(5u, portTICK_PERIOD_MS);
+    ASSERT_TRUE(animator.start(makeFrames({ 10, 200 }), std::move(timeline)));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    animator.stop();
+
+    // Every frame took a tick, so there were a few but not 20
+    const auto frames = Ws2812Sink::instance().frames();
+    EXPECT_GE(frames.size(), 3u);
+    EXPECT_LE(frames.size(), 12u);
+}
+
+TEST(TimelineTest, AnimatorRejectsTimelinesThatDoNotFit)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    Animator animator{ matrix };
+
+    Timeline timeline = Timeline::uniform(3, 10);
+    EXPECT_FALSE(animator.start(makeFrames({ 1, 2 }), std::move(timeline)));
+}
@@ -0,0 +1,171 @@
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "Transition.hpp"
+#include "Ws2812Sink.hpp"
+
+#include <gtest/gtest.h>
+
+using HostSim::Ws2812Sink;
+using Kind = Transition::Kind;
+
+namespace
+{
+using WireColor = LedMatrix::WireColor;
+constexpr uint16_t W = LedMatrix::width;
+constexpr uint16_t H = LedMatrix::height;
+
+// Old content: green level 100 + x, new content: blue level 10 + x
+WireColor oldColor(uint16_t x) { return { static_cast<uint8_t>(100 + x), 0, 0 }; }
+WireColor newColor(uint16_t x) { return { 0, 0, static_cast<uint8_t>(10 + x) }; }
+
+// Blends the two test contents at progress
+void blend(LedMatrix& matrix, Kind kind, uint32_t progress)
+{
+    for (uint16_t y = 0; y < H; ++y)
+    {
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            matrix.setWirePixel(x, y, oldColor(x));
+        }
+    }
+    const LedMatrix::WireFrame from = matrix.wireFrame();
+    for (uint16_t y = 0; y < H; ++y)
+    {
+        for (uint16_t x = 0; x < W; ++x)
+        {
+            matrix.setWirePixel(x, y, newColor(x));
+        }
+    }
+    blendTransition(matrix, from, kind, progress);
+}
+
+bool isOld(WireColor c, uint16_t x) { return c.g == oldColor(x).g && c.b == 0; }
+bool isNew(WireColor c, uint16_t x) { return c.b == newColor(x).b && c.g == 0; }
+}  // namespace
+
+TEST(TransitionTest, EndsShowOneSideOnly)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    for (auto kind: { Kind::Crossfade, Kind::Wipe, Kind::Dissolve, Kind::Slide })
+    {
+        blend(matrix, kind, 0);
+        EXPECT_TRUE(isOld(matrix.wirePixel(3, 5), 3)) << Transition::toString(kind);
+        blend(matrix, kind, Transition::full);
+        EXPECT_TRUE(isNew(matrix.wirePixel(3, 5), 3)) << Transition::toString(kind);
+    }
+}
+
+TEST(TransitionTest, CrossfadeMixesLinearly)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    blend(matrix, Kind::Crossfade, 64);
+    const auto c = matrix.wirePixel(4, 7);
+    EXPECT_EQ(c.g, (104 * 192) >> 8);
+    EXPECT_EQ(c.b, (14 * 64) >> 8);
+}
+
+TEST(TransitionTest, WipeUncoversColumnsFromTheLeft)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    blend(matrix, Kind::Wipe, Transition::full / 4);
+    for (uint16_t x = 0; x < W; ++x)
+    {
+        const auto c = matrix.wirePixel(x, 9);
+        EXPECT_TRUE(x < W / 4 ? isNew(c, x) : isOld(c, x)) << "x " << x;
+    }
+}
+
+TEST(TransitionTest, SlidePushesTheOldContentLeft)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    const uint16_t shift = W / 4;
+    blend(matrix, Kind::Slide, Transition::full / 4);
+    for (uint16_t x = 0; x < W; ++x)
+    {
+        const auto c = matrix.wirePixel(x, 2);
+        if (x + shift < W)
+        {
+            EXPECT_TRUE(isOld(c, x + shift)) << "x " << x;
+        }
+        else
+        {
+            EXPECT_TRUE(isNew(c, x + shift - W)) << "x " << x;
+        }
+    }
+}
+
+TEST(TransitionTest, DissolveOnlyEverAddsPixels)
+{
+    LedMatrix matrix{ GPIO_NUM_6 };
+    std::vector<bool> switched(LedMatrix::numPixels, false);
+    size_t previousCount = 0;
+    for (uint32_t progress = 0; progress <= Transition::full; progress += 32)
+    {
+        blend(matrix, Kind::Dissolve, progress);
+        size_t count = 0;
+        for (uint16_t y = 0; y < H; ++y)
+        {
+            for (uint16_t x = 0; x < W; ++x)
+            {
+                const bool now = isNew(matrix.wirePixel(x, y), x);
+                EXPECT_TRUE(now || !switched[y * W + x]);
+                switched[y * W + x] = now;
+                count += now;
+            }
+        }
+        EXPECT_GE(count, previousCount);
+        previousCount = count;
+    }
+    EXPECT_EQ(previousCount, LedMatrix::numPixels);
+}
+
+TEST(TransitionTest, KindNamesRoundTrip)
+{
+    for (auto kind:
+         { Kind::Cut, Kind::Crossfade, Kind::Wipe, Kind::Dissolve, Kind::Slide })
+    {
+        EXPECT_EQ(Transition::parseKind(Transition::toString(kind)), kind);
+    }
+    EXPECT_FALSE(Transition::parseKind("fade").has_value());
+}
+
+TEST(TransitionTest, AnimatorCrossfadesBetweenStills)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Ws2812Sink::instance().clear();
+    Ws2812Sink::instance().setRealtime(true);
+
+    LedMatrix matrix{ GPIO_NUM_6 };
+    ASSERT_TRUE(matrix.init());
+    MatrixAnimator<LedMatrix> animator{ matrix };
+
+    std::array<LedMatrix::RGB, LedMatrix::numPixels> red;
+    red.fill({ 255, 0, 0 });
+    std::array<LedMatrix::RGB, LedMatrix::numPixels> blue;
+    blue.fill({ 0, 0, 255 });
+    ASSERT_TRUE(animator.show(red, {}));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    ASSERT_TRUE(animator.show(blue, { Kind::Crossfade, 200 }));
+    vTaskDelay(pdMS_TO_TICKS(400));
+    animator.stop();
+
+    // Red, a run of mixed frames, then blue (GRB on the wire)
+    size_t mixed = 0;
+    int lastBlue = -1;
+    for (const auto& frame: Ws2812Sink::instance().frames())
+    {
+        const int r = frame.grb[1];
+        const int b = frame.grb[2];
+        if (r > 0 && b > 0)
+        {
+            ++mixed;
+            EXPECT_GE(b, lastBlue) << "the new content only gets stronger";
+            lastBlue = b;
+        }
+    }
+    EXPECT_GE(mixed, 5u);
+    const auto last = Ws2812Sink::instance().lastFrame();
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(last->grb[1], 0);
+    EXPECT_GT(last->grb[2], 0);
+}
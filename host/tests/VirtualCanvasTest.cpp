@@ -0,0 +1,118 @@
+#include "VirtualCanvas.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+// Every pixel holds its own coordinates
+std::vector<uint8_t> coordinateFrame(const VirtualCanvas& canvas)
+{
+    std::vector<uint8_t> frame;
+    for (uint16_t y = 0; y < canvas.height; ++y)
+    {
+        for (uint16_t x = 0; x < canvas.width; ++x)
+        {
+            frame.insert(frame.end(), { static_cast<uint8_t>(x), static_cast<uint8_t>(y), 7 });
+        }
+    }
+    return frame;
+}
+
+// A 3x2 matrix at (2, 1) of an 8x6 canvas
+VirtualCanvas tile(WS2812MatrixRotation rotation)
+{
+    return { 8, 6, 2, 1, 3, 2, rotation };
+}
+}  // namespace
+
+TEST(VirtualCanvasTest, RotatedTilesShowTheirCorner)
+{
+    // Canvas pixel shown by the matrix's top left and bottom right pixel
+    struct Expected
+    {
+        WS2812MatrixRotation rotation;
+        uint8_t topLeft[2];
+        uint8_t bottomRight[2];
+    };
+    const Expected expected[] = {
+        { WS2812MatrixRotation::Rot0, { 2, 1 }, { 4, 2 } },
+        { WS2812MatrixRotation::Rot90, { 3, 1 }, { 2, 3 } },
+        { WS2812MatrixRotation::Rot180, { 4, 2 }, { 2, 1 } },
+        { WS2812MatrixRotation::Rot270, { 2, 3 }, { 3, 1 } },
+    };
+    for (const auto& [rotation, topLeft, bottomRight]: expected)
+    {
+        const VirtualCanvas canvas = tile(rotation);
+        ASSERT_TRUE(canvas.valid());
+        std::vector<uint8_t> matrix(3 * 2 * 3);
+        const auto frame = coordinateFrame(canvas);
+        EXPECT_EQ(canvas.crop(0, frame, matrix), matrix.size());
+        EXPECT_EQ(matrix[0], topLeft[0]);
+        EXPECT_EQ(matrix[1], topLeft[1]);
+        EXPECT_EQ(matrix[15], bottomRight[0]);
+        EXPECT_EQ(matrix[16], bottomRight[1]);
+
+        // pixelAt() agrees with the crop
+        for (uint16_t y = 0; y < canvas.height; ++y)
+        {
+            for (uint16_t x = 0; x < canvas.width; ++x)
+            {
+                if (const auto pixel = canvas.pixelAt(x, y))
+                {
+                    EXPECT_EQ(matrix[*pixel * 3], x);
+                    EXPECT_EQ(matrix[*pixel * 3 + 1], y);
+                    EXPECT_EQ(matrix[*pixel * 3 + 2], 7);
+                }
+            }
+        }
+    }
+    // Turned, the tile is 2 pixels wide and 3 high
+    EXPECT_EQ(tile(WS2812MatrixRotation::Rot90).tileWidth(), 2);
+    EXPECT_EQ(tile(WS2812MatrixRotation::Rot90).tileHeight(), 3);
+    EXPECT_FALSE(tile(WS2812MatrixRotation::Rot0).pixelAt(5, 1).has_value());
+}
+
+TEST(VirtualCanvasTest, CropsPiecesAsTheyCome)
+{
+    for (auto rotation: { WS2812MatrixRotation::Rot0, WS2812MatrixRotation::Rot270 })
+    {
+        const VirtualCanvas canvas = tile(rotation);
+        const auto frame = coordinateFrame(canvas);
+        std::vector<uint8_t> whole(18);
+        canvas.crop(0, frame, whole);
+
+        // Pieces that split pixels, only the tile's rows are written
+        std::vector<uint8_t> pieces(18);
+        size_t written = 0;
+        for (size_t offset = 0; offset < frame.size(); offset += 7)
+        {
+            const size_t size = std::min<size_t>(7, frame.size() - offset);
+            written += canvas.crop(offset, std::span{ frame }.subspan(offset, size), pieces);
+        }
+        EXPECT_EQ(written, pieces.size());
+        EXPECT_EQ(pieces, whole);
+        EXPECT_EQ(canvas.firstChannel(), 8u * 3);
+        EXPECT_EQ(canvas.endChannel(), 8u * 3 * (rotation == WS2812MatrixRotation::Rot0 ? 3 : 4));
+    }
+}
+
+TEST(VirtualCanvasTest, TheTileMustBeInsideTheCanvas)
+{
+    EXPECT_TRUE(VirtualCanvas::single(16, 16).valid());
+    EXPECT_FALSE((VirtualCanvas{ 8, 6, 6, 1, 3, 2, WS2812MatrixRotation::Rot0 }.valid()));
+    // Turned, it is higher than the canvas
+    EXPECT_FALSE((VirtualCanvas{ 8, 2, 0, 0, 3, 2, WS2812MatrixRotation::Rot90 }.valid()));
+    EXPECT_FALSE((VirtualCanvas{ 8, 6, 0, 0, 0, 2, WS2812MatrixRotation::Rot0 }.valid()));
+}
+
+TEST(VirtualCanvasTest, TheCanvasMustFitADecoder)
+{
+    EXPECT_TRUE((VirtualCanvas{ 256, 256, 0, 0, 16, 16, WS2812MatrixRotation::Rot0 }.valid()));
+    // Within the pixel budget, but longer than any GIF
+    EXPECT_FALSE((VirtualCanvas{ 8192, 16, 0, 0, 16, 16, WS2812MatrixRotation::Rot0 }.valid()));
+    EXPECT_FALSE((VirtualCanvas{ 1024, 1024, 0, 0, 16, 16, WS2812MatrixRotation::Rot0 }.valid()));
+    EXPECT_FALSE(
+        (VirtualCanvas{ UINT16_MAX, UINT16_MAX, 0, 0, 16, 16, WS2812MatrixRotation::Rot0 }.valid()));
+}
@@ -0,0 +1,171 @@
+#include "ClockOverlay.hpp"
+
+#include <esp_log.h>
+
+namespace
+{
+// 3x5 digits, rows top to bottom, 3 bits per row (left pixel first)
+constexpr uint16_t digits[10] = {
+    0b111'101'101'101'111,  // 0
+    0b010'110'010'010'111,  // 1
+    0b111'001'111'100'111,  // 2
+    0b111'001'111'001'111,  // 3
+    0b101'101'111'001'001,  // 4
+    0b111'100'111'001'111,  // 5
+    0b111'100'111'101'111,  // 6
+    0b111'001'001'001'001,  // 7
+    0b111'101'111'101'111,  // 8
+    0b111'101'111'001'111,  // 9
+};
+
+// Behind the digits, so they stay readable on bright content
+constexpr uint8_t bandAlpha = 112;
+
+// Anything before this means SNTP has not set the clock yet
+constexpr int firstValidYear = 2024;
+}  // namespace
+
+ClockOverlay::ClockOverlay()
+    : OverlayLayer{ Blend::Alpha }
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+ClockOverlay::~ClockOverlay()
+{
+    if (lock_)
+    {
+        vSemaphoreDelete(lock_);
+    }
+}
+
+void ClockOverlay::configure(const Settings& settings)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    settings_ = settings;
+    dirty_ = true;
+    xSemaphoreGive(lock_);
+    ESP_LOGI(TAG, "Clock overlay: %s", toString(settings.mode));
+}
+
+ClockOverlay::Settings ClockOverlay::settings() const
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    Settings settings = settings_;
+    xSemaphoreGive(lock_);
+    return settings;
+}
+
+bool ClockOverlay::refresh(int64_t)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    const Settings settings = settings_;
+    const bool dirty = dirty_;
+    dirty_ = false;
+    xSemaphoreGive(lock_);
+
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+
+    int shown = -1;
+    if (settings.mode != Mode::Off && local.tm_year + 1900 >= firstValidYear)
+    {
+        shown = settings.mode == Mode::Time ? local.tm_hour * 60 + local.tm_min
+                                            : local.tm_yday;
+    }
+    if (!dirty && shown == shown_)
+    {
+        return false;
+    }
+    shown_ = shown;
+
+    if (shown < 0)
+    {
+        clear();
+    }
+    else
+    {
+        draw(settings, local);
+    }
+    return true;
+}
+
+void ClockOverlay::draw(const Settings& settings, const std::tm& local)
+{
+    clear();
+    if (settings.mode == Mode::Off)
+    {
+        return;
+    }
+
+    const uint16_t band = settings.top ? 0 : LedMatrix::height - bandHeight;
+    for (uint16_t y = band; y < band + bandHeight; ++y)
+    {
+        for (uint16_t x = 0; x < LedMatrix::width; ++x)
+        {
+            setPixel(x, y, { 0, 0, 0 }, bandAlpha);
+        }
+    }
+
+    // Two 2-digit numbers and a separator: 0-2 4-6 | 7 | 9-11 13-15
+    const bool time = settings.mode == Mode::Time;
+    const int left = time ? local.tm_hour : local.tm_mday;
+    const int right = time ? local.tm_min : local.tm_mon + 1;
+    const uint16_t y = band + 1;
+    drawGlyph(digits[left / 10], 0, y, settings.color);
+    drawGlyph(digits[left % 10], 4, y, settings.color);
+    drawGlyph(digits[right / 10], 9, y, settings.color);
+    drawGlyph(digits[right % 10], 13, y, settings.color);
+    if (time)
+    {
+        setPixel(7, y + 1, settings.color);
+        setPixel(7, y + 3, settings.color);
+    }
+    else
+    {
+        setPixel(7, y + 4, settings.color);
+    }
+}
+
+void ClockOverlay::drawGlyph(
+    uint16_t glyph, uint16_t x, uint16_t y, LedMatrix::RGB color)
+{
+    for (uint16_t row = 0; row < 5; ++row)
+    {
+        for (uint16_t column = 0; column < 3; ++column)
+        {
+            if (glyph & (1u << (14 - row * 3 - column)))
+            {
+                setPixel(x + column, y + row, color);
+            }
+        }
+    }
+}
+
+const char* ClockOverlay::toString(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Off:
+        return "off";
+    case Mode::Time:
+        return "time";
+    case Mode::Date:
+        return "date";
+    default:
+        return "invalid";
+    }
+}
+
+std::optional<ClockOverlay::Mode> ClockOverlay::parseMode(std::string_view name)
+{
+    for (auto mode: { Mode::Off, Mode::Time, Mode::Date })
+    {
+        if (name == toString(mode))
+        {
+            return mode;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,69 @@
+#ifndef CLOCK_OVERLAY_HPP
+#define CLOCK_OVERLAY_HPP
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "Compositor.hpp"
+#include "LedMatrix.hpp"
+
+#include <ctime>
+#include <optional>
+#include <string_view>
+
+/**
+ * ClockOverlay: the local time (HH:MM) or date (DD.MM) in a 3x5 font on a
+ * dimmed band at the top or bottom of the matrix. It is redrawn only when
+ * the minute (or day) changes, and stays empty until the system time has
+ * been set (SNTP).
+ */
+class ClockOverlay : public OverlayLayer<LedMatrix>
+{
+    inline static constexpr const char* TAG = "ClockOverlay";
+
+public:
+    enum class Mode : uint8_t
+    {
+        Off = 0,
+        Time,
+        Date,
+    };
+
+    struct Settings
+    {
+        Mode mode{ Mode::Off };
+        LedMatrix::RGB color{ 255, 255, 255 };
+        // Top rows instead of the bottom ones
+        bool top{ false };
+    };
+
+    // Rows the band takes
+    static constexpr uint16_t bandHeight = 7;
+
+    ClockOverlay();
+    ~ClockOverlay() override;
+
+    // Safe to call from any task, shows from the next frame on
+    void configure(const Settings& settings);
+    Settings settings() const;
+
+    bool refresh(int64_t nowUs) override;
+    // What refresh() draws for local
+    void draw(const Settings& settings, const std::tm& local);
+
+    static const char* toString(Mode mode);
+    static std::optional<Mode> parseMode(std::string_view name);
+
+private:
+    void drawGlyph(uint16_t glyph, uint16_t x, uint16_t y, LedMatrix::RGB color);
+
+    SemaphoreHandle_t lock_;
+    // Guarded by lock_
+    Settings settings_{};
+    bool dirty_{ true };
+
+    // Animator task only: minute or day on display, -1 for nothing
+    int shown_{ -1 };
+};
+
+#endif  // CLOCK_OVERLAY_HPP
@@ -0,0 +1,473 @@
+#include "FrameJson.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace FrameJson
+{
+
+static int hexDigit(char c)
+{
+    if ('0' <= c && c <= '9')
+        return c - '0';
+    if ('a' <= c && c <= 'f')
+        return c - 'a' + 10;
+    if ('A' <= c && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+std::optional<LedMatrix::RGB> parseHexColor(const char* hex)
+{
+    if (!hex || hex[0] != '#')
+    {
+        return std::nullopt;
+    }
+
+    uint8_t channels[3];
+    for (size_t i = 0; i < 3; ++i)
+    {
+        int hi = hexDigit(hex[1 + 2 * i]);
+        if (hi < 0)
+        {
+            return std::nullopt;
+        }
+        int lo = hexDigit(hex[2 + 2 * i]);
+        if (lo < 0)
+        {
+            return std::nullopt;
+        }
+        channels[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    if (hex[7] != '\0')
+    {
+        return std::nullopt;
+    }
+
+    return LedMatrix::RGB{ channels[0], channels[1], channels[2] };
+}
+
+std::optional<Frame> parseFrame(const cJSON* array, bool invalidAsBlack)
+{
+    if (!cJSON_IsArray(array)
+        || cJSON_GetArraySize(array) != LedMatrix::numPixels)
+    {
+        return std::nullopt;
+    }
+
+    Frame frame;
+    size_t i = 0;
+    // Walk the item list once, cJSON_GetArrayItem() is linear per call
+    const cJSON* item = nullptr;
+    cJSON_ArrayForEach(item, array)
+    {
+        auto color = parseHexColor(cJSON_GetStringValue(item));
+        if (!color)
+        {
+            if (!invalidAsBlack)
+            {
+                return std::nullopt;
+            }
+            color = LedMatrix::RGB{ 0, 0, 0 };
+        }
+        frame[i++] = *color;
+    }
+
+    return frame;
+}
+
+std::optional<Timeline>
+parseTimeline(const cJSON* root, size_t numFrames, uint32_t intervalMs)
+{
+    Timeline timeline;
+    const cJSON* durations = cJSON_GetObjectItem(root, "durations_ms");
+    if (!durations)
+    {
+        timeline = Timeline::uniform(numFrames, intervalMs);
+    }
+    else
+    {
+        if (!cJSON_IsArray(durations)
+            || static_cast<size_t>(cJSON_GetArraySize(durations)) != numFrames)
+        {
+            return std::nullopt;
+        }
+        timeline.entries.reserve(numFrames);
+        const cJSON* item = nullptr;
+        cJSON_ArrayForEach(item, durations)
+        {
+            if (!cJSON_IsNumber(item) || item->valuedouble < 1
+                || item->valuedouble > UINT32_MAX)
+            {
+                return std::nullopt;
+            }
+            timeline.entries.push_back(
+                { static_cast<uint16_t>(timeline.entries.size()),
+                  static_cast<uint32_t>(item->valuedouble) });
+        }
+    }
+
+    const cJSON* loop = cJSON_GetObjectItem(root, "loop");
+    if (loop)
+    {
+        const char* name = cJSON_GetStringValue(loop);
+        auto mode = name ? Timeline::parseLoopMode(name) : std::nullopt;
+        if (!mode)
+        {
+            return std::nullopt;
+        }
+        timeline.mode = *mode;
+    }
+    if (timeline.mode == Timeline::LoopMode::Segment)
+    {
+        const cJSON* start = cJSON_GetObjectItem(root, "loop_start");
+        const cJSON* end = cJSON_GetObjectItem(root, "loop_end");
+        if (!cJSON_IsNumber(start) || !cJSON_IsNumber(end)
+            || start->valueint < 0 || end->valueint > UINT16_MAX)
+        {
+            return std::nullopt;
+        }
+        timeline.loopStart = static_cast<uint16_t>(start->valueint);
+        timeline.loopEnd = static_cast<uint16_t>(end->valueint);
+    }
+
+    if (!timeline.valid(numFrames))
+    {
+        return std::nullopt;
+    }
+    return timeline;
+}
+
+std::optional<Transition> parseTransition(const cJSON* root)
+{
+    const cJSON* item = cJSON_GetObjectItem(root, "transition");
+    if (!item)
+    {
+        return Transition{};
+    }
+    const char* type = cJSON_GetStringValue(cJSON_GetObjectItem(item, "type"));
+    const cJSON* durationMs = cJSON_GetObjectItem(item, "duration_ms");
+    auto kind = type ? Transition::parseKind(type) : std::nullopt;
+    if (!kind || !cJSON_IsNumber(durationMs) || durationMs->valuedouble < 0
+        || durationMs->valuedouble > UINT32_MAX)
+    {
+        return std::nullopt;
+    }
+    return Transition{ *kind, static_cast<uint32_t>(durationMs->valuedouble) };
+}
+
+void addTransition(cJSON* root, const Transition& transition)
+{
+    if (transition.isCut())
+    {
+        return;
+    }
+    cJSON* item = cJSON_AddObjectToObject(root, "transition");
+    cJSON_AddStringToObject(item, "type", Transition::toString(transition.kind));
+    cJSON_AddNumberToObject(item, "duration_ms", transition.durationMs);
+}
+
+std::optional<Effect> parseEffect(const cJSON* root, const Effect& base)
+{
+    Effect effect = base;
+    if (const cJSON* kind = cJSON_GetObjectItem(root, "effect"))
+    {
+        const char* name = cJSON_GetStringValue(kind);
+        auto parsed = name ? Effect::parseKind(name) : std::nullopt;
+        if (!parsed)
+        {
+            return std::nullopt;
+        }
+        effect.kind = *parsed;
+    }
+
+    auto byte = [root](const char* name, uint8_t& value)
+    {
+        const cJSON* item = cJSON_GetObjectItem(root, name);
+        if (!item)
+        {
+            return true;
+        }
+        if (!cJSON_IsNumber(item) || item->valuedouble < 0
+            || item->valuedouble > 255)
+        {
+            return false;
+        }
+        value = static_cast<uint8_t>(item->valuedouble);
+        return true;
+    };
+    if (!byte("speed", effect.params.speed) || !byte("scale", effect.params.scale)
+        || !byte("intensity", effect.params.intensity))
+    {
+        return std::nullopt;
+    }
+
+    if (const cJSON* color = cJSON_GetObjectItem(root, "color"))
+    {
+        auto rgb = parseHexColor(cJSON_GetStringValue(color));
+        if (!rgb)
+        {
+            return std::nullopt;
+        }
+        effect.params.r = rgb->r;
+        effect.params.g = rgb->g;
+        effect.params.b = rgb->b;
+    }
+    return effect;
+}
+
+void addEffect(cJSON* root, const Effect& effect)
+{
+    const Effect::Params& params = effect.params;
+    char color[8];
+    snprintf(color, sizeof(color), "#%02x%02x%02x", params.r, params.g, params.b);
+    cJSON_AddStringToObject(root, "effect", Effect::toString(effect.kind));
+    cJSON_AddNumberToObject(root, "speed", params.speed);
+    cJSON_AddNumberToObject(root, "scale", params.scale);
+    cJSON_AddNumberToObject(root, "intensity", params.intensity);
+    cJSON_AddStringToObject(root, "color", color);
+}
+
+std::optional<ScrollingText> parseText(const cJSON* root, const ScrollingText& base)
+{
+    ScrollingText text = base;
+    if (const cJSON* item = cJSON_GetObjectItem(root, "text"))
+    {
+        const char* value = cJSON_GetStringValue(item);
+        if (!value || strlen(value) > ScrollingText::maxLength)
+        {
+            return std::nullopt;
+        }
+        text.text = value;
+    }
+    if (const cJSON* item = cJSON_GetObjectItem(root, "font"))
+    {
+        const char* name = cJSON_GetStringValue(item);
+        auto font = name ? ScrollingText::parseFont(name) : std::nullopt;
+        if (!font)
+        {
+            return std::nullopt;
+        }
+        text.font = *font;
+    }
+
+    auto color = [root](const char* name, ScrollingText::Color& value)
+    {
+        const cJSON* item = cJSON_GetObjectItem(root, name);
+        if (!item)
+        {
+            return true;
+        }
+        auto rgb = parseHexColor(cJSON_GetStringValue(item));
+        if (!rgb)
+        {
+            return false;
+        }
+        value = { rgb->r, rgb->g, rgb->b };
+        return true;
+    };
+    if (!color("color", text.color) || !color("background", text.background))
+    {
+        return std::nullopt;
+    }
+
+    if (const cJSON* speed = cJSON_GetObjectItem(root, "speed"))
+    {
+        if (!cJSON_IsNumber(speed) || speed->valuedouble < ScrollingText::minSpeed
+            || speed->valuedouble > ScrollingText::maxSpeed)
+        {
+            return std::nullopt;
+        }
+        text.speed = static_cast<uint16_t>(speed->valuedouble);
+    }
+    if (const cJSON* loop = cJSON_GetObjectItem(root, "loop"))
+    {
+        if (!cJSON_IsBool(loop))
+        {
+            return std::nullopt;
+        }
+        text.loop = loop->valueint != 0;
+    }
+    return text;
+}
+
+void addText(cJSON* root, const ScrollingText& text)
+{
+    auto hex = [](const ScrollingText::Color& c, char (&out)[8])
+    { snprintf(out, sizeof(out), "#%02x%02x%02x", c.r, c.g, c.b); };
+    char color[8];
+    char background[8];
+    hex(text.color, color);
+    hex(text.background, background);
+    cJSON_AddStringToObject(root, "text", text.text.c_str());
+    cJSON_AddStringToObject(root, "font", ScrollingText::toString(text.font));
+    cJSON_AddStringToObject(root, "color", color);
+    cJSON_AddStringToObject(root, "background", background);
+    cJSON_AddNumberToObject(root, "speed", text.speed);
+    cJSON_AddBoolToObject(root, "loop", text.loop);
+}
+
+std::optional<Sprites> parseSprites(const cJSON* root)
+{
+    Frame background{};
+    if (const cJSON* item = cJSON_GetObjectItem(root, "background"))
+    {
+        auto frame = parseFrame(item);
+        if (!frame)
+        {
+            return std::nullopt;
+        }
+        background = *frame;
+    }
+    Sprites sprites{ background };
+
+    const cJSON* sheet = cJSON_GetObjectItem(root, "sprites");
+    if (!cJSON_IsArray(sheet))
+    {
+        return std::nullopt;
+    }
+    const cJSON* item = nullptr;
+    cJSON_ArrayForEach(item, sheet)
+    {
+        const cJSON* width = cJSON_GetObjectItem(item, "width");
+        const cJSON* height = cJSON_GetObjectItem(item, "height");
+        const cJSON* pixels = cJSON_GetObjectItem(item, "pixels");
+        if (!cJSON_IsNumber(width) || !cJSON_IsNumber(height) || !cJSON_IsArray(pixels)
+            || width->valueint <= 0 || width->valueint > LedMatrix::width
+            || height->valueint <= 0 || height->valueint > LedMatrix::height)
+        {
+            return std::nullopt;
+        }
+        Sprites::Sprite sprite;
+        sprite.width = static_cast<uint8_t>(width->valueint);
+        sprite.height = static_cast<uint8_t>(height->valueint);
+        const size_t count = size_t{ sprite.width } * sprite.height;
+        sprite.pixels.reserve(count);
+        sprite.opaque.reserve(count);
+        const cJSON* pixel = nullptr;
+        cJSON_ArrayForEach(pixel, pixels)
+        {
+            auto color = cJSON_IsNull(pixel)
+                ? LedMatrix::RGB{ 0, 0, 0 }
+                : parseHexColor(cJSON_GetStringValue(pixel));
+            if (!color)
+            {
+                return std::nullopt;
+            }
+            sprite.pixels.push_back(*color);
+            sprite.opaque.push_back(cJSON_IsNull(pixel) ? 0 : 1);
+        }
+        // addSprite() checks the pixel count
+        if (!sprites.addSprite(std::move(sprite)))
+        {
+            return std::nullopt;
+        }
+    }
+
+    const cJSON* frames = cJSON_GetObjectItem(root, "frames");
+    if (!cJSON_IsArray(frames) || cJSON_GetArraySize(frames) == 0)
+    {
+        return std::nullopt;
+    }
+    std::vector<Sprites::Placement> placements;
+    const cJSON* frame = nullptr;
+    cJSON_ArrayForEach(frame, frames)
+    {
+        if (!cJSON_IsArray(frame))
+        {
+            return std::nullopt;
+        }
+        placements.clear();
+        const cJSON* placement = nullptr;
+        cJSON_ArrayForEach(placement, frame)
+        {
+            const cJSON* id = cJSON_GetObjectItem(placement, "sprite");
+            const cJSON* x = cJSON_GetObjectItem(placement, "x");
+            const cJSON* y = cJSON_GetObjectItem(placement, "y");
+            if (!cJSON_IsNumber(id) || !cJSON_IsNumber(x) || !cJSON_IsNumber(y)
+                || id->valueint < 0 || id->valueint >= static_cast<int>(Sprites::maxSprites)
+                || x->valueint < INT8_MIN || x->valueint > INT8_MAX
+                || y->valueint < INT8_MIN || y->valueint > INT8_MAX)
+            {
+                return std::nullopt;
+            }
+            auto flag = [placement](const char* name, uint8_t bit)
+            {
+                const cJSON* item = cJSON_GetObjectItem(placement, name);
+                return item && item->valueint != 0 ? bit : uint8_t{ 0 };
+            };
+            placements.push_back(
+                { static_cast<uint8_t>(id->valueint),
+                  static_cast<int8_t>(x->valueint),
+                  static_cast<int8_t>(y->valueint),
+                  static_cast<uint8_t>(
+                      flag("flip_x", Sprites::Placement::flipX)
+                      | flag("flip_y", Sprites::Placement::flipY)) });
+        }
+        if (!sprites.addFrame(placements))
+        {
+            return std::nullopt;
+        }
+    }
+    return sprites;
+}
+
+void addAnimation(
+    cJSON* root, const Frames& frames, const Timeline& timeline, uint32_t intervalMs)
+{
+    auto repeats = [intervalMs](const Timeline::Entry& entry)
+    { return intervalMs > 0 && entry.durationMs % intervalMs == 0; };
+    // A short first delay and a long hold, e.g. of a GIF, would repeat
+    // into thousands of frames
+    size_t repeated = 0;
+    for (const auto& entry: timeline.entries)
+    {
+        repeated += repeats(entry) ? entry.durationMs / intervalMs : 1;
+    }
+    const bool canRepeat = repeated <= maxRepeatedFrames;
+
+    cJSON* framesArray = cJSON_CreateArray();
+    cJSON* durations = cJSON_CreateArray();
+    size_t emitted = 0;
+    size_t loopStart = 0;
+    size_t loopEnd = 0;
+    for (size_t k = 0; k < timeline.entries.size(); ++k)
+    {
+        const auto& entry = timeline.entries[k];
+        const bool repeat = canRepeat && repeats(entry);
+        const size_t copies = repeat ? entry.durationMs / intervalMs : 1;
+        const uint32_t durationMs = repeat ? intervalMs : entry.durationMs;
+
+        if (k == timeline.loopStart)
+        {
+            loopStart = emitted;
+        }
+        for (size_t c = 0; c < copies; ++c, ++emitted)
+        {
+            cJSON* frameArray = cJSON_CreateArray();
+            for (const auto& pixel: frames[entry.frame])
+            {
+                char hex[8];
+                snprintf(hex, sizeof(hex), "#%02x%02x%02x", pixel.r, pixel.g, pixel.b);
+                cJSON_AddItemToArray(frameArray, cJSON_CreateString(hex));
+            }
+            cJSON_AddItemToArray(framesArray, frameArray);
+            cJSON_AddItemToArray(durations, cJSON_CreateNumber(durationMs));
+        }
+        if (k == timeline.loopEnd)
+        {
+            loopEnd = emitted - 1;
+        }
+    }
+
+    cJSON_AddItemToObject(root, "frames", framesArray);
+    cJSON_AddItemToObject(root, "durations_ms", durations);
+    cJSON_AddStringToObject(root, "loop", Timeline::toString(timeline.mode));
+    if (timeline.mode == Timeline::LoopMode::Segment)
+    {
+        cJSON_AddNumberToObject(root, "loop_start", loopStart);
+        cJSON_AddNumberToObject(root, "loop_end", loopEnd);
+    }
+}
+
+}  // namespace FrameJson
@@ -0,0 +1,77 @@
+#ifndef FRAME_JSON_HPP
+#define FRAME_JSON_HPP
+
+#include "Effect.hpp"
+#include "FramePool.hpp"
+#include "LedMatrix.hpp"
+#include "ScrollingText.hpp"
+#include "SpriteFrames.hpp"
+#include "Timeline.hpp"
+#include "Transition.hpp"
+
+#include <cJSON.h>
+
+#include <array>
+#include <optional>
+
+namespace FrameJson
+{
+using Frame = std::array<LedMatrix::RGB, LedMatrix::numPixels>;
+using Frames = FrameSequence<Frame>;
+using Sprites = SpriteFrames<LedMatrix>;
+
+// Parses a "#rrggbb" color string
+std::optional<LedMatrix::RGB> parseHexColor(const char* hex);
+
+// Parses a JSON array of LedMatrix::numPixels "#rrggbb" strings.
+// Invalid colors either fail the whole frame, or become black when
+// invalidAsBlack is set.
+std::optional<Frame> parseFrame(const cJSON* array, bool invalidAsBlack = false);
+
+// Reads the optional "durations_ms" (one per frame), "loop", "loop_start"
+// and "loop_end" members of an animation upload. Without durations every
+// frame shows for intervalMs. nullopt when a member is invalid.
+std::optional<Timeline>
+parseTimeline(const cJSON* root, size_t numFrames, uint32_t intervalMs);
+
+// Reads the optional "transition" member of root:
+// { "type": "crossfade" | "wipe" | "dissolve" | "slide" | "cut",
+//   "duration_ms": n }. A cut when it is missing, nullopt when invalid.
+std::optional<Transition> parseTransition(const cJSON* root);
+// Adds it as a "transition" member, nothing for a cut
+void addTransition(cJSON* root, const Transition& transition);
+
+// Reads an effect from root: "effect" (the kind's name), "speed",
+// "scale" and "intensity" (0-255) and "color" ("#rrggbb"). Members that
+// are missing keep their value from base, nullopt when one is invalid.
+std::optional<Effect> parseEffect(const cJSON* root, const Effect& base);
+// Adds the members parseEffect() reads
+void addEffect(cJSON* root, const Effect& effect);
+
+// Reads scrolling text from root: "text", "font" ("5x7" or "8x8"),
+// "color" and "background" ("#rrggbb"), "speed" (pixels per second) and
+// "loop". Members that are missing keep their value from base, nullopt
+// when one is invalid.
+std::optional<ScrollingText> parseText(const cJSON* root, const ScrollingText& base);
+// Adds the members parseText() reads
+void addText(cJSON* root, const ScrollingText& text);
+
+// Reads a sprite animation from root: "background" (a frame, black when
+// missing), "sprites" ([{ "width", "height", "pixels" }], pixels "#rrggbb"
+// or null where transparent) and "frames" (one array of
+// { "sprite", "x", "y", "flip_x", "flip_y" } per frame, the flips
+// optional). nullopt when anything is invalid.
+std::optional<Sprites> parseSprites(const cJSON* root);
+
+// Most frames addAnimation() repeats entries into
+inline constexpr size_t maxRepeatedFrames = 256;
+
+// Adds "frames" and the members parseTimeline() reads to root, one frame
+// per timeline entry. Entries lasting a multiple of intervalMs are
+// repeated, so clients that only know "interval_ms" still play them right,
+// unless that takes more than maxRepeatedFrames frames.
+void addAnimation(
+    cJSON* root, const Frames& frames, const Timeline& timeline, uint32_t intervalMs);
+}  // namespace FrameJson
+
+#endif  // FRAME_JSON_HPP
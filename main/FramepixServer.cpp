@@ -1,10 +1,50 @@
 #include "FramepixServer.hpp"
+#include "FrameJson.hpp"
+#include "GifDecoder.hpp"
+
+#include "Arena.hpp"
+#include "HeapStats.hpp"
 
 #include <cJSON.h>
 
+#include <esp_heap_caps.h>
 #include <esp_log.h>
 #include <esp_system.h>
 
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace
+{
+// Handler buffers too big for the httpd task stack come from the request
+// arena. Scratch<T> destroys them, the arena frees them with the request.
+struct ScratchDelete
+{
+    template<typename T> void operator()(T* p) const
+    {
+        p->~T();
+        HeapStats::Arena::deallocateScratch(p, HeapStats::AllocTag::Http);
+    }
+};
+template<typename T> using Scratch = std::unique_ptr<T, ScratchDelete>;
+
+// nullptr when the arena is out of memory
+template<typename T, typename... Args> Scratch<T> makeScratch(Args&&... args)
+{
+    void* p = HeapStats::Arena::allocateScratch(sizeof(T), HeapStats::AllocTag::Http, true);
+    return Scratch<T>{ p ? new (p) T(std::forward<Args>(args)...) : nullptr };
+}
+
+// A frame of this device's tile, cropped from the canvas as it comes
+struct TileBuffers
+{
+    std::array<char, 512> chunk;
+    std::array<uint8_t, LedMatrix::numPixels * 3> tile;
+    MatrixAnimator<LedMatrix>::Frame frame;
+};
+}  // namespace
+
 extern const uint8_t designer_html_start[] asm("_binary_designer_html_start");
 extern const uint8_t designer_html_end[] asm("_binary_designer_html_end");
 
@@ -22,12 +62,20 @@ FramepixServer::FramepixServer(
     LedMatrix& ledMatrix,
     MatrixAnimator<LedMatrix>& animator,
     WifiProvisioningWeb& wifiProvisioningWeb,
-    StorageManager& storageManager)
+    StorageManager& storageManager,
+    PlaylistScheduler& playlistScheduler,
+    ClockOverlay& clockOverlay,
+    TaskDiagnostics& taskDiagnostics,
+    TimeSync& timeSync)
     : httpServer_{ httpServer }
     , ledMatrix_{ ledMatrix }
     , animator_{ animator }
     , wifiProvisioningWeb_{ wifiProvisioningWeb }
     , storageManager_{ storageManager }
+    , playlistScheduler_{ playlistScheduler }
+    , clockOverlay_{ clockOverlay }
+    , taskDiagnostics_{ taskDiagnostics }
+    , timeSync_{ timeSync }
     , framepixPageUri_{ "/",
                         HTTP_GET,
                         [](HttpRequest req) -> HttpResponse
@@ -109,7 +157,9 @@ FramepixServer::FramepixServer(
                               }
                               cJSON* matrix
                                   = cJSON_GetObjectItem(root, "matrix");
-                              if (!cJSON_IsArray(matrix))
+                              if (!cJSON_IsArray(matrix)
+                                  || cJSON_GetArraySize(matrix)
+                                      != LedMatrix::numPixels)
                               {
                                   ESP_LOGW(TAG, "Invalid Request Content");
                                   cJSON_Delete(root);
@@ -118,54 +168,35 @@ FramepixServer::FramepixServer(
                                       "Invalid request content", "text/plain");
                                   return response;
                               }
-                              if (cJSON_GetArraySize(matrix)
-                                  != LedMatrix::numPixels)
+                              auto pixelData = FrameJson::parseFrame(matrix);
+                              auto transition = FrameJson::parseTransition(root);
+                              cJSON_Delete(root);
+                              if (!pixelData)
                               {
-                                  ESP_LOGW(TAG, "Invalid Request Content");
-                                  cJSON_Delete(root);
+                                  ESP_LOGW(TAG, "Invalid color data");
                                   response.setStatus("400 Bad Request");
                                   response.setContent(
-                                      "Invalid request content", "text/plain");
+                                      "Invalid color", "text/plain");
                                   return response;
                               }
-                              std::array<LedMatrix::RGB, LedMatrix::numPixels>
-                                  pixelData;
-                              bool error = false;
-                              for (int i = 0; i < 256; ++i)
-                              {
-                                  cJSON* colorItem
-                                      = cJSON_GetArrayItem(matrix, i);
-                                  const char* hex
-                                      = cJSON_GetStringValue(colorItem);
-                                  if (!hex || strlen(hex) != 7 || hex[0] != '#')
-                                  {
-                                      error = true;
-                                      break;
-                                  }
-
-                                  uint8_t r, g, b;
-                                  sscanf(
-                                      hex + 1,
-                                      "%02hhx%02hhx%02hhx",
-                                      &r,
-                                      &g,
-                                      &b);
-                                  pixelData[i] = { r, g, b };
-                              }
-
-                              cJSON_Delete(root);
-                              if (error)
+                              if (!transition)
                               {
-                                  ESP_LOGW(TAG, "Invalid color data");
                                   response.setStatus("400 Bad Request");
                                   response.setContent(
-                                      "Invalid color", "text/plain");
+                                      "Invalid transition", "text/plain");
                                   return response;
                               }
                               ESP_LOGI(TAG, "Setting matrix");
-                              animator_.stop();
-                              ledMatrix_.setAllPixels(pixelData);
-                              ledMatrix_.update();
+                              playlistScheduler_.stop();
+                              // Through the animator, which blends it in and
+                              // keeps the overlays on top
+                              if (!animator_.show(*pixelData, *transition))
+                              {
+                                  response.setStatus("500 Internal Server Error");
+                                  response.setContent(
+                                      "Failed to show", "text/plain");
+                                  return response;
+                              }
                               response.setStatus("200 OK");
                               response.setContent("OK", "text/plain");
                               return response;
@@ -227,58 +258,45 @@ FramepixServer::FramepixServer(
                                      return response;
                                  }
 
-                                 using RGB = LedMatrix::RGB;
-                                 constexpr size_t N = LedMatrix::numPixels;
-                                 std::vector<
-                                     std::array<RGB, N>,
-                                     MatrixAnimator<LedMatrix>::VectorAllocator>
-                                     framesVec;
-                                 framesVec.reserve(
-                                     cJSON_GetArraySize(framesItem));
-
-                                 for (int i = 0;
-                                      i < cJSON_GetArraySize(framesItem);
-                                      ++i)
+                                 MatrixAnimator<LedMatrix>::Frames framesVec;
+                                 if (!framesVec.reserve(
+                                         cJSON_GetArraySize(framesItem)))
+                                 {
+                                     ESP_LOGE(TAG, "No memory for frames");
+                                     cJSON_Delete(root);
+                                     response.setStatus(
+                                         "507 Insufficient Storage");
+                                     response.setContent(
+                                         "Not enough memory for frames",
+                                         "text/plain");
+                                     return response;
+                                 }
+
+                                 int i = 0;
+                                 cJSON* frameArr = nullptr;
+                                 cJSON_ArrayForEach(frameArr, framesItem)
                                  {
-                                     cJSON* frameArr
-                                         = cJSON_GetArrayItem(framesItem, i);
-                                     if (!cJSON_IsArray(frameArr)
-                                         || cJSON_GetArraySize(frameArr) != N)
+                                     // Invalid colors default to black
+                                     auto framePixels
+                                         = FrameJson::parseFrame(frameArr, true);
+                                     if (!framePixels)
                                      {
                                          ESP_LOGW(
                                              TAG,
                                              "Skipping invalid frame %d",
                                              i);
-                                         continue;
                                      }
-                                     std::array<RGB, N> framePixels{};
-                                     for (size_t j = 0; j < N; ++j)
+                                     else
                                      {
-                                         cJSON* colItem
-                                             = cJSON_GetArrayItem(frameArr, j);
-                                         const char* hex
-                                             = cJSON_GetStringValue(colItem);
-                                         if (!hex || strlen(hex) != 7
-                                             || hex[0] != '#')
-                                         {
-                                             // default to black
-                                             framePixels[j] = { 0, 0, 0 };
-                                         }
-                                         else
-                                         {
-                                             uint8_t r, g, b;
-                                             sscanf(
-                                                 hex + 1,
-                                                 "%02hhx%02hhx%02hhx",
-                                                 &r,
-                                                 &g,
-                                                 &b);
-                                             framePixels[j] = { r, g, b };
-                                         }
+                                         framesVec.push_back(*framePixels);
                                      }
-                                     framesVec.push_back(framePixels);
+                                     ++i;
                                  }
 
+                                 auto timeline = FrameJson::parseTimeline(
+                                     root, framesVec.size(), intervalMs);
+                                 auto transition
+                                     = FrameJson::parseTransition(root);
                                  cJSON_Delete(root);
 
                                  if (framesVec.empty())
@@ -289,15 +307,36 @@ FramepixServer::FramepixServer(
                                          "No frames data", "text/plain");
                                      return response;
                                  }
+                                 if (!timeline)
+                                 {
+                                     ESP_LOGW(TAG, "Invalid timeline");
+                                     response.setStatus("400 Bad Request");
+                                     response.setContent(
+                                         "Invalid timeline", "text/plain");
+                                     return response;
+                                 }
+                                 if (!transition)
+                                 {
+                                     response.setStatus("400 Bad Request");
+                                     response.setContent(
+                                         "Invalid transition", "text/plain");
+                                     return response;
+                                 }
 
+                                 deduplicate(framesVec, *timeline);
                                  ESP_LOGI(
                                      TAG,
-                                     "Received %d frames @ %d ms interval",
+                                     "Received %d unique frames in %d entries "
+                                     "(%s)",
                                      (int)framesVec.size(),
-                                     intervalMs);
+                                     (int)timeline->entries.size(),
+                                     Timeline::toString(timeline->mode));
 
+                                 playlistScheduler_.stop();
                                  animator_.start(
-                                     std::move(framesVec), intervalMs);
+                                     std::move(framesVec),
+                                     std::move(*timeline),
+                                     *transition);
 
                                  response.setStatus("200 OK");
                                  response.setContent(
@@ -353,30 +392,16 @@ FramepixServer::FramepixServer(
 
                           StorageManager::Design design;
                           design.name = name->valuestring;
-                          bool error = false;
-                          for (int i = 0; i < LedMatrix::numPixels; ++i)
-                          {
-                              cJSON* colorItem = cJSON_GetArrayItem(matrix, i);
-                              const char* hex = cJSON_GetStringValue(colorItem);
-                              if (!hex || strlen(hex) != 7 || hex[0] != '#')
-                              {
-                                  error = true;
-                                  break;
-                              }
-
-                              uint8_t r, g, b;
-                              sscanf(hex + 1, "%02hhx%02hhx%02hhx", &r, &g, &b);
-                              design.pixels[i] = { r, g, b };
-                          }
-
+                          auto pixels = FrameJson::parseFrame(matrix);
                           cJSON_Delete(root);
-                          if (error)
+                          if (!pixels)
                           {
                               response.setStatus("400 Bad Request");
                               response.setContent(
                                   "Invalid color data", "text/plain");
                               return response;
                           }
+                          design.pixels = *pixels;
 
                           if (storageManager_.saveDesign(design))
                           {
@@ -436,10 +461,19 @@ FramepixServer::FramepixServer(
                              animation.name = name->valuestring;
                              animation.intervalMs = intervalMs->valueint;
 
-                             for (int i = 0; i < cJSON_GetArraySize(frames);
-                                  ++i)
+                             if (!animation.frames.reserve(
+                                     cJSON_GetArraySize(frames)))
+                             {
+                                 cJSON_Delete(root);
+                                 response.setStatus("507 Insufficient Storage");
+                                 response.setContent(
+                                     "Not enough memory for frames",
+                                     "text/plain");
+                                 return response;
+                             }
+                             cJSON* frame = nullptr;
+                             cJSON_ArrayForEach(frame, frames)
                              {
-                                 cJSON* frame = cJSON_GetArrayItem(frames, i);
                                  if (!cJSON_IsArray(frame)
                                      || cJSON_GetArraySize(frame)
                                          != LedMatrix::numPixels)
@@ -451,38 +485,20 @@ FramepixServer::FramepixServer(
                                      return response;
                                  }
 
-                                 std::
-                                     array<LedMatrix::RGB, LedMatrix::numPixels>
-                                         framePixels;
-                                 for (int j = 0; j < LedMatrix::numPixels; ++j)
+                                 auto framePixels = FrameJson::parseFrame(frame);
+                                 if (!framePixels)
                                  {
-                                     cJSON* colorItem
-                                         = cJSON_GetArrayItem(frame, j);
-                                     const char* hex
-                                         = cJSON_GetStringValue(colorItem);
-                                     if (!hex || strlen(hex) != 7
-                                         || hex[0] != '#')
-                                     {
-                                         cJSON_Delete(root);
-                                         response.setStatus("400 Bad Request");
-                                         response.setContent(
-                                             "Invalid color data",
-                                             "text/plain");
-                                         return response;
-                                     }
-
-                                     uint8_t r, g, b;
-                                     sscanf(
-                                         hex + 1,
-                                         "%02hhx%02hhx%02hhx",
-                                         &r,
-                                         &g,
-                                         &b);
-                                     framePixels[j] = { r, g, b };
+                                     cJSON_Delete(root);
+                                     response.setStatus("400 Bad Request");
+                                     response.setContent(
+                                         "Invalid color data", "text/plain");
+                                     return response;
                                  }
-                                 animation.frames.push_back(framePixels);
+                                 animation.frames.push_back(*framePixels);
                              }
 
+                             auto timeline = FrameJson::parseTimeline(
+                                 root, animation.frames.size(), animation.intervalMs);
                              cJSON_Delete(root);
                              if (animation.frames.empty())
                              {
@@ -491,6 +507,15 @@ FramepixServer::FramepixServer(
                                      "No frames data", "text/plain");
                                  return response;
                              }
+                             if (!timeline)
+                             {
+                                 response.setStatus("400 Bad Request");
+                                 response.setContent(
+                                     "Invalid timeline", "text/plain");
+                                 return response;
+                             }
+                             deduplicate(animation.frames, *timeline);
+                             animation.timeline = std::move(*timeline);
 
                              if (storageManager_.saveAnimation(animation))
                              {
@@ -637,33 +662,26 @@ FramepixServer::FramepixServer(
                              cJSON* root = cJSON_CreateObject();
                              cJSON_AddNumberToObject(
                                  root, "interval_ms", animation->intervalMs);
-                             cJSON* frames = cJSON_CreateArray();
-                             for (const auto& frame: animation->frames)
-                             {
-                                 cJSON* frameArray = cJSON_CreateArray();
-                                 for (const auto& pixel: frame)
-                                 {
-                                     char hex[8];
-                                     snprintf(
-                                         hex,
-                                         sizeof(hex),
-                                         "#%02x%02x%02x",
-                                         pixel.r,
-                                         pixel.g,
-                                         pixel.b);
-                                     cJSON_AddItemToArray(
-                                         frameArray, cJSON_CreateString(hex));
-                                 }
-                                 cJSON_AddItemToArray(frames, frameArray);
-                             }
-                             cJSON_AddItemToObject(root, "frames", frames);
+                             FrameJson::addAnimation(
+                                 root,
+                                 animation->frames,
+                                 animation->timeline,
+                                 animation->intervalMs);
 
                              char* json = cJSON_PrintUnformatted(root);
+                             cJSON_Delete(root);
+                             if (!json)
+                             {
+                                 response.setStatus("507 Insufficient Storage");
+                                 response.setContent(
+                                     "Not enough memory for the animation",
+                                     "text/plain");
+                                 return response;
+                             }
                              response.setStatus("200 OK");
                              response.setContent(json, "application/json");
 
                              cJSON_free(json);
-                             cJSON_Delete(root);
                              return response;
                          } }
     , deleteDesignUri_{ "/delete-design",
@@ -795,80 +813,1346 @@ FramepixServer::FramepixServer(
 
             cJSON* name = cJSON_GetObjectItem(root, "name");
             cJSON* isAnimation = cJSON_GetObjectItem(root, "isAnimation");
-            if (!cJSON_IsString(name) || !cJSON_IsBool(isAnimation))
+            auto transition = FrameJson::parseTransition(root);
+            if (!cJSON_IsString(name) || !cJSON_IsBool(isAnimation) || !transition)
             {
                 cJSON_Delete(root);
                 response.setStatus("400 Bad Request");
                 response.setContent("Invalid request format", "text/plain");
                 return response;
             }
+            const std::string itemName = name->valuestring;
+            const bool itemIsAnimation = isAnimation->valueint != 0;
+            // With a transition the item is also shown right away
+            const bool show = cJSON_GetObjectItem(root, "transition") != nullptr;
+            cJSON_Delete(root);
 
-            if (storageManager_.saveLastUsed(name->valuestring, isAnimation->valueint != 0))
-            {
-                response.setStatus("200 OK");
-                response.setContent("Last used item set", "text/plain");
-            }
-            else
+            if (!storageManager_.saveLastUsed(itemName, itemIsAnimation))
             {
                 response.setStatus("500 Internal Server Error");
                 response.setContent("Failed to set last used item", "text/plain");
+                return response;
+            }
+            if (show && !showItem(itemName, itemIsAnimation, *transition))
+            {
+                response.setStatus("404 Not Found");
+                response.setContent("Failed to show item", "text/plain");
+                return response;
+            }
+
+            response.setStatus("200 OK");
+            response.setContent("Last used item set", "text/plain");
+            return response;
+        }
+    }
+    , playlistUri_{
+        "/playlist",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            auto playlist = storageManager_.loadPlaylist().value_or(
+                StorageManager::Playlist{ {}, false });
+            const auto status = playlistScheduler_.status();
+
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddBoolToObject(root, "active", playlist.active);
+            cJSON_AddBoolToObject(root, "running", status.running);
+            if (status.running)
+            {
+                cJSON_AddNumberToObject(root, "index", status.index);
+            }
+            cJSON* items = cJSON_AddArrayToObject(root, "items");
+            for (const auto& item: playlist.items)
+            {
+                cJSON* entry = cJSON_CreateObject();
+                cJSON_AddStringToObject(entry, "name", item.name.c_str());
+                cJSON_AddBoolToObject(entry, "isAnimation", item.isAnimation);
+                cJSON_AddNumberToObject(entry, "dwell_ms", item.dwellMs);
+                FrameJson::addTransition(entry, item.transition);
+                cJSON_AddItemToArray(items, entry);
             }
 
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
             cJSON_Delete(root);
             return response;
         }
     }
-{
-}
+    , setPlaylistUri_{
+        "/playlist",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
 
-void FramepixServer::start()
-{
-    httpServer_.start();
-    httpServer_.registerUri(framepixPageUri_);
-    httpServer_.registerUri(framepixCssUri_);
-    httpServer_.registerUri(framepixJsUri_);
-    httpServer_.registerUri(jszipUri_);
-    httpServer_.registerUri(framepixMatrixUri_);
-    httpServer_.registerUri(framepixAnimationUri_);
-    httpServer_.registerUri(framepixWifiChangeUri_);
+            cJSON* active = cJSON_GetObjectItem(root, "active");
+            cJSON* items = cJSON_GetObjectItem(root, "items");
+            if (!cJSON_IsBool(active) || !cJSON_IsArray(items))
+            {
+                cJSON_Delete(root);
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid request format", "text/plain");
+                return response;
+            }
 
-    // Register new storage endpoints
-    httpServer_.registerUri(saveDesignUri_);
-    httpServer_.registerUri(saveAnimationUri_);
-    httpServer_.registerUri(listDesignsUri_);
-    httpServer_.registerUri(listAnimationsUri_);
-    httpServer_.registerUri(loadDesignUri_);
-    httpServer_.registerUri(loadAnimationUri_);
-    httpServer_.registerUri(deleteDesignUri_);
-    httpServer_.registerUri(deleteAnimationUri_);
-    httpServer_.registerUri(clearStorageUri_);
-    httpServer_.registerUri(loadLastUsedUri_);
-    httpServer_.registerUri(setLastUsedUri_);
+            StorageManager::Playlist playlist{ {}, active->valueint != 0 };
+            cJSON* item = nullptr;
+            cJSON_ArrayForEach(item, items)
+            {
+                cJSON* name = cJSON_GetObjectItem(item, "name");
+                cJSON* isAnimation = cJSON_GetObjectItem(item, "isAnimation");
+                cJSON* dwellMs = cJSON_GetObjectItem(item, "dwell_ms");
+                auto transition = FrameJson::parseTransition(item);
+                if (!cJSON_IsString(name) || !cJSON_IsBool(isAnimation)
+                    || !cJSON_IsNumber(dwellMs) || dwellMs->valuedouble < 1
+                    || dwellMs->valuedouble > UINT32_MAX || !transition)
+                {
+                    cJSON_Delete(root);
+                    response.setStatus("400 Bad Request");
+                    response.setContent("Invalid playlist item", "text/plain");
+                    return response;
+                }
+                playlist.items.push_back(
+                    { name->valuestring,
+                      isAnimation->valueint != 0,
+                      static_cast<uint32_t>(dwellMs->valuedouble),
+                      *transition });
+            }
+            cJSON_Delete(root);
 
-    // Load last used design/animation
-    auto lastUsed = storageManager_.loadLastUsed();
-    if (lastUsed)
-    {
-        const auto& [name, isAnimation] = *lastUsed;
-        if (isAnimation)
+            if (playlist.active && playlist.items.empty())
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Empty playlist", "text/plain");
+                return response;
+            }
+            if (!storageManager_.savePlaylist(playlist))
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save playlist", "text/plain");
+                return response;
+            }
+
+            if (playlist.active)
+            {
+                playlistScheduler_.start(std::move(playlist));
+            }
+            else
+            {
+                playlistScheduler_.stop();
+            }
+            response.setStatus("200 OK");
+            response.setContent("Playlist saved", "text/plain");
+            return response;
+        }
+    }
+    , clockUri_{
+        "/clock",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto settings = clockOverlay_.settings();
+            char color[8];
+            snprintf(
+                color,
+                sizeof(color),
+                "#%02x%02x%02x",
+                settings.color.r,
+                settings.color.g,
+                settings.color.b);
+
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddStringToObject(
+                root, "mode", ClockOverlay::toString(settings.mode));
+            cJSON_AddStringToObject(root, "color", color);
+            cJSON_AddStringToObject(
+                root, "position", settings.top ? "top" : "bottom");
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , setClockUri_{
+        "/clock",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
         {
-            auto animation = storageManager_.loadAnimation(name);
-            if (animation)
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
+
+            // Members left out keep their current value
+            auto settings = clockOverlay_.settings();
+            const char* mode = cJSON_GetStringValue(cJSON_GetObjectItem(root, "mode"));
+            const char* color = cJSON_GetStringValue(cJSON_GetObjectItem(root, "color"));
+            const char* position
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "position"));
+            auto parsedMode = mode ? ClockOverlay::parseMode(mode) : settings.mode;
+            auto parsedColor
+                = color ? FrameJson::parseHexColor(color) : settings.color;
+            const bool validPosition = !position || strcmp(position, "top") == 0
+                || strcmp(position, "bottom") == 0;
+            if (position && validPosition)
+            {
+                settings.top = strcmp(position, "top") == 0;
+            }
+            cJSON_Delete(root);
+
+            if (!parsedMode || !parsedColor || !validPosition)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid clock settings", "text/plain");
+                return response;
+            }
+            settings.mode = *parsedMode;
+            settings.color = *parsedColor;
+
+            if (!storageManager_.saveClock(settings))
             {
-                animator_.start(std::move(animation->frames), animation->intervalMs);
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save clock", "text/plain");
+                return response;
             }
+            clockOverlay_.configure(settings);
+            response.setStatus("200 OK");
+            response.setContent("Clock saved", "text/plain");
+            return response;
         }
-        else
+    }
+    , effectUri_{
+        "/effect",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
         {
-            auto design = storageManager_.loadDesign(name);
-            if (design)
+            HttpResponse response(req);
+            cJSON* root = cJSON_CreateObject();
+            cJSON* effects = cJSON_AddArrayToObject(root, "effects");
+            for (auto kind:
+                 { Effect::Kind::Plasma,
+                   Effect::Kind::Rainbow,
+                   Effect::Kind::Noise,
+                   Effect::Kind::Fire,
+                   Effect::Kind::MatrixRain,
+                   Effect::Kind::Life })
+            {
+                cJSON_AddItemToArray(
+                    effects, cJSON_CreateString(Effect::toString(kind)));
+            }
+            cJSON* presets = cJSON_AddArrayToObject(root, "presets");
+            for (const auto& name: storageManager_.listEffectPresets())
+            {
+                cJSON_AddItemToArray(presets, cJSON_CreateString(name.c_str()));
+            }
+            if (auto effect = animator_.effect())
             {
-                animator_.stop();
-                ledMatrix_.setAllPixels(design->pixels);
-                ledMatrix_.update();
+                FrameJson::addEffect(
+                    cJSON_AddObjectToObject(root, "playing"), *effect);
             }
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
         }
     }
+    , setEffectUri_{
+        "/effect",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
+
+            // Starts from a preset, a new effect, or tunes the one playing
+            const char* presetName
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "preset"));
+            const bool newEffect
+                = presetName || cJSON_GetObjectItem(root, "effect") != nullptr;
+            std::optional<Effect> base
+                = presetName ? storageManager_.loadEffectPreset(presetName)
+                : newEffect  ? Effect{}
+                             : animator_.effect();
+            if (!base)
+            {
+                cJSON_Delete(root);
+                response.setStatus(presetName ? "404 Not Found" : "409 Conflict");
+                response.setContent(
+                    presetName ? "Preset not found" : "No effect playing",
+                    "text/plain");
+                return response;
+            }
+            auto effect = FrameJson::parseEffect(root, *base);
+            auto transition = FrameJson::parseTransition(root);
+            const char* saveAs
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "save_as"));
+            std::string saveName = saveAs ? saveAs : "";
+            cJSON_Delete(root);
+            if (!effect || !transition)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid effect", "text/plain");
+                return response;
+            }
+
+            if (newEffect)
+            {
+                playlistScheduler_.stop();
+                animator_.play(*effect, *transition);
+            }
+            else
+            {
+                animator_.tune(effect->params);
+            }
+            if (!saveName.empty()
+                && !storageManager_.saveEffectPreset(saveName, *effect))
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save preset", "text/plain");
+                return response;
+            }
+            response.setStatus("200 OK");
+            response.setContent("OK", "text/plain");
+            return response;
+        }
+    }
+    , deleteEffectUri_{
+        "/effect",
+        HTTP_DELETE,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            auto name = req.getQueryParam("preset");
+            if (!name)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Missing preset parameter", "text/plain");
+                return response;
+            }
+            if (storageManager_.deleteEffectPreset(std::string{ name.value() }))
+            {
+                response.setStatus("200 OK");
+                response.setContent("Preset deleted", "text/plain");
+            }
+            else
+            {
+                response.setStatus("404 Not Found");
+                response.setContent("Preset not found", "text/plain");
+            }
+            return response;
+        }
+    }
+    , textUri_{
+        "/text",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            cJSON* root = cJSON_CreateObject();
+            cJSON* fonts = cJSON_AddArrayToObject(root, "fonts");
+            for (auto font: { ScrollingText::Font::Small, ScrollingText::Font::Large })
+            {
+                cJSON_AddItemToArray(
+                    fonts, cJSON_CreateString(ScrollingText::toString(font)));
+            }
+            cJSON* messages = cJSON_AddArrayToObject(root, "messages");
+            for (const auto& name: storageManager_.listMessages())
+            {
+                cJSON_AddItemToArray(messages, cJSON_CreateString(name.c_str()));
+            }
+            if (auto text = animator_.text())
+            {
+                FrameJson::addText(cJSON_AddObjectToObject(root, "playing"), *text);
+            }
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , setTextUri_{
+        "/text",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
+
+            // Starts a stored message, new text, or restarts the text
+            // scrolling with new settings
+            const char* messageName
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "message"));
+            const bool newText = cJSON_GetObjectItem(root, "text") != nullptr;
+            std::optional<ScrollingText> base
+                = messageName ? storageManager_.loadMessage(messageName)
+                : newText     ? ScrollingText{}
+                              : animator_.text();
+            if (!base)
+            {
+                cJSON_Delete(root);
+                response.setStatus(messageName ? "404 Not Found" : "409 Conflict");
+                response.setContent(
+                    messageName ? "Message not found" : "No text scrolling",
+                    "text/plain");
+                return response;
+            }
+            auto text = FrameJson::parseText(root, *base);
+            auto transition = FrameJson::parseTransition(root);
+            const char* saveAs
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "save_as"));
+            std::string saveName = saveAs ? saveAs : "";
+            cJSON_Delete(root);
+            if (!text || !transition)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid text", "text/plain");
+                return response;
+            }
+
+            playlistScheduler_.stop();
+            animator_.scroll(*text, *transition);
+            if (!saveName.empty() && !storageManager_.saveMessage(saveName, *text))
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save message", "text/plain");
+                return response;
+            }
+            response.setStatus("200 OK");
+            response.setContent("OK", "text/plain");
+            return response;
+        }
+    }
+    , deleteTextUri_{
+        "/text",
+        HTTP_DELETE,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            auto name = req.getQueryParam("message");
+            if (!name)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Missing message parameter", "text/plain");
+                return response;
+            }
+            if (storageManager_.deleteMessage(std::string{ name.value() }))
+            {
+                response.setStatus("200 OK");
+                response.setContent("Message deleted", "text/plain");
+            }
+            else
+            {
+                response.setStatus("404 Not Found");
+                response.setContent("Message not found", "text/plain");
+            }
+            return response;
+        }
+    }
+    , spritesUri_{
+        "/sprites",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            cJSON* root = cJSON_CreateObject();
+            cJSON* animations = cJSON_AddArrayToObject(root, "animations");
+            for (const auto& name: storageManager_.listSpriteAnimations())
+            {
+                cJSON_AddItemToArray(animations, cJSON_CreateString(name.c_str()));
+            }
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , setSpritesUri_{
+        "/sprites",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
+
+            auto transition = FrameJson::parseTransition(root);
+            if (!transition)
+            {
+                cJSON_Delete(root);
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid transition", "text/plain");
+                return response;
+            }
+
+            // Plays a stored animation, or an uploaded one that may be
+            // stored as well
+            const char* storedName
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "animation"));
+            if (storedName)
+            {
+                auto animation = storageManager_.loadSpriteAnimation(storedName);
+                cJSON_Delete(root);
+                if (!animation)
+                {
+                    response.setStatus("404 Not Found");
+                    response.setContent("Animation not found", "text/plain");
+                    return response;
+                }
+                Timeline timeline = animation->timeline;
+                playlistScheduler_.stop();
+                animator_.start(
+                    MatrixAnimator<LedMatrix>::Clip{
+                        std::in_place_type<FrameJson::Sprites>,
+                        std::move(animation->frames) },
+                    std::move(timeline),
+                    *transition);
+                response.setStatus("200 OK");
+                response.setContent("OK", "text/plain");
+                return response;
+            }
+
+            const cJSON* intervalMs = cJSON_GetObjectItem(root, "interval_ms");
+            auto sprites = FrameJson::parseSprites(root);
+            if (!cJSON_IsNumber(intervalMs) || intervalMs->valueint <= 0 || !sprites)
+            {
+                cJSON_Delete(root);
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid sprite animation", "text/plain");
+                return response;
+            }
+            StorageManager::SpriteAnimation animation{
+                "", intervalMs->valueint, std::move(*sprites), {}
+            };
+            auto timeline = FrameJson::parseTimeline(
+                root, animation.frames.size(), animation.intervalMs);
+            const char* saveAs
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "save_as"));
+            animation.name = saveAs ? saveAs : "";
+            cJSON_Delete(root);
+            if (!timeline)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid timeline", "text/plain");
+                return response;
+            }
+            animation.timeline = *timeline;
+
+            if (!animation.name.empty()
+                && !storageManager_.saveSpriteAnimation(animation))
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save animation", "text/plain");
+                return response;
+            }
+            ESP_LOGI(
+                TAG,
+                "Received %u sprites in %u frames",
+                static_cast<unsigned>(animation.frames.spriteCount()),
+                static_cast<unsigned>(animation.frames.size()));
+            playlistScheduler_.stop();
+            animator_.start(
+                MatrixAnimator<LedMatrix>::Clip{ std::in_place_type<FrameJson::Sprites>,
+                                                 std::move(animation.frames) },
+                std::move(*timeline),
+                *transition);
+            response.setStatus("200 OK");
+            response.setContent("OK", "text/plain");
+            return response;
+        }
+    }
+    , deleteSpritesUri_{
+        "/sprites",
+        HTTP_DELETE,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            auto name = req.getQueryParam("animation");
+            if (!name)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Missing animation parameter", "text/plain");
+                return response;
+            }
+            if (storageManager_.deleteSpriteAnimation(std::string{ name.value() }))
+            {
+                response.setStatus("200 OK");
+                response.setContent("Animation deleted", "text/plain");
+            }
+            else
+            {
+                response.setStatus("404 Not Found");
+                response.setContent("Animation not found", "text/plain");
+            }
+            return response;
+        }
+    }
+    , shaderUri_{
+        "/shader",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddNumberToObject(root, "max_instructions", PixelShader::maxInstructions);
+            cJSON_AddNumberToObject(root, "steps_per_pixel", PixelShader::stepsPerPixel);
+            cJSON* shaders = cJSON_AddArrayToObject(root, "shaders");
+            for (const auto& name: storageManager_.listShaders())
+            {
+                cJSON_AddItemToArray(shaders, cJSON_CreateString(name.c_str()));
+            }
+            if (auto shader = animator_.shader())
+            {
+                cJSON_AddStringToObject(root, "playing", shader->source().c_str());
+            }
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , setShaderUri_{
+        "/shader",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
+
+            // Runs a stored shader or assembles new source
+            const char* shaderName
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "shader"));
+            const char* source = cJSON_GetStringValue(cJSON_GetObjectItem(root, "source"));
+            auto transition = FrameJson::parseTransition(root);
+            const char* saveAs
+                = cJSON_GetStringValue(cJSON_GetObjectItem(root, "save_as"));
+            std::string saveName = saveAs ? saveAs : "";
+            std::string error = "Missing shader or source";
+            std::optional<PixelShader> shader;
+            if (shaderName)
+            {
+                shader = storageManager_.loadShader(shaderName);
+                error = "Shader not found";
+            }
+            else if (source)
+            {
+                shader = PixelShader::assemble(source, &error);
+            }
+            cJSON_Delete(root);
+            if (!shader || !transition)
+            {
+                response.setStatus(
+                    shaderName && !shader ? "404 Not Found" : "400 Bad Request");
+                response.setContent(shader ? "Invalid transition" : error, "text/plain");
+                return response;
+            }
+
+            playlistScheduler_.stop();
+            animator_.play(*shader, *transition);
+            if (!saveName.empty() && !storageManager_.saveShader(saveName, *shader))
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save shader", "text/plain");
+                return response;
+            }
+            response.setStatus("200 OK");
+            response.setContent("OK", "text/plain");
+            return response;
+        }
+    }
+    , deleteShaderUri_{
+        "/shader",
+        HTTP_DELETE,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            auto name = req.getQueryParam("shader");
+            if (!name)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Missing shader parameter", "text/plain");
+                return response;
+            }
+            if (storageManager_.deleteShader(std::string{ name.value() }))
+            {
+                response.setStatus("200 OK");
+                response.setContent("Shader deleted", "text/plain");
+            }
+            else
+            {
+                response.setStatus("404 Not Found");
+                response.setContent("Shader not found", "text/plain");
+            }
+            return response;
+        }
+    }
+    , uploadGifUri_{
+        "/upload-gif",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            // The body is the GIF file, decoded as it arrives into frames
+            // of the matrix size, so it is never held whole
+            StorageManager::Animation animation;
+            animation.name = req.getQueryParam("save_as").value_or("");
+            // With ?canvas the GIF is of the whole video wall: decoded at
+            // the canvas size, this device plays its tile, and the canvas
+            // frames are saved for every device to play its own
+            const bool wall = req.getQueryParam("canvas").has_value();
+            const VirtualCanvas canvas = wall
+                ? storageManager_.canvas()
+                : VirtualCanvas::single(LedMatrix::width, LedMatrix::height);
+            // Canvas frames go to the file as they are decoded
+            std::optional<StorageManager::CanvasAnimationWriter> canvasWriter;
+            if (wall && !animation.name.empty())
+            {
+                canvasWriter.emplace(
+                    storageManager_, animation.name, canvas.width, canvas.height);
+            }
+            bool outOfMemory = false;
+            bool writeFailed = false;
+            auto buffers = makeScratch<TileBuffers>();
+            auto decoder = buffers ? makeScratch<GifDecoder>(
+                canvas.width,
+                canvas.height,
+                [&](std::span<const GifDecoder::Color> pixels, uint32_t delayMs)
+                {
+                    static_assert(sizeof(GifDecoder::Color) == 3);
+                    const std::span<const uint8_t> bytes{
+                        reinterpret_cast<const uint8_t*>(pixels.data()), pixels.size() * 3
+                    };
+                    auto& tile = buffers->tile;
+                    auto& frame = buffers->frame;
+                    tile.fill(0);
+                    canvas.crop(0, bytes, tile);
+                    for (size_t i = 0; i < frame.size(); ++i)
+                    {
+                        frame[i] = { tile[i * 3], tile[i * 3 + 1], tile[i * 3 + 2] };
+                    }
+                    if (animation.frames.size() > UINT16_MAX
+                        || !animation.frames.push_back(frame))
+                    {
+                        outOfMemory = true;
+                        return false;
+                    }
+                    if (canvasWriter && !canvasWriter->addFrame(bytes))
+                    {
+                        writeFailed = true;
+                        return false;
+                    }
+                    animation.timeline.entries.push_back(
+                        { static_cast<uint16_t>(animation.frames.size() - 1), delayMs });
+                    return true;
+                })
+                                  : nullptr;
+            if (!decoder || !decoder->ok())
+            {
+                ESP_LOGE(TAG, "No memory to decode a %ux%u GIF", canvas.width, canvas.height);
+                response.setStatus("507 Insufficient Storage");
+                response.setContent("Not enough memory to decode the GIF", "text/plain");
+                return response;
+            }
+
+            auto& chunk = buffers->chunk;
+            int received;
+            while ((received = req.receive(chunk.data(), chunk.size())) > 0
+                   && decoder->feed(reinterpret_cast<const uint8_t*>(chunk.data()), received))
+            {
+            }
+            if (received < 0)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Failed to receive the GIF", "text/plain");
+                return response;
+            }
+            if (outOfMemory)
+            {
+                response.setStatus("507 Insufficient Storage");
+                response.setContent("Not enough memory for frames", "text/plain");
+                return response;
+            }
+            if (writeFailed)
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save animation", "text/plain");
+                return response;
+            }
+            if (!decoder->done() || animation.frames.empty())
+            {
+                ESP_LOGW(
+                    TAG,
+                    "Invalid GIF after %u frames: %s",
+                    static_cast<unsigned>(decoder->frames()),
+                    decoder->error() ? decoder->error() : "incomplete");
+                response.setStatus("400 Bad Request");
+                response.setContent(
+                    decoder->error() ? decoder->error() : "Incomplete GIF", "text/plain");
+                return response;
+            }
+
+            animation.intervalMs = static_cast<int>(animation.timeline.entries[0].durationMs);
+            // The canvas timeline, before frames that are the same on this
+            // tile are merged
+            const bool savedCanvas = !canvasWriter
+                || canvasWriter->finish(animation.intervalMs, animation.timeline);
+            deduplicate(animation.frames, animation.timeline);
+            ESP_LOGI(
+                TAG,
+                "Decoded GIF: %u unique frames in %u entries",
+                static_cast<unsigned>(animation.frames.size()),
+                static_cast<unsigned>(animation.timeline.entries.size()));
+            const bool saved = canvasWriter
+                ? savedCanvas
+                : animation.name.empty() || storageManager_.saveAnimation(animation);
+            if (!saved)
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save animation", "text/plain");
+                return response;
+            }
+
+            playlistScheduler_.stop();
+            if (!animator_.start(std::move(animation.frames), std::move(animation.timeline)))
+            {
+                response.setStatus("507 Insufficient Storage");
+                response.setContent("Not enough memory to play the GIF", "text/plain");
+                return response;
+            }
+            response.setStatus("200 OK");
+            response.setContent("OK", "text/plain");
+            return response;
+        }
+    }
+    , frameStatsUri_{
+        "/frame-stats",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto& frameStats = animator_.frameStats();
+            const auto summary = frameStats.summary();
+
+            auto addHistogram = [](cJSON* parent, const char* name, const FrameStats::Histogram& histogram)
+            {
+                cJSON* array = cJSON_CreateArray();
+                for (auto count: histogram)
+                {
+                    cJSON_AddItemToArray(array, cJSON_CreateNumber(count));
+                }
+                cJSON_AddItemToObject(parent, name, array);
+            };
+
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddNumberToObject(root, "intervalUs", summary.intervalUs);
+            cJSON_AddNumberToObject(root, "frames", summary.frames);
+            cJSON_AddNumberToObject(root, "deadlineMisses", summary.deadlineMisses);
+            cJSON_AddNumberToObject(root, "meanPeriodUs", summary.meanPeriodUs);
+            cJSON_AddNumberToObject(root, "maxPeriodUs", summary.maxPeriodUs);
+            cJSON_AddNumberToObject(root, "meanRenderUs", summary.meanRenderUs);
+            cJSON_AddNumberToObject(root, "maxRenderUs", summary.maxRenderUs);
+
+            cJSON* bounds = cJSON_CreateArray();
+            for (auto bound: FrameStats::bucketBoundsUs)
+            {
+                cJSON_AddItemToArray(bounds, cJSON_CreateNumber(bound));
+            }
+            cJSON_AddItemToObject(root, "bucketBoundsUs", bounds);
+            addHistogram(root, "periodHistogram", summary.period);
+            addHistogram(root, "renderHistogram", summary.render);
+
+            std::array<FrameStats::Sample, 16> samples;
+            const size_t count = frameStats.recent(samples);
+            cJSON* recent = cJSON_CreateArray();
+            for (size_t i = 0; i < count; ++i)
+            {
+                cJSON* sample = cJSON_CreateObject();
+                cJSON_AddNumberToObject(sample, "convertStartUs", samples[i].convertStartUs);
+                cJSON_AddNumberToObject(sample, "transmitStartUs", samples[i].transmitStartUs);
+                cJSON_AddNumberToObject(sample, "transmitDoneUs", samples[i].transmitDoneUs);
+                cJSON_AddItemToArray(recent, sample);
+            }
+            cJSON_AddItemToObject(root, "recent", recent);
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , tasksUri_{
+        "/tasks",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            auto snapshot = taskDiagnostics_.latest();
+            if (!snapshot)
+            {
+                response.setStatus("503 Service Unavailable");
+                response.setContent("No task statistics yet", "text/plain");
+                return response;
+            }
+
+            auto stateName = [](eTaskState state)
+            {
+                switch (state)
+                {
+                case eRunning:
+                    return "running";
+                case eReady:
+                    return "ready";
+                case eBlocked:
+                    return "blocked";
+                case eSuspended:
+                    return "suspended";
+                case eDeleted:
+                    return "deleted";
+                default:
+                    return "invalid";
+                }
+            };
+
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddNumberToObject(root, "windowMs", snapshot->windowMs);
+            cJSON* cores = cJSON_CreateArray();
+            for (auto load: snapshot->coreLoadPercent)
+            {
+                cJSON_AddItemToArray(cores, cJSON_CreateNumber(load));
+            }
+            cJSON_AddItemToObject(root, "coreLoadPercent", cores);
+
+            cJSON* tasks = cJSON_CreateArray();
+            for (size_t i = 0; i < snapshot->numTasks; ++i)
+            {
+                const auto& task = snapshot->tasks[i];
+                cJSON* item = cJSON_CreateObject();
+                cJSON_AddStringToObject(item, "name", task.name);
+                cJSON_AddNumberToObject(item, "core", task.core);
+                cJSON_AddNumberToObject(item, "priority", task.priority);
+                cJSON_AddStringToObject(item, "state", stateName(task.state));
+                cJSON_AddNumberToObject(item, "cpuPercent", task.cpuPercent);
+                cJSON_AddNumberToObject(item, "stackFreeMin", task.stackFreeMin);
+                cJSON_AddItemToArray(tasks, item);
+            }
+            cJSON_AddItemToObject(root, "tasks", tasks);
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , heapUri_{
+        "/heap",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+
+            auto addHeap = [](cJSON* parent, const char* name, uint32_t caps)
+            {
+                const auto info = HeapStats::heapInfo(caps);
+                cJSON* heap = cJSON_CreateObject();
+                cJSON_AddNumberToObject(heap, "freeBytes", info.freeBytes);
+                cJSON_AddNumberToObject(heap, "minimumFreeBytes", info.minimumFreeBytes);
+                cJSON_AddNumberToObject(heap, "largestFreeBlock", info.largestFreeBlock);
+                cJSON_AddNumberToObject(heap, "fragmentationPercent", info.fragmentationPercent);
+                cJSON_AddItemToObject(parent, name, heap);
+            };
+
+            cJSON* root = cJSON_CreateObject();
+            cJSON* heaps = cJSON_CreateObject();
+            addHeap(heaps, "internal", MALLOC_CAP_INTERNAL);
+            addHeap(heaps, "psram", MALLOC_CAP_SPIRAM);
+            cJSON_AddItemToObject(root, "heaps", heaps);
+
+            cJSON* tags = cJSON_CreateObject();
+            for (size_t i = 0; i < HeapStats::numTags; ++i)
+            {
+                const auto tag = static_cast<HeapStats::AllocTag>(i);
+                const auto stats = HeapStats::tagStats(tag);
+                cJSON* item = cJSON_CreateObject();
+                cJSON_AddNumberToObject(item, "bytes", stats.bytes);
+                cJSON_AddNumberToObject(item, "peakBytes", stats.peakBytes);
+                cJSON_AddNumberToObject(item, "allocations", stats.allocations);
+                cJSON_AddNumberToObject(item, "psramFallbacks", stats.psramFallbacks);
+                cJSON_AddNumberToObject(item, "failures", stats.failures);
+                cJSON_AddItemToObject(tags, HeapStats::toString(tag), item);
+            }
+            cJSON_AddItemToObject(root, "tags", tags);
+
+            const auto& arena = httpServer_.arena();
+            cJSON* requestArena = cJSON_CreateObject();
+            cJSON_AddNumberToObject(requestArena, "capacity", arena.capacity());
+            cJSON_AddNumberToObject(requestArena, "peakUsed", arena.peakUsed());
+            cJSON_AddItemToObject(root, "requestArena", requestArena);
+
+            using Pool = MatrixAnimator<LedMatrix>::Frames::Pool;
+            const auto pool = Pool::instance().stats();
+            cJSON* framePool = cJSON_CreateObject();
+            cJSON_AddNumberToObject(framePool, "blockBytes", pool.blockBytes);
+            cJSON_AddNumberToObject(framePool, "framesPerBlock", Pool::framesPerBlock);
+            cJSON_AddNumberToObject(framePool, "blocks", pool.blocks);
+            cJSON_AddNumberToObject(framePool, "freeBlocks", pool.freeBlocks);
+            cJSON_AddNumberToObject(framePool, "failures", pool.failures);
+            cJSON_AddItemToObject(root, "framePool", framePool);
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , syncUri_{
+        "/sync",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto stats = timeSync_.stats();
+
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddBoolToObject(root, "running", stats.running);
+            cJSON_AddBoolToObject(root, "leading", stats.leading);
+            cJSON_AddNumberToObject(root, "leaderId", stats.leaderId);
+            cJSON_AddBoolToObject(root, "synced", stats.synced);
+            cJSON_AddNumberToObject(root, "errorUs", stats.clock.errorUs);
+            cJSON_AddNumberToObject(root, "offsetUs", static_cast<double>(stats.clock.offsetUs));
+            cJSON_AddNumberToObject(root, "skewPpm", stats.clock.skewPpm);
+            cJSON_AddNumberToObject(root, "roundTripUs", stats.clock.roundTripUs);
+            cJSON_AddNumberToObject(root, "exchanges", stats.clock.exchanges);
+            cJSON_AddNumberToObject(root, "leaderChanges", stats.leaderChanges);
+            cJSON_AddNumberToObject(root, "invalid", stats.invalid);
+            if (const auto sinceUs = timeSync_.sinceEpochUs())
+            {
+                cJSON_AddNumberToObject(root, "sinceEpochMs", static_cast<double>(*sinceUs / 1000));
+            }
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , canvasUri_{
+        "/canvas",
+        HTTP_GET,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const VirtualCanvas& canvas = storageManager_.canvas();
+            cJSON* root = cJSON_CreateObject();
+            cJSON_AddNumberToObject(root, "width", canvas.width);
+            cJSON_AddNumberToObject(root, "height", canvas.height);
+            cJSON_AddNumberToObject(root, "x", canvas.tileX);
+            cJSON_AddNumberToObject(root, "y", canvas.tileY);
+            cJSON_AddNumberToObject(root, "rotation", static_cast<int>(canvas.rotation) * 90);
+
+            char* json = cJSON_PrintUnformatted(root);
+            response.setStatus("200 OK");
+            response.setContent(json, "application/json");
+
+            cJSON_free(json);
+            cJSON_Delete(root);
+            return response;
+        }
+    }
+    , setCanvasUri_{
+        "/canvas",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            const auto content = req.getContent();
+            cJSON* root = content.empty() ? nullptr : cJSON_Parse(content.c_str());
+            if (!root)
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent("Invalid JSON", "text/plain");
+                return response;
+            }
+
+            // Members left out keep their current value
+            VirtualCanvas canvas = storageManager_.canvas();
+            bool validNumbers = true;
+            auto number = [&](const char* name, uint16_t& value)
+            {
+                cJSON* item = cJSON_GetObjectItem(root, name);
+                if (!item)
+                {
+                    return;
+                }
+                if (!cJSON_IsNumber(item) || item->valueint < 0 || item->valueint > UINT16_MAX)
+                {
+                    validNumbers = false;
+                    return;
+                }
+                value = static_cast<uint16_t>(item->valueint);
+            };
+            uint16_t rotation = static_cast<uint16_t>(canvas.rotation) * 90;
+            number("width", canvas.width);
+            number("height", canvas.height);
+            number("x", canvas.tileX);
+            number("y", canvas.tileY);
+            number("rotation", rotation);
+            cJSON_Delete(root);
+            canvas.rotation = static_cast<WS2812MatrixRotation>(rotation / 90);
+
+            if (!validNumbers || rotation % 90 != 0 || rotation > 270 || !canvas.valid())
+            {
+                response.setStatus("400 Bad Request");
+                response.setContent(
+                    "Invalid canvas, the tile must be on it and the canvas not too large",
+                    "text/plain");
+                return response;
+            }
+            if (!storageManager_.saveCanvas(canvas))
+            {
+                response.setStatus("500 Internal Server Error");
+                response.setContent("Failed to save canvas", "text/plain");
+                return response;
+            }
+            // Realtime streams are cropped from the next start on
+            storageManager_.setCanvas(canvas);
+            if (auto lastUsed = storageManager_.loadLastUsed())
+            {
+                // The boot frame is of the new tile
+                storageManager_.saveLastUsed(lastUsed->first, lastUsed->second);
+            }
+            response.setStatus("200 OK");
+            response.setContent("Canvas saved", "text/plain");
+            return response;
+        }
+    }
+    , canvasFrameUri_{
+        "/canvas-frame",
+        HTTP_POST,
+        [this](HttpRequest req) -> HttpResponse
+        {
+            HttpResponse response(req);
+            // The body is a frame of the whole canvas, RGB row after row.
+            // Every device gets the same upload and keeps its tile as the
+            // body goes by.
+            const VirtualCanvas canvas = storageManager_.canvas();
+            auto buffers = makeScratch<TileBuffers>();
+            if (!buffers)
+            {
+                response.setStatus("507 Insufficient Storage");
+                response.setContent("Not enough memory for the frame", "text/plain");
+                return response;
+            }
+            auto& tile = buffers->tile;
+            auto& chunk = buffers->chunk;
+            size_t offset = 0;
+            int received;
+            while ((received = req.receive(chunk.data(), chunk.size())) > 0)
+            {
+                canvas.crop(
+                    offset,
+                    { reinterpret_cast<const uint8_t*>(chunk.data()),
+                      static_cast<size_t>(received) },
+                    tile);
+                offset += received;
+            }
+            if (received < 0 || offset != canvas.channels())
+            {
+                ESP_LOGW(
+                    TAG,
+                    "Canvas frame of %u bytes, expected %u",
+                    static_cast<unsigned>(offset),
+                    static_cast<unsigned>(canvas.channels()));
+                response.setStatus("400 Bad Request");
+                response.setContent("Not a frame of the canvas", "text/plain");
+                return response;
+            }
+
+            auto& frame = buffers->frame;
+            for (size_t i = 0; i < frame.size(); ++i)
+            {
+                frame[i] = { tile[i * 3], tile[i * 3 + 1], tile[i * 3 + 2] };
+            }
+            playlistScheduler_.stop();
+            if (!animator_.show(frame, {}))
+            {
+                response.setStatus("507 Insufficient Storage");
+                response.setContent("Not enough memory for the frame", "text/plain");
+                return response;
+            }
+            response.setStatus("200 OK");
+            response.setContent("OK", "text/plain");
+            return response;
+        }
+    }
+    , liveUri_{
+        "/ws",
+        MatrixAnimator<LedMatrix>::Live::maxMessageSize,
+        [this](httpd_ws_type_t type, std::span<const uint8_t> message)
+        {
+            if (type != HTTPD_WS_TYPE_BINARY)
+            {
+                ESP_LOGW(TAG, "Ignoring a non-binary live message");
+                return true;
+            }
+            // Straight into the animator, which shows the change with its
+            // next frame; a bad message closes the connection
+            playlistScheduler_.stop();
+            if (!animator_.draw(message))
+            {
+                ESP_LOGW(
+                    TAG,
+                    "Invalid live message of %u bytes",
+                    static_cast<unsigned>(message.size()));
+                return false;
+            }
+            return true;
+        }
+    }
+{
+}
+
+bool FramepixServer::showItem(
+    const std::string& name, bool isAnimation, Transition transition)
+{
+    playlistScheduler_.stop();
+    if (isAnimation)
+    {
+        auto animation = storageManager_.loadAnimation(name);
+        return animation
+            && animator_.start(
+                std::move(animation->frames),
+                std::move(animation->timeline),
+                transition);
+    }
+    auto design = storageManager_.loadDesign(name);
+    return design && animator_.show(design->pixels, transition);
+}
+
+void FramepixServer::start()
+{
+    httpServer_.start();
+    httpServer_.registerUri(framepixPageUri_);
+    httpServer_.registerUri(framepixCssUri_);
+    httpServer_.registerUri(framepixJsUri_);
+    httpServer_.registerUri(jszipUri_);
+    httpServer_.registerUri(framepixMatrixUri_);
+    httpServer_.registerUri(framepixAnimationUri_);
+    httpServer_.registerUri(framepixWifiChangeUri_);
+
+    // Register new storage endpoints
+    httpServer_.registerUri(saveDesignUri_);
+    httpServer_.registerUri(saveAnimationUri_);
+    httpServer_.registerUri(listDesignsUri_);
+    httpServer_.registerUri(listAnimationsUri_);
+    httpServer_.registerUri(loadDesignUri_);
+    httpServer_.registerUri(loadAnimationUri_);
+    httpServer_.registerUri(deleteDesignUri_);
+    httpServer_.registerUri(deleteAnimationUri_);
+    httpServer_.registerUri(clearStorageUri_);
+    httpServer_.registerUri(loadLastUsedUri_);
+    httpServer_.registerUri(setLastUsedUri_);
+    httpServer_.registerUri(playlistUri_);
+    httpServer_.registerUri(setPlaylistUri_);
+    httpServer_.registerUri(clockUri_);
+    httpServer_.registerUri(setClockUri_);
+    httpServer_.registerUri(effectUri_);
+    httpServer_.registerUri(setEffectUri_);
+    httpServer_.registerUri(deleteEffectUri_);
+    httpServer_.registerUri(textUri_);
+    httpServer_.registerUri(setTextUri_);
+    httpServer_.registerUri(deleteTextUri_);
+    httpServer_.registerUri(spritesUri_);
+    httpServer_.registerUri(setSpritesUri_);
+    httpServer_.registerUri(deleteSpritesUri_);
+    httpServer_.registerUri(shaderUri_);
+    httpServer_.registerUri(setShaderUri_);
+    httpServer_.registerUri(deleteShaderUri_);
+    httpServer_.registerUri(uploadGifUri_);
+    httpServer_.registerUri(frameStatsUri_);
+    httpServer_.registerUri(tasksUri_);
+    httpServer_.registerUri(heapUri_);
+    httpServer_.registerUri(syncUri_);
+    httpServer_.registerUri(canvasUri_);
+    httpServer_.registerUri(setCanvasUri_);
+    httpServer_.registerUri(canvasFrameUri_);
+    httpServer_.registerUri(liveUri_);
+    httpServer_.registerMetricsUri();
 
     ESP_LOGI(TAG, "Framepix server started");
 }
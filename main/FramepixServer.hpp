@@ -1,10 +1,14 @@
 #ifndef FRAMEPIX_SERVER_HPP
 #define FRAMEPIX_SERVER_HPP
 
+#include "ClockOverlay.hpp"
 #include "HttpServer.hpp"
 #include "LedMatrix.hpp"
 #include "MatrixAnimator.hpp"
+#include "PlaylistScheduler.hpp"
 #include "StorageManager.hpp"
+#include "TaskDiagnostics.hpp"
+#include "TimeSync.hpp"
 #include "WifiProvisioningWeb.hpp"
 
 using namespace EspHttpServer;
@@ -20,16 +24,27 @@ public:
         LedMatrix& ledMatrix,
         MatrixAnimator<LedMatrix>& animator,
         WifiProvisioningWeb& wifiProvisioningWeb,
-        StorageManager& storageManager);
+        StorageManager& storageManager,
+        PlaylistScheduler& playlistScheduler,
+        ClockOverlay& clockOverlay,
+        TaskDiagnostics& taskDiagnostics,
+        TimeSync& timeSync);
     void start();
     void stop();
 
 private:
+    // Loads a stored design or animation and plays it
+    bool showItem(const std::string& name, bool isAnimation, Transition transition);
+
     HttpServer& httpServer_;
     LedMatrix& ledMatrix_;
     MatrixAnimator<LedMatrix>& animator_;
     WifiProvisioningWeb& wifiProvisioningWeb_;
     StorageManager& storageManager_;
+    PlaylistScheduler& playlistScheduler_;
+    ClockOverlay& clockOverlay_;
+    TaskDiagnostics& taskDiagnostics_;
+    TimeSync& timeSync_;
     HttpUri framepixPageUri_;
     HttpUri framepixCssUri_;
     HttpUri framepixJsUri_;
@@ -49,6 +64,33 @@ private:
     HttpUri clearStorageUri_;
     HttpUri loadLastUsedUri_;
     HttpUri setLastUsedUri_;
+    HttpUri playlistUri_;
+    HttpUri setPlaylistUri_;
+    HttpUri clockUri_;
+    HttpUri setClockUri_;
+    HttpUri effectUri_;
+    HttpUri setEffectUri_;
+    HttpUri deleteEffectUri_;
+    HttpUri textUri_;
+    HttpUri setTextUri_;
+    HttpUri deleteTextUri_;
+    HttpUri spritesUri_;
+    HttpUri setSpritesUri_;
+    HttpUri deleteSpritesUri_;
+    HttpUri shaderUri_;
+    HttpUri setShaderUri_;
+    HttpUri deleteShaderUri_;
+    HttpUri uploadGifUri_;
+    HttpUri frameStatsUri_;
+    HttpUri tasksUri_;
+    HttpUri heapUri_;
+    HttpUri syncUri_;
+    // Video wall, see VirtualCanvas
+    HttpUri canvasUri_;
+    HttpUri setCanvasUri_;
+    HttpUri canvasFrameUri_;
+    // Live drawing, LiveFrame messages over a WebSocket
+    WebSocketUri liveUri_;
 };
 
 #endif  // FRAMEPIX_SERVER_HPP
@@ -0,0 +1,257 @@
+#include "PlaylistScheduler.hpp"
+
+#include <esp_log.h>
+
+PlaylistScheduler::PlaylistScheduler(StorageManager& storage, Animator& animator)
+    : storage_{ storage }
+    , animator_{ animator }
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+PlaylistScheduler::~PlaylistScheduler()
+{
+    if (taskHandle_)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        quit_ = true;
+        xSemaphoreGive(lock_);
+        xTaskNotifyGive(taskHandle_);
+
+        // Let a load in progress finish, its frames go back to the pool
+        while (true)
+        {
+            xSemaphoreTake(lock_, portMAX_DELAY);
+            const bool exited = exited_;
+            xSemaphoreGive(lock_);
+            if (exited)
+            {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+    if (lock_)
+    {
+        vSemaphoreDelete(lock_);
+    }
+}
+
+bool PlaylistScheduler::start(StorageManager::Playlist playlist)
+{
+    if (playlist.items.empty())
+    {
+        return false;
+    }
+    for (const auto& item: playlist.items)
+    {
+        if (item.dwellMs == 0)
+        {
+            ESP_LOGE(TAG, "No dwell time for: %s", item.name.c_str());
+            return false;
+        }
+    }
+
+    ESP_LOGI(
+        TAG,
+        "Starting playlist of %u items",
+        static_cast<unsigned>(playlist.items.size()));
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    playlist_ = std::move(playlist);
+    running_ = true;
+    index_ = 0;
+    ++generation_;
+    xSemaphoreGive(lock_);
+
+    if (!taskHandle_)
+    {
+        xTaskCreate(
+            taskEntry,
+            "playlistTask",
+            6 * 1024,
+            this,
+            tskIDLE_PRIORITY + 1,
+            &taskHandle_);
+    }
+    xTaskNotifyGive(taskHandle_);
+    return true;
+}
+
+void PlaylistScheduler::stop()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    const bool wasRunning = running_;
+    running_ = false;
+    ++generation_;
+    xSemaphoreGive(lock_);
+
+    if (taskHandle_)
+    {
+        xTaskNotifyGive(taskHandle_);
+    }
+    if (wasRunning)
+    {
+        ESP_LOGI(TAG, "Playlist stopped");
+    }
+}
+
+PlaylistScheduler::Status PlaylistScheduler::status() const
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    Status status{ running_, index_ };
+    xSemaphoreGive(lock_);
+    return status;
+}
+
+void PlaylistScheduler::taskEntry(void* arg)
+{
+    auto* self = static_cast<PlaylistScheduler*>(arg);
+    self->run();
+
+    xSemaphoreTake(self->lock_, portMAX_DELAY);
+    self->exited_ = true;
+    xSemaphoreGive(self->lock_);
+    vTaskDelete(nullptr);
+}
+
+void PlaylistScheduler::run()
+{
+    uint32_t seen = 0;
+    StorageManager::Playlist playlist{};
+    bool running = false;
+    // Loaded and converted while the current item is on
+    std::optional<Prepared> next;
+    TickType_t shownAt = 0;
+    TickType_t dwell = 0;
+
+    while (true)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool quit = quit_;
+        const bool changed = generation_ != seen;
+        if (changed)
+        {
+            seen = generation_;
+            playlist = playlist_;
+            running = running_;
+        }
+        xSemaphoreGive(lock_);
+
+        if (quit)
+        {
+            return;
+        }
+        if (changed)
+        {
+            next.reset();
+            if (running)
+            {
+                next = prepareFrom(playlist, 0);
+                shownAt = xTaskGetTickCount();
+                dwell = 0;
+                if (!next)
+                {
+                    xSemaphoreTake(lock_, portMAX_DELAY);
+                    running_ = running_ && generation_ != seen;
+                    xSemaphoreGive(lock_);
+                }
+            }
+            // Loading takes a while, look for newer calls first
+            continue;
+        }
+
+        if (!running || !next)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        const TickType_t elapsed = xTaskGetTickCount() - shownAt;
+        if (elapsed < dwell)
+        {
+            ulTaskNotifyTake(pdTRUE, dwell - elapsed);
+            continue;
+        }
+
+        // Switch, unless start() or stop() came in meanwhile
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        const bool current = generation_ == seen;
+        if (current)
+        {
+            if (!animator_.start(
+                    std::move(next->clip),
+                    std::move(next->timeline),
+                    playlist.items[next->index].transition))
+            {
+                ESP_LOGW(
+                    TAG,
+                    "Failed to start: %s",
+                    playlist.items[next->index].name.c_str());
+            }
+            index_ = next->index;
+        }
+        xSemaphoreGive(lock_);
+        if (!current)
+        {
+            continue;
+        }
+
+        const size_t shown = next->index;
+        shownAt = xTaskGetTickCount();
+        dwell = pdMS_TO_TICKS(playlist.items[shown].dwellMs);
+        next.reset();
+        // A single item just stays on
+        if (playlist.items.size() > 1)
+        {
+            next = prepareFrom(playlist, shown + 1);
+        }
+    }
+}
+
+std::optional<PlaylistScheduler::Prepared> PlaylistScheduler::prepareFrom(
+    const StorageManager::Playlist& playlist, size_t index)
+{
+    const size_t count = playlist.items.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t at = (index + i) % count;
+        if (auto prepared = prepare(playlist.items[at]))
+        {
+            prepared->index = at;
+            return prepared;
+        }
+        ESP_LOGW(TAG, "Skipping: %s", playlist.items[at].name.c_str());
+    }
+    ESP_LOGE(TAG, "No playlist item could be loaded");
+    return std::nullopt;
+}
+
+std::optional<PlaylistScheduler::Prepared>
+PlaylistScheduler::prepare(const StorageManager::PlaylistItem& item)
+{
+    if (item.isAnimation)
+    {
+        auto animation = storage_.loadAnimation(item.name);
+        if (!animation)
+        {
+            return std::nullopt;
+        }
+        return Prepared{ 0,
+                         Animator::toClip(std::move(animation->frames)),
+                         std::move(animation->timeline) };
+    }
+
+    auto design = storage_.loadDesign(item.name);
+    if (!design)
+    {
+        return std::nullopt;
+    }
+    Animator::Frames frames;
+    if (!frames.push_back(design->pixels))
+    {
+        ESP_LOGE(TAG, "No memory for: %s", item.name.c_str());
+        return std::nullopt;
+    }
+    // A design is a one frame animation that stays on
+    return Prepared{ 0, Animator::toClip(std::move(frames)), Timeline::still() };
+}
@@ -0,0 +1,75 @@
+#ifndef PLAYLIST_SCHEDULER_HPP
+#define PLAYLIST_SCHEDULER_HPP
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "LedMatrix.hpp"
+#include "MatrixAnimator.hpp"
+#include "StorageManager.hpp"
+
+#include <optional>
+
+/**
+ * Cycles through the designs and animations of a playlist, each one for
+ * its dwell time. While an item is on, the next one is loaded and
+ * converted in the scheduler's own task, so switching is only handing the
+ * clip to the animator, which shows it from its next frame on, blending
+ * in with the item's transition. Items that fail to load are skipped.
+ */
+class PlaylistScheduler
+{
+    inline static constexpr const char* TAG = "PlaylistScheduler";
+
+public:
+    using Animator = MatrixAnimator<LedMatrix>;
+
+    struct Status
+    {
+        bool running;
+        // Playlist position of the item on the matrix, when running
+        size_t index;
+    };
+
+    PlaylistScheduler(StorageManager& storage, Animator& animator);
+    ~PlaylistScheduler();
+
+    // Plays playlist from its first item, replacing the one playing.
+    // False when it has no items.
+    bool start(StorageManager::Playlist playlist);
+    // No switches after this returns, the current item stays on
+    void stop();
+    Status status() const;
+
+private:
+    // An item ready to hand to the animator
+    struct Prepared
+    {
+        size_t index;
+        Animator::Clip clip;
+        Timeline timeline;
+    };
+
+    static void taskEntry(void* arg);
+    void run();
+    // The first item from index on that loads, nullopt when none does
+    std::optional<Prepared>
+    prepareFrom(const StorageManager::Playlist& playlist, size_t index);
+    std::optional<Prepared> prepare(const StorageManager::PlaylistItem& item);
+
+    StorageManager& storage_;
+    Animator& animator_;
+    TaskHandle_t taskHandle_{ nullptr };
+    SemaphoreHandle_t lock_;
+
+    // Guarded by lock_, generation_ counts start() and stop() calls
+    StorageManager::Playlist playlist_{};
+    uint32_t generation_{ 0 };
+    bool running_{ false };
+    size_t index_{ 0 };
+    bool quit_{ false };
+    bool exited_{ false };
+};
+
+#endif  // PLAYLIST_SCHEDULER_HPP
@@ -1,19 +1,25 @@
 #include "StorageManager.hpp"
+#include "FrameJson.hpp"
 
 #include <esp_log.h>
 
 #include <cJSON.h>
 
+#include <cstddef>
 #include <cstring>
 #include <span>
 
 StorageManager::StorageManager(Spiffs& spiffs)
     : spiffs_(spiffs)
+    , lock_(xSemaphoreCreateRecursiveMutex())
 {
 }
 
+StorageManager::~StorageManager() { vSemaphoreDelete(lock_); }
+
 bool StorageManager::init()
 {
+    Lock lock{ lock_ };
     ESP_LOGI(TAG, "Initializing storage");
 
     // Initialize index files
@@ -29,6 +35,12 @@ bool StorageManager::init()
         return false;
     }
 
+    if (!initIndexFile(spritesIndexFile))
+    {
+        ESP_LOGE(TAG, "Failed to initialize sprite animations index file");
+        return false;
+    }
+
     return true;
 }
 
@@ -76,6 +88,11 @@ std::string StorageManager::getAnimationFilename(const std::string& name)
     return "/" + std::string(animationPrefix) + name + ".bin";
 }
 
+std::string StorageManager::getSpriteAnimationFilename(const std::string& name)
+{
+    return "/" + std::string(spritePrefix) + name + ".bin";
+}
+
 bool StorageManager::updateIndexFile(
     const std::string& indexFile,
     const std::string& name,
@@ -163,9 +180,11 @@ StorageManager::readIndexFile(const std::string& filename)
     return entries;
 }
 
-std::vector<uint8_t> StorageManager::serializeDesign(const Design& design)
+StorageManager::Buffer StorageManager::serializeDesign(const Design& design)
 {
-    std::vector<uint8_t> data(sizeof(BinaryDesign));
+    Buffer data(
+        sizeof(BinaryDesign),
+        BufferAllocator{ HeapStats::AllocTag::Storage });
     BinaryDesign* binary = reinterpret_cast<BinaryDesign*>(data.data());
 
     binary->magic = BinaryDesign::MAGIC;
@@ -186,7 +205,7 @@ std::vector<uint8_t> StorageManager::serializeDesign(const Design& design)
 }
 
 std::optional<StorageManager::Design>
-StorageManager::deserializeDesign(const std::vector<uint8_t>& data)
+StorageManager::deserializeDesign(const Buffer& data)
 {
     if (data.size() != sizeof(BinaryDesign))
     {
@@ -217,13 +236,88 @@ StorageManager::deserializeDesign(const std::vector<uint8_t>& data)
     return design;
 }
 
-std::vector<uint8_t>
-StorageManager::serializeAnimation(const Animation& animation)
+using AnimationFrame = std::array<LedMatrix::RGB, LedMatrix::numPixels>;
+// Stored as RGB bytes, so the frames are written and read in place
+static_assert(sizeof(AnimationFrame) == LedMatrix::numPixels * 3);
+
+/* Streams the (de)serializers go through, a file or a buffer */
+static auto fileWriter(Spiffs::File& file, size_t& written)
+{
+    return [&file, &written](const void* data, size_t size)
+    {
+        written += size;
+        return file.write({ static_cast<const std::byte*>(data), size }).has_value();
+    };
+}
+
+static auto fileReader(Spiffs::File& file)
+{
+    return [&file](void* data, size_t size)
+    { return file.read({ static_cast<std::byte*>(data), size }).has_value(); };
+}
+
+template<typename Write>
+bool StorageManager::writeTimeline(const Timeline& timeline, Write&& write)
+{
+    const BinaryTimeline header{ static_cast<uint8_t>(timeline.mode),
+                                 0,
+                                 timeline.loopStart,
+                                 timeline.loopEnd,
+                                 static_cast<uint16_t>(timeline.entries.size()) };
+    if (!write(&header, sizeof(header)))
+    {
+        return false;
+    }
+    for (const auto& entry: timeline.entries)
+    {
+        const BinaryTimelineEntry binaryEntry{ entry.frame, 0, entry.durationMs };
+        if (!write(&binaryEntry, sizeof(binaryEntry)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Read>
+bool StorageManager::readTimeline(
+    size_t size, size_t numFrames, Timeline& timeline, Read&& read)
 {
-    size_t frameDataSize = LedMatrix::numPixels * 3 * animation.frames.size();
-    std::vector<uint8_t> data(sizeof(BinaryAnimation) + frameDataSize);
-    BinaryAnimation* binary = reinterpret_cast<BinaryAnimation*>(data.data());
+    BinaryTimeline header;
+    if (size < sizeof(header) || !read(&header, sizeof(header))
+        || size != sizeof(header) + header.numEntries * sizeof(BinaryTimelineEntry))
+    {
+        ESP_LOGE(TAG, "Invalid animation data size");
+        return false;
+    }
+
+    timeline.mode = static_cast<Timeline::LoopMode>(header.loopMode);
+    timeline.loopStart = header.loopStart;
+    timeline.loopEnd = header.loopEnd;
+    timeline.entries.reserve(header.numEntries);
+    for (uint16_t i = 0; i < header.numEntries; i++)
+    {
+        BinaryTimelineEntry entry;
+        if (!read(&entry, sizeof(entry)))
+        {
+            return false;
+        }
+        timeline.entries.push_back({ entry.frame, entry.durationMs });
+    }
+    if (header.loopMode > static_cast<uint8_t>(Timeline::LoopMode::Segment)
+        || !timeline.valid(numFrames))
+    {
+        ESP_LOGE(TAG, "Invalid animation timeline");
+        return false;
+    }
+    return true;
+}
 
+template<typename Write>
+bool StorageManager::writeAnimation(const Animation& animation, Write&& write)
+{
+    alignas(BinaryAnimation) uint8_t header[sizeof(BinaryAnimation)]{};
+    auto* binary = reinterpret_cast<BinaryAnimation*>(header);
     binary->magic = BinaryAnimation::MAGIC;
     binary->version = BinaryAnimation::VERSION;
     binary->nameLength = std::min(animation.name.length(), size_t(31));
@@ -231,44 +325,59 @@ StorageManager::serializeAnimation(const Animation& animation)
     binary->name[31] = '\0';
     binary->intervalMs = animation.intervalMs;
     binary->numFrames = animation.frames.size();
+    if (!write(header, offsetof(BinaryAnimation, frames)))
+    {
+        return false;
+    }
 
-    // Copy frame data
-    uint8_t* frameData = binary->frames;
-    for (const auto& frame: animation.frames)
+    // A pool block at a time
+    for (size_t b = 0; b < animation.frames.blockCount(); b++)
     {
-        for (size_t i = 0; i < LedMatrix::numPixels; i++)
+        const auto block = animation.frames.block(b);
+        if (!write(block.data(), block.size_bytes()))
         {
-            frameData[i * 3] = frame[i].r;
-            frameData[i * 3 + 1] = frame[i].g;
-            frameData[i * 3 + 2] = frame[i].b;
+            return false;
         }
-        frameData += LedMatrix::numPixels * 3;
+    }
+    // The header's padding, the frames start before it
+    if (!write(
+            header + offsetof(BinaryAnimation, frames),
+            sizeof(header) - offsetof(BinaryAnimation, frames)))
+    {
+        return false;
     }
 
-    return data;
+    // Timeline after the frames, where version 1 readers stop. Designer
+    // uploads without one show every frame once.
+    if (animation.timeline.entries.empty())
+    {
+        return writeTimeline(
+            Timeline::uniform(animation.frames.size(), animation.intervalMs), write);
+    }
+    return writeTimeline(animation.timeline, write);
 }
 
+template<typename Read>
 std::optional<StorageManager::Animation>
-StorageManager::deserializeAnimation(const std::vector<uint8_t>& data)
+StorageManager::readAnimation(size_t size, Read&& read)
 {
-    if (data.size() < sizeof(BinaryAnimation))
+    alignas(BinaryAnimation) uint8_t header[sizeof(BinaryAnimation)];
+    const auto* binary = reinterpret_cast<const BinaryAnimation*>(header);
+    if (size < sizeof(header) || !read(header, offsetof(BinaryAnimation, frames)))
     {
         ESP_LOGE(TAG, "Invalid animation data size");
         return std::nullopt;
     }
-
-    const BinaryAnimation* binary
-        = reinterpret_cast<const BinaryAnimation*>(data.data());
     if (binary->magic != BinaryAnimation::MAGIC
-        || binary->version != BinaryAnimation::VERSION)
+        || (binary->version != 1 && binary->version != BinaryAnimation::VERSION))
     {
         ESP_LOGE(TAG, "Invalid animation format");
         return std::nullopt;
     }
 
-    size_t expectedSize = sizeof(BinaryAnimation)
-        + (binary->numFrames * LedMatrix::numPixels * 3);
-    if (data.size() != expectedSize)
+    const size_t frameDataSize = binary->numFrames * sizeof(AnimationFrame);
+    if (size < sizeof(header) + frameDataSize
+        || (binary->version == 1 && size != sizeof(header) + frameDataSize))
     {
         ESP_LOGE(TAG, "Invalid animation data size");
         return std::nullopt;
@@ -277,258 +386,1047 @@ StorageManager::deserializeAnimation(const std::vector<uint8_t>& data)
     Animation animation;
     animation.name = std::string(binary->name, binary->nameLength);
     animation.intervalMs = binary->intervalMs;
-
-    const uint8_t* frameData = binary->frames;
-    for (uint16_t f = 0; f < binary->numFrames; f++)
+    if (!animation.frames.resize(binary->numFrames))
     {
-        std::array<LedMatrix::RGB, LedMatrix::numPixels> frame;
-        for (size_t i = 0; i < LedMatrix::numPixels; i++)
+        ESP_LOGE(TAG, "No memory for %u frames", binary->numFrames);
+        return std::nullopt;
+    }
+    for (size_t b = 0; b < animation.frames.blockCount(); b++)
+    {
+        const auto block = animation.frames.block(b);
+        if (!read(block.data(), block.size_bytes()))
         {
-            frame[i] = { frameData[i * 3],
-                         frameData[i * 3 + 1],
-                         frameData[i * 3 + 2] };
+            ESP_LOGE(TAG, "Failed to read animation frames");
+            return std::nullopt;
         }
-        animation.frames.push_back(frame);
-        frameData += LedMatrix::numPixels * 3;
+    }
+    if (!read(
+            header + offsetof(BinaryAnimation, frames),
+            sizeof(header) - offsetof(BinaryAnimation, frames)))
+    {
+        ESP_LOGE(TAG, "Invalid animation data size");
+        return std::nullopt;
     }
 
+    if (binary->version == 1)
+    {
+        // Version 1 stored held frames as copies
+        animation.timeline
+            = Timeline::uniform(animation.frames.size(), animation.intervalMs);
+        deduplicate(animation.frames, animation.timeline);
+        return animation;
+    }
+    if (!readTimeline(
+            size - sizeof(header) - frameDataSize,
+            animation.frames.size(),
+            animation.timeline,
+            read))
+    {
+        return std::nullopt;
+    }
     return animation;
 }
 
-bool StorageManager::writeBinaryToFile(
-    const std::string& filename, const std::vector<uint8_t>& data)
+StorageManager::Buffer
+StorageManager::serializeAnimation(const Animation& animation)
 {
-    ESP_LOGI(TAG, "Writing binary data to file: %s", filename.c_str());
-    std::span<const std::byte> dataSpan{
-        reinterpret_cast<const std::byte*>(data.data()), data.size()
-    };
-    auto result = spiffs_.write(filename, dataSpan);
-    return result.has_value();
+    Buffer data(BufferAllocator{ HeapStats::AllocTag::Storage });
+    writeAnimation(
+        animation,
+        [&data](const void* bytes, size_t size)
+        {
+            const auto* in = static_cast<const uint8_t*>(bytes);
+            data.insert(data.end(), in, in + size);
+            return true;
+        });
+    return data;
 }
 
-std::optional<std::vector<uint8_t>> StorageManager::readBinaryFromFile(
-    const std::string& filename, const size_t readBufferSize)
+std::optional<StorageManager::Animation>
+StorageManager::deserializeAnimation(const Buffer& data)
 {
-    ESP_LOGI(TAG, "Reading binary data from file: %s", filename.c_str());
-    std::vector<std::byte> buffer(readBufferSize);
-    auto result = spiffs_.read(filename, buffer);
-    if (!result)
-    {
-        ESP_LOGE(TAG, "Failed to read file: %s", filename.c_str());
-        return std::nullopt;
-    }
-    return std::vector<uint8_t>(
-        reinterpret_cast<uint8_t*>(buffer.data()),
-        reinterpret_cast<uint8_t*>(buffer.data()) + *result);
+    size_t pos = 0;
+    return readAnimation(
+        data.size(),
+        [&data, &pos](void* bytes, size_t size)
+        {
+            if (data.size() - pos < size)
+            {
+                return false;
+            }
+            std::memcpy(bytes, data.data() + pos, size);
+            pos += size;
+            return true;
+        });
 }
 
-bool StorageManager::saveDesign(const Design& design)
+/* The tile's part of the canvas frame at offset in file. Only the rows of
+   the tile are read, a piece at a time. */
+static bool readTile(
+    Spiffs::File& file, const VirtualCanvas& tile, size_t offset, AnimationFrame& frame)
 {
-    ESP_LOGI(TAG, "Saving design: %s", design.name.c_str());
-
-    auto data = serializeDesign(design);
-    std::string filename = getDesignFilename(design.name);
-    bool result = writeBinaryToFile(filename, data);
-
-    if (result)
+    std::array<uint8_t, 512> chunk;
+    const std::span<uint8_t> out{ reinterpret_cast<uint8_t*>(frame.data()), sizeof(frame) };
+    std::fill(out.begin(), out.end(), 0);
+    if (!file.seek(offset + tile.firstChannel()))
     {
-        result = updateIndexFile(
-            designsIndexFile, design.name, filename, data.size());
+        return false;
     }
-
-    return result;
+    for (size_t at = tile.firstChannel(); at < tile.endChannel();)
+    {
+        const size_t size = std::min(chunk.size(), tile.endChannel() - at);
+        if (!file.read(std::as_writable_bytes(std::span{ chunk.data(), size })))
+        {
+            return false;
+        }
+        tile.crop(at, { chunk.data(), size }, out);
+        at += size;
+    }
+    return true;
 }
 
-std::optional<StorageManager::Design>
-StorageManager::loadDesign(const std::string& name)
+std::optional<StorageManager::Animation> StorageManager::readCanvasAnimation(
+    Spiffs::File& file, size_t size, const VirtualCanvas& canvas)
 {
-    ESP_LOGI(TAG, "Loading design: %s", name.c_str());
-
-    auto entries = readIndexFile(designsIndexFile);
-    auto it = entries.find(name);
-    if (it == entries.end())
+    alignas(BinaryCanvasAnimation) uint8_t header[sizeof(BinaryCanvasAnimation)];
+    const auto* binary = reinterpret_cast<const BinaryCanvasAnimation*>(header);
+    if (size < sizeof(header)
+        || !file.read(std::as_writable_bytes(
+            std::span{ header, offsetof(BinaryCanvasAnimation, frames) })))
+    {
+        ESP_LOGE(TAG, "Invalid canvas animation data size");
         return std::nullopt;
-
-    auto data = readBinaryFromFile(it->second.filename, it->second.size);
-    if (!data)
+    }
+    if (binary->magic != BinaryCanvasAnimation::MAGIC
+        || binary->version != BinaryCanvasAnimation::VERSION)
+    {
+        ESP_LOGE(TAG, "Invalid canvas animation format");
         return std::nullopt;
-
-    return deserializeDesign(*data);
-}
-
-bool StorageManager::deleteDesign(const std::string& name)
-{
-    ESP_LOGI(TAG, "Deleting design: %s", name.c_str());
-
-    auto entries = readIndexFile(designsIndexFile);
-    auto it = entries.find(name);
-    if (it == entries.end())
-        return false;
-
-    // Check if this was the last used design
-    auto lastUsed = loadLastUsed();
-    if (lastUsed && !lastUsed->second && lastUsed->first == name) {
-        // This was the last used design, clear the last used state
-        spiffs_.remove(lastUsedFile);
     }
 
-    // Delete the design file
-    if (!spiffs_.remove(it->second.filename).has_value())
+    // The tile where this device has it, on the canvas the frames are of
+    VirtualCanvas tile = canvas;
+    tile.width = binary->width;
+    tile.height = binary->height;
+    if (!tile.valid())
     {
         ESP_LOGE(
             TAG,
-            "Failed to delete design file: %s",
-            it->second.filename.c_str());
-        return false;
+            "Tile at %u,%u is not on the %ux%u canvas",
+            tile.tileX,
+            tile.tileY,
+            tile.width,
+            tile.height);
+        return std::nullopt;
     }
 
-    // Update index file
-    return removeFromIndexFile(designsIndexFile, name);
-}
+    const size_t frameDataSize = binary->numFrames * tile.channels();
+    if (size < sizeof(header) + frameDataSize)
+    {
+        ESP_LOGE(TAG, "Invalid canvas animation data size");
+        return std::nullopt;
+    }
 
-std::vector<std::string> StorageManager::listDesigns()
-{
-    ESP_LOGI(TAG, "Listing designs");
-    std::vector<std::string> result;
+    Animation animation;
+    animation.name = std::string(binary->name, binary->nameLength);
+    animation.intervalMs = binary->intervalMs;
+    if (!animation.frames.resize(binary->numFrames))
+    {
+        ESP_LOGE(TAG, "No memory for %u frames", binary->numFrames);
+        return std::nullopt;
+    }
+    for (uint16_t f = 0; f < binary->numFrames; f++)
+    {
+        const size_t offset = offsetof(BinaryCanvasAnimation, frames) + f * tile.channels();
+        if (!readTile(file, tile, offset, animation.frames[f]))
+        {
+            ESP_LOGE(TAG, "Failed to read canvas animation frames");
+            return std::nullopt;
+        }
+    }
 
-    auto entries = readIndexFile(designsIndexFile);
-    for (const auto& [name, _]: entries)
+    if (!file.seek(sizeof(header) + frameDataSize)
+        || !readTimeline(
+            size - sizeof(header) - frameDataSize,
+            animation.frames.size(),
+            animation.timeline,
+            fileReader(file)))
     {
-        result.push_back(name);
+        return std::nullopt;
     }
 
-    return result;
+    // Canvas frames that differ elsewhere can be the same on this tile
+    deduplicate(animation.frames, animation.timeline);
+    return animation;
 }
 
-bool StorageManager::saveAnimation(const Animation& animation)
+StorageManager::CanvasAnimationWriter::CanvasAnimationWriter(
+    StorageManager& storage, const std::string& name, uint16_t width, uint16_t height)
+    : storage_{ storage }
+    , name_{ name }
+    , width_{ width }
+    , height_{ height }
 {
-    ESP_LOGI(TAG, "Saving animation: %s", animation.name.c_str());
+    Lock lock{ storage_.lock_ };
+    ESP_LOGI(TAG, "Saving %ux%u canvas animation: %s", width, height, name.c_str());
 
-    auto data = serializeAnimation(animation);
-    std::string filename = getAnimationFilename(animation.name);
-    bool result = writeBinaryToFile(filename, data);
-
-    if (result)
+    auto file = storage_.spiffs_.open(canvasUploadFile, Spiffs::Mode::Write);
+    if (!file)
     {
-        result = updateIndexFile(
-            animationsIndexFile, animation.name, filename, data.size());
+        ESP_LOGE(TAG, "Failed to open %s", canvasUploadFile);
+        return;
     }
+    file_ = std::move(*file);
 
-    return result;
+    // Rewritten with the frame count by finish()
+    alignas(BinaryCanvasAnimation) uint8_t header[sizeof(BinaryCanvasAnimation)]{};
+    if (!file_->write(std::as_bytes(
+            std::span{ header, offsetof(BinaryCanvasAnimation, frames) })))
+    {
+        file_.reset();
+    }
+    size_ = offsetof(BinaryCanvasAnimation, frames);
 }
 
-std::optional<StorageManager::Animation>
-StorageManager::loadAnimation(const std::string& name)
+StorageManager::CanvasAnimationWriter::~CanvasAnimationWriter()
 {
-    ESP_LOGI(TAG, "Loading animation: %s", name.c_str());
-
-    auto entries = readIndexFile(animationsIndexFile);
-    auto it = entries.find(name);
-    if (it == entries.end())
-        return std::nullopt;
-
-    auto data = readBinaryFromFile(it->second.filename, it->second.size);
-    if (!data)
-        return std::nullopt;
-
-    return deserializeAnimation(*data);
+    Lock lock{ storage_.lock_ };
+    if (!finished_)
+    {
+        file_.reset();
+        storage_.spiffs_.remove(canvasUploadFile);
+    }
 }
 
-bool StorageManager::deleteAnimation(const std::string& name)
+bool StorageManager::CanvasAnimationWriter::addFrame(std::span<const uint8_t> frame)
 {
-    ESP_LOGI(TAG, "Deleting animation: %s", name.c_str());
-
-    auto entries = readIndexFile(animationsIndexFile);
-    auto it = entries.find(name);
-    if (it == entries.end())
-        return false;
-
-    // Check if this was the last used animation
-    auto lastUsed = loadLastUsed();
-    if (lastUsed && lastUsed->second && lastUsed->first == name) {
-        // This was the last used animation, clear the last used state
-        spiffs_.remove(lastUsedFile);
-    }
-
-    // Delete the animation file
-    if (!spiffs_.remove(it->second.filename).has_value())
+    Lock lock{ storage_.lock_ };
+    if (!file_ || frame.size() != size_t{ width_ } * height_ * 3 || frames_ == UINT16_MAX
+        || !file_->write(std::as_bytes(frame)))
     {
-        ESP_LOGE(
-            TAG,
-            "Failed to delete animation file: %s",
-            it->second.filename.c_str());
+        ESP_LOGE(TAG, "Failed to add frame %u", static_cast<unsigned>(frames_));
+        file_.reset();
         return false;
     }
-
-    // Update index file
-    return removeFromIndexFile(animationsIndexFile, name);
+    size_ += frame.size();
+    ++frames_;
+    return true;
 }
 
-std::vector<std::string> StorageManager::listAnimations()
+bool StorageManager::CanvasAnimationWriter::finish(int intervalMs, const Timeline& timeline)
 {
-    ESP_LOGI(TAG, "Listing animations");
-    std::vector<std::string> result;
-
-    auto entries = readIndexFile(animationsIndexFile);
-    for (const auto& [name, _]: entries)
+    Lock lock{ storage_.lock_ };
+    if (!file_ || frames_ == 0)
     {
-        result.push_back(name);
+        return false;
     }
 
+    alignas(BinaryCanvasAnimation) uint8_t header[sizeof(BinaryCanvasAnimation)]{};
+    auto* binary = reinterpret_cast<BinaryCanvasAnimation*>(header);
+    binary->magic = BinaryCanvasAnimation::MAGIC;
+    binary->version = BinaryCanvasAnimation::VERSION;
+    binary->nameLength = std::min(name_.length(), size_t(31));
+    strncpy(binary->name, name_.c_str(), 31);
+    binary->name[31] = '\0';
+    binary->intervalMs = intervalMs;
+    binary->numFrames = frames_;
+    binary->width = width_;
+    binary->height = height_;
+
+    // The header's padding and the timeline follow the frames
+    auto write = fileWriter(*file_, size_);
+    bool result = write(
+                      header + offsetof(BinaryCanvasAnimation, frames),
+                      sizeof(header) - offsetof(BinaryCanvasAnimation, frames))
+        && writeTimeline(
+                      timeline.entries.empty() ? Timeline::uniform(frames_, intervalMs)
+                                               : timeline,
+                      write)
+        && file_->seek(0)
+        && file_->write(std::as_bytes(
+            std::span{ header, offsetof(BinaryCanvasAnimation, frames) }))
+        && file_->close();
+    file_.reset();
+
+    const std::string filename = storage_.getAnimationFilename(name_);
+    result = result && storage_.spiffs_.rename(canvasUploadFile, filename)
+        && storage_.updateIndexFile(animationsIndexFile, name_, filename, size_);
+    finished_ = result;
+    if (result)
+    {
+        storage_.refreshBootFrame(name_, true);
+    }
     return result;
 }
 
-bool StorageManager::clearStorage()
+StorageManager::Buffer
+StorageManager::serializeSpriteAnimation(const SpriteAnimation& animation)
 {
-    ESP_LOGI(TAG, "Clearing storage");
-
-    // Delete all files in designs directory
-    auto designs = listDesigns();
-    for (const auto& name: designs)
+    using Sprites = SpriteFrames<LedMatrix>;
+    const Sprites& frames = animation.frames;
+    const bool uniform = animation.timeline.entries.empty();
+    const Timeline fallback = uniform
+        ? Timeline::uniform(frames.size(), animation.intervalMs)
+        : Timeline{};
+    const Timeline& written = uniform ? fallback : animation.timeline;
+
+    Buffer data(
+        sizeof(BinarySpriteAnimation),
+        BufferAllocator{ HeapStats::AllocTag::Storage });
+    auto* binary = reinterpret_cast<BinarySpriteAnimation*>(data.data());
+    binary->magic = BinarySpriteAnimation::MAGIC;
+    binary->version = BinarySpriteAnimation::VERSION;
+    binary->nameLength = std::min(animation.name.length(), size_t(31));
+    strncpy(binary->name, animation.name.c_str(), 31);
+    binary->name[31] = '\0';
+    binary->intervalMs = animation.intervalMs;
+    binary->numSprites = frames.spriteCount();
+    binary->numFrames = frames.size();
+    for (size_t i = 0; i < LedMatrix::numPixels; i++)
     {
-        if (!deleteDesign(name))
-        {
-            ESP_LOGE(TAG, "Failed to delete design: %s", name.c_str());
-            return false;
-        }
+        binary->background[i * 3] = frames.background()[i].r;
+        binary->background[i * 3 + 1] = frames.background()[i].g;
+        binary->background[i * 3 + 2] = frames.background()[i].b;
+    }
+
+    // binary is not valid past here, appending may move the data
+    auto append = [&data](const void* bytes, size_t size)
+    {
+        const auto* in = static_cast<const uint8_t*>(bytes);
+        data.insert(data.end(), in, in + size);
+    };
+    for (size_t s = 0; s < frames.spriteCount(); s++)
+    {
+        const Sprites::Sprite& sprite = frames.sprite(s);
+        const uint8_t size[2] = { sprite.width, sprite.height };
+        append(size, sizeof(size));
+        for (const auto& pixel: sprite.pixels)
+        {
+            const uint8_t rgb[3] = { pixel.r, pixel.g, pixel.b };
+            append(rgb, sizeof(rgb));
+        }
+        for (size_t i = 0; i < sprite.opaque.size(); i += 8)
+        {
+            uint8_t bits = 0;
+            for (size_t b = 0; b < 8 && i + b < sprite.opaque.size(); b++)
+            {
+                bits |= (sprite.opaque[i + b] ? 1 : 0) << b;
+            }
+            append(&bits, 1);
+        }
+    }
+    for (size_t f = 0; f < frames.size(); f++)
+    {
+        const uint16_t count = frames.placements(f).size();
+        append(&count, sizeof(count));
+    }
+    for (size_t f = 0; f < frames.size(); f++)
+    {
+        for (const auto& placement: frames.placements(f))
+        {
+            const uint8_t bytes[4] = { placement.sprite,
+                                       static_cast<uint8_t>(placement.x),
+                                       static_cast<uint8_t>(placement.y),
+                                       placement.flags };
+            append(bytes, sizeof(bytes));
+        }
+    }
+
+    const BinaryTimeline timeline{ static_cast<uint8_t>(written.mode),
+                                   0,
+                                   written.loopStart,
+                                   written.loopEnd,
+                                   static_cast<uint16_t>(written.entries.size()) };
+    append(&timeline, sizeof(timeline));
+    for (const auto& entry: written.entries)
+    {
+        const BinaryTimelineEntry binaryEntry{ entry.frame, 0, entry.durationMs };
+        append(&binaryEntry, sizeof(binaryEntry));
+    }
+    return data;
+}
+
+std::optional<StorageManager::SpriteAnimation>
+StorageManager::deserializeSpriteAnimation(const Buffer& data)
+{
+    using Sprites = SpriteFrames<LedMatrix>;
+    auto invalid = []
+    {
+        ESP_LOGE(TAG, "Invalid sprite animation data");
+        return std::nullopt;
+    };
+    if (data.size() < sizeof(BinarySpriteAnimation))
+    {
+        return invalid();
+    }
+    const auto* binary = reinterpret_cast<const BinarySpriteAnimation*>(data.data());
+    if (binary->magic != BinarySpriteAnimation::MAGIC
+        || binary->version != BinarySpriteAnimation::VERSION)
+    {
+        ESP_LOGE(TAG, "Invalid sprite animation format");
+        return std::nullopt;
+    }
+
+    // The variable part is read byte by byte, it has no alignment
+    size_t pos = sizeof(BinarySpriteAnimation);
+    auto take = [&data, &pos](size_t size) -> const uint8_t*
+    {
+        if (data.size() - pos < size)
+        {
+            return nullptr;
+        }
+        const uint8_t* at = data.data() + pos;
+        pos += size;
+        return at;
+    };
+
+    Sprites::Frame background;
+    for (size_t i = 0; i < LedMatrix::numPixels; i++)
+    {
+        background[i] = { binary->background[i * 3],
+                          binary->background[i * 3 + 1],
+                          binary->background[i * 3 + 2] };
+    }
+    SpriteAnimation animation{ std::string(binary->name, binary->nameLength),
+                               static_cast<int>(binary->intervalMs),
+                               Sprites{ background },
+                               {} };
+
+    for (uint16_t s = 0; s < binary->numSprites; s++)
+    {
+        const uint8_t* size = take(2);
+        const size_t count = size ? size_t{ size[0] } * size[1] : 0;
+        const uint8_t* rgb = take(count * 3);
+        const uint8_t* bits = take((count + 7) / 8);
+        if (!size || !rgb || !bits)
+        {
+            return invalid();
+        }
+        Sprites::Sprite sprite;
+        sprite.width = size[0];
+        sprite.height = size[1];
+        sprite.pixels.reserve(count);
+        sprite.opaque.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            sprite.pixels.push_back({ rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2] });
+            sprite.opaque.push_back((bits[i / 8] >> (i % 8)) & 1);
+        }
+        if (!animation.frames.addSprite(std::move(sprite)))
+        {
+            return invalid();
+        }
+    }
+
+    const uint8_t* counts = take(binary->numFrames * sizeof(uint16_t));
+    if (!counts)
+    {
+        return invalid();
+    }
+    std::vector<Sprites::Placement> placements;
+    for (uint16_t f = 0; f < binary->numFrames; f++)
+    {
+        uint16_t count;
+        memcpy(&count, counts + f * sizeof(count), sizeof(count));
+        const uint8_t* in = take(count * 4);
+        if (!in)
+        {
+            return invalid();
+        }
+        placements.clear();
+        for (uint16_t i = 0; i < count; i++, in += 4)
+        {
+            placements.push_back({ in[0],
+                                   static_cast<int8_t>(in[1]),
+                                   static_cast<int8_t>(in[2]),
+                                   in[3] });
+        }
+        if (!animation.frames.addFrame(placements))
+        {
+            return invalid();
+        }
+    }
+
+    BinaryTimeline timeline;
+    const uint8_t* in = take(sizeof(timeline));
+    if (!in)
+    {
+        return invalid();
+    }
+    memcpy(&timeline, in, sizeof(timeline));
+    animation.timeline.mode = static_cast<Timeline::LoopMode>(timeline.loopMode);
+    animation.timeline.loopStart = timeline.loopStart;
+    animation.timeline.loopEnd = timeline.loopEnd;
+    animation.timeline.entries.reserve(timeline.numEntries);
+    for (uint16_t i = 0; i < timeline.numEntries; i++)
+    {
+        BinaryTimelineEntry entry;
+        in = take(sizeof(entry));
+        if (!in)
+        {
+            return invalid();
+        }
+        memcpy(&entry, in, sizeof(entry));
+        animation.timeline.entries.push_back({ entry.frame, entry.durationMs });
+    }
+    if (pos != data.size()
+        || timeline.loopMode > static_cast<uint8_t>(Timeline::LoopMode::Segment)
+        || !animation.timeline.valid(animation.frames.size()))
+    {
+        return invalid();
+    }
+    return animation;
+}
+
+std::optional<StorageManager::Buffer>
+StorageManager::serializeBootFrame(const BootFrame& bootFrame)
+{
+    if (bootFrame.name.length() > BinaryBootFrame::maxNameLength)
+    {
+        return std::nullopt;
+    }
+    Buffer data(
+        sizeof(BinaryBootFrame) + bootFrame.name.length(),
+        BufferAllocator{ HeapStats::AllocTag::Storage });
+    BinaryBootFrame* binary = reinterpret_cast<BinaryBootFrame*>(data.data());
+
+    binary->magic = BinaryBootFrame::MAGIC;
+    binary->version = BinaryBootFrame::VERSION;
+    binary->isAnimation = bootFrame.isAnimation ? 1 : 0;
+    binary->nameLength = static_cast<uint8_t>(bootFrame.name.length());
+    std::memcpy(
+        data.data() + sizeof(BinaryBootFrame), bootFrame.name.data(), bootFrame.name.length());
+
+    // Copy RGB values directly
+    for (size_t i = 0; i < LedMatrix::numPixels; i++)
+    {
+        binary->pixels[i * 3] = bootFrame.pixels[i].r;
+        binary->pixels[i * 3 + 1] = bootFrame.pixels[i].g;
+        binary->pixels[i * 3 + 2] = bootFrame.pixels[i].b;
+    }
+
+    return data;
+}
+
+std::optional<StorageManager::BootFrame>
+StorageManager::deserializeBootFrame(const Buffer& data)
+{
+    if (data.size() < sizeof(BinaryBootFrame))
+    {
+        ESP_LOGE(TAG, "Invalid boot frame data size");
+        return std::nullopt;
+    }
+
+    const BinaryBootFrame* binary
+        = reinterpret_cast<const BinaryBootFrame*>(data.data());
+    if (binary->magic != BinaryBootFrame::MAGIC
+        || binary->version != BinaryBootFrame::VERSION
+        || data.size() != sizeof(BinaryBootFrame) + binary->nameLength)
+    {
+        ESP_LOGE(TAG, "Invalid boot frame format");
+        return std::nullopt;
+    }
+
+    BootFrame bootFrame;
+    bootFrame.name = std::string(
+        reinterpret_cast<const char*>(data.data() + sizeof(BinaryBootFrame)),
+        binary->nameLength);
+    bootFrame.isAnimation = binary->isAnimation != 0;
+
+    // Copy RGB values directly
+    for (size_t i = 0; i < LedMatrix::numPixels; i++)
+    {
+        bootFrame.pixels[i] = { binary->pixels[i * 3],
+                                binary->pixels[i * 3 + 1],
+                                binary->pixels[i * 3 + 2] };
+    }
+
+    return bootFrame;
+}
+
+std::optional<std::array<LedMatrix::RGB, LedMatrix::numPixels>>
+StorageManager::loadFirstFrame(const std::string& name, bool isAnimation)
+{
+    if (!isAnimation)
+    {
+        auto design = loadDesign(name);
+        if (!design)
+            return std::nullopt;
+        return design->pixels;
+    }
+
+    auto entries = readIndexFile(animationsIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return std::nullopt;
+
+    // Only the header and the first frame are needed
+    auto data = readBinaryFromFile(
+        it->second.filename,
+        sizeof(BinaryAnimation) + LedMatrix::numPixels * 3);
+
+    // Of a canvas animation, the header and the tile's rows of its first
+    // frame
+    if (data && data->size() >= sizeof(BinaryCanvasAnimation)
+        && (*data)[0] == BinaryCanvasAnimation::MAGIC)
+    {
+        const auto* header = reinterpret_cast<const BinaryCanvasAnimation*>(data->data());
+        VirtualCanvas tile = canvas_;
+        tile.width = header->width;
+        tile.height = header->height;
+        if (header->version != BinaryCanvasAnimation::VERSION || header->numFrames == 0
+            || !tile.valid())
+        {
+            ESP_LOGE(TAG, "Invalid canvas animation format");
+            return std::nullopt;
+        }
+        auto file = spiffs_.open(it->second.filename, Spiffs::Mode::Read);
+        AnimationFrame frame;
+        if (!file
+            || !readTile(*file, tile, offsetof(BinaryCanvasAnimation, frames), frame))
+            return std::nullopt;
+        return frame;
+    }
+    if (!data
+        || data->size() != sizeof(BinaryAnimation) + LedMatrix::numPixels * 3)
+        return std::nullopt;
+
+    const BinaryAnimation* binary
+        = reinterpret_cast<const BinaryAnimation*>(data->data());
+    // The first frame is the first one shown in both versions
+    if (binary->magic != BinaryAnimation::MAGIC
+        || (binary->version != 1 && binary->version != BinaryAnimation::VERSION)
+        || binary->numFrames == 0)
+    {
+        ESP_LOGE(TAG, "Invalid animation format");
+        return std::nullopt;
+    }
+
+    std::array<LedMatrix::RGB, LedMatrix::numPixels> frame;
+    for (size_t i = 0; i < LedMatrix::numPixels; i++)
+    {
+        frame[i] = { binary->frames[i * 3],
+                     binary->frames[i * 3 + 1],
+                     binary->frames[i * 3 + 2] };
+    }
+    return frame;
+}
+
+bool StorageManager::writeBinaryToFile(
+    const std::string& filename, const Buffer& data)
+{
+    ESP_LOGI(TAG, "Writing binary data to file: %s", filename.c_str());
+    std::span<const std::byte> dataSpan{
+        reinterpret_cast<const std::byte*>(data.data()), data.size()
+    };
+    auto result = spiffs_.write(filename, dataSpan);
+    return result.has_value();
+}
+
+std::optional<StorageManager::Buffer> StorageManager::readBinaryFromFile(
+    const std::string& filename, const size_t readBufferSize)
+{
+    ESP_LOGI(TAG, "Reading binary data from file: %s", filename.c_str());
+    Buffer data(readBufferSize, BufferAllocator{ HeapStats::AllocTag::Storage });
+    auto result = spiffs_.read(filename, std::as_writable_bytes(std::span{ data }));
+    if (!result)
+    {
+        ESP_LOGE(TAG, "Failed to read file: %s", filename.c_str());
+        return std::nullopt;
+    }
+    data.resize(*result);
+    return data;
+}
+
+bool StorageManager::saveDesign(const Design& design)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving design: %s", design.name.c_str());
+
+    auto data = serializeDesign(design);
+    std::string filename = getDesignFilename(design.name);
+    bool result = writeBinaryToFile(filename, data);
+
+    if (result)
+    {
+        result = updateIndexFile(
+            designsIndexFile, design.name, filename, data.size());
+    }
+    if (result)
+    {
+        refreshBootFrame(design.name, false);
+    }
+
+    return result;
+}
+
+std::optional<StorageManager::Design>
+StorageManager::loadDesign(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading design: %s", name.c_str());
+
+    auto entries = readIndexFile(designsIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return std::nullopt;
+
+    auto data = readBinaryFromFile(it->second.filename, it->second.size);
+    if (!data)
+        return std::nullopt;
+
+    return deserializeDesign(*data);
+}
+
+bool StorageManager::deleteDesign(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Deleting design: %s", name.c_str());
+
+    auto entries = readIndexFile(designsIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return false;
+
+    // Check if this was the last used design
+    auto lastUsed = loadLastUsed();
+    if (lastUsed && !lastUsed->second && lastUsed->first == name) {
+        // This was the last used design, clear the last used state
+        spiffs_.remove(lastUsedFile);
+        spiffs_.remove(bootFrameFile);
+    }
+
+    // Delete the design file
+    if (!spiffs_.remove(it->second.filename).has_value())
+    {
+        ESP_LOGE(
+            TAG,
+            "Failed to delete design file: %s",
+            it->second.filename.c_str());
+        return false;
+    }
+
+    // Update index file
+    return removeFromIndexFile(designsIndexFile, name);
+}
+
+std::vector<std::string> StorageManager::listDesigns()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Listing designs");
+    std::vector<std::string> result;
+
+    auto entries = readIndexFile(designsIndexFile);
+    for (const auto& [name, _]: entries)
+    {
+        result.push_back(name);
+    }
+
+    return result;
+}
+
+bool StorageManager::saveAnimation(const Animation& animation)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving animation: %s", animation.name.c_str());
+
+    // Written a pool block at a time, never as one buffer
+    std::string filename = getAnimationFilename(animation.name);
+    auto file = spiffs_.open(filename, Spiffs::Mode::Write);
+    size_t size = 0;
+    bool result = file.has_value() && writeAnimation(animation, fileWriter(*file, size))
+        && file->close().has_value();
+    if (!result)
+    {
+        ESP_LOGE(TAG, "Failed to write animation file: %s", filename.c_str());
+        return false;
+    }
+
+    if (!updateIndexFile(animationsIndexFile, animation.name, filename, size))
+    {
+        return false;
+    }
+    refreshBootFrame(animation.name, true);
+    return true;
+}
+
+std::optional<StorageManager::Animation>
+StorageManager::loadAnimation(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading animation: %s", name.c_str());
+
+    auto entries = readIndexFile(animationsIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return std::nullopt;
+
+    auto file = spiffs_.open(it->second.filename, Spiffs::Mode::Read);
+    uint8_t magic = 0;
+    if (!file || !file->read(std::as_writable_bytes(std::span{ &magic, 1 }))
+        || !file->seek(0))
+    {
+        ESP_LOGE(TAG, "Failed to read file: %s", it->second.filename.c_str());
+        return std::nullopt;
+    }
+
+    if (magic == BinaryCanvasAnimation::MAGIC)
+    {
+        return readCanvasAnimation(*file, it->second.size, canvas_);
+    }
+    // Read straight into the frame pool blocks
+    return readAnimation(it->second.size, fileReader(*file));
+}
+
+bool StorageManager::deleteAnimation(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Deleting animation: %s", name.c_str());
+
+    auto entries = readIndexFile(animationsIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return false;
+
+    // Check if this was the last used animation
+    auto lastUsed = loadLastUsed();
+    if (lastUsed && lastUsed->second && lastUsed->first == name) {
+        // This was the last used animation, clear the last used state
+        spiffs_.remove(lastUsedFile);
+        spiffs_.remove(bootFrameFile);
+    }
+
+    // Delete the animation file
+    if (!spiffs_.remove(it->second.filename).has_value())
+    {
+        ESP_LOGE(
+            TAG,
+            "Failed to delete animation file: %s",
+            it->second.filename.c_str());
+        return false;
+    }
+
+    // Update index file
+    return removeFromIndexFile(animationsIndexFile, name);
+}
+
+std::vector<std::string> StorageManager::listAnimations()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Listing animations");
+    std::vector<std::string> result;
+
+    auto entries = readIndexFile(animationsIndexFile);
+    for (const auto& [name, _]: entries)
+    {
+        result.push_back(name);
+    }
+
+    return result;
+}
+
+bool StorageManager::saveSpriteAnimation(const SpriteAnimation& animation)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving sprite animation: %s", animation.name.c_str());
+
+    auto data = serializeSpriteAnimation(animation);
+    std::string filename = getSpriteAnimationFilename(animation.name);
+    bool result = writeBinaryToFile(filename, data);
+
+    if (result)
+    {
+        result = updateIndexFile(
+            spritesIndexFile, animation.name, filename, data.size());
+    }
+
+    return result;
+}
+
+std::optional<StorageManager::SpriteAnimation>
+StorageManager::loadSpriteAnimation(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading sprite animation: %s", name.c_str());
+
+    auto entries = readIndexFile(spritesIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return std::nullopt;
+
+    auto data = readBinaryFromFile(it->second.filename, it->second.size);
+    if (!data)
+        return std::nullopt;
+
+    return deserializeSpriteAnimation(*data);
+}
+
+bool StorageManager::deleteSpriteAnimation(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Deleting sprite animation: %s", name.c_str());
+
+    auto entries = readIndexFile(spritesIndexFile);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return false;
+
+    if (!spiffs_.remove(it->second.filename).has_value())
+    {
+        ESP_LOGE(
+            TAG,
+            "Failed to delete sprite animation file: %s",
+            it->second.filename.c_str());
+        return false;
+    }
+
+    return removeFromIndexFile(spritesIndexFile, name);
+}
+
+std::vector<std::string> StorageManager::listSpriteAnimations()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Listing sprite animations");
+    std::vector<std::string> result;
+
+    auto entries = readIndexFile(spritesIndexFile);
+    for (const auto& [name, _]: entries)
+    {
+        result.push_back(name);
+    }
+
+    return result;
+}
+
+bool StorageManager::clearStorage()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Clearing storage");
+
+    // Delete all files in designs directory
+    auto designs = listDesigns();
+    for (const auto& name: designs)
+    {
+        if (!deleteDesign(name))
+        {
+            ESP_LOGE(TAG, "Failed to delete design: %s", name.c_str());
+            return false;
+        }
     }
 
     // Delete all files in animations directory
     auto animations = listAnimations();
     for (const auto& name: animations)
     {
-        if (!deleteAnimation(name))
-        {
-            ESP_LOGE(TAG, "Failed to delete animation: %s", name.c_str());
-            return false;
-        }
+        if (!deleteAnimation(name))
+        {
+            ESP_LOGE(TAG, "Failed to delete animation: %s", name.c_str());
+            return false;
+        }
+    }
+
+    auto spriteAnimations = listSpriteAnimations();
+    for (const auto& name: spriteAnimations)
+    {
+        if (!deleteSpriteAnimation(name))
+        {
+            ESP_LOGE(TAG, "Failed to delete sprite animation: %s", name.c_str());
+            return false;
+        }
+    }
+
+    // Delete last used, boot frame, playlist, clock, effect, message and
+    // shader files
+    spiffs_.remove(lastUsedFile);
+    spiffs_.remove(bootFrameFile);
+    spiffs_.remove(playlistFile);
+    spiffs_.remove(clockFile);
+    spiffs_.remove(effectsFile);
+    spiffs_.remove(messagesFile);
+    spiffs_.remove(shadersFile);
+
+    // Reinitialize storage
+    return init();
+}
+
+bool StorageManager::saveLastUsed(const std::string& name, bool isAnimation)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving last used: %s (isAnimation: %d)", name.c_str(), isAnimation);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "name", name.c_str());
+    cJSON_AddBoolToObject(root, "isAnimation", isAnimation);
+
+    char* json = cJSON_PrintUnformatted(root);
+    bool result = writeJsonToFile(lastUsedFile, json);
+    cJSON_free(json);
+    cJSON_Delete(root);
+    if (!result)
+    {
+        return false;
+    }
+
+    writeBootFrame(name, isAnimation);
+    return true;
+}
+
+void StorageManager::writeBootFrame(const std::string& name, bool isAnimation)
+{
+    // Precompute the boot frame, so the display can be restored at boot
+    // without parsing any JSON
+    auto firstFrame = loadFirstFrame(name, isAnimation);
+    if (!firstFrame)
+    {
+        ESP_LOGW(TAG, "Failed to load first frame of: %s", name.c_str());
+        spiffs_.remove(bootFrameFile);
+        return;
+    }
+    auto data = serializeBootFrame({ name, isAnimation, *firstFrame });
+    if (!data)
+    {
+        // Restored from the last used record at boot instead
+        ESP_LOGW(TAG, "Name too long for a boot frame: %s", name.c_str());
+        spiffs_.remove(bootFrameFile);
+        return;
     }
+    if (!writeBinaryToFile(bootFrameFile, *data))
+    {
+        ESP_LOGW(TAG, "Failed to write boot frame");
+    }
+}
 
-    // Delete last used file
-    spiffs_.remove(lastUsedFile);
-
-    // Reinitialize storage
-    return init();
+void StorageManager::refreshBootFrame(const std::string& name, bool isAnimation)
+{
+    auto lastUsed = loadLastUsed();
+    if (lastUsed && lastUsed->first == name && lastUsed->second == isAnimation)
+    {
+        writeBootFrame(name, isAnimation);
+    }
 }
 
-bool StorageManager::saveLastUsed(const std::string& name, bool isAnimation)
+std::optional<StorageManager::BootFrame> StorageManager::loadBootFrame()
 {
-    ESP_LOGI(TAG, "Saving last used: %s (isAnimation: %d)", name.c_str(), isAnimation);
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading boot frame");
 
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "name", name.c_str());
-    cJSON_AddBoolToObject(root, "isAnimation", isAnimation);
+    if (!spiffs_.exists(bootFrameFile).value_or(false))
+    {
+        ESP_LOGI(TAG, "No boot frame file found");
+        return std::nullopt;
+    }
 
-    char* json = cJSON_PrintUnformatted(root);
-    bool result = writeJsonToFile(lastUsedFile, json);
-    cJSON_free(json);
-    cJSON_Delete(root);
+    auto data = readBinaryFromFile(
+        bootFrameFile, sizeof(BinaryBootFrame) + BinaryBootFrame::maxNameLength);
+    if (!data)
+        return std::nullopt;
 
-    return result;
+    return deserializeBootFrame(*data);
 }
 
 std::optional<std::pair<std::string, bool>> StorageManager::loadLastUsed()
 {
+    Lock lock{ lock_ };
     ESP_LOGI(TAG, "Loading last used");
 
     auto json = readJsonFromFile(lastUsedFile);
@@ -560,6 +1458,482 @@ std::optional<std::pair<std::string, bool>> StorageManager::loadLastUsed()
     return result;
 }
 
+bool StorageManager::savePlaylist(const Playlist& playlist)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(
+        TAG,
+        "Saving playlist: %u items (active: %d)",
+        static_cast<unsigned>(playlist.items.size()),
+        playlist.active);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "active", playlist.active);
+    cJSON* items = cJSON_AddArrayToObject(root, "items");
+    for (const auto& item: playlist.items)
+    {
+        cJSON* entry = cJSON_CreateObject();
+        cJSON_AddStringToObject(entry, "name", item.name.c_str());
+        cJSON_AddBoolToObject(entry, "isAnimation", item.isAnimation);
+        cJSON_AddNumberToObject(entry, "dwellMs", item.dwellMs);
+        cJSON_AddStringToObject(
+            entry, "transition", Transition::toString(item.transition.kind));
+        cJSON_AddNumberToObject(entry, "transitionMs", item.transition.durationMs);
+        cJSON_AddItemToArray(items, entry);
+    }
+
+    char* json = cJSON_PrintUnformatted(root);
+    bool result = writeJsonToFile(playlistFile, json);
+    cJSON_free(json);
+    cJSON_Delete(root);
+    return result;
+}
+
+std::optional<StorageManager::Playlist> StorageManager::loadPlaylist()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading playlist");
+
+    auto json = readJsonFromFile(playlistFile);
+    if (!json)
+    {
+        ESP_LOGI(TAG, "No playlist file found");
+        return std::nullopt;
+    }
+
+    cJSON* root = cJSON_Parse(json->c_str());
+    if (!root)
+    {
+        ESP_LOGE(TAG, "Invalid JSON in playlist file");
+        return std::nullopt;
+    }
+
+    cJSON* active = cJSON_GetObjectItem(root, "active");
+    cJSON* items = cJSON_GetObjectItem(root, "items");
+    if (!cJSON_IsBool(active) || !cJSON_IsArray(items))
+    {
+        ESP_LOGE(TAG, "Invalid playlist format");
+        cJSON_Delete(root);
+        return std::nullopt;
+    }
+
+    Playlist playlist{ {}, active->valueint != 0 };
+    cJSON* item = nullptr;
+    cJSON_ArrayForEach(item, items)
+    {
+        cJSON* name = cJSON_GetObjectItem(item, "name");
+        cJSON* isAnimation = cJSON_GetObjectItem(item, "isAnimation");
+        cJSON* dwellMs = cJSON_GetObjectItem(item, "dwellMs");
+        if (!cJSON_IsString(name) || !cJSON_IsBool(isAnimation)
+            || !cJSON_IsNumber(dwellMs))
+        {
+            ESP_LOGE(TAG, "Invalid playlist item");
+            cJSON_Delete(root);
+            return std::nullopt;
+        }
+        playlist.items.push_back(
+            { name->valuestring,
+              isAnimation->valueint != 0,
+              static_cast<uint32_t>(dwellMs->valuedouble),
+              Transition{} });
+
+        // Missing in playlists saved before transitions existed
+        const char* transition
+            = cJSON_GetStringValue(cJSON_GetObjectItem(item, "transition"));
+        cJSON* transitionMs = cJSON_GetObjectItem(item, "transitionMs");
+        auto kind = transition ? Transition::parseKind(transition) : std::nullopt;
+        if (kind && cJSON_IsNumber(transitionMs))
+        {
+            playlist.items.back().transition
+                = { *kind, static_cast<uint32_t>(transitionMs->valuedouble) };
+        }
+    }
+
+    cJSON_Delete(root);
+    return playlist;
+}
+
+bool StorageManager::saveClock(const ClockOverlay::Settings& settings)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving clock: %s", ClockOverlay::toString(settings.mode));
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "mode", ClockOverlay::toString(settings.mode));
+    cJSON* color = cJSON_AddArrayToObject(root, "color");
+    for (uint8_t channel: { settings.color.r, settings.color.g, settings.color.b })
+    {
+        cJSON_AddItemToArray(color, cJSON_CreateNumber(channel));
+    }
+    cJSON_AddBoolToObject(root, "top", settings.top);
+
+    char* json = cJSON_PrintUnformatted(root);
+    bool result = writeJsonToFile(clockFile, json);
+    cJSON_free(json);
+    cJSON_Delete(root);
+    return result;
+}
+
+std::optional<ClockOverlay::Settings> StorageManager::loadClock()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading clock");
+
+    auto json = readJsonFromFile(clockFile);
+    if (!json)
+    {
+        ESP_LOGI(TAG, "No clock file found");
+        return std::nullopt;
+    }
+
+    cJSON* root = cJSON_Parse(json->c_str());
+    if (!root)
+    {
+        ESP_LOGE(TAG, "Invalid JSON in clock file");
+        return std::nullopt;
+    }
+
+    const char* mode = cJSON_GetStringValue(cJSON_GetObjectItem(root, "mode"));
+    cJSON* color = cJSON_GetObjectItem(root, "color");
+    cJSON* top = cJSON_GetObjectItem(root, "top");
+    auto parsed = mode ? ClockOverlay::parseMode(mode) : std::nullopt;
+    if (!parsed || !cJSON_IsArray(color) || cJSON_GetArraySize(color) != 3
+        || !cJSON_IsBool(top))
+    {
+        ESP_LOGE(TAG, "Invalid clock format");
+        cJSON_Delete(root);
+        return std::nullopt;
+    }
+
+    auto channel = [color](int i)
+    { return static_cast<uint8_t>(cJSON_GetArrayItem(color, i)->valueint); };
+    ClockOverlay::Settings settings{ *parsed,
+                                     { channel(0), channel(1), channel(2) },
+                                     top->valueint != 0 };
+    cJSON_Delete(root);
+    return settings;
+}
+
+bool StorageManager::saveCanvas(const VirtualCanvas& canvas)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(
+        TAG,
+        "Saving canvas: %ux%u, tile at %u,%u",
+        canvas.width,
+        canvas.height,
+        canvas.tileX,
+        canvas.tileY);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "width", canvas.width);
+    cJSON_AddNumberToObject(root, "height", canvas.height);
+    cJSON_AddNumberToObject(root, "x", canvas.tileX);
+    cJSON_AddNumberToObject(root, "y", canvas.tileY);
+    cJSON_AddNumberToObject(root, "rotation", static_cast<int>(canvas.rotation) * 90);
+
+    char* json = cJSON_PrintUnformatted(root);
+    bool result = writeJsonToFile(canvasFile, json);
+    cJSON_free(json);
+    cJSON_Delete(root);
+    return result;
+}
+
+std::optional<VirtualCanvas> StorageManager::loadCanvas()
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading canvas");
+
+    auto json = readJsonFromFile(canvasFile);
+    if (!json)
+    {
+        ESP_LOGI(TAG, "No canvas file found");
+        return std::nullopt;
+    }
+
+    cJSON* root = cJSON_Parse(json->c_str());
+    if (!root)
+    {
+        ESP_LOGE(TAG, "Invalid JSON in canvas file");
+        return std::nullopt;
+    }
+
+    auto number = [root](const char* name)
+    {
+        cJSON* item = cJSON_GetObjectItem(root, name);
+        return cJSON_IsNumber(item) && item->valueint >= 0 && item->valueint <= UINT16_MAX
+            ? std::optional<uint16_t>{ static_cast<uint16_t>(item->valueint) }
+            : std::nullopt;
+    };
+    const auto width = number("width");
+    const auto height = number("height");
+    const auto x = number("x");
+    const auto y = number("y");
+    const auto rotation = number("rotation");
+    cJSON_Delete(root);
+    if (!width || !height || !x || !y || !rotation || *rotation % 90 != 0 || *rotation > 270)
+    {
+        ESP_LOGE(TAG, "Invalid canvas format");
+        return std::nullopt;
+    }
+
+    VirtualCanvas canvas{ *width,
+                          *height,
+                          *x,
+                          *y,
+                          LedMatrix::width,
+                          LedMatrix::height,
+                          static_cast<WS2812MatrixRotation>(*rotation / 90) };
+    if (!canvas.valid())
+    {
+        ESP_LOGE(TAG, "Canvas too large or tile not on it");
+        return std::nullopt;
+    }
+    return canvas;
+}
+
+void StorageManager::setCanvas(const VirtualCanvas& canvas)
+{
+    Lock lock{ lock_ };
+    canvas_ = canvas;
+}
+
+VirtualCanvas StorageManager::canvas() const
+{
+    Lock lock{ lock_ };
+    return canvas_;
+}
+
+bool StorageManager::saveEffectPreset(const std::string& name, const Effect& effect)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving effect preset: %s", name.c_str());
+
+    cJSON* preset = cJSON_CreateObject();
+    FrameJson::addEffect(preset, effect);
+    return saveNamedEntry(effectsFile, name, preset);
+}
+
+std::optional<Effect> StorageManager::loadEffectPreset(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading effect preset: %s", name.c_str());
+
+    cJSON* presets = readNamedEntries(effectsFile);
+    if (!presets)
+    {
+        return std::nullopt;
+    }
+    const cJSON* preset = cJSON_GetObjectItem(presets, name.c_str());
+    auto effect = cJSON_IsObject(preset) ? FrameJson::parseEffect(preset, Effect{})
+                                         : std::nullopt;
+    cJSON_Delete(presets);
+    if (!effect)
+    {
+        ESP_LOGW(TAG, "Effect preset not found: %s", name.c_str());
+    }
+    return effect;
+}
+
+bool StorageManager::deleteEffectPreset(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Deleting effect preset: %s", name.c_str());
+    return deleteNamedEntry(effectsFile, name);
+}
+
+std::vector<std::string> StorageManager::listEffectPresets()
+{
+    Lock lock{ lock_ };
+    return listNamedEntries(effectsFile);
+}
+
+bool StorageManager::saveMessage(const std::string& name, const ScrollingText& message)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving message: %s", name.c_str());
+
+    cJSON* entry = cJSON_CreateObject();
+    FrameJson::addText(entry, message);
+    return saveNamedEntry(messagesFile, name, entry);
+}
+
+std::optional<ScrollingText> StorageManager::loadMessage(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading message: %s", name.c_str());
+
+    cJSON* messages = readNamedEntries(messagesFile);
+    if (!messages)
+    {
+        return std::nullopt;
+    }
+    const cJSON* entry = cJSON_GetObjectItem(messages, name.c_str());
+    auto message = cJSON_IsObject(entry)
+        ? FrameJson::parseText(entry, ScrollingText{})
+        : std::nullopt;
+    cJSON_Delete(messages);
+    if (!message)
+    {
+        ESP_LOGW(TAG, "Message not found: %s", name.c_str());
+    }
+    return message;
+}
+
+bool StorageManager::deleteMessage(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Deleting message: %s", name.c_str());
+    return deleteNamedEntry(messagesFile, name);
+}
+
+std::vector<std::string> StorageManager::listMessages()
+{
+    Lock lock{ lock_ };
+    return listNamedEntries(messagesFile);
+}
+
+bool StorageManager::saveShader(const std::string& name, const PixelShader& shader)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Saving shader: %s", name.c_str());
+
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddStringToObject(entry, "source", shader.source().c_str());
+    return saveNamedEntry(shadersFile, name, entry);
+}
+
+std::optional<PixelShader> StorageManager::loadShader(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Loading shader: %s", name.c_str());
+
+    cJSON* shaders = readNamedEntries(shadersFile);
+    if (!shaders)
+    {
+        return std::nullopt;
+    }
+    const cJSON* source = cJSON_GetObjectItem(
+        cJSON_GetObjectItem(shaders, name.c_str()), "source");
+    std::optional<PixelShader> shader;
+    if (cJSON_IsString(source))
+    {
+        std::string error;
+        shader = PixelShader::assemble(source->valuestring, &error);
+        if (!shader)
+        {
+            ESP_LOGE(TAG, "Stored shader %s does not assemble: %s", name.c_str(), error.c_str());
+        }
+    }
+    else
+    {
+        ESP_LOGW(TAG, "Shader not found: %s", name.c_str());
+    }
+    cJSON_Delete(shaders);
+    return shader;
+}
+
+bool StorageManager::deleteShader(const std::string& name)
+{
+    Lock lock{ lock_ };
+    ESP_LOGI(TAG, "Deleting shader: %s", name.c_str());
+    return deleteNamedEntry(shadersFile, name);
+}
+
+std::vector<std::string> StorageManager::listShaders()
+{
+    Lock lock{ lock_ };
+    return listNamedEntries(shadersFile);
+}
+
+cJSON* StorageManager::readNamedEntries(const char* filename)
+{
+    auto exists = spiffs_.exists(filename);
+    if (exists && !*exists)
+    {
+        return cJSON_CreateObject();
+    }
+    // Saving over a file that could not be read would drop its entries
+    auto json = exists ? readJsonFromFile(filename) : std::nullopt;
+    if (!json)
+    {
+        ESP_LOGE(TAG, "Failed to read %s", filename);
+        return nullptr;
+    }
+    cJSON* entries = cJSON_Parse(json->c_str());
+    if (!cJSON_IsObject(entries))
+    {
+        ESP_LOGE(TAG, "Invalid JSON in %s", filename);
+        cJSON_Delete(entries);
+        return nullptr;
+    }
+    return entries;
+}
+
+bool StorageManager::writeNamedEntries(const char* filename, cJSON* entries)
+{
+    char* json = cJSON_PrintUnformatted(entries);
+    bool result = writeJsonToFile(filename, json);
+    cJSON_free(json);
+    return result;
+}
+
+bool StorageManager::saveNamedEntry(
+    const char* filename, const std::string& name, cJSON* entry)
+{
+    cJSON* entries = readNamedEntries(filename);
+    if (!entries)
+    {
+        cJSON_Delete(entry);
+        return false;
+    }
+    if (cJSON_GetObjectItem(entries, name.c_str()))
+    {
+        cJSON_ReplaceItemInObject(entries, name.c_str(), entry);
+    }
+    else
+    {
+        cJSON_AddItemToObject(entries, name.c_str(), entry);
+    }
+    bool result = writeNamedEntries(filename, entries);
+    cJSON_Delete(entries);
+    return result;
+}
+
+bool StorageManager::deleteNamedEntry(const char* filename, const std::string& name)
+{
+    cJSON* entries = readNamedEntries(filename);
+    if (!entries)
+    {
+        return false;
+    }
+    bool result = cJSON_GetObjectItem(entries, name.c_str()) != nullptr;
+    if (result)
+    {
+        cJSON_DeleteItemFromObject(entries, name.c_str());
+        result = writeNamedEntries(filename, entries);
+    }
+    cJSON_Delete(entries);
+    return result;
+}
+
+std::vector<std::string> StorageManager::listNamedEntries(const char* filename)
+{
+    std::vector<std::string> names;
+    cJSON* entries = readNamedEntries(filename);
+    if (!entries)
+    {
+        return names;
+    }
+    const cJSON* entry = nullptr;
+    cJSON_ArrayForEach(entry, entries)
+    {
+        names.emplace_back(entry->string);
+    }
+    cJSON_Delete(entries);
+    return names;
+}
+
 bool StorageManager::writeJsonToFile(
     const std::string& filename, const std::string& json)
 {
@@ -571,20 +1945,26 @@ bool StorageManager::writeJsonToFile(
     return result.has_value();
 }
 
-std::optional<std::string> StorageManager::readJsonFromFile(
-    const std::string& filename, const size_t readBufferSize)
+std::optional<std::string>
+StorageManager::readJsonFromFile(const std::string& filename)
 {
     ESP_LOGI(TAG, "Reading JSON from file: %s", filename.c_str());
 
-    std::vector<std::byte> buffer(readBufferSize);
-    auto result = spiffs_.read(filename, buffer);
-    if (!result)
+    // Sized from the file, a truncated read would not parse
+    auto size = spiffs_.size(filename);
+    if (!size)
+    {
+        ESP_LOGE(TAG, "Failed to read file: %s", filename.c_str());
+        return std::nullopt;
+    }
+    std::string content(*size, '\0');
+    auto result = spiffs_.read(filename, std::as_writable_bytes(std::span{ content }));
+    if (!result || *result != content.size())
     {
         ESP_LOGE(TAG, "Failed to read file: %s", filename.c_str());
         return std::nullopt;
     }
 
-    std::string content(reinterpret_cast<char*>(buffer.data()), *result);
     ESP_LOGI(TAG, "File content: %s", content.c_str());
 
     cJSON* root = cJSON_Parse(content.c_str());
@@ -1,21 +1,36 @@
 #ifndef STORAGE_MANAGER_HPP
 #define STORAGE_MANAGER_HPP
 
+#include "ClockOverlay.hpp"
+#include "Effect.hpp"
+#include "ScrollingText.hpp"
+#include "FramePool.hpp"
 #include "LedMatrix.hpp"
 #include "PSRAMallocator.hpp"
+#include "PixelShader.hpp"
 #include "Spiffs.hpp"
+#include "SpriteFrames.hpp"
+#include "Timeline.hpp"
+#include "Transition.hpp"
+#include "VirtualCanvas.hpp"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #include <cstdint>
 #include <map>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
+struct cJSON;
+
 class StorageManager
 {
 private:
     static constexpr const char* TAG = "StorageManager";
-    using VectorAllocator = PSRAMAllocator<std::array<LedMatrix::RGB, LedMatrix::numPixels>>;
+    using BufferAllocator = PSRAMAllocator<uint8_t>;
 
     // Binary format structures
     struct BinaryDesign
@@ -29,9 +44,43 @@ private:
         uint8_t pixels[LedMatrix::numPixels * 3];  // RGB values
     };
 
+    // Version 1 is the frames only, version 2 appends the timeline
     struct BinaryAnimation
     {
         static constexpr uint8_t MAGIC = 0x41;  // 'A'
+        static constexpr uint8_t VERSION = 2;
+        uint8_t magic;
+        uint8_t version;
+        uint8_t nameLength;
+        char name[32];  // Fixed size for name
+        uint32_t intervalMs;
+        uint16_t numFrames;
+        uint8_t frames[];  // Flexible array member for frame data
+    };
+
+    // Follows the frame data in version 2
+    struct BinaryTimeline
+    {
+        uint8_t loopMode;
+        uint8_t reserved;
+        uint16_t loopStart;
+        uint16_t loopEnd;
+        uint16_t numEntries;
+    };
+
+    struct BinaryTimelineEntry
+    {
+        uint16_t frame;
+        uint16_t reserved;
+        uint32_t durationMs;
+    };
+
+    // Frames of a whole video wall canvas, followed by the timeline like a
+    // version 2 animation. Listed with the animations, loadAnimation()
+    // crops them.
+    struct BinaryCanvasAnimation
+    {
+        static constexpr uint8_t MAGIC = 0x43;  // 'C'
         static constexpr uint8_t VERSION = 1;
         uint8_t magic;
         uint8_t version;
@@ -39,10 +88,47 @@ private:
         char name[32];  // Fixed size for name
         uint32_t intervalMs;
         uint16_t numFrames;
+        uint16_t width;
+        uint16_t height;
         uint8_t frames[];  // Flexible array member for frame data
     };
 
+    // Header of a sprite animation, followed by every sprite (width,
+    // height, RGB pixels, opaque flags eight to a byte), the placement
+    // count of every frame, the placements and the timeline
+    struct BinarySpriteAnimation
+    {
+        static constexpr uint8_t MAGIC = 0x53;  // 'S'
+        static constexpr uint8_t VERSION = 1;
+        uint8_t magic;
+        uint8_t version;
+        uint8_t nameLength;
+        char name[32];  // Fixed size for name
+        uint32_t intervalMs;
+        uint16_t numSprites;
+        uint16_t numFrames;
+        uint8_t background[LedMatrix::numPixels * 3];  // RGB values
+    };
+
+    struct BinaryBootFrame
+    {
+        static constexpr uint8_t MAGIC = 0x42;  // 'B'
+        // Version 1 cut the name to 31 characters
+        static constexpr uint8_t VERSION = 2;
+        static constexpr size_t maxNameLength = UINT8_MAX;
+        uint8_t magic;
+        uint8_t version;
+        uint8_t isAnimation;
+        uint8_t nameLength;
+        uint8_t pixels[LedMatrix::numPixels * 3];  // RGB values of first frame
+        // Followed by the nameLength bytes of the whole name, the boot
+        // path loads the content by it
+    };
+
 public:
+    // Serialized designs and animations, kept in PSRAM
+    using Buffer = std::vector<uint8_t, BufferAllocator>;
+
     struct Design
     {
         std::string name;
@@ -52,8 +138,48 @@ public:
     struct Animation
     {
         std::string name;
+        // Frame duration in the designer, the timeline has the real ones
         int intervalMs;
-        std::vector<std::array<LedMatrix::RGB, LedMatrix::numPixels>, VectorAllocator> frames;
+        // Pooled, see FramePool.hpp. Distinct frames only, once the
+        // animation went through deduplicate().
+        FrameSequence<std::array<LedMatrix::RGB, LedMatrix::numPixels>> frames;
+        // Every frame once at intervalMs when left empty
+        Timeline timeline;
+    };
+
+    struct SpriteAnimation
+    {
+        std::string name;
+        int intervalMs;
+        SpriteFrames<LedMatrix> frames;
+        // Every frame once at intervalMs when left empty
+        Timeline timeline;
+    };
+
+    // Last used item together with its first frame, readable at boot
+    // without touching the JSON index files
+    struct BootFrame
+    {
+        std::string name;
+        bool isAnimation;
+        std::array<LedMatrix::RGB, LedMatrix::numPixels> pixels;
+    };
+
+    struct PlaylistItem
+    {
+        std::string name;
+        bool isAnimation;
+        // How long the item stays on
+        uint32_t dwellMs;
+        // How it replaces the item before
+        Transition transition;
+    };
+
+    struct Playlist
+    {
+        std::vector<PlaylistItem> items;
+        // Played from boot instead of the last used item
+        bool active;
     };
 
     struct StorageEntry
@@ -62,7 +188,12 @@ public:
         size_t size;
     };
 
+    // Shared by the playlist, HTTP server and realtime tasks, every member
+    // holds a lock while it touches the files, the indexes or the canvas
     explicit StorageManager(Spiffs& spiffs);
+    ~StorageManager();
+    StorageManager(const StorageManager&) = delete;
+    StorageManager& operator=(const StorageManager&) = delete;
     bool init();
 
     bool saveDesign(const Design& design);
@@ -74,18 +205,145 @@ public:
     std::optional<Animation> loadAnimation(const std::string& name);
     bool deleteAnimation(const std::string& name);
     std::vector<std::string> listAnimations();
+
+    /**
+     * Saves an animation of a whole video wall canvas one frame at a time,
+     * as they are decoded, so it is never held in memory. It is listed and
+     * loaded with the animations, each device reading just its tile.
+     * Written to a scratch file first, an existing animation of the same
+     * name stays until finish() replaces it; without finish() nothing is
+     * saved.
+     */
+    class CanvasAnimationWriter
+    {
+    public:
+        CanvasAnimationWriter(
+            StorageManager& storage,
+            const std::string& name,
+            uint16_t width,
+            uint16_t height);
+        ~CanvasAnimationWriter();
+        CanvasAnimationWriter(const CanvasAnimationWriter&) = delete;
+        CanvasAnimationWriter& operator=(const CanvasAnimationWriter&) = delete;
+
+        // One frame of the canvas, RGB row after row
+        bool addFrame(std::span<const uint8_t> frame);
+        // Every frame once at intervalMs when timeline is empty
+        bool finish(int intervalMs, const Timeline& timeline);
+
+    private:
+        StorageManager& storage_;
+        std::string name_;
+        uint16_t width_;
+        uint16_t height_;
+        std::optional<Spiffs::File> file_;
+        size_t frames_{ 0 };
+        size_t size_{ 0 };
+        bool finished_{ false };
+    };
+
+    bool saveSpriteAnimation(const SpriteAnimation& animation);
+    std::optional<SpriteAnimation> loadSpriteAnimation(const std::string& name);
+    bool deleteSpriteAnimation(const std::string& name);
+    std::vector<std::string> listSpriteAnimations();
+
     bool clearStorage();
 
     bool saveLastUsed(const std::string& name, bool isAnimation);
     std::optional<std::pair<std::string, bool>> loadLastUsed();
+    std::optional<BootFrame> loadBootFrame();
+
+    bool savePlaylist(const Playlist& playlist);
+    std::optional<Playlist> loadPlaylist();
+
+    bool saveClock(const ClockOverlay::Settings& settings);
+    std::optional<ClockOverlay::Settings> loadClock();
+
+    // The video wall this device is part of, just the matrix until set
+    bool saveCanvas(const VirtualCanvas& canvas);
+    std::optional<VirtualCanvas> loadCanvas();
+    void setCanvas(const VirtualCanvas& canvas);
+    VirtualCanvas canvas() const;
+
+    // Effect presets are a few bytes each, they share one JSON file
+    bool saveEffectPreset(const std::string& name, const Effect& effect);
+    std::optional<Effect> loadEffectPreset(const std::string& name);
+    bool deleteEffectPreset(const std::string& name);
+    std::vector<std::string> listEffectPresets();
+
+    // Scrolling text messages, stored as the string and its settings in
+    // one JSON file
+    bool saveMessage(const std::string& name, const ScrollingText& message);
+    std::optional<ScrollingText> loadMessage(const std::string& name);
+    bool deleteMessage(const std::string& name);
+    std::vector<std::string> listMessages();
+
+    // Pixel shaders, stored as their source in one JSON file and assembled
+    // again when loaded
+    bool saveShader(const std::string& name, const PixelShader& shader);
+    std::optional<PixelShader> loadShader(const std::string& name);
+    bool deleteShader(const std::string& name);
+    std::vector<std::string> listShaders();
+
+    // Binary format helpers. Animations are saved and loaded in pieces,
+    // these hold one whole in a buffer for tests and benchmarks.
+    static Buffer serializeDesign(const Design& design);
+    static std::optional<Design>
+    deserializeDesign(const Buffer& data);
+    static Buffer serializeAnimation(const Animation& animation);
+    static std::optional<Animation>
+    deserializeAnimation(const Buffer& data);
+    static Buffer serializeSpriteAnimation(const SpriteAnimation& animation);
+    static std::optional<SpriteAnimation>
+    deserializeSpriteAnimation(const Buffer& data);
+    // nullopt when the name is longer than BinaryBootFrame::maxNameLength
+    static std::optional<Buffer> serializeBootFrame(const BootFrame& bootFrame);
+    static std::optional<BootFrame>
+    deserializeBootFrame(const Buffer& data);
 
 private:
+    // Held for the scope of a member. Members call each other, so the
+    // mutex is recursive.
+    class Lock
+    {
+    public:
+        explicit Lock(SemaphoreHandle_t mutex)
+            : mutex_{ mutex }
+        {
+            xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+        }
+        ~Lock() { xSemaphoreGiveRecursive(mutex_); }
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+
+    private:
+        SemaphoreHandle_t mutex_;
+    };
+
+    // Streamed animation format: write(const void*, size_t) and
+    // read(void*, size_t) return false when they fail, size is the size of
+    // the whole item. Frames go straight from and to their pool blocks.
+    template<typename Write>
+    static bool writeAnimation(const Animation& animation, Write&& write);
+    template<typename Read>
+    static std::optional<Animation> readAnimation(size_t size, Read&& read);
+    // The tile of canvas, whose size comes from the file, reading nothing
+    // but the rows of the tile
+    static std::optional<Animation>
+    readCanvasAnimation(Spiffs::File& file, size_t size, const VirtualCanvas& canvas);
+    template<typename Write>
+    static bool writeTimeline(const Timeline& timeline, Write&& write);
+    // Reads the remaining size bytes as the timeline of numFrames frames
+    template<typename Read>
+    static bool
+    readTimeline(size_t size, size_t numFrames, Timeline& timeline, Read&& read);
+
     bool initIndexFile(const std::string& filename);
     bool writeJsonToFile(const std::string& filename, const std::string& json);
-    std::optional<std::string> readJsonFromFile(
-        const std::string& filename, const size_t readBufferSize = 10240);
+    std::optional<std::string> readJsonFromFile(const std::string& filename);
     std::string getDesignFilename(const std::string& name);
     std::string getAnimationFilename(const std::string& name);
+    std::string getSpriteAnimationFilename(const std::string& name);
     bool updateIndexFile(
         const std::string& indexFile,
         const std::string& name,
@@ -96,24 +354,44 @@ private:
     std::map<std::string, StorageEntry>
     readIndexFile(const std::string& filename);
 
-    // Binary format helpers
-    std::vector<uint8_t> serializeDesign(const Design& design);
-    std::optional<Design> deserializeDesign(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> serializeAnimation(const Animation& animation);
-    std::optional<Animation>
-    deserializeAnimation(const std::vector<uint8_t>& data);
+    // A JSON object of named entries (effect presets, messages), an empty
+    // one when there is no file yet and nullptr when it cannot be read
+    cJSON* readNamedEntries(const char* filename);
+    bool writeNamedEntries(const char* filename, cJSON* entries);
+    bool saveNamedEntry(const char* filename, const std::string& name, cJSON* entry);
+    bool deleteNamedEntry(const char* filename, const std::string& name);
+    std::vector<std::string> listNamedEntries(const char* filename);
+
+    std::optional<std::array<LedMatrix::RGB, LedMatrix::numPixels>>
+    loadFirstFrame(const std::string& name, bool isAnimation);
+    void writeBootFrame(const std::string& name, bool isAnimation);
+    // Rewrites the boot frame when the item saved as name is the last used
+    // one, its first frame may have changed
+    void refreshBootFrame(const std::string& name, bool isAnimation);
     bool writeBinaryToFile(
-        const std::string& filename, const std::vector<uint8_t>& data);
-    std::optional<std::vector<uint8_t>> readBinaryFromFile(
+        const std::string& filename, const Buffer& data);
+    std::optional<Buffer> readBinaryFromFile(
         const std::string& filename, const size_t readBufferSize = 10240);
 
     static constexpr const char* designsIndexFile = "/designs_index.json";
     static constexpr const char* animationsIndexFile = "/animations_index.json";
     static constexpr const char* designPrefix = "design_";
     static constexpr const char* animationPrefix = "anim_";
+    static constexpr const char* canvasUploadFile = "/canvas_upload.tmp";
+    static constexpr const char* spritesIndexFile = "/sprites_index.json";
+    static constexpr const char* spritePrefix = "sprite_";
     static constexpr const char* lastUsedFile = "/last_used.json";
+    static constexpr const char* bootFrameFile = "/boot_frame.bin";
+    static constexpr const char* playlistFile = "/playlist.json";
+    static constexpr const char* clockFile = "/clock.json";
+    static constexpr const char* canvasFile = "/canvas.json";
+    static constexpr const char* effectsFile = "/effects.json";
+    static constexpr const char* messagesFile = "/messages.json";
+    static constexpr const char* shadersFile = "/shaders.json";
 
     Spiffs& spiffs_;
+    SemaphoreHandle_t lock_;
+    VirtualCanvas canvas_{ VirtualCanvas::single(LedMatrix::width, LedMatrix::height) };
 };
 
 #endif  // STORAGE_MANAGER_HPP
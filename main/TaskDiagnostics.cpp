@@ -0,0 +1,165 @@
+#include "TaskDiagnostics.hpp"
+
+#include <esp_log.h>
+
+#include <algorithm>
+#include <cstring>
+
+TaskDiagnostics::TaskDiagnostics()
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+TaskDiagnostics::~TaskDiagnostics()
+{
+    if (taskHandle_)
+    {
+        vTaskDelete(taskHandle_);
+    }
+    if (lock_)
+    {
+        vSemaphoreDelete(lock_);
+    }
+}
+
+bool TaskDiagnostics::start(uint32_t windowMs)
+{
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    if (taskHandle_)
+    {
+        return true;
+    }
+    windowMs_ = windowMs;
+    if (xTaskCreate(
+            taskEntry,
+            "diagTask",
+            3 * 1024,
+            this,
+            tskIDLE_PRIORITY + 1,
+            &taskHandle_)
+        != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create diagnostics task");
+        taskHandle_ = nullptr;
+        return false;
+    }
+    return true;
+#else
+    ESP_LOGW(TAG, "FreeRTOS run time stats are disabled in sdkconfig");
+    return false;
+#endif
+}
+
+std::optional<TaskDiagnostics::Snapshot> TaskDiagnostics::latest() const
+{
+    std::optional<Snapshot> result;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (haveSnapshot_)
+    {
+        result = snapshot_;
+    }
+    xSemaphoreGive(lock_);
+    return result;
+}
+
+void TaskDiagnostics::taskEntry(void* arg)
+{
+    auto* self = static_cast<TaskDiagnostics*>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        self->sample();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(self->windowMs_));
+    }
+}
+
+void TaskDiagnostics::sample()
+{
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    const size_t count
+        = uxTaskGetSystemState(status_.data(), status_.size(), &total);
+    if (count == 0)
+    {
+        ESP_LOGW(
+            TAG,
+            "More than %u tasks, not sampled",
+            static_cast<unsigned>(maxTasks));
+        return;
+    }
+
+    if (havePrevious_)
+    {
+        // The total counts wall time, every core adds its own share on top
+        const configRUN_TIME_COUNTER_TYPE elapsed = total - previousTotal_;
+        Snapshot& snapshot = working_;
+        snapshot = {};
+        snapshot.windowMs = static_cast<uint32_t>(elapsed / 1000);
+        snapshot.numTasks = count;
+
+        auto delta = [this](const TaskStatus_t& task)
+        {
+            for (size_t i = 0; i < numPrevious_; ++i)
+            {
+                if (previous_[i].handle == task.xHandle)
+                {
+                    return task.ulRunTimeCounter - previous_[i].runTime;
+                }
+            }
+            // Created during the window
+            return task.ulRunTimeCounter;
+        };
+        auto percent = [elapsed](configRUN_TIME_COUNTER_TYPE runTime)
+        {
+            return elapsed > 0 ? 100.0f * runTime / elapsed : 0.0f;
+        };
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const TaskStatus_t& status = status_[i];
+            Task& task = snapshot.tasks[i];
+            strncpy(task.name, status.pcTaskName, sizeof(task.name) - 1);
+            const BaseType_t core = xTaskGetCoreID(status.xHandle);
+            task.core = core == tskNO_AFFINITY ? -1 : static_cast<int>(core);
+            task.priority = status.uxCurrentPriority;
+            task.state = status.eCurrentState;
+            task.cpuPercent = percent(delta(status));
+            task.stackFreeMin = status.usStackHighWaterMark;
+        }
+
+        for (size_t core = 0; core < numCores; ++core)
+        {
+            TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+            snapshot.coreLoadPercent[core] = 100.0f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (status_[i].xHandle == idle)
+                {
+                    snapshot.coreLoadPercent[core] = std::max(
+                        0.0f, 100.0f - percent(delta(status_[i])));
+                    break;
+                }
+            }
+        }
+
+        std::sort(
+            snapshot.tasks.begin(),
+            snapshot.tasks.begin() + count,
+            [](const Task& a, const Task& b)
+            { return a.cpuPercent > b.cpuPercent; });
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        snapshot_ = snapshot;
+        haveSnapshot_ = true;
+        xSemaphoreGive(lock_);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        previous_[i] = { status_[i].xHandle, status_[i].ulRunTimeCounter };
+    }
+    numPrevious_ = count;
+    previousTotal_ = total;
+    havePrevious_ = true;
+#endif
+}
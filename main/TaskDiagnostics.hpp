@@ -0,0 +1,83 @@
+#ifndef TASK_DIAGNOSTICS_HPP
+#define TASK_DIAGNOSTICS_HPP
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <array>
+#include <optional>
+
+/**
+ * Periodically samples the FreeRTOS run-time counters and stack high-water
+ * marks of all tasks and keeps the CPU share of the last window.
+ * Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+ */
+class TaskDiagnostics
+{
+    inline static constexpr const char* TAG = "TaskDiagnostics";
+
+public:
+    static constexpr size_t maxTasks = 32;
+    static constexpr size_t numCores = portNUM_PROCESSORS;
+
+    struct Task
+    {
+        char name[configMAX_TASK_NAME_LEN];
+        // Pinned core, -1 when the task can run on any core
+        int core;
+        UBaseType_t priority;
+        eTaskState state;
+        // Share of one core over the window, in percent
+        float cpuPercent;
+        // Smallest free stack ever seen, in bytes
+        uint32_t stackFreeMin;
+    };
+
+    struct Snapshot
+    {
+        uint32_t windowMs;
+        std::array<float, numCores> coreLoadPercent;
+        size_t numTasks;
+        // Sorted by CPU share, busiest first
+        std::array<Task, maxTasks> tasks;
+    };
+
+    TaskDiagnostics();
+    ~TaskDiagnostics();
+
+    // Starts the sampling task, a window of windowMs is published each time
+    bool start(uint32_t windowMs = 5000);
+
+    // Last completed window, nothing before the first one is done
+    std::optional<Snapshot> latest() const;
+
+private:
+    struct Counter
+    {
+        TaskHandle_t handle;
+        configRUN_TIME_COUNTER_TYPE runTime;
+    };
+
+    static void taskEntry(void* arg);
+    void sample();
+
+    TaskHandle_t taskHandle_{ nullptr };
+    SemaphoreHandle_t lock_;
+    uint32_t windowMs_{ 0 };
+
+    // Only touched by the sampling task
+    std::array<TaskStatus_t, maxTasks> status_{};
+    std::array<Counter, maxTasks> previous_{};
+    size_t numPrevious_{ 0 };
+    configRUN_TIME_COUNTER_TYPE previousTotal_{ 0 };
+    bool havePrevious_{ false };
+    Snapshot working_{};
+
+    // Guarded by lock_
+    Snapshot snapshot_{};
+    bool haveSnapshot_{ false };
+};
+
+#endif  // TASK_DIAGNOSTICS_HPP
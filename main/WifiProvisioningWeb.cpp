@@ -125,7 +125,7 @@ WifiProvisioningWeb::WifiProvisioningWeb(
         [this](HttpRequest req) -> HttpResponse
         {
             HttpResponse response(req);
-            std::string content = req.getContent();
+            const auto content = req.getContent();
             ESP_LOGI(TAG, "Received body: %s", content.c_str());
             FormParser parser{ content };
             auto ssid = parser.get("ssid");
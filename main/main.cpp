@@ -4,27 +4,180 @@
 
 #include <esp_event.h>
 #include <esp_log.h>
+#include <esp_mac.h>
+#include <esp_netif_sntp.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
 #include <nvs_flash.h>
 
 #include <mdns.h>
 
+#include <cstdlib>
+#include <ctime>
+
+#include "CJsonHooks.hpp"
 #include "HttpServer.hpp"
 #include "WifiManager.hpp"
 
 #include "Spiffs.hpp"
 
+#include "ClockOverlay.hpp"
 #include "FramepixServer.hpp"
 #include "LedMatrix.hpp"
 #include "MatrixAnimator.hpp"
+#include "PlaylistScheduler.hpp"
+#include "RealtimeReceiver.hpp"
 #include "StorageManager.hpp"
+#include "TaskDiagnostics.hpp"
+#include "TimeSync.hpp"
 
 #include "WifiProvisioningWeb.hpp"
 
+#if CONFIG_FRAMEPIX_RUN_BENCHMARKS
+#include "Benchmarks.hpp"
+#endif
+
 #define TAG "framepix"
 
+/* Shows the first frame of the last used design or animation, without
+ * waiting for WiFi and before any JSON is parsed. */
+static std::optional<StorageManager::BootFrame> lightBootFrame(
+    StorageManager& storageManager, LedMatrix& matrix)
+{
+    auto bootFrame = storageManager.loadBootFrame();
+    if (!bootFrame)
+    {
+        // Boot frame missing (e.g. storage from older firmware),
+        // regenerate it from the last used record, of this device's tile
+        auto lastUsed = storageManager.loadLastUsed();
+        if (!lastUsed)
+        {
+            ESP_LOGI(TAG, "Nothing to restore");
+            return std::nullopt;
+        }
+        if (auto canvas = storageManager.loadCanvas())
+        {
+            storageManager.setCanvas(*canvas);
+        }
+        const auto& [name, isAnimation] = *lastUsed;
+        storageManager.saveLastUsed(name, isAnimation);
+        bootFrame = storageManager.loadBootFrame();
+        if (!bootFrame)
+        {
+            ESP_LOGW(TAG, "Failed to restore last used: %s", name.c_str());
+            return std::nullopt;
+        }
+    }
+
+    matrix.setAllPixels(bootFrame->pixels);
+    matrix.update();
+    ESP_LOGI(
+        TAG,
+        "Time to first light: %lld ms",
+        static_cast<long long>(esp_timer_get_time() / 1000));
+    return bootFrame;
+}
+
+/* Plays the design or animation the boot frame is of */
+static void startBootContent(
+    StorageManager& storageManager,
+    MatrixAnimator<LedMatrix>& animator,
+    const StorageManager::BootFrame& bootFrame)
+{
+    if (bootFrame.isAnimation)
+    {
+        auto animation = storageManager.loadAnimation(bootFrame.name);
+        if (animation)
+        {
+            animator.start(
+                std::move(animation->frames), std::move(animation->timeline));
+        }
+    }
+    else
+    {
+        // Held by the animator from here on, so overlays go on top
+        animator.show(bootFrame.pixels, {});
+    }
+}
+
+/* Back to what played before a realtime stream: the active playlist, or
+ * else the last used design or animation. */
+static void resumeStoredContent(
+    StorageManager& storageManager,
+    MatrixAnimator<LedMatrix>& animator,
+    PlaylistScheduler& playlistScheduler)
+{
+    if (auto playlist = storageManager.loadPlaylist(); playlist && playlist->active)
+    {
+        playlistScheduler.start(std::move(*playlist));
+        return;
+    }
+    auto lastUsed = storageManager.loadLastUsed();
+    if (!lastUsed)
+    {
+        // The last realtime frame stays
+        return;
+    }
+    const auto& [name, isAnimation] = *lastUsed;
+    if (isAnimation)
+    {
+        if (auto animation = storageManager.loadAnimation(name))
+        {
+            animator.start(std::move(animation->frames), std::move(animation->timeline));
+        }
+    }
+    else if (auto design = storageManager.loadDesign(name))
+    {
+        animator.show(design->pixels, {});
+    }
+}
+
+/* canvas: the video wall this device is part of, streams are of all of
+ * it */
+static RealtimeReceiver::Config realtimeConfig(const VirtualCanvas& canvas)
+{
+    RealtimeReceiver::Config config{};
+    config.mapping.canvas = canvas;
+#if CONFIG_FRAMEPIX_REALTIME_DDP
+    config.ddp = true;
+#else
+    config.ddp = false;
+#endif
+#if CONFIG_FRAMEPIX_REALTIME_E131
+    config.e131 = true;
+    config.mapping.e131Universe = CONFIG_FRAMEPIX_REALTIME_E131_UNIVERSE;
+#else
+    config.e131 = false;
+#endif
+#if CONFIG_FRAMEPIX_REALTIME_ARTNET
+    config.artNet = true;
+    config.mapping.artNetUniverse = CONFIG_FRAMEPIX_REALTIME_ARTNET_UNIVERSE;
+#else
+    config.artNet = false;
+#endif
+    config.timeoutMs = CONFIG_FRAMEPIX_REALTIME_TIMEOUT_MS;
+    return config;
+}
+
+/* The last four bytes of the MAC address tell devices apart */
+static TimeSync::Config timeSyncConfig()
+{
+    uint8_t mac[6]{};
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    TimeSync::Config config{};
+    config.id = (uint32_t{ mac[2] } << 24) | (uint32_t{ mac[3] } << 16)
+        | (uint32_t{ mac[4] } << 8) | mac[5];
+#if CONFIG_FRAMEPIX_SYNC
+    config.priority = CONFIG_FRAMEPIX_SYNC_PRIORITY;
+#endif
+    return config;
+}
+
 extern "C" void app_main()
 {
+    // Before the first cJSON allocation, so every block is accounted
+    HeapStats::installCJsonHooks();
+
     /* Initialize NVS partition */
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES
@@ -41,6 +194,12 @@ extern "C" void app_main()
     /* Initialize TCP/IP */
     ESP_ERROR_CHECK(esp_netif_init());
 
+    /* Local time for the clock overlay, set by SNTP once WiFi is up */
+    setenv("TZ", CONFIG_FRAMEPIX_TIMEZONE, 1);
+    tzset();
+    esp_sntp_config_t sntpConfig = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
+    ESP_ERROR_CHECK(esp_netif_sntp_init(&sntpConfig));
+
     /* Initialize the event loop */
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
@@ -55,6 +214,90 @@ extern "C" void app_main()
         return;
     }
 
+    /* Initialize LED matrix and restore the last used content */
+    LedMatrix matrix(GPIO_NUM_6);
+    if (!matrix.init())
+    {
+        ESP_LOGE(TAG, "Failed to initialize LED matrix");
+        return;
+    }
+    MatrixAnimator<LedMatrix> animator{ matrix };
+    StorageManager storageManager{ spiffs };
+    if (!storageManager.init())
+    {
+        ESP_LOGE(TAG, "Failed to initialize storage manager");
+        return;
+    }
+    const auto bootFrame = lightBootFrame(storageManager, matrix);
+
+    // Which tile of a video wall this device shows, before anything
+    // canvas sized is loaded
+    if (auto canvas = storageManager.loadCanvas())
+    {
+        storageManager.setCanvas(*canvas);
+    }
+
+    ClockOverlay clockOverlay{};
+    if (auto clock = storageManager.loadClock())
+    {
+        clockOverlay.configure(*clock);
+    }
+    animator.addOverlay(clockOverlay);
+
+    // Plays in step with the other devices once WiFi is up
+    TimeSync timeSync{ timeSyncConfig() };
+#if CONFIG_FRAMEPIX_SYNC
+    animator.synchronize(&timeSync);
+#endif
+
+#if CONFIG_FRAMEPIX_RUN_BENCHMARKS
+    // After first light, before the animator draws on the matrix
+    {
+        Bench::Runner runner{};
+        runPipelineBenchmarks(runner, matrix);
+        runShaderBenchmarks(runner, matrix);
+        runStorageBenchmarks(runner);
+        runner.printJson(stdout);
+    }
+#endif
+
+    // An active playlist takes over from the boot frame once its first
+    // item is loaded
+    auto playlist = storageManager.loadPlaylist();
+    const bool playlistActive = playlist && playlist->active;
+    if (bootFrame && !playlistActive)
+    {
+        startBootContent(storageManager, animator, *bootFrame);
+    }
+    PlaylistScheduler playlistScheduler{ storageManager, animator };
+    if (playlistActive)
+    {
+        playlistScheduler.start(std::move(*playlist));
+    }
+
+    // Frames from lighting software take over while they keep coming and
+    // are shown through the animator's live clip, like the designer's
+    using Live = MatrixAnimator<LedMatrix>::Live;
+    std::array<uint8_t, Live::frameMessageSize> liveMessage{
+        static_cast<uint8_t>(Live::Message::Frame)
+    };
+    RealtimeReceiver realtimeReceiver{
+        3 * LedMatrix::numPixels,
+        realtimeConfig(storageManager.canvas()),
+        { .onStart = [&playlistScheduler] { playlistScheduler.stop(); },
+          .onFrame =
+              [&animator, &liveMessage](std::span<const uint8_t> rgb)
+          {
+              std::copy(rgb.begin(), rgb.end(), liveMessage.begin() + 1);
+              animator.draw(liveMessage);
+          },
+          .onEnd = [&]
+          { resumeStoredContent(storageManager, animator, playlistScheduler); } }
+    };
+
+    TaskDiagnostics taskDiagnostics{};
+    taskDiagnostics.start();
+
     // Initialize mDNS
     ESP_ERROR_CHECK(mdns_init());
     ESP_ERROR_CHECK(mdns_hostname_set("framepix"));
@@ -69,30 +312,26 @@ extern "C" void app_main()
     HttpServer httpServer{};
     WifiProvisioningWeb provisioningWeb{ manager, httpServer, spiffs };
 
-    LedMatrix matrix(GPIO_NUM_6);
-    if (!matrix.init())
-    {
-        ESP_LOGE(TAG, "Failed to initialize LED matrix");
-        return;
-    }
-    MatrixAnimator<LedMatrix> animator{ matrix };
-    StorageManager storageManager{ spiffs };
-    if (!storageManager.init())
-    {
-        ESP_LOGE(TAG, "Failed to initialize storage manager");
-        return;
-    }
+    FramepixServer framepixServer{ httpServer,        matrix,
+                                   animator,          provisioningWeb,
+                                   storageManager,    playlistScheduler,
+                                   clockOverlay,      taskDiagnostics,
+                                   timeSync };
 
-    FramepixServer framepixServer{
-        httpServer, matrix, animator, provisioningWeb, storageManager
+    auto onConnected = [&]()
+    {
+        framepixServer.start();
+        realtimeReceiver.start();
+#if CONFIG_FRAMEPIX_SYNC
+        timeSync.start();
+#endif
     };
 
     bool provisioningApplied = false;
     if (provisioningWeb.checkForPreviousProvisioning())
     {
         ESP_LOGI(TAG, "Found previous provisioning");
-        if (provisioningWeb.applyPreviousProvisioning(
-                [&framepixServer]() { framepixServer.start(); }))
+        if (provisioningWeb.applyPreviousProvisioning(onConnected))
         {
             ESP_LOGI(TAG, "Applying previous provisioning");
             provisioningApplied = true;
@@ -108,10 +347,7 @@ extern "C" void app_main()
     }
     if (!provisioningApplied)
     {
-        provisioningWeb.start(
-            "FramePix",
-            "12345678",
-            [&framepixServer]() { framepixServer.start(); });
+        provisioningWeb.start("FramePix", "12345678", onConnected);
     }
 
     while (1)
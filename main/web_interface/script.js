@@ -9,6 +9,7 @@ const redoBtn = document.getElementById('redoBtn');
 const importImageBtn = document.getElementById('importImage');
 const exportImageBtn = document.getElementById('exportImageBtn');
 const applyBtn = document.getElementById('applyImageBtn');
+const liveDrawBtn = document.getElementById('liveDrawBtn');
 
 // Animation related elements
 // Timeline control buttons
@@ -90,6 +91,7 @@ function applyState(state) {
   // update animation frames
   animationFrames[selectedFrameIndex] = captureState();
   renderFrameTimeline();
+  scheduleLiveUpdate();
 }
 
 function pushHistory() {
@@ -219,12 +221,14 @@ function applyTool(innerDiv) {
 
     bucketFill(x, y, targetColor, colorHex);
   }
+  scheduleLiveUpdate();
 }
 
 function clearMatrix() {
   document.querySelectorAll('.matrix .cell div').forEach(inner => {
     inner.style.backgroundColor = '';
   });
+  scheduleLiveUpdate();
   pushHistory();
   // update animation frames
   animationFrames[selectedFrameIndex] = captureState();
@@ -354,6 +358,86 @@ function applyDesign() {
   .catch(console.error);
 }
 
+// Live drawing: the grid is mirrored to the matrix over a WebSocket while
+// it changes, at most once per display frame (about 60 fps). Messages are
+// binary: 0x01 and 256 RGB triples for a whole frame, or 0x02 and
+// (index low, index high, r, g, b) per changed pixel.
+const LIVE_FRAME = 1;
+const LIVE_PIXELS = 2;
+// Frames are skipped while this much is still unsent
+const LIVE_MAX_BUFFERED = 4096;
+let liveSocket = null;
+// Colours the matrix shows, null until a whole frame was sent
+let liveSent = null;
+let liveScheduled = false;
+
+function hexToRgb(hex) {
+  const value = parseInt(hex.slice(1), 16);
+  return [(value >> 16) & 0xff, (value >> 8) & 0xff, value & 0xff];
+}
+
+function scheduleLiveUpdate() {
+  if (!liveSocket || liveScheduled) return;
+  liveScheduled = true;
+  requestAnimationFrame(sendLiveUpdate);
+}
+
+function sendLiveUpdate() {
+  liveScheduled = false;
+  if (!liveSocket || liveSocket.readyState !== WebSocket.OPEN) return;
+  if (liveSocket.bufferedAmount > LIVE_MAX_BUFFERED) {
+    // Try again with the next display frame
+    scheduleLiveUpdate();
+    return;
+  }
+  const design = getMatrixDesign();
+  const changed = [];
+  design.forEach((hex, i) => {
+    if (!liveSent || liveSent[i] !== hex) changed.push(i);
+  });
+  if (changed.length === 0) return;
+
+  let message;
+  if (!liveSent || changed.length * 5 >= design.length * 3) {
+    message = new Uint8Array(1 + design.length * 3);
+    message[0] = LIVE_FRAME;
+    design.forEach((hex, i) => message.set(hexToRgb(hex), 1 + i * 3));
+  } else {
+    message = new Uint8Array(1 + changed.length * 5);
+    message[0] = LIVE_PIXELS;
+    changed.forEach((index, n) => {
+      message.set([index & 0xff, index >> 8, ...hexToRgb(design[index])], 1 + n * 5);
+    });
+  }
+  liveSocket.send(message);
+  liveSent = design;
+}
+
+function setLiveDrawing(enabled) {
+  if (liveSocket) {
+    const socket = liveSocket;
+    liveSocket = null;
+    socket.close();
+  }
+  liveSent = null;
+  liveDrawBtn.textContent = enabled ? "Live: On" : "Live: Off";
+  if (!enabled) return;
+
+  const scheme = location.protocol === 'https:' ? 'wss' : 'ws';
+  const socket = new WebSocket(`${scheme}://${location.host}/ws`);
+  socket.binaryType = 'arraybuffer';
+  socket.onopen = scheduleLiveUpdate;
+  socket.onclose = () => {
+    if (liveSocket === socket) {
+      console.error("Live drawing connection closed");
+      setLiveDrawing(false);
+    }
+  };
+  liveSocket = socket;
+}
+
+liveDrawBtn.addEventListener('click', () => setLiveDrawing(!liveSocket));
+
 function applyAnimation() {
   // Update the current frame with the latest grid state
   animationFrames[selectedFrameIndex] = captureState();
@@ -508,6 +592,14 @@ applyAnimationBtn.addEventListener("click", applyAnimation);
 
 importFramesBtn.addEventListener("change", (e) => {
   const files = Array.from(e.target.files);
+  // An animated GIF goes to the device as it is, it decodes it itself
+  if (files.length === 1 && files[0].type === 'image/gif') {
+    fetch('/upload-gif', { method: 'POST', body: files[0] })
+      .then(res => res.ok ? console.log("GIF uploaded!") : res.text().then(console.error))
+      .catch(console.error);
+    e.target.value = '';
+    return;
+  }
   const readerPromises = files.map(file => new Promise((resolve) => {
     const img = new Image();
     img.onload = () => resolve(img);